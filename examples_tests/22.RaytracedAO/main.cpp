@@ -89,12 +89,11 @@ int main()
 			io::IReadFile* cacheFile = device->getFileSystem()->createAndOpenFile("../../tmp/normalCache101010.sse");
 			if (cacheFile)
 			{
-				asset::normalCacheFor2_10_10_10Quant.resize(cacheFile->getSize() / sizeof(asset::QuantizationCacheEntry2_10_10_10));
-				cacheFile->read(asset::normalCacheFor2_10_10_10Quant.data(), cacheFile->getSize());
+				core::vector<asset::QuantizationCacheEntry2_10_10_10> entries(cacheFile->getSize()/sizeof(asset::QuantizationCacheEntry2_10_10_10));
+				cacheFile->read(entries.data(),cacheFile->getSize());
 				cacheFile->drop();
 
-				//make sure its still ok
-				std::sort(asset::normalCacheFor2_10_10_10Quant.begin(), asset::normalCacheFor2_10_10_10Quant.end());
+				asset::normalCacheFor2_10_10_10Quant.insertEntries(entries.begin(),entries.end());
 			}
 		}
 		//! load the mitsuba scene
@@ -104,7 +103,8 @@ int main()
 			io::IWriteFile* cacheFile = device->getFileSystem()->createAndWriteFile("../../tmp/normalCache101010.sse");
 			if (cacheFile)
 			{
-				cacheFile->write(asset::normalCacheFor2_10_10_10Quant.data(), asset::normalCacheFor2_10_10_10Quant.size() * sizeof(asset::QuantizationCacheEntry2_10_10_10));
+				auto entries = asset::normalCacheFor2_10_10_10Quant.getEntries();
+				cacheFile->write(entries.data(),entries.size()*sizeof(asset::QuantizationCacheEntry2_10_10_10));
 				cacheFile->drop();
 			}
 		}
@@ -251,10 +251,7 @@ int main()
 
 			uint32_t (&out)[][2] = *reinterpret_cast<uint32_t(*)[][2]>(sampleSequence->getPointer());
 			for (auto dim=0u; dim<Renderer::MaxDimensions; dim++)
-			for (uint32_t i=0; i<MaxSamples; i++)
-			{
-				out[(dim>>1u)*MaxSamples+i][dim&0x1u] = sampler.sample(dim,i);
-			}
+				sampler.sampleRange(&out[(dim>>1u)*MaxSamples][dim&0x1u],dim,0u,MaxSamples,2u);
 
 			io::IWriteFile* cacheFile = device->getFileSystem()->createAndWriteFile("../../tmp/rtSamples.bin");
 			if (cacheFile)
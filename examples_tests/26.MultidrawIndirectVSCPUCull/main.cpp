@@ -163,12 +163,11 @@ int main()
         io::IReadFile* cacheFile = device->getFileSystem()->createAndOpenFile("../../tmp/normalCache101010.sse");
         if (cacheFile)
         {
-            asset::normalCacheFor2_10_10_10Quant.resize(cacheFile->getSize()/sizeof(asset::QuantizationCacheEntry2_10_10_10));
-            cacheFile->read(asset::normalCacheFor2_10_10_10Quant.data(),cacheFile->getSize());
+            core::vector<asset::QuantizationCacheEntry2_10_10_10> entries(cacheFile->getSize()/sizeof(asset::QuantizationCacheEntry2_10_10_10));
+            cacheFile->read(entries.data(),cacheFile->getSize());
             cacheFile->drop();
 
-            //make sure its still ok
-            std::sort(asset::normalCacheFor2_10_10_10Quant.begin(),asset::normalCacheFor2_10_10_10Quant.end());
+            asset::normalCacheFor2_10_10_10Quant.insertEntries(entries.begin(),entries.end());
         }
 	}
 
@@ -233,7 +232,8 @@ int main()
         //! cache results -- speeds up mesh generation on second run
         {
             io::IWriteFile* cacheFile = device->getFileSystem()->createAndWriteFile("../../tmp/normalCache101010.sse");
-            cacheFile->write(asset::normalCacheFor2_10_10_10Quant.data(),asset::normalCacheFor2_10_10_10Quant.size()*sizeof(asset::QuantizationCacheEntry2_10_10_10));
+            auto entries = asset::normalCacheFor2_10_10_10Quant.getEntries();
+            cacheFile->write(entries.data(),entries.size()*sizeof(asset::QuantizationCacheEntry2_10_10_10));
             cacheFile->drop();
         }
 
@@ -0,0 +1,118 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using namespace irr;
+
+
+constexpr uint32_t Dimensions = 32u;
+constexpr uint32_t SampleCount = 1u<<20u;
+
+template<typename F>
+double measure(const char* name, F&& f)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	f();
+	auto end = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration<double>(end-start).count();
+	printf("%-40s %8.3f ms %10.2f MSamples/s\n",name,seconds*1000.0,double(Dimensions)*double(SampleCount)/seconds*0.000001);
+	return seconds;
+}
+
+bool verify(const char* name, const core::vector<uint32_t>& reference, const core::vector<uint32_t>& result)
+{
+	if (reference==result)
+		return true;
+	printf("%s produced different samples than the per-sample path!\n",name);
+	return false;
+}
+
+int main()
+{
+	core::vector<uint32_t> reference(Dimensions*SampleCount);
+	core::vector<uint32_t> result(Dimensions*SampleCount);
+	bool passed = true;
+
+	printf("Generating %u samples in %u dimensions\n\n",SampleCount,Dimensions);
+	{
+		core::SobolSampler sampler(Dimensions);
+		measure("SobolSampler::sample",[&]() -> void
+		{
+			for (uint32_t i=0u; i<SampleCount; i++)
+			for (uint32_t dim=0u; dim<Dimensions; dim++)
+				reference[i*Dimensions+dim] = sampler.sample(dim,i);
+		});
+		measure("SobolSampler::sampleRange per dimension",[&]() -> void
+		{
+			for (uint32_t dim=0u; dim<Dimensions; dim++)
+				sampler.sampleRange(result.data()+dim,dim,0u,SampleCount,Dimensions);
+		});
+		passed = verify("SobolSampler::sampleRange per dimension",reference,result)&&passed;
+		std::fill(result.begin(),result.end(),0u);
+		measure("SobolSampler::sampleRange SIMD",[&]() -> void
+		{
+			sampler.sampleRange(result.data(),0u,Dimensions,0u,SampleCount,Dimensions);
+		});
+		passed = verify("SobolSampler::sampleRange SIMD",reference,result)&&passed;
+	}
+	printf("\n");
+	{
+		core::OwenSampler<> sampler(Dimensions,0xdeadbeefu);
+		measure("OwenSampler::sample",[&]() -> void
+		{
+			for (uint32_t dim=0u; dim<Dimensions; dim++)
+			for (uint32_t i=0u; i<SampleCount; i++)
+				reference[i*Dimensions+dim] = sampler.sample(dim,i);
+		});
+		core::OwenSampler<> rangeSampler(Dimensions,0xdeadbeefu);
+		measure("OwenSampler::sampleRange",[&]() -> void
+		{
+			for (uint32_t dim=0u; dim<Dimensions; dim++)
+				rangeSampler.sampleRange(result.data()+dim,dim,0u,SampleCount,Dimensions);
+		});
+		passed = verify("OwenSampler::sampleRange",reference,result)&&passed;
+	}
+	printf("\n");
+	{
+		const core::HashedOwenSampler<> sampler(Dimensions,0xdeadbeefu);
+		measure("HashedOwenSampler::sample",[&]() -> void
+		{
+			for (uint32_t i=0u; i<SampleCount; i++)
+			for (uint32_t dim=0u; dim<Dimensions; dim++)
+				reference[i*Dimensions+dim] = sampler.sample(dim,i);
+		});
+		measure("HashedOwenSampler::sampleRange SIMD",[&]() -> void
+		{
+			sampler.sampleRange(result.data(),0u,Dimensions,0u,SampleCount,Dimensions);
+		});
+		passed = verify("HashedOwenSampler::sampleRange SIMD",reference,result)&&passed;
+
+		std::fill(result.begin(),result.end(),0u);
+		const uint32_t threadCount = core::max(std::thread::hardware_concurrency(),1u);
+		measure("HashedOwenSampler::sampleRange threaded",[&]() -> void
+		{
+			core::vector<std::thread> threads;
+			const uint32_t samplesPerThread = (SampleCount+threadCount-1u)/threadCount;
+			for (uint32_t t=0u; t<threadCount; t++)
+			{
+				const uint32_t first = t*samplesPerThread;
+				if (first>=SampleCount)
+					break;
+				const uint32_t count = core::min(samplesPerThread,SampleCount-first);
+				threads.emplace_back([&,first,count]() -> void
+				{
+					sampler.sampleRange(result.data()+first*Dimensions,0u,Dimensions,first,count,Dimensions);
+				});
+			}
+			for (auto& thread : threads)
+				thread.join();
+		});
+		passed = verify("HashedOwenSampler::sampleRange threaded",reference,result)&&passed;
+	}
+
+	printf("\n%s\n",passed ? "All bulk paths match the per-sample path.":"FAILED");
+	return passed ? 0:1;
+}
@@ -0,0 +1,105 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <cstdio>
+
+using namespace irr;
+
+
+//! Box which only counts how many times it was drawn, so the test does not need a GPU
+class CBoxSceneNode : public scene::ISceneNode
+{
+	public:
+		CBoxSceneNode(scene::ISceneManager* mgr, const core::vector3df& position, const core::vector3df& halfExtent)
+			: scene::ISceneNode(mgr->getRootSceneNode(),mgr,-1,position), Box(-halfExtent,halfExtent), RenderCount(0u)
+		{
+		}
+
+		void OnRegisterSceneNode() override
+		{
+			if (IsVisible)
+				SceneManager->registerNodeForRendering(this,scene::ESNRP_SOLID);
+			ISceneNode::OnRegisterSceneNode();
+		}
+
+		void render() override { RenderCount++; }
+
+		const core::aabbox3d<float>& getBoundingBox() override { return Box; }
+
+		core::aabbox3df Box;
+		uint32_t RenderCount;
+};
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = core::dimension2d<uint32_t>(1280, 720);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+	video::IVideoDriver* driver = device->getVideoDriver();
+	smgr->addCameraSceneNode(nullptr,core::vector3df(0.f,0.f,0.f),core::vectorSIMDf(0.f,0.f,100.f));
+
+	// a big wall in front of the camera, its own shape is the occluder
+	auto wallMesh = device->getAssetManager()->getGeometryCreator()->createCubeMesh(core::vector3df(100.f,100.f,1.f));
+	auto* wall = new CBoxSceneNode(smgr,core::vector3df(0.f,0.f,50.f),core::vector3df(50.f,50.f,0.5f));
+	scene::IOcclusionCuller* culler = smgr->getOcclusionCuller();
+	culler->addOccluder(wallMesh->getMeshBuffer(0u),wall);
+	culler->setEnabled(true);
+
+	core::vector<CBoxSceneNode*> hidden,visible;
+	for (int32_t y=-4; y<=4; y++)
+	for (int32_t x=-4; x<=4; x++)
+		hidden.push_back(new CBoxSceneNode(smgr,core::vector3df(x*8.f,y*8.f,80.f),core::vector3df(1.f,1.f,1.f)));
+	// in front of the wall, and behind it but off to the side
+	visible.push_back(new CBoxSceneNode(smgr,core::vector3df(0.f,0.f,20.f),core::vector3df(1.f,1.f,1.f)));
+	visible.push_back(new CBoxSceneNode(smgr,core::vector3df(10.f,-5.f,30.f),core::vector3df(2.f,2.f,2.f)));
+	visible.push_back(new CBoxSceneNode(smgr,core::vector3df(70.f,0.f,60.f),core::vector3df(5.f,5.f,5.f)));
+	// straddles the wall, so it pokes out in front of it
+	visible.push_back(new CBoxSceneNode(smgr,core::vector3df(0.f,20.f,50.f),core::vector3df(3.f,3.f,3.f)));
+	visible.push_back(wall);
+
+	driver->beginScene(true,true,video::SColor(255,0,0,0));
+	smgr->drawAll();
+	driver->endScene();
+
+	bool passed = true;
+	for (auto node : hidden)
+	if (node->RenderCount)
+	{
+		printf("Box at (%f,%f,%f) should have been occluded!\n",node->getPosition().X,node->getPosition().Y,node->getPosition().Z);
+		passed = false;
+	}
+	for (auto node : visible)
+	if (!node->RenderCount)
+	{
+		printf("Box at (%f,%f,%f) should have been drawn!\n",node->getPosition().X,node->getPosition().Y,node->getPosition().Z);
+		passed = false;
+	}
+
+	const auto& stats = smgr->getCullingStatistics();
+	printf("Tested %u nodes, %u frustum culled, %u occlusion culled, %u submitted\n",stats.testedNodes,stats.frustumCulledNodes,stats.occlusionCulledNodes,stats.submittedNodes);
+	printf("Rasterized %u occluder triangles\n",culler->getStatistics().rasterizedTriangles);
+	if (stats.occlusionCulledNodes!=hidden.size() || stats.submittedNodes!=visible.size())
+		passed = false;
+
+	// with the culler off everything in the frustum is drawn again
+	culler->setEnabled(false);
+	driver->beginScene(true,true,video::SColor(255,0,0,0));
+	smgr->drawAll();
+	driver->endScene();
+	if (smgr->getCullingStatistics().occlusionCulledNodes || smgr->getCullingStatistics().submittedNodes!=hidden.size()+visible.size())
+		passed = false;
+
+	for (auto node : hidden)
+		node->drop();
+	for (auto node : visible)
+		node->drop();
+	device->drop();
+
+	printf(passed ? "Passed\n":"FAILED\n");
+	return passed ? 0:1;
+}
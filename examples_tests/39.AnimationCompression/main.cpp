@@ -0,0 +1,195 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <cmath>
+#include <cstdio>
+
+using namespace irr;
+using namespace asset;
+
+
+constexpr uint32_t BoneCount = 19u;
+constexpr uint32_t KeyframeCount = 240u;
+
+//! Procedural animation with every kind of track the compressor treats differently
+CFinalBoneHierarchy::AnimationKeyData makeKey(uint32_t boneID, uint32_t keyIx, bool interpolated)
+{
+	const float time = float(keyIx)/30.f;
+	CFinalBoneHierarchy::AnimationKeyData key;
+
+	// smooth rotation around a tilted axis, some bones go the long way around so the quaternions cross the sign boundary
+	const float angle = 0.3f*float(boneID)+time*(boneID%3u==0u ? 4.f:1.f);
+	core::vectorSIMDf axis = core::normalize(core::vectorSIMDf(1.f,float(boneID%4u),0.5f,0.f));
+	const float s = std::sin(angle*0.5f);
+	key.Rotation[0] = axis.x*s;
+	key.Rotation[1] = axis.y*s;
+	key.Rotation[2] = axis.z*s;
+	key.Rotation[3] = std::cos(angle*0.5f);
+
+	for (uint32_t i=0u; i<3u; i++)
+	{
+		if (interpolated)
+			key.Position[i] = boneID%2u ? 2.f*std::sin(time*float(i+1u)):0.5f*float(i);
+		else // steps
+			key.Position[i] = float((keyIx/17u)%5u)-float(i);
+		// travels so far that 16 bits over the range of the track can't stay within the error bounds
+		if (boneID==BoneCount-1u)
+			key.Position[i] = interpolated ? 1000.f*std::sin(time*0.5f+float(i)):key.Position[i]*1000.f;
+		// scales stay constant on most bones
+		key.Scale[i] = boneID%5u==4u ? 1.f+0.25f*std::sin(time):1.f;
+	}
+	key.Padding[0] = key.Padding[1] = 0.f;
+	return key;
+}
+
+//! largest difference of any component, quaternions are compared with the sign that makes them closest
+float keyError(const float* a, const float* b, uint32_t count, bool rotation)
+{
+	float sign = 1.f;
+	if (rotation && a[0]*b[0]+a[1]*b[1]+a[2]*b[2]+a[3]*b[3]<0.f)
+		sign = -1.f;
+	float retval = 0.f;
+	for (uint32_t i=0u; i<count; i++)
+		retval = core::max(retval,std::abs(a[i]-b[i]*sign));
+	return retval;
+}
+
+//! Compares the keys of `fbh` against the procedural ones, returns the number of keys out of bounds
+uint32_t checkKeys(const char* name, const CFinalBoneHierarchy* fbh, const CFinalBoneHierarchy::SAnimationCompressionParams& params)
+{
+	// the error bound is on values the keys were quantized to, so float rounding of the decode gets a little slack
+	constexpr float Slack = 1e-6f;
+	float maxError[3] = {0.f,0.f,0.f};
+	uint32_t failures = 0u;
+	for (uint32_t boneID=0u; boneID<BoneCount; boneID++)
+	for (uint32_t keyIx=0u; keyIx<KeyframeCount; keyIx++)
+	for (uint32_t track=0u; track<2u; track++)
+	{
+		const bool interpolated = track==0u;
+		const auto expected = makeKey(boneID,keyIx,interpolated);
+		const auto actual = fbh->getAnimationKey(boneID,keyIx,interpolated);
+		const float error[3] = {
+			keyError(expected.Rotation,actual.Rotation,4u,true),
+			keyError(expected.Position,actual.Position,3u,false),
+			keyError(expected.Scale,actual.Scale,3u,false)
+		};
+		const float bound[3] = {params.maxRotationError,params.maxPositionError,params.maxScaleError};
+		bool failed = false;
+		for (uint32_t i=0u; i<3u; i++)
+		{
+			maxError[i] = core::max(maxError[i],error[i]);
+			failed = failed||error[i]>bound[i]+Slack;
+		}
+		if (failed && failures++<8u)
+			printf("\t%s: bone %u key %u %s out of bounds (rotation %f position %f scale %f)\n",name,boneID,keyIx,interpolated ? "interpolated":"non interpolated",error[0],error[1],error[2]);
+	}
+	printf("%-40s largest error rotation %f position %f scale %f, %u keys out of bounds\n",name,maxError[0],maxError[1],maxError[2],failures);
+	return failures;
+}
+
+int main()
+{
+	core::vector<CFinalBoneHierarchy::BoneReferenceData> bones(BoneCount);
+	core::vector<core::stringc> boneNames(BoneCount);
+	for (uint32_t i=0u; i<BoneCount; i++)
+	{
+		bones[i].PoseBindMatrix = core::matrix3x4SIMD();
+		for (uint32_t j=0u; j<3u; j++)
+		{
+			bones[i].MinBBoxEdge[j] = -1.f;
+			bones[i].MaxBBoxEdge[j] = 1.f;
+		}
+		// a chain, every bone is the child of the one before it
+		bones[i].parentOffsetRelative = i ? 1u:0u;
+		bones[i].parentOffsetFromTop = i ? (i-1u):0u;
+		boneNames[i] = ("bone"+std::to_string(i)).c_str();
+	}
+	core::vector<size_t> levels(BoneCount);
+	for (uint32_t i=0u; i<BoneCount; i++)
+		levels[i] = i+1u;
+	core::vector<float> keyframes(KeyframeCount);
+	for (uint32_t i=0u; i<KeyframeCount; i++)
+		keyframes[i] = float(i);
+	core::vector<CFinalBoneHierarchy::AnimationKeyData> interpolated(BoneCount*KeyframeCount), nonInterpolated(BoneCount*KeyframeCount);
+	for (uint32_t boneID=0u; boneID<BoneCount; boneID++)
+	for (uint32_t keyIx=0u; keyIx<KeyframeCount; keyIx++)
+	{
+		interpolated[boneID*KeyframeCount+keyIx] = makeKey(boneID,keyIx,true);
+		nonInterpolated[boneID*KeyframeCount+keyIx] = makeKey(boneID,keyIx,false);
+	}
+
+	auto fbh = core::make_smart_refctd_ptr<CFinalBoneHierarchy>(
+		bones.data(), bones.data()+BoneCount,
+		boneNames.data(), boneNames.data()+BoneCount,
+		levels.data(), levels.data()+BoneCount,
+		keyframes.data(), keyframes.data()+KeyframeCount,
+		interpolated.data(), interpolated.data()+interpolated.size(),
+		nonInterpolated.data(), nonInterpolated.data()+nonInterpolated.size(),
+		false
+	);
+
+	const CFinalBoneHierarchy::SAnimationCompressionParams params;
+	uint32_t failures = checkKeys("uncompressed",fbh.get(),params);
+
+	const size_t rawSize = 2u*sizeof(CFinalBoneHierarchy::AnimationKeyData)*fbh->getAnimationCount();
+	fbh->compressAnimations(params);
+	if (!fbh->hasCompressedAnimations() || fbh->getInterpolatedAnimationData() || fbh->getNonInterpolatedAnimationData())
+	{
+		printf("compressAnimations did not replace the raw keys!\n");
+		return 1;
+	}
+	printf("%zu bytes of keys compressed to %zu\n",rawSize,fbh->getCompressedAnimationDataSize());
+	failures += checkKeys("compressed",fbh.get(),params);
+
+	// write the blob the way the .baw writer does, and load it back
+	const size_t blobSize = FinalBoneHierarchyBlobV3::calcBlobSizeForObj(fbh.get());
+	void* blob = fbh->serializeToBlob();
+	if (!(reinterpret_cast<const FinalBoneHierarchyBlobV3*>(blob)->finalBoneHierarchyFlags&FinalBoneHierarchyBlobV3::EBFBHF_COMPRESSED_ANIMATIONS))
+	{
+		printf("blob of a compressed hierarchy is missing EBFBHF_COMPRESSED_ANIMATIONS!\n");
+		return 1;
+	}
+	BlobLoadingParams loadingParams{nullptr,nullptr,nullptr,io::path(),IAssetLoader::SAssetLoadParams(),nullptr};
+	auto loaded = core::smart_refctd_ptr<CFinalBoneHierarchy>(
+		reinterpret_cast<CFinalBoneHierarchy*>(TypedBlob<FinalBoneHierarchyBlobV3,CFinalBoneHierarchy>::instantiateEmpty(blob,blobSize,loadingParams)),
+		core::dont_grab
+	);
+	_IRR_ALIGNED_FREE(blob);
+	if (!loaded || !loaded->hasCompressedAnimations() || loaded->getCompressedAnimationDataSize()!=fbh->getCompressedAnimationDataSize() ||
+		memcmp(loaded->getCompressedAnimationData(),fbh->getCompressedAnimationData(),fbh->getCompressedAnimationDataSize()))
+	{
+		printf("compressed animations did not survive the blob round trip!\n");
+		return 1;
+	}
+	failures += checkKeys("compressed, reloaded from blob",loaded.get(),params);
+
+	loaded->decompressAnimations();
+	if (loaded->hasCompressedAnimations() || !loaded->getInterpolatedAnimationData() || !loaded->getNonInterpolatedAnimationData())
+	{
+		printf("decompressAnimations did not restore the raw keys!\n");
+		return 1;
+	}
+	failures += checkKeys("decompressed",loaded.get(),params);
+
+	// a hierarchy without keyframes has no tracks to compress
+	{
+		auto empty = core::make_smart_refctd_ptr<CFinalBoneHierarchy>(
+			bones.data(), bones.data()+BoneCount,
+			boneNames.data(), boneNames.data()+BoneCount,
+			levels.data(), levels.data()+BoneCount,
+			keyframes.data(), keyframes.data(),
+			interpolated.data(), interpolated.data(),
+			nonInterpolated.data(), nonInterpolated.data(),
+			false
+		);
+		empty->compressAnimations(params);
+		if (empty->hasCompressedAnimations())
+		{
+			printf("compressAnimations compressed a hierarchy without keyframes!\n");
+			failures++;
+		}
+	}
+
+	printf("\n%s\n",failures ? "FAILED":"All keys within the compression error bounds.");
+	return failures ? 1:0;
+}
@@ -0,0 +1,140 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <cstdio>
+
+using namespace irr;
+
+
+//! Stands in for a fence, the test decides when each point of the timeline gets signalled
+class FakeEvent
+{
+		const core::vector<bool>*	signalled;
+		uint32_t					timelinePoint;
+	public:
+		FakeEvent(const core::vector<bool>* _signalled, uint32_t _timelinePoint) : signalled(_signalled), timelinePoint(_timelinePoint) {}
+
+		inline bool operator==(const FakeEvent& other) const {return timelinePoint==other.timelinePoint;}
+
+		inline bool poll() const {return (*signalled)[timelinePoint];}
+
+		//! nothing signals behind the test's back, so waiting can't change the outcome
+		template<class Clock, class Duration>
+		inline bool wait_until(const std::chrono::time_point<Clock,Duration>& timeout_time) const {return poll();}
+};
+
+//! Records the ranges it frees into a log, like the default free functor of SubAllocatedDataBuffer it takes over the ranges of the functors after it
+class FakeFree
+{
+		core::vector<uint32_t>*	log;
+		uint32_t*				callCount;
+		core::vector<uint32_t>	ranges;
+	public:
+		FakeFree(core::vector<uint32_t>* _log, uint32_t* _callCount, uint32_t range) : log(_log), callCount(_callCount), ranges(1u,range) {}
+
+		inline void absorb(FakeFree&& other)
+		{
+			ranges.insert(ranges.end(),other.ranges.begin(),other.ranges.end());
+			other.ranges.clear();
+		}
+
+		inline bool operator()()
+		{
+			(*callCount)++;
+			log->insert(log->end(),ranges.begin(),ranges.end());
+			return false;
+		}
+};
+
+typedef core::EventDeferredHandlerTimelineST<FakeEvent,FakeFree> Handler;
+
+
+bool check(bool condition, const char* what)
+{
+	printf("%-72s %s\n",what,condition ? "OK":"FAILED");
+	return condition;
+}
+
+int main()
+{
+	bool passed = true;
+
+	// functors only run once all the earlier points of the timeline have signalled
+	{
+		core::vector<bool> signalled(4u,false);
+		core::vector<uint32_t> log;
+		uint32_t callCount = 0u;
+		{
+			Handler handler;
+			for (uint32_t i=0u; i<4u; i++)
+				handler.addEvent(FakeEvent(&signalled,i),FakeFree(&log,&callCount,i));
+			passed = check(handler.getEventsCount()==4u,"one functor pending per timeline point")&&passed;
+
+			signalled[2] = signalled[3] = true;
+			passed = check(handler.pollForReadyEvents()==4u&&log.empty(),"later points signalled first run nothing")&&passed;
+			passed = check(handler.cullEvents(0u)==4u&&log.empty(),"culling does not skip over the unsignalled oldest point")&&passed;
+
+			signalled[0] = true;
+			passed = check(handler.pollForReadyEvents()==3u&&log==core::vector<uint32_t>{0u},"signalling the oldest point runs only its functor")&&passed;
+
+			signalled[1] = true;
+			const bool drained = handler.waitUntilForReadyEvents(std::chrono::high_resolution_clock::now())==0u;
+			passed = check(drained&&log==core::vector<uint32_t>({0u,1u,2u,3u}),"signalling the gap runs everything after it in timeline order")&&passed;
+		}
+		passed = check(callCount==4u,"every functor ran exactly once")&&passed;
+	}
+
+	// an event added behind a later one only waits for the events before it
+	{
+		core::vector<bool> signalled(3u,false);
+		core::vector<uint32_t> log;
+		uint32_t callCount = 0u;
+		{
+			Handler handler;
+			handler.addEvent(FakeEvent(&signalled,2u),FakeFree(&log,&callCount,2u));
+			handler.addEvent(FakeEvent(&signalled,0u),FakeFree(&log,&callCount,0u));
+
+			signalled[0] = true;
+			passed = check(handler.pollForReadyEvents()==2u&&log.empty(),"event added out of order does not run before the ones added earlier")&&passed;
+
+			signalled[2] = true;
+			passed = check(handler.pollForReadyEvents()==0u&&log==core::vector<uint32_t>({2u,0u}),"it runs as soon as they have signalled")&&passed;
+		}
+		passed = check(callCount==2u,"every functor ran exactly once")&&passed;
+	}
+
+	// consecutive frees on the same event get absorbed into one functor
+	{
+		core::vector<bool> signalled(2u,false);
+		core::vector<uint32_t> log;
+		uint32_t callCount = 0u;
+		{
+			Handler handler;
+			for (uint32_t i=0u; i<3u; i++)
+				handler.addEvent(FakeEvent(&signalled,0u),FakeFree(&log,&callCount,i));
+			handler.addEvent(FakeEvent(&signalled,1u),FakeFree(&log,&callCount,3u));
+			handler.addEvent(FakeEvent(&signalled,1u),FakeFree(&log,&callCount,4u));
+			passed = check(handler.getEventsCount()==2u,"adjacent frees on the same event are merged")&&passed;
+
+			signalled[0] = signalled[1] = true;
+			passed = check(handler.pollForReadyEvents()==0u,"merged frees retire together")&&passed;
+			passed = check(callCount==2u&&log==core::vector<uint32_t>({0u,1u,2u,3u,4u}),"one call per event frees all the absorbed ranges in order")&&passed;
+		}
+	}
+
+	// the destructor waits for and runs whatever is still pending
+	{
+		core::vector<bool> signalled(2u,true);
+		core::vector<uint32_t> log;
+		uint32_t callCount = 0u;
+		{
+			Handler handler;
+			handler.addEvent(FakeEvent(&signalled,0u),FakeFree(&log,&callCount,0u));
+			handler.addEvent(FakeEvent(&signalled,1u),FakeFree(&log,&callCount,1u));
+		}
+		passed = check(callCount==2u&&log==core::vector<uint32_t>({0u,1u}),"destruction flushes pending functors")&&passed;
+	}
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
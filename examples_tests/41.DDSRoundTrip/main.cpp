@@ -0,0 +1,148 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+#include "irr/asset/format/compressBlocks.h"
+
+#include <cstdio>
+#include <string>
+
+using namespace irr;
+using namespace asset;
+
+
+constexpr uint32_t Extent = 8u;
+
+core::smart_refctd_ptr<CImageData> createImage(E_FORMAT format)
+{
+	const uint32_t minCoord[3] = {0u,0u,0u};
+	const uint32_t maxCoord[3] = {Extent,Extent,1u};
+	auto image = core::make_smart_refctd_ptr<CImageData>(nullptr,minCoord,maxCoord,0u,format);
+	// a pattern that keeps the bytes of every channel apart, so swapped or reinterpreted channels show up
+	uint8_t* data = reinterpret_cast<uint8_t*>(image->getData());
+	for (size_t i=0u; i<image->getImageDataSizeInBytes(); i++)
+		data[i] = uint8_t(i*37u+(i/7u));
+	return image;
+}
+
+//! the fourCC of the pixel format, 'DX10' when the extended header follows
+uint32_t readFourCC(io::IFileSystem* fs, const std::string& path)
+{
+	uint32_t fourCC = 0u;
+	io::IReadFile* file = fs->createAndOpenFile(path.c_str());
+	if (!file)
+		return 0u;
+	file->seek(84u);
+	file->read(&fourCC,sizeof(fourCC));
+	file->drop();
+	return fourCC;
+}
+
+constexpr uint32_t DX10FourCC = uint32_t('D')|(uint32_t('X')<<8u)|(uint32_t('1')<<16u)|(uint32_t('0')<<24u);
+
+struct STestCase
+{
+	E_FORMAT source;
+	bool compress;
+	//! EF_UNKNOWN if the writer has to refuse
+	E_FORMAT expected;
+	bool legacyHeader;
+};
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = core::dimension2d<uint32_t>(640, 480);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+
+	IAssetManager* am = device->getAssetManager();
+	io::IFileSystem* fs = device->getFileSystem();
+
+	const STestCase testCases[] = {
+		// linear formats must not come back as sRGB, which is what the reader makes of the legacy masks and DXTn
+		{EF_R8G8B8A8_UNORM,false,EF_R8G8B8A8_UNORM,false},
+		{EF_R8G8B8A8_SRGB,false,EF_R8G8B8A8_SRGB,true},
+		{EF_B8G8R8A8_UNORM,false,EF_B8G8R8A8_UNORM,false},
+		{EF_B8G8R8A8_SRGB,false,EF_B8G8R8A8_SRGB,true},
+		{EF_R8G8B8_SRGB,false,EF_R8G8B8_SRGB,true},
+		{EF_R8_UNORM,false,EF_R8_UNORM,false},
+		{EF_R8G8_SNORM,false,EF_R8G8_SNORM,false},
+		{EF_R16G16B16A16_SFLOAT,false,EF_R16G16B16A16_SFLOAT,false},
+		// compressed on the way out
+		{EF_R8G8B8A8_UNORM,true,EF_BC3_UNORM_BLOCK,false},
+		{EF_R8G8B8A8_SRGB,true,EF_BC3_SRGB_BLOCK,true},
+		{EF_R8G8B8_UNORM,true,EF_BC1_RGBA_UNORM_BLOCK,false},
+		{EF_R8G8B8_SRGB,true,EF_BC1_RGB_SRGB_BLOCK,true},
+		{EF_R8_UNORM,true,EF_BC4_UNORM_BLOCK,true},
+		{EF_R8_SNORM,true,EF_BC4_SNORM_BLOCK,true},
+		{EF_R8G8_UNORM,true,EF_BC5_UNORM_BLOCK,true},
+		{EF_R8G8_SNORM,true,EF_BC5_SNORM_BLOCK,true},
+		// nothing we can encode keeps these values
+		{EF_R16G16B16A16_SFLOAT,true,EF_UNKNOWN,false},
+		{EF_R8G8B8A8_SNORM,true,EF_UNKNOWN,false},
+		{EF_R8G8B8A8_UINT,true,EF_UNKNOWN,false}
+	};
+
+	bool passed = true;
+	for (uint32_t i=0u; i<sizeof(testCases)/sizeof(STestCase); i++)
+	{
+		const auto& testCase = testCases[i];
+		const std::string path = "roundtrip_"+std::to_string(i)+".dds";
+
+		auto image = createImage(testCase.source);
+		const bool written = am->writeAsset(path,IAssetWriter::SAssetWriteParams(image.get(),testCase.compress ? EWF_COMPRESSED:EWF_NONE));
+		if (testCase.expected==EF_UNKNOWN)
+		{
+			const bool ok = !written;
+			printf("%2u: format %u compressed, writer refuses %s\n",i,uint32_t(testCase.source),ok ? "OK":"FAILED");
+			passed = passed&&ok;
+			continue;
+		}
+
+		const char* failure = nullptr;
+		if (!written)
+			failure = "could not write";
+		else if ((readFourCC(fs,path)!=DX10FourCC)!=testCase.legacyHeader)
+			failure = "wrong header";
+
+		// the bytes we expect in the file, compressed the same way the writer does
+		core::smart_refctd_ptr<ICPUTexture> reference;
+		const CImageData* expectedImage = image.get();
+		if (!failure && testCase.compress)
+		{
+			auto sourceTexture = core::smart_refctd_ptr<ICPUTexture>(ICPUTexture::create(core::vector<CImageData*>{image.get()},""),core::dont_grab);
+			reference = core::smart_refctd_ptr<ICPUTexture>(createBlockCompressedTexture(sourceTexture.get(),testCase.expected),core::dont_grab);
+			expectedImage = reference ? reference->getMipMap(0u).first[0]:nullptr;
+			if (!expectedImage)
+				failure = "could not compress the reference";
+		}
+
+		if (!failure)
+		{
+			auto bundle = am->getAsset(path,{});
+			auto contents = bundle.getContents();
+			if (contents.first==contents.second)
+				failure = "could not load";
+			else
+			{
+				auto texture = core::smart_refctd_ptr_static_cast<ICPUTexture>(*contents.first);
+				const CImageData* loaded = texture->getMipMap(0u).first[0];
+				if (texture->getColorFormat()!=testCase.expected || loaded->getColorFormat()!=testCase.expected)
+					failure = "loaded with another format";
+				else if (loaded->getImageDataSizeInBytes()!=expectedImage->getImageDataSizeInBytes() ||
+						memcmp(loaded->getData(),expectedImage->getData(),expectedImage->getImageDataSizeInBytes()))
+					failure = "texels differ";
+				am->removeAssetFromCache(bundle);
+			}
+		}
+
+		printf("%2u: format %u%s to format %u %s%s\n",i,uint32_t(testCase.source),testCase.compress ? " compressed":"",uint32_t(testCase.expected),failure ? "FAILED, ":"OK",failure ? failure:"");
+		passed = passed&&!failure;
+	}
+
+	device->drop();
+
+	printf("\n%s\n",passed ? "All formats survive the round trip.":"FAILED");
+	return passed ? 0:1;
+}
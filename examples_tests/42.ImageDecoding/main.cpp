@@ -0,0 +1,145 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace irr;
+using namespace asset;
+
+
+const char* JPEGs[] = {
+	"../../media/color_space_test/R8G8B8_1.jpg",
+	"../../media/color_space_test/R8G8B8_2.jpg",
+	"../../media/color_space_test/R8_1.jpg",
+	"../../media/color_space_test/R8_2.jpg",
+	"../../media/axe.jpg",
+	"../../media/wall.jpg"
+};
+const char* PNGs[] = {
+	"../../media/color_space_test/R8G8B8A8_1.png",
+	"../../media/color_space_test/R8G8B8A8_2.png",
+	"../../media/color_space_test/R8G8B8_1.png",
+	"../../media/color_space_test/R8G8B8_2.png",
+	"../../media/color_space_test/R8_1.png",
+	"../../media/color_space_test/R8_2.png"
+};
+constexpr uint32_t FileCount = sizeof(JPEGs)/sizeof(const char*);
+static_assert(FileCount==sizeof(PNGs)/sizeof(const char*), "as many PNGs as JPEGs");
+
+bool check(bool condition, const char* what, const char* file = "")
+{
+	printf("%-64s %s %s\n",what,condition ? "OK":"FAILED",file);
+	return condition;
+}
+
+bool sameImage(const CImageData* a, const CImageData* b)
+{
+	return a && b && a->getColorFormat()==b->getColorFormat() && a->getSize()==b->getSize() &&
+		a->getImageDataSizeInBytes()==b->getImageDataSizeInBytes() && !memcmp(a->getData(),b->getData(),a->getImageDataSizeInBytes());
+}
+
+//! decodes every file one by one, then all of them as a batch, and checks they decode the same
+template<class Decode, class DecodeBatch>
+bool testBatch(io::IFileSystem* fs, const char* const* paths, Decode decode, DecodeBatch decodeBatch, const char* name)
+{
+	bool passed = true;
+	io::IReadFile* files[FileCount];
+	CImageData* single[FileCount];
+	CImageData* batch[FileCount];
+	for (uint32_t i=0u; i<FileCount; i++)
+	{
+		files[i] = fs->createAndOpenFile(paths[i]);
+		if (!files[i])
+		{
+			printf("Could not open %s\n",paths[i]);
+			return false;
+		}
+		single[i] = decode(files[i]);
+		files[i]->seek(0u);
+	}
+	decodeBatch(files,batch);
+	for (uint32_t i=0u; i<FileCount; i++)
+	{
+		passed = check(single[i]&&sameImage(single[i],batch[i]),name,paths[i])&&passed;
+		if (single[i])
+			single[i]->drop();
+		if (batch[i])
+			batch[i]->drop();
+		files[i]->drop();
+	}
+	return passed;
+}
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = core::dimension2d<uint32_t>(640, 480);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+
+	IAssetManager* am = device->getAssetManager();
+	io::IFileSystem* fs = device->getFileSystem();
+	bool passed = true;
+
+	passed = testBatch(fs,JPEGs,[](io::IReadFile* file) {return decodeJPEG(file);},
+		[](io::IReadFile* const* files, CImageData** images) {decodeJPEGBatch(files,FileCount,0u,images);},"JPEG batch decodes like single files")&&passed;
+	passed = testBatch(fs,JPEGs,[](io::IReadFile* file) {return decodeJPEG(file,64u);},
+		[](io::IReadFile* const* files, CImageData** images) {decodeJPEGBatch(files,FileCount,64u,images);},"JPEG batch at reduced resolution decodes like single files")&&passed;
+	passed = testBatch(fs,PNGs,[](io::IReadFile* file) {return decodePNG(file);},
+		[](io::IReadFile* const* files, CImageData** images) {decodePNGBatch(files,FileCount,images);},"PNG batch decodes like single files")&&passed;
+
+	// reduced resolution picks the smallest DCT scale which still covers what was asked for
+	for (uint32_t i=0u; i<FileCount; i++)
+	{
+		io::IReadFile* file = fs->createAndOpenFile(JPEGs[i]);
+		auto full = core::smart_refctd_ptr<CImageData>(decodeJPEG(file),core::dont_grab);
+		if (!full)
+		{
+			passed = check(false,"JPEG decodes",JPEGs[i]);
+			file->drop();
+			continue;
+		}
+		const auto fullSize = full->getSize();
+		const uint32_t longestSide = core::max(fullSize.X,fullSize.Y);
+		// a quarter of the longest side, rounded up, is exactly what a 1/4 scale decodes to
+		const uint32_t maxResolution = (longestSide+3u)/4u;
+		file->seek(0u);
+		auto reduced = core::smart_refctd_ptr<CImageData>(decodeJPEG(file,maxResolution),core::dont_grab);
+		file->drop();
+		const bool quarterSize = reduced && reduced->getSize()==core::vector3d<uint32_t>((fullSize.X+3u)/4u,(fullSize.Y+3u)/4u,1u);
+		passed = check(quarterSize&&reduced->getColorFormat()==full->getColorFormat(),"JPEG decodes at a quarter of its size",JPEGs[i])&&passed;
+
+		// the same through the asset manager
+		IAssetLoader::SAssetLoadParams lparams(0u,nullptr,IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL,nullptr,IAssetLoader::ELPF_NONE,maxResolution);
+		auto bundle = am->getAsset(JPEGs[i],lparams);
+		const bool loaded = bundle.getContents().first!=bundle.getContents().second;
+		const CImageData* loadedImage = loaded ? static_cast<ICPUTexture*>(bundle.getContents().first->get())->getMipMap(0u).first[0]:nullptr;
+		passed = check(sameImage(loadedImage,reduced.get()),"maxImageResolution reaches the JPEG loader",JPEGs[i])&&passed;
+	}
+
+	// a broken file makes libjpeg bail out, the decompressor of the thread has to be usable for the next file
+	{
+		const char garbage[] = "\xFF\xD8\xFF\xE0 definitely not the rest of a JPEG";
+		io::IReadFile* file = fs->createMemoryReadFile(garbage,sizeof(garbage),"garbage.jpg");
+		CImageData* image = decodeJPEG(file);
+		file->drop();
+		passed = check(!image,"broken JPEG fails to decode")&&passed;
+		if (image)
+			image->drop();
+
+		file = fs->createAndOpenFile(JPEGs[0]);
+		image = decodeJPEG(file);
+		file->drop();
+		passed = check(image!=nullptr,"next JPEG on the same thread decodes")&&passed;
+		if (image)
+			image->drop();
+	}
+
+	device->drop();
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
@@ -0,0 +1,150 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <cstdio>
+#include <chrono>
+
+using namespace irr;
+using namespace core;
+
+
+bool check(bool condition, const char* what)
+{
+	printf("%-72s %s\n",what,condition ? "OK":"FAILED");
+	return condition;
+}
+
+void sleepFor(uint32_t milliseconds)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+int main()
+{
+	bool passed = true;
+
+	// every index gets visited exactly once, whatever the grain
+	{
+		CTaskScheduler scheduler(3u);
+		const uint32_t grains[] = {0u,1u,7u,1000u,1u<<20u};
+		for (auto grain : grains)
+		{
+			core::vector<uint8_t> visits(100003u,0u);
+			scheduler.parallelFor(0u,visits.size(),grain,[&](uint32_t begin, uint32_t end) {for (uint32_t i=begin; i<end; i++) visits[i]++;});
+			bool once = true;
+			for (auto count : visits)
+				once = once&&count==1u;
+			passed = check(once,("parallelFor covers the range once, grain "+std::to_string(grain)).c_str())&&passed;
+		}
+
+		// empty and reversed ranges still hand back a task, but never call the functor
+		std::atomic<uint32_t> calls(0u);
+		auto countCalls = [&](uint32_t begin, uint32_t end) {calls++;};
+		auto empty = scheduler.parallelForAsync(5u,5u,0u,countCalls);
+		auto reversed = scheduler.parallelForAsync(7u,3u,0u,countCalls);
+		scheduler.wait(empty);
+		scheduler.wait(reversed);
+		scheduler.parallelFor(7u,3u,0u,countCalls);
+		passed = check(empty.isDone()&&reversed.isDone()&&calls==0u,"empty and reversed ranges call nothing")&&passed;
+	}
+
+	// continuations run after all of their dependencies, children finish before their parent
+	{
+		CTaskScheduler scheduler(3u);
+		std::atomic<uint32_t> order(0u);
+		uint32_t first = ~0u, second = ~0u, last = ~0u;
+		auto slow = scheduler.submit([&]() {sleepFor(20u); first = order++;});
+		auto fast = scheduler.submit([&]() {second = order++;});
+		const CTaskScheduler::TaskHandle dependencies[] = {slow,fast,CTaskScheduler::TaskHandle()};
+		auto after = scheduler.submitAfter(dependencies,3u,[&]() {last = order++;});
+		scheduler.wait(after);
+		passed = check(last==2u&&first<2u&&second<2u,"submitAfter waits for every dependency")&&passed;
+
+		std::atomic<uint32_t> children(0u);
+		auto parent = scheduler.submit([&]()
+		{
+			for (uint32_t i=0u; i<64u; i++)
+				scheduler.spawnChild([&]() {sleepFor(1u); children++;});
+		});
+		uint32_t childrenSeen = ~0u;
+		auto continuation = scheduler.then(parent,[&]() {childrenSeen = children.load();});
+		scheduler.wait(continuation);
+		passed = check(parent.isDone()&&childrenSeen==64u,"a task finishes only after its children")&&passed;
+	}
+
+	// the counters add up once the work is done
+	{
+		CTaskScheduler scheduler(3u);
+		const auto initial = scheduler.getStatistics();
+		passed = check(!initial.submitted&&!initial.executed&&!initial.stolen,"a new scheduler counts nothing")&&passed;
+
+		// halving 1024 down to single elements spawns 1023 children besides the root
+		std::atomic<uint32_t> sum(0u);
+		scheduler.parallelFor(0u,1024u,1u,[&](uint32_t begin, uint32_t end) {sum += end-begin;});
+		auto statistics = scheduler.getStatistics();
+		passed = check(sum==1024u&&statistics.submitted==1024ull&&statistics.executed==1024ull,"parallelFor submits and executes one task per subrange")&&passed;
+		passed = check(statistics.stolen<=statistics.executed,"no more steals than executed tasks")&&passed;
+		printf("\tstolen %llu, failed steals %llu\n",(unsigned long long)statistics.stolen,(unsigned long long)statistics.failedSteals);
+
+		scheduler.resetStatistics();
+		statistics = scheduler.getStatistics();
+		passed = check(!statistics.submitted&&!statistics.executed&&!statistics.stolen&&!statistics.failedSteals,"resetStatistics zeroes every counter")&&passed;
+
+		// plenty of tiny tasks from several threads which aren't workers, so pops race with pushes
+		std::atomic<uint32_t> executed(0u);
+		core::vector<CTaskScheduler::TaskHandle> handles[4];
+		core::vector<std::thread> submitters;
+		for (uint32_t t=0u; t<4u; t++)
+			submitters.emplace_back([&,t]()
+			{
+				for (uint32_t i=0u; i<5000u; i++)
+					handles[t].push_back(scheduler.submit([&]() {executed++;}));
+			});
+		for (auto& submitter : submitters)
+			submitter.join();
+		for (const auto& threadHandles : handles)
+		for (const auto& handle : threadHandles)
+			scheduler.wait(handle);
+		statistics = scheduler.getStatistics();
+		passed = check(executed==20000u&&statistics.submitted==20000ull&&statistics.executed==20000ull,"tasks submitted from many threads all execute")&&passed;
+	}
+
+	// the destructor runs everything, tasks still waiting on dependencies included
+	{
+		std::atomic<uint32_t> order(0u);
+		uint32_t a = ~0u, b = ~0u, c = ~0u;
+		{
+			CTaskScheduler scheduler(2u);
+			auto taskA = scheduler.submit([&]() {sleepFor(20u); a = order++;});
+			auto taskB = scheduler.then(taskA,[&]() {b = order++;});
+			scheduler.then(taskB,[&]() {c = order++;});
+		}
+		passed = check(a==0u&&b==1u&&c==2u,"destruction runs the chain of continuations in order")&&passed;
+
+		// a dependency on another scheduler's task, the continuation still runs on its own scheduler
+		CTaskScheduler other(1u);
+		bool ran = false;
+		uint64_t otherExecuted = 0ull, ownExecuted = 0ull;
+		{
+			CTaskScheduler scheduler(1u);
+			auto foreign = other.submit([]() {sleepFor(20u);});
+			auto continuation = scheduler.then(foreign,[&]() {ran = true;});
+			scheduler.wait(continuation);
+			ownExecuted = scheduler.getStatistics().executed;
+			other.wait(foreign);
+			otherExecuted = other.getStatistics().executed;
+		}
+		passed = check(ran&&ownExecuted==1ull&&otherExecuted==1ull,"continuation of another scheduler's task runs on its own scheduler")&&passed;
+
+		ran = false;
+		{
+			CTaskScheduler scheduler(1u);
+			auto foreign = other.submit([]() {sleepFor(20u);});
+			scheduler.then(foreign,[&]() {ran = true;});
+		}
+		passed = check(ran,"destruction waits for dependencies on another scheduler")&&passed;
+	}
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
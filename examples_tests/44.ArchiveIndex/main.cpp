@@ -0,0 +1,127 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace irr;
+using namespace io;
+
+
+//! An old style TAR holding `files`, every file has to be shorter than a block
+std::string makeTar(std::initializer_list<std::pair<const char*,const char*> > files)
+{
+	std::string tar;
+	for (const auto& file : files)
+	{
+		char header[512] = {};
+		strncpy(header,file.first,100u);
+		sprintf(header+100,"%07o",0644u);
+		sprintf(header+124,"%011o",uint32_t(strlen(file.second)));
+		header[156] = '0';
+		// the checksum is over the header with its own field blanked
+		memset(header+148,' ',8u);
+		uint32_t checksum = 0u;
+		for (auto c : header)
+			checksum += uint8_t(c);
+		sprintf(header+148,"%06o",checksum);
+		tar.append(header,sizeof(header));
+
+		std::string data(file.second);
+		data.resize(sizeof(header),'\0');
+		tar += data;
+	}
+	return tar;
+}
+
+IFileArchive* addTar(IFileSystem* fs, const std::string& contents, const char* name)
+{
+	IReadFile* file = fs->createMemoryReadFile(contents.data(),contents.size(),name);
+	IFileArchive* archive = nullptr;
+	if (!fs->addFileArchive(file,EFAT_TAR,"",&archive))
+		archive = nullptr;
+	file->drop();
+	return archive;
+}
+
+//! contents of the file createAndOpenFile finds, empty if it doesn't
+std::string readFile(IFileSystem* fs, const char* name)
+{
+	IReadFile* file = fs->createAndOpenFile(name);
+	if (!file)
+		return "";
+	std::string retval(file->getSize(),'\0');
+	file->read(&retval[0],retval.size());
+	file->drop();
+	return retval;
+}
+
+bool check(bool condition, const char* what)
+{
+	printf("%-72s %s\n",what,condition ? "OK":"FAILED");
+	return condition;
+}
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = core::dimension2d<uint32_t>(640, 480);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+
+	IFileSystem* fs = device->getFileSystem();
+	const uint32_t firstArchive = fs->getFileArchiveCount();
+
+	const std::string tarA = makeTar({{"shared.txt","shared from a"},{"a.txt","only in a"},{"dir/nested.txt","nested in a"}});
+	const std::string tarB = makeTar({{"shared.txt","shared from b"},{"b.txt","only in b"},{"dir/nested.txt","nested in b"}});
+	const std::string tarC = makeTar({{"b.txt","b.txt from c"},{"c.txt","only in c"}});
+
+	bool passed = true;
+	IFileArchive* archiveA = addTar(fs,tarA,"a.tar");
+	IFileArchive* archiveB = addTar(fs,tarB,"b.tar");
+	if (!archiveA || !archiveB)
+	{
+		printf("Could not mount the test archives\n");
+		device->drop();
+		return 1;
+	}
+
+	// the archive added first wins
+	passed = check(readFile(fs,"shared.txt")=="shared from a","file in both archives opens from the one added first")&&passed;
+	passed = check(readFile(fs,"a.txt")=="only in a"&&readFile(fs,"b.txt")=="only in b","files in only one archive open from it")&&passed;
+	passed = check(readFile(fs,"DIR\\Nested.TXT")=="nested in a","lookups ignore case and slash direction")&&passed;
+	{
+		const SFileListEntry* entry = nullptr;
+		IFileArchive* found = fs->findFileInArchives("b.txt",5u,&entry);
+		passed = check(found==archiveB&&entry&&entry->FullName=="b.txt","findFileInArchives gives the archive and its entry")&&passed;
+		passed = check(!fs->findFileInArchives("missing.txt",11u)&&!fs->existFile("missing.txt")&&fs->existFile("a.txt"),"files in no archive aren't found")&&passed;
+	}
+
+	// reordering flips which one wins
+	fs->moveFileArchive(firstArchive+1u,-1);
+	passed = check(readFile(fs,"shared.txt")=="shared from b"&&readFile(fs,"dir/nested.txt")=="nested in b","moving an archive up makes it win")&&passed;
+	passed = check(readFile(fs,"a.txt")=="only in a","files only the other archive has are still found")&&passed;
+
+	// removing one leaves the other's files
+	fs->removeFileArchive(firstArchive);
+	passed = check(readFile(fs,"shared.txt")=="shared from a","removing the winning archive uncovers the next one")&&passed;
+	passed = check(!fs->existFile("b.txt")&&readFile(fs,"b.txt").empty(),"files of a removed archive are gone")&&passed;
+
+	// appending only adds what the earlier archives don't have
+	archiveB = addTar(fs,tarB,"b.tar");
+	IFileArchive* archiveC = addTar(fs,tarC,"c.tar");
+	passed = check(archiveB&&archiveC,"archives can be mounted again")&&passed;
+	passed = check(readFile(fs,"shared.txt")=="shared from a"&&readFile(fs,"b.txt")=="only in b","a new archive doesn't override the ones before it")&&passed;
+	passed = check(fs->findFileInArchives("c.txt",5u)==archiveC&&readFile(fs,"c.txt")=="only in c","its own files are found")&&passed;
+
+	while (fs->getFileArchiveCount()>firstArchive)
+		fs->removeFileArchive(fs->getFileArchiveCount()-1u);
+	passed = check(!fs->existFile("a.txt")&&!fs->existFile("c.txt"),"nothing is left once all of them got removed")&&passed;
+
+	device->drop();
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
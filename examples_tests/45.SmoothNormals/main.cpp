@@ -0,0 +1,147 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <cstdio>
+#include <algorithm>
+#include <random>
+
+using namespace irr;
+using namespace asset;
+
+
+constexpr uint32_t GridSize = 32u;
+
+struct SVertex
+{
+	float pos[3];
+	float normal[3];
+};
+
+//! a bumpy height field with a sharp ridge down the middle, so some neighbouring faces get smoothed together and some don't
+float height(uint32_t x, uint32_t z)
+{
+	const float u = float(x)/float(GridSize), v = float(z)/float(GridSize);
+	return 0.5f+0.1f*std::sin(u*7.f)*std::cos(v*5.f)+2.f*std::abs(u-0.5f);
+}
+
+//! an unwelded grid, every triangle has its own vertices, in shuffled order so buckets don't follow the buffer
+core::smart_refctd_ptr<ICPUMeshBuffer> createGrid()
+{
+	core::vector<std::array<core::vector3df,3u> > triangles;
+	for (uint32_t z=0u; z<GridSize; z++)
+	for (uint32_t x=0u; x<GridSize; x++)
+	{
+		const core::vector3df corners[4] = {
+			core::vector3df(float(x)/float(GridSize),height(x,z),float(z)/float(GridSize)),
+			core::vector3df(float(x+1u)/float(GridSize),height(x+1u,z),float(z)/float(GridSize)),
+			core::vector3df(float(x+1u)/float(GridSize),height(x+1u,z+1u),float(z+1u)/float(GridSize)),
+			core::vector3df(float(x)/float(GridSize),height(x,z+1u),float(z+1u)/float(GridSize))
+		};
+		triangles.push_back({corners[0],corners[2],corners[1]});
+		triangles.push_back({corners[0],corners[3],corners[2]});
+	}
+	std::mt19937 rng(42u);
+	std::shuffle(triangles.begin(),triangles.end(),rng);
+
+	const uint32_t vertexCount = triangles.size()*3u;
+	auto vertices = core::make_smart_refctd_ptr<ICPUBuffer>(vertexCount*sizeof(SVertex));
+	SVertex* out = reinterpret_cast<SVertex*>(vertices->getPointer());
+	for (const auto& triangle : triangles)
+	for (const auto& corner : triangle)
+	{
+		*out = {{corner.X,corner.Y,corner.Z},{0.f,0.f,0.f}};
+		out++;
+	}
+
+	auto desc = core::make_smart_refctd_ptr<ICPUMeshDataFormatDesc>();
+	desc->setVertexAttrBuffer(core::smart_refctd_ptr<ICPUBuffer>(vertices),EVAI_ATTR0,EF_R32G32B32_SFLOAT,sizeof(SVertex),offsetof(SVertex,pos));
+	desc->setVertexAttrBuffer(core::smart_refctd_ptr<ICPUBuffer>(vertices),EVAI_ATTR3,EF_R32G32B32_SFLOAT,sizeof(SVertex),offsetof(SVertex,normal));
+	auto buffer = core::make_smart_refctd_ptr<ICPUMeshBuffer>();
+	buffer->setMeshDataAndFormat(std::move(desc));
+	buffer->setIndexCount(vertexCount);
+	buffer->setNormalnAttributeIx(EVAI_ATTR3);
+	return buffer;
+}
+
+//! Brute force version of what CSmoothNormalGenerator does, every vertex against every other one
+core::vector<core::vectorSIMDf> referenceNormals(ICPUMeshBuffer* buffer, float epsilon, const IMeshManipulator::VxCmpFunction& vxcmp)
+{
+	const uint32_t vertexCount = buffer->getIndexCount();
+	core::vector<IMeshManipulator::SSNGVertexData> vertices(vertexCount);
+	for (uint32_t i=0u; i<vertexCount; i+=3u)
+	{
+		const core::vectorSIMDf v[3] = {buffer->getPosition(i),buffer->getPosition(i+1u),buffer->getPosition(i+2u)};
+		const core::vectorSIMDf faceNormal = core::normalize(core::cross(v[1]-v[0],v[2]-v[0]));
+		// angle at each corner
+		for (uint32_t j=0u; j<3u; j++)
+		{
+			const core::vectorSIMDf toNext = core::normalize(v[(j+1u)%3u]-v[j]);
+			const core::vectorSIMDf toPrev = core::normalize(v[(j+2u)%3u]-v[j]);
+			vertices[i+j] = {i+j,0u,acosf(core::dot(toNext,toPrev).x),v[j],faceNormal};
+		}
+	}
+
+	core::vector<core::vectorSIMDf> normals(vertexCount);
+	for (uint32_t i=0u; i<vertexCount; i++)
+	{
+		core::vectorSIMDf normal = vertices[i].parentTriangleFaceNormal*vertices[i].wage;
+		for (uint32_t j=0u; j<vertexCount; j++)
+		{
+			const core::vectorSIMDf difference = core::abs(vertices[j].position-vertices[i].position);
+			if (j!=i && difference.x<=epsilon && difference.y<=epsilon && difference.z<=epsilon && vxcmp(vertices[i],vertices[j],buffer))
+				normal += vertices[j].parentTriangleFaceNormal*vertices[j].wage;
+		}
+		normals[i] = core::normalize(normal);
+	}
+	return normals;
+}
+
+bool check(bool condition, const char* what)
+{
+	printf("%-72s %s\n",what,condition ? "OK":"FAILED");
+	return condition;
+}
+
+//! smooths a fresh grid and compares every normal with the brute force one
+bool compare(float epsilon, const IMeshManipulator::VxCmpFunction& vxcmp, const char* what)
+{
+	auto buffer = createGrid();
+	const auto expected = referenceNormals(buffer.get(),epsilon,vxcmp);
+	IMeshManipulator::calculateSmoothNormals(buffer.get(),false,epsilon,EVAI_ATTR3,vxcmp);
+
+	uint32_t mismatches = 0u;
+	float worst = 1.f;
+	for (uint32_t i=0u; i<expected.size(); i++)
+	{
+		core::vectorSIMDf normal;
+		buffer->getAttribute(normal,EVAI_ATTR3,i);
+		normal.w = 0.f;
+		// only the order of summation differs
+		const float similarity = core::dot(normal,expected[i]).x;
+		worst = core::min(worst,similarity);
+		if (similarity<0.9999f)
+			mismatches++;
+	}
+	printf("\tworst cosine to the reference %f, %u of %u normals differ\n",worst,mismatches,uint32_t(expected.size()));
+	return check(!mismatches,what);
+}
+
+int main()
+{
+	bool passed = true;
+
+	// the default comparison from calculateSmoothNormals, faces closer than 45 degrees get smoothed together
+	const IMeshManipulator::VxCmpFunction within45Degrees = [](const IMeshManipulator::SSNGVertexData& v0, const IMeshManipulator::SSNGVertexData& v1, ICPUMeshBuffer* buffer)
+	{
+		return core::dot(v0.parentTriangleFaceNormal,v1.parentTriangleFaceNormal).x>0.70710678118f;
+	};
+	passed = compare(1.525e-5f,within45Degrees,"smoothing keeps the ridge sharp like the brute force")&&passed;
+
+	const IMeshManipulator::VxCmpFunction always = [](const IMeshManipulator::SSNGVertexData&, const IMeshManipulator::SSNGVertexData&, ICPUMeshBuffer*) {return true;};
+	passed = compare(1.525e-5f,always,"smoothing everything matches the brute force")&&passed;
+	// a cell size of a third of the grid spacing, vertices a cell apart must not get merged
+	passed = compare(0.01f,within45Degrees,"larger epsilon matches the brute force")&&passed;
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
@@ -0,0 +1,232 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include "irr/core/alloc/GeneralpurposeAddressAllocator.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace irr;
+using namespace core;
+
+
+constexpr uint32_t AddressOffset = 1024u;
+constexpr uint32_t MaxAlignment = 128u;
+constexpr uint32_t BufferSize = 4096u;
+constexpr uint32_t MinBlockSize = 32u;
+
+//! Lets the test look at the free lists and defragment them on demand
+class TestAllocator : public GeneralpurposeAddressAllocator<uint32_t>
+{
+		typedef GeneralpurposeAddressAllocator<uint32_t> Base;
+	public:
+		TestAllocator(void* reservedSpc) : Base(reservedSpc,AddressOffset,0u,MaxAlignment,BufferSize,MinBlockSize) {}
+
+		using Base::defragment;
+
+		//! The free blocks sorted on their offsets, put back on the free lists afterwards
+		core::vector<std::pair<uint32_t,uint32_t> > freeBlocks()
+		{
+			uint32_t count;
+			const auto* sorted = Base::sortFreeBlocks(count);
+			core::vector<std::pair<uint32_t,uint32_t> > retval;
+			for (auto it=sorted; it!=sorted+count; it++)
+			{
+				retval.emplace_back(it->startOffset,it->endOffset);
+				Base::insertFreeBlock(*it);
+			}
+			return retval;
+		}
+};
+
+struct SAllocation
+{
+	uint32_t address;
+	uint32_t size;
+	uint32_t alignment;
+	uint8_t pattern;
+};
+
+bool check(bool condition, const char* what)
+{
+	printf("%-72s %s\n",what,condition ? "OK":"FAILED");
+	return condition;
+}
+
+//! Allocates `count` ranges of a few minimum block sizes, fills them with their own byte and frees every third one
+core::vector<SAllocation> fragment(TestAllocator& allocator, uint8_t* data, uint32_t count, uint32_t alignment)
+{
+	core::vector<SAllocation> live;
+	for (uint32_t i=0u; i<count; i++)
+	{
+		const uint32_t size = MinBlockSize*(1u+(i*7u)%4u);
+		const uint32_t address = allocator.alloc_addr(size,alignment);
+		if (address==TestAllocator::invalid_address)
+			break;
+		SAllocation allocation{address,size,alignment,uint8_t(i+1u)};
+		memset(data+address-AddressOffset,allocation.pattern,size);
+		if (i%3u)
+			live.push_back(allocation);
+		else
+			allocator.free_addr(address,size);
+	}
+	return live;
+}
+
+//! Runs the moves like an owner of the allocator would, with memmove semantics, and patches the addresses of the live allocations
+void applyMoves(const TestAllocator::Move* moves, uint32_t moveCount, uint8_t* data, core::vector<SAllocation>& live)
+{
+	for (uint32_t i=0u; i<moveCount; i++)
+		memmove(data+moves[i].newOffset-AddressOffset,data+moves[i].oldOffset-AddressOffset,moves[i].size);
+	for (auto& allocation : live)
+	for (uint32_t i=0u; i<moveCount; i++)
+	{
+		if (allocation.address<moves[i].oldOffset || allocation.address>=moves[i].oldOffset+moves[i].size)
+			continue;
+		allocation.address = allocation.address-moves[i].oldOffset+moves[i].newOffset;
+		break;
+	}
+}
+
+//! Moves go towards the start in order, never onto each other, and keep the offsets modulo `alignment`
+bool validMovePlan(const TestAllocator::Move* moves, uint32_t moveCount, uint32_t alignment)
+{
+	for (uint32_t i=0u; i<moveCount; i++)
+	{
+		const auto& move = moves[i];
+		if (move.newOffset>=move.oldOffset || (move.oldOffset-move.newOffset)%alignment || move.oldOffset-move.newOffset<MinBlockSize)
+			return false;
+		if (move.oldOffset<AddressOffset || move.oldOffset+move.size>AddressOffset+BufferSize)
+			return false;
+		if (i && (moves[i-1u].oldOffset+moves[i-1u].size>move.oldOffset || moves[i-1u].newOffset+moves[i-1u].size>move.newOffset))
+			return false;
+	}
+	return true;
+}
+
+//! The free blocks and the live allocations tile the buffer exactly, the allocations kept their bytes and alignment
+bool validLayout(TestAllocator& allocator, const uint8_t* data, const core::vector<SAllocation>& live)
+{
+	const auto blocks = allocator.freeBlocks();
+	uint32_t total = 0u;
+	for (uint32_t i=0u; i<blocks.size(); i++)
+	{
+		if (blocks[i].second-blocks[i].first<MinBlockSize || (i && blocks[i-1u].second>blocks[i].first))
+			return false;
+		total += blocks[i].second-blocks[i].first;
+	}
+	if (total!=allocator.get_free_size())
+		return false;
+
+	for (const auto& allocation : live)
+	{
+		const uint32_t offset = allocation.address-AddressOffset;
+		for (const auto& block : blocks)
+		if (offset<block.second && block.first<offset+allocation.size)
+			return false;
+		if (allocation.address%allocation.alignment)
+			return false;
+		for (uint32_t i=0u; i<allocation.size; i++)
+		if (data[offset+i]!=allocation.pattern)
+			return false;
+		total += allocation.size;
+	}
+	return total==BufferSize;
+}
+
+//! Offset just past the last live allocation, where compaction has to have put the free space
+uint32_t liveEnd(const core::vector<SAllocation>& live)
+{
+	uint32_t retval = 0u;
+	for (const auto& allocation : live)
+		retval = core::max(retval,allocation.address-AddressOffset+allocation.size);
+	return retval;
+}
+
+int main()
+{
+	const uint32_t reservedSize = TestAllocator::reserved_size(MaxAlignment,BufferSize,MinBlockSize);
+	bool passed = true;
+
+	// allocations needing no more alignment than a block close every gap
+	{
+		void* reserved = _IRR_ALIGNED_MALLOC(reservedSize,_IRR_SIMD_ALIGNMENT);
+		core::vector<uint8_t> data(BufferSize,0u);
+		TestAllocator allocator(reserved);
+		auto live = fragment(allocator,data.data(),40u,MinBlockSize);
+		passed = check(validLayout(allocator,data.data(),live)&&allocator.freeBlocks().size()>1u,"fragmented allocator starts out consistent")&&passed;
+
+		const uint32_t freeSize = allocator.get_free_size();
+		core::vector<TestAllocator::Move> moves(allocator.max_compaction_moves());
+		const uint32_t moveCount = allocator.compact(moves.data(),MinBlockSize);
+		passed = check(moveCount&&validMovePlan(moves.data(),moveCount,MinBlockSize),"moves are sorted, disjoint, towards the start and block aligned")&&passed;
+
+		applyMoves(moves.data(),moveCount,data.data(),live);
+		const auto blocks = allocator.freeBlocks();
+		passed = check(validLayout(allocator,data.data(),live)&&allocator.get_free_size()==freeSize,"moved allocations keep their bytes, free size is unchanged")&&passed;
+		passed = check(blocks.size()==1u&&blocks[0].first==allocator.get_allocated_size()&&blocks[0].second==BufferSize,"free space becomes one block at the end")&&passed;
+
+		passed = check(allocator.compact(moves.data(),MinBlockSize)==0u&&allocator.freeBlocks()==blocks,"compacting again plans nothing")&&passed;
+		passed = check(allocator.compact(moves.data(),0u)==0u&&allocator.freeBlocks()==blocks,"zero alignment is rejected")&&passed;
+
+		_IRR_ALIGNED_FREE(reserved);
+	}
+
+	// with a coarser alignment runs only move by multiples of it, so holes smaller than the alignment may stay
+	{
+		void* reserved = _IRR_ALIGNED_MALLOC(reservedSize,_IRR_SIMD_ALIGNMENT);
+		core::vector<uint8_t> data(BufferSize,0u);
+		TestAllocator allocator(reserved);
+		auto live = fragment(allocator,data.data(),24u,MaxAlignment);
+		const uint32_t freeSize = allocator.get_free_size();
+
+		core::vector<TestAllocator::Move> moves(allocator.max_compaction_moves());
+		const uint32_t moveCount = allocator.compact(moves.data());
+		passed = check(moveCount&&validMovePlan(moves.data(),moveCount,MaxAlignment),"moves keep the offsets modulo the largest alignment")&&passed;
+
+		applyMoves(moves.data(),moveCount,data.data(),live);
+		const auto blocks = allocator.freeBlocks();
+		passed = check(validLayout(allocator,data.data(),live)&&allocator.get_free_size()==freeSize,"aligned allocations keep their bytes and alignment")&&passed;
+		passed = check(!blocks.empty()&&blocks.back().first==liveEnd(live)&&blocks.back().second==BufferSize,"free space after the last allocation is one block")&&passed;
+
+		_IRR_ALIGNED_FREE(reserved);
+	}
+
+	// defragmenting coalesces adjacent free blocks and finds the one reaching the end of the buffer
+	{
+		void* reserved = _IRR_ALIGNED_MALLOC(reservedSize,_IRR_SIMD_ALIGNMENT);
+		TestAllocator allocator(reserved);
+		passed = check(allocator.defragment()==0u,"empty allocator is free from the start")&&passed;
+
+		uint32_t addresses[8];
+		bool backToBack = true;
+		for (uint32_t i=0u; i<8u; i++)
+		{
+			addresses[i] = allocator.alloc_addr(256u,MinBlockSize);
+			backToBack = backToBack&&addresses[i]==AddressOffset+256u*i;
+		}
+		passed = check(backToBack,"fresh allocations are laid out back to back")&&passed;
+
+		// freed out of order, so neighbours sit in the free lists as separate blocks
+		const uint32_t freed[] = {2u,7u,1u,3u,6u};
+		for (auto i : freed)
+			allocator.free_addr(addresses[i],256u);
+		const uint32_t freeSize = allocator.get_free_size();
+		passed = check(allocator.freeBlocks().size()==6u,"free blocks are not coalesced on free")&&passed;
+
+		const uint32_t tail = allocator.defragment();
+		const core::vector<std::pair<uint32_t,uint32_t> > expected = {{256u,1024u},{1536u,BufferSize}};
+		passed = check(tail==1536u,"defragment returns the start of the block reaching the end")&&passed;
+		passed = check(allocator.freeBlocks()==expected&&allocator.get_free_size()==freeSize,"defragment leaves only coalesced blocks")&&passed;
+
+		allocator.free_addr(addresses[0],256u);
+		allocator.free_addr(addresses[4],256u);
+		allocator.free_addr(addresses[5],256u);
+		passed = check(allocator.defragment()==0u&&allocator.freeBlocks().size()==1u,"everything freed coalesces into the whole buffer")&&passed;
+
+		_IRR_ALIGNED_FREE(reserved);
+	}
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
@@ -0,0 +1,118 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace irr;
+using namespace io;
+
+
+//! Writes through `file` the way the mesh writers do and returns what the file has to contain afterwards
+class WriteRecorder
+{
+		IWriteFile* file;
+		bool allWritten;
+	public:
+		std::string expected;
+
+		WriteRecorder(IWriteFile* _file) : file(_file), allWritten(true) {}
+
+		void put(size_t pos, const std::string& bytes)
+		{
+			allWritten = file->seek(pos)&&allWritten;
+			allWritten = file->write(bytes.data(),bytes.size())==int32_t(bytes.size())&&allWritten;
+			if (expected.size()<pos+bytes.size())
+				expected.resize(pos+bytes.size(),'\0');
+			expected.replace(pos,bytes.size(),bytes);
+		}
+
+		bool succeeded() const {return allWritten;}
+};
+
+//! contents of the file, empty if it can't be opened
+std::string readFile(IFileSystem* fs, const char* name)
+{
+	IReadFile* file = fs->createAndOpenFile(name);
+	if (!file)
+		return "";
+	std::string retval(file->getSize(),'\0');
+	file->read(&retval[0],retval.size());
+	file->drop();
+	return retval;
+}
+
+bool check(bool condition, const char* what)
+{
+	printf("%-72s %s\n",what,condition ? "OK":"FAILED");
+	return condition;
+}
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = core::dimension2d<uint32_t>(640, 480);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+
+	IFileSystem* fs = device->getFileSystem();
+	bool passed = true;
+
+	// buffers far smaller than the writes make nearly every write flush, with write-behind each flush waits for the previous one
+	const std::pair<uint32_t,bool> configurations[] = {{0u,false},{1u<<20u,false},{1u<<20u,true},{64u,false},{64u,true},{7u,true},{1u,true}};
+	for (const auto& configuration : configurations)
+	{
+		fs->setWriteBuffering(configuration.first,configuration.second);
+		const std::string suffix = ", buffer "+std::to_string(configuration.first)+(configuration.second ? " with write-behind":"");
+		const char* path = "buffered_write.bin";
+
+		IWriteFile* file = fs->createAndWriteFile(path);
+		if (!file)
+		{
+			passed = check(false,("could not create the file"+suffix).c_str());
+			continue;
+		}
+		WriteRecorder recorder(file);
+		// a placeholder header gets patched at the end
+		recorder.put(0u,"HEADER??");
+		for (uint32_t i=0u; i<2000u; i++)
+		{
+			recorder.put(recorder.expected.size(),std::string(1u+(i*13u)%47u,char('a'+i%26u)));
+			// now and then patch bytes written long ago, behind the window of the smaller buffers
+			if (i%97u==0u)
+				recorder.put((i*31u)%(recorder.expected.size()-4u),"PTCH");
+		}
+		// every single byte lands away from the last one, so each write hands a buffer over while the previous one may still be pending
+		const size_t burstStart = recorder.expected.size()+1000u;
+		for (uint32_t i=0u; i<64u; i++)
+			recorder.put(burstStart+(63u-i)*100u,std::string(1u,char('A'+i%26u)));
+		recorder.put(0u,"HEADEROK");
+		const bool succeeded = recorder.succeeded();
+		// dropping the file has to flush the last buffer and wait for the one still being written
+		file->drop();
+
+		passed = check(succeeded,("every write and seek succeeds"+suffix).c_str())&&passed;
+		passed = check(readFile(fs,path)==recorder.expected,("file holds exactly what was written"+suffix).c_str())&&passed;
+	}
+
+	// a file dropped straight after a flush, and one never written to, still close cleanly
+	fs->setWriteBuffering(16u,true);
+	for (uint32_t length=0u; length<=32u; length+=16u)
+	{
+		IWriteFile* file = fs->createAndWriteFile("buffered_short.bin");
+		const std::string bytes(length,'x');
+		if (file)
+		{
+			file->write(bytes.data(),bytes.size());
+			file->drop();
+		}
+		passed = check(file&&readFile(fs,"buffered_short.bin")==bytes,("file of "+std::to_string(length)+" bytes with write-behind").c_str())&&passed;
+	}
+
+	device->drop();
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
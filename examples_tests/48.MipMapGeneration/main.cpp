@@ -0,0 +1,177 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+#include "irr/asset/format/generateMipMaps.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+using namespace irr;
+using namespace asset;
+
+
+//! A 2D texture with one level whose `channels` channels of type `T` come from `texel(x,y,channel)`
+template<typename T, class Texel>
+core::smart_refctd_ptr<ICPUTexture> createTexture(E_FORMAT format, uint32_t width, uint32_t height, uint32_t channels, Texel texel)
+{
+	const uint32_t minCoord[3] = {0u,0u,0u};
+	const uint32_t maxCoord[3] = {width,height,1u};
+	auto image = core::make_smart_refctd_ptr<CImageData>(nullptr,minCoord,maxCoord,0u,format);
+	for (uint32_t y=0u; y<height; y++)
+	{
+		T* row = reinterpret_cast<T*>(image->getSliceRowPointer(0u,y));
+		for (uint32_t x=0u; x<width; x++)
+		for (uint32_t c=0u; c<channels; c++)
+			row[x*channels+c] = T(texel(x,y,c));
+	}
+	return core::smart_refctd_ptr<ICPUTexture>(ICPUTexture::create(core::vector<CImageData*>{image.get()},"",video::ITexture::ETT_2D),core::dont_grab);
+}
+
+template<typename T>
+T texelAt(const ICPUTexture* texture, uint32_t mip, uint32_t x, uint32_t y, uint32_t channel, uint32_t channels)
+{
+	const CImageData* level = texture->getMipMap(mip).first[0];
+	return reinterpret_cast<const T*>(level->getSliceRowPointer(0u,y))[x*channels+channel];
+}
+
+//! Every level down to 1x1 exists with half the size of the one before, rounded down
+bool fullChain(const ICPUTexture* texture, uint32_t width, uint32_t height)
+{
+	uint32_t mip = 0u;
+	for (; width>1u||height>1u; mip++)
+	{
+		const auto range = texture->getMipMap(mip);
+		if (range.first==range.second || range.first[0]->getSize()!=core::vector3d<uint32_t>(width,height,1u))
+			return false;
+		width = core::max(width>>1u,1u);
+		height = core::max(height>>1u,1u);
+	}
+	return texture->getHighestMip()==mip;
+}
+
+//! mean of one channel of a float level, box filtering keeps it on every level
+float mean(const ICPUTexture* texture, uint32_t mip, uint32_t channel)
+{
+	const auto size = texture->getMipMap(mip).first[0]->getSize();
+	double sum = 0.0;
+	for (uint32_t y=0u; y<size.Y; y++)
+	for (uint32_t x=0u; x<size.X; x++)
+		sum += texelAt<float>(texture,mip,x,y,channel,4u);
+	return float(sum/(size.X*size.Y));
+}
+
+bool check(bool condition, const char* what)
+{
+	printf("%-72s %s\n",what,condition ? "OK":"FAILED");
+	return condition;
+}
+
+int main()
+{
+	bool passed = true;
+
+	// box filtering of power of two sizes averages every 2x2 block, down to the mean of the whole image
+	{
+		auto pattern = [](uint32_t x, uint32_t y, uint32_t c) {return float((x*7u+y*3u+c*5u)%11u);};
+		auto texture = createTexture<float>(EF_R32G32B32A32_SFLOAT,16u,8u,4u,pattern);
+		auto mipped = core::smart_refctd_ptr<ICPUTexture>(createMipMappedTexture(texture.get()),core::dont_grab);
+		passed = check(mipped&&fullChain(mipped.get(),16u,8u),"full mip chain of a 16x8 texture")&&passed;
+		if (mipped)
+		{
+			passed = check(mipped->getMipMap(0u).first[0]==texture->getMipMap(0u).first[0],"level 0 is shared with the source")&&passed;
+
+			float maxError = 0.f;
+			for (uint32_t y=0u; y<4u; y++)
+			for (uint32_t x=0u; x<8u; x++)
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				const float expected = (pattern(2u*x,2u*y,c)+pattern(2u*x+1u,2u*y,c)+pattern(2u*x,2u*y+1u,c)+pattern(2u*x+1u,2u*y+1u,c))*0.25f;
+				maxError = core::max(maxError,std::abs(texelAt<float>(mipped.get(),1u,x,y,c,4u)-expected));
+			}
+			passed = check(maxError<1e-5f,"level 1 averages 2x2 blocks")&&passed;
+
+			bool meanKept = true;
+			for (uint32_t c=0u; c<4u; c++)
+				meanKept = meanKept&&std::abs(mean(mipped.get(),4u,c)-mean(texture.get(),0u,c))<1e-4f;
+			passed = check(meanKept,"last level is the mean of level 0")&&passed;
+		}
+	}
+
+	// odd sizes share the middle texel between neighbours, which still keeps the mean
+	{
+		auto texture = createTexture<float>(EF_R32G32B32A32_SFLOAT,5u,3u,4u,[](uint32_t x, uint32_t y, uint32_t c) {return float(x*x+3u*y+c);});
+		auto mipped = core::smart_refctd_ptr<ICPUTexture>(createMipMappedTexture(texture.get()),core::dont_grab);
+		bool meanKept = mipped&&fullChain(mipped.get(),5u,3u);
+		for (uint32_t mip=1u; meanKept&&mip<=mipped->getHighestMip(); mip++)
+		for (uint32_t c=0u; c<4u; c++)
+			meanKept = meanKept&&std::abs(mean(mipped.get(),mip,c)-mean(texture.get(),0u,c))<1e-4f;
+		passed = check(meanKept,"box filtering a 5x3 texture keeps the mean on every level")&&passed;
+	}
+
+	// the windowed sincs have normalized weights, so a flat image stays flat
+	const std::pair<E_MIP_MAP_FILTER,const char*> filters[] = {{EMMF_KAISER,"Kaiser"},{EMMF_LANCZOS,"Lanczos"}};
+	for (const auto& filter : filters)
+	{
+		auto texture = createTexture<float>(EF_R32G32B32A32_SFLOAT,16u,16u,4u,[](uint32_t x, uint32_t y, uint32_t c) {return 0.25f+0.125f*c;});
+		SMipMapGenerationParams params;
+		params.filter = filter.first;
+		params.grain = 1u;
+		auto mipped = core::smart_refctd_ptr<ICPUTexture>(createMipMappedTexture(texture.get(),params),core::dont_grab);
+		bool flat = mipped&&fullChain(mipped.get(),16u,16u);
+		for (uint32_t mip=1u; flat&&mip<=mipped->getHighestMip(); mip++)
+		{
+			const auto size = mipped->getMipMap(mip).first[0]->getSize();
+			for (uint32_t y=0u; y<size.Y; y++)
+			for (uint32_t x=0u; x<size.X; x++)
+			for (uint32_t c=0u; c<4u; c++)
+				flat = flat&&std::abs(texelAt<float>(mipped.get(),mip,x,y,c,4u)-(0.25f+0.125f*c))<1e-5f;
+		}
+		passed = check(flat,(std::string(filter.second)+" filter keeps a flat image flat").c_str())&&passed;
+	}
+
+	// black next to white averages to half the light, which sRGB encodes far above half of 255
+	{
+		auto blackAndWhite = [](uint32_t x, uint32_t y, uint32_t c) {return c==3u||x ? 255u:0u;};
+		auto srgb = createTexture<uint8_t>(EF_R8G8B8A8_SRGB,2u,2u,4u,blackAndWhite);
+		auto unorm = createTexture<uint8_t>(EF_R8G8B8A8_UNORM,2u,2u,4u,blackAndWhite);
+		auto srgbMipped = core::smart_refctd_ptr<ICPUTexture>(createMipMappedTexture(srgb.get()),core::dont_grab);
+		auto unormMipped = core::smart_refctd_ptr<ICPUTexture>(createMipMappedTexture(unorm.get()),core::dont_grab);
+		bool linear = srgbMipped&&unormMipped&&fullChain(srgbMipped.get(),2u,2u)&&fullChain(unormMipped.get(),2u,2u);
+		for (uint32_t c=0u; linear&&c<3u; c++)
+		{
+			const uint8_t srgbValue = texelAt<uint8_t>(srgbMipped.get(),1u,0u,0u,c,4u);
+			const uint8_t unormValue = texelAt<uint8_t>(unormMipped.get(),1u,0u,0u,c,4u);
+			linear = srgbValue>=187u&&srgbValue<=188u&&unormValue>=127u&&unormValue<=128u;
+		}
+		linear = linear&&texelAt<uint8_t>(srgbMipped.get(),1u,0u,0u,3u,4u)==255u;
+		passed = check(linear,"sRGB is filtered in linear space")&&passed;
+	}
+
+	// a sinc would overshoot a hard edge, so integer formats get box filtered whatever was asked for
+	{
+		auto texture = createTexture<uint8_t>(EF_R8_UINT,8u,4u,1u,[](uint32_t x, uint32_t y, uint32_t c) {return x<4u ? 0u:255u;});
+		SMipMapGenerationParams params;
+		params.filter = EMMF_LANCZOS;
+		auto mipped = core::smart_refctd_ptr<ICPUTexture>(createMipMappedTexture(texture.get(),params),core::dont_grab);
+		bool box = mipped&&fullChain(mipped.get(),8u,4u);
+		for (uint32_t y=0u; box&&y<2u; y++)
+		for (uint32_t x=0u; x<4u; x++)
+			box = box&&texelAt<uint8_t>(mipped.get(),1u,x,y,0u,1u)==(x<2u ? 0u:255u);
+		passed = check(box,"integer format ignores the Lanczos filter")&&passed;
+	}
+
+	// block compressed textures have to be compressed after generating the chain
+	{
+		const uint32_t minCoord[3] = {0u,0u,0u};
+		const uint32_t maxCoord[3] = {4u,4u,1u};
+		auto image = core::make_smart_refctd_ptr<CImageData>(nullptr,minCoord,maxCoord,0u,EF_BC1_RGB_UNORM_BLOCK);
+		auto texture = core::smart_refctd_ptr<ICPUTexture>(ICPUTexture::create(core::vector<CImageData*>{image.get()},"",video::ITexture::ETT_2D),core::dont_grab);
+		ICPUTexture* mipped = createMipMappedTexture(texture.get());
+		passed = check(texture&&!mipped&&!createMipMappedTexture(nullptr),"block compressed and null textures are refused")&&passed;
+		if (mipped)
+			mipped->drop();
+	}
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
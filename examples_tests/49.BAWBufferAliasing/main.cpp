@@ -0,0 +1,220 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+#include "../src/irr/asset/CBAWMeshWriter.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace irr;
+using namespace asset;
+
+
+constexpr uint32_t BufferCount = 2u;
+
+//! bytes of buffer `index`, regular enough to compress but nothing else in the file looks like them
+std::string bufferContents(uint32_t index, uint32_t size)
+{
+	std::string retval(size,'\0');
+	for (uint32_t i=0u; i<size; i++)
+		retval[i] = char((i>>3u)*7u+(i>>11u)*13u+index*101u+1u);
+	return retval;
+}
+
+//! One meshbuffer reading each of its attributes from a buffer of its own
+core::smart_refctd_ptr<CCPUMesh> createMesh(uint32_t size)
+{
+	auto desc = core::make_smart_refctd_ptr<ICPUMeshDataFormatDesc>();
+	for (uint32_t i=0u; i<BufferCount; i++)
+	{
+		auto buffer = core::make_smart_refctd_ptr<ICPUBuffer>(size);
+		const std::string contents = bufferContents(i,size);
+		memcpy(buffer->getPointer(),contents.data(),size);
+		desc->setVertexAttrBuffer(std::move(buffer),static_cast<E_VERTEX_ATTRIBUTE_ID>(EVAI_ATTR0+i),EF_R8G8B8A8_UNORM,4u,0u);
+	}
+	auto meshbuffer = core::make_smart_refctd_ptr<ICPUMeshBuffer>();
+	meshbuffer->setMeshDataAndFormat(std::move(desc));
+	meshbuffer->setIndexCount(size/4u);
+	auto mesh = core::make_smart_refctd_ptr<CCPUMesh>();
+	mesh->addMeshBuffer(std::move(meshbuffer));
+	return mesh;
+}
+
+//! contents of the file, empty if it can't be opened
+std::string readFile(io::IFileSystem* fs, const char* name)
+{
+	io::IReadFile* file = fs->createAndOpenFile(name);
+	if (!file)
+		return "";
+	std::string retval(file->getSize(),'\0');
+	file->read(&retval[0],retval.size());
+	file->drop();
+	return retval;
+}
+
+//! the attribute buffers of a loaded mesh, nullptr where there's none
+core::vector<ICPUBuffer*> loadBuffers(IAssetManager* am, io::IReadFile* file, bool alias, core::smart_refctd_ptr<ICPUMesh>& outMesh)
+{
+	// nothing may come from the cache, every load has to read the file again
+	IAssetLoader::SAssetLoadParams params(0u,nullptr,IAssetLoader::ECF_DUPLICATE_REFERENCES,nullptr,alias ? IAssetLoader::ELPF_ALIAS_MAPPED_FILE_MEMORY:IAssetLoader::ELPF_NONE);
+	file->seek(0u);
+	auto bundle = am->getAsset(file,file->getFileName().c_str(),params);
+	core::vector<ICPUBuffer*> buffers(BufferCount,nullptr);
+	if (bundle.getContents().first==bundle.getContents().second)
+		return buffers;
+
+	outMesh = core::smart_refctd_ptr_static_cast<ICPUMesh>(*bundle.getContents().first);
+	if (!outMesh->getMeshBufferCount())
+		return buffers;
+	auto desc = outMesh->getMeshBuffer(0u)->getMeshDataAndFormat();
+	for (uint32_t i=0u; desc&&i<BufferCount; i++)
+		buffers[i] = const_cast<ICPUBuffer*>(desc->getMappedBuffer(static_cast<E_VERTEX_ATTRIBUTE_ID>(EVAI_ATTR0+i)));
+	return buffers;
+}
+
+bool check(bool condition, const char* what)
+{
+	printf("%-72s %s\n",what,condition ? "OK":"FAILED");
+	return condition;
+}
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = core::dimension2d<uint32_t>(640, 480);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+
+	IAssetManager* am = device->getAssetManager();
+	io::IFileSystem* fs = device->getFileSystem();
+	bool passed = true;
+
+	CBAWMeshWriter::WriteProperties properties;
+	memset(properties.initializationVector,0,sizeof(properties.initializationVector));
+
+	// blobs are packed without padding, so grow the buffers until one of them starts on a SIMD aligned offset of the file
+	const char* rawPath = "aliasing_raw.baw";
+	uint32_t size = 0u;
+	std::string rawFile;
+	size_t offsets[BufferCount] = {};
+	bool anyAligned = false;
+	for (uint32_t padding=0u; !anyAligned&&padding<_IRR_SIMD_ALIGNMENT; padding++)
+	{
+		size = 4096u+padding;
+		auto mesh = createMesh(size);
+		am->writeAsset(rawPath,IAssetWriter::SAssetWriteParams(mesh.get(),EWF_NONE,0.f,0u,nullptr,&properties));
+		rawFile = readFile(fs,rawPath);
+		for (uint32_t i=0u; i<BufferCount; i++)
+		{
+			offsets[i] = rawFile.find(bufferContents(i,size));
+			anyAligned = anyAligned||(offsets[i]!=std::string::npos&&(offsets[i]%_IRR_SIMD_ALIGNMENT)==0u);
+		}
+	}
+	passed = check(anyAligned,"a raw buffer blob lands on an aligned offset")&&passed;
+
+	//! checks the buffers hold what was written, and that they alias the file exactly where they're allowed to
+	auto checkBuffers = [&](const core::vector<ICPUBuffer*>& buffers, const void* mapped, bool mayAlias, const char* what)
+	{
+		bool contentsKept = true, aliasedAsExpected = true;
+		for (uint32_t i=0u; i<BufferCount; i++)
+		{
+			const std::string expected = bufferContents(i,size);
+			contentsKept = contentsKept&&buffers[i]&&buffers[i]->getSize()==size&&!memcmp(buffers[i]->getPointer(),expected.data(),size);
+			if (!buffers[i])
+				continue;
+			const uint8_t* inFile = reinterpret_cast<const uint8_t*>(mapped)+offsets[i];
+			const bool aliasable = mayAlias&&(reinterpret_cast<size_t>(inFile)%_IRR_SIMD_ALIGNMENT)==0u;
+			aliasedAsExpected = aliasedAsExpected&&(buffers[i]->getPointer()==inFile)==aliasable;
+		}
+		return check(contentsKept&&aliasedAsExpected,what);
+	};
+
+	// a mapped file with the flag set, aligned blobs are used in place
+	{
+		io::IReadFile* file = fs->createMappedReadFile(rawPath);
+		const void* mapped = file ? file->getMappedPointer():nullptr;
+		passed = check(mapped!=nullptr,"createMappedReadFile maps the file")&&passed;
+		if (mapped)
+		{
+			core::smart_refctd_ptr<ICPUMesh> mesh;
+			auto buffers = loadBuffers(am,file,true,mesh);
+			passed = checkBuffers(buffers,mapped,true,"mapped file, aligned raw blobs are aliased, the rest copied")&&passed;
+
+			// the buffers hold the mapping now
+			file->drop();
+			file = nullptr;
+			bool stillThere = true;
+			for (uint32_t i=0u; i<BufferCount; i++)
+				stillThere = stillThere&&buffers[i]&&!memcmp(buffers[i]->getPointer(),bufferContents(i,size).data(),size);
+			passed = check(stillThere,"aliasing buffers outlive the dropped file")&&passed;
+
+			// copy-on-write, the file on disk never changes
+			for (auto buffer : buffers)
+			if (buffer)
+				memset(buffer->getPointer(),0xff,size);
+			passed = check(readFile(fs,rawPath)==rawFile,"writing to the buffers leaves the file untouched")&&passed;
+		}
+		if (file)
+			file->drop();
+	}
+
+	// without the flag nothing gets aliased, even when it could be
+	{
+		io::IReadFile* file = fs->createMappedReadFile(rawPath);
+		if (file)
+		{
+			core::smart_refctd_ptr<ICPUMesh> mesh;
+			auto buffers = loadBuffers(am,file,false,mesh);
+			passed = checkBuffers(buffers,file->getMappedPointer(),false,"mapped file without the flag, every blob is copied")&&passed;
+			file->drop();
+		}
+		else
+			passed = check(false,"could not open the raw file")&&passed;
+	}
+
+	// memory files are in memory just the same
+	{
+		io::IReadFile* file = fs->createMemoryReadFile(rawFile.data(),rawFile.size(),"aliasing_memory.baw");
+		core::smart_refctd_ptr<ICPUMesh> mesh;
+		auto buffers = loadBuffers(am,file,true,mesh);
+		passed = checkBuffers(buffers,file->getMappedPointer(),true,"memory file, aligned raw blobs are aliased, the rest copied")&&passed;
+		file->drop();
+	}
+
+	// compressed blobs get decompressed into memory of their own
+	{
+		const char* compressedPath = "aliasing_compressed.baw";
+		auto mesh = createMesh(size);
+		am->writeAsset(compressedPath,IAssetWriter::SAssetWriteParams(mesh.get(),EWF_COMPRESSED,1.f,0u,nullptr,&properties));
+		io::IReadFile* file = fs->createMappedReadFile(compressedPath);
+		if (file)
+		{
+			const std::string compressedFile = readFile(fs,compressedPath);
+			bool compressed = true;
+			for (uint32_t i=0u; i<BufferCount; i++)
+				compressed = compressed&&compressedFile.find(bufferContents(i,size))==std::string::npos;
+
+			core::smart_refctd_ptr<ICPUMesh> loaded;
+			auto buffers = loadBuffers(am,file,true,loaded);
+			const uint8_t* mapped = reinterpret_cast<const uint8_t*>(file->getMappedPointer());
+			bool contentsKept = compressed, outsideFile = true;
+			for (uint32_t i=0u; i<BufferCount; i++)
+			{
+				contentsKept = contentsKept&&buffers[i]&&!memcmp(buffers[i]->getPointer(),bufferContents(i,size).data(),size);
+				const uint8_t* pointer = buffers[i] ? reinterpret_cast<const uint8_t*>(buffers[i]->getPointer()):nullptr;
+				outsideFile = outsideFile&&(pointer<mapped||pointer>=mapped+compressedFile.size());
+			}
+			passed = check(contentsKept&&outsideFile,"compressed blobs decompress into buffers of their own")&&passed;
+			file->drop();
+		}
+		else
+			passed = check(false,"could not open the compressed file")&&passed;
+	}
+
+	device->drop();
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
@@ -0,0 +1,258 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace irr;
+using namespace asset;
+
+
+//! One facet as its 12 number literals, normal first and then the vertices in file order
+typedef std::array<std::string,12u> SFacet;
+
+//! A literal for every kind of notation exporters write, all of them exact after parsing or rounded the same way as strtod
+std::string literal(uint32_t i)
+{
+	const float value = float(int32_t((i*2654435761u)>>8u)%200000-100000)/1024.f;
+	char buffer[64];
+	switch (i%5u)
+	{
+		case 0u:
+			sprintf(buffer,"%f",value);
+			break;
+		case 1u:
+			sprintf(buffer,"%e",value);
+			break;
+		case 2u:
+			sprintf(buffer,"%.9g",value);
+			break;
+		case 3u:
+			sprintf(buffer,"%+.3E",value);
+			break;
+		default:
+			// more significant digits than the fast path keeps
+			sprintf(buffer,"%.25f",value);
+			break;
+	}
+	return buffer;
+}
+
+//! what a correct parser has to make of a literal
+float parsed(const std::string& literal)
+{
+	return float(strtod(literal.c_str(),nullptr));
+}
+
+//! An ASCII STL split into two concatenated solids, tokens separated by every kind of whitespace
+std::string asciiSTL(const core::vector<SFacet>& facets)
+{
+	const char* separators[] = {" ","\t","\r\n  ","\n"," \t "};
+	uint32_t separator = 0u;
+	auto next = [&]() {return separators[(separator++)%5u];};
+
+	std::string retval = "solid first part\n";
+	for (size_t f=0u; f<facets.size(); f++)
+	{
+		if (f==facets.size()/2u)
+			retval += "endsolid first part\nsolid second part\n";
+		const auto& facet = facets[f];
+		retval += std::string("facet")+next()+"normal"+next()+facet[0]+next()+facet[1]+next()+facet[2]+"\n";
+		retval += std::string("  outer")+next()+"loop\n";
+		for (uint32_t v=0u; v<3u; v++)
+			retval += std::string("    vertex")+next()+facet[3u+3u*v]+next()+facet[4u+3u*v]+next()+facet[5u+3u*v]+"\n";
+		retval += std::string("  endloop")+next()+"endfacet\n";
+	}
+	return retval+"endsolid second part\n";
+}
+
+//! A binary STL of the same facets, `attribute(f)` gives the attribute word of each
+template<class Attribute>
+std::string binarySTL(const core::vector<SFacet>& facets, const char* header, Attribute attribute)
+{
+	std::string retval(84u+50u*facets.size(),'\0');
+	memcpy(&retval[0],header,strlen(header));
+	const uint32_t triangleCount = facets.size();
+	memcpy(&retval[80],&triangleCount,4u);
+	for (size_t f=0u; f<facets.size(); f++)
+	{
+		char* triangle = &retval[84u+50u*f];
+		for (uint32_t i=0u; i<12u; i++)
+		{
+			const float value = parsed(facets[f][i]);
+			memcpy(triangle+4u*i,&value,4u);
+		}
+		const uint16_t word = attribute(f);
+		memcpy(triangle+48u,&word,2u);
+	}
+	return retval;
+}
+
+//! the only meshbuffer of the STL in `contents`, nullptr if it didn't load
+core::smart_refctd_ptr<ICPUMeshBuffer> load(IAssetManager* am, io::IFileSystem* fs, const std::string& contents, uint32_t loaderFlags)
+{
+	io::IReadFile* file = fs->createMemoryReadFile(contents.data(),contents.size(),"stl_loading.stl");
+	// nothing may come from the cache, every load has to parse the file again
+	IAssetLoader::SAssetLoadParams params(0u,nullptr,IAssetLoader::ECF_DUPLICATE_REFERENCES,nullptr,static_cast<IAssetLoader::E_LOADER_PARAMETER_FLAGS>(loaderFlags));
+	auto bundle = am->getAsset(file,file->getFileName().c_str(),params);
+	file->drop();
+	if (bundle.getContents().first==bundle.getContents().second)
+		return nullptr;
+
+	auto mesh = core::smart_refctd_ptr_static_cast<ICPUMesh>(*bundle.getContents().first);
+	if (mesh->getMeshBufferCount()!=1u)
+		return nullptr;
+	return core::smart_refctd_ptr<ICPUMeshBuffer>(mesh->getMeshBuffer(0u));
+}
+
+//! bytes of the interleaved vertex buffer
+const ICPUBuffer* vertexBuffer(const ICPUMeshBuffer* meshbuffer)
+{
+	return meshbuffer->getMeshDataAndFormat()->getMappedBuffer(EVAI_ATTR0);
+}
+
+//! Vertex `3t+i` is vertex `2-i` of facet `t`, the first `triangleCount` facets are all there
+bool positionsMatch(const ICPUMeshBuffer* meshbuffer, const core::vector<SFacet>& facets, size_t triangleCount, bool flipX)
+{
+	if (!meshbuffer || meshbuffer->getIndexCount()!=3u*triangleCount)
+		return false;
+	for (size_t t=0u; t<triangleCount; t++)
+	for (uint32_t i=0u; i<3u; i++)
+	{
+		const auto& facet = facets[t];
+		const uint32_t v = 3u+3u*(2u-i);
+		const float x = parsed(facet[v]);
+		const core::vectorSIMDf position = meshbuffer->getPosition(meshbuffer->getIndexValue(3u*t+i));
+		if (position.x!=(flipX ? -x:x) || position.y!=parsed(facet[v+1u]) || position.z!=parsed(facet[v+2u]))
+			return false;
+	}
+	return true;
+}
+
+bool check(bool condition, const char* what)
+{
+	printf("%-72s %s\n",what,condition ? "OK":"FAILED");
+	return condition;
+}
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = core::dimension2d<uint32_t>(640, 480);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+
+	IAssetManager* am = device->getAssetManager();
+	io::IFileSystem* fs = device->getFileSystem();
+	bool passed = true;
+
+	// enough facets for the ASCII file to need several refills of the tokenizer and the binary several chunks
+	core::vector<SFacet> facets(24000u);
+	for (uint32_t f=0u; f<facets.size(); f++)
+	for (uint32_t i=0u; i<12u; i++)
+		facets[f][i] = literal(f*12u+i);
+	// notations the fast path hands over to strtod, and a zero normal which has to be recomputed
+	facets[7] = {"-0","0","+0.","+2.",".5","1.5e-3","12345678901234567890123","0x1p-2","-1E+2","3","4e0","-5.25"};
+
+	const std::string ascii = asciiSTL(facets);
+	auto noAttribute = [](size_t f) {return uint16_t(0u);};
+	const std::string binary = binarySTL(facets,"binary header without the magic",noAttribute);
+	// some exporters begin the binary header with "solid" too
+	const std::string binarySolid = binarySTL(facets,"solid exported as binary",noAttribute);
+
+	auto asciiMesh = load(am,fs,ascii,IAssetLoader::ELPF_NONE);
+	auto binaryMesh = load(am,fs,binary,IAssetLoader::ELPF_NONE);
+	auto binarySolidMesh = load(am,fs,binarySolid,IAssetLoader::ELPF_NONE);
+	passed = check(ascii.size()>(2u<<20u)&&positionsMatch(asciiMesh.get(),facets,facets.size(),true),"ASCII positions parse exactly, x flipped and winding reversed")&&passed;
+	passed = check(positionsMatch(binaryMesh.get(),facets,facets.size(),true),"binary positions load exactly, x flipped and winding reversed")&&passed;
+	passed = check(positionsMatch(binarySolidMesh.get(),facets,facets.size(),true),"binary file with a header starting with solid")&&passed;
+
+	// the normals got quantized from the same floats, so the whole vertex buffers are the same
+	{
+		bool same = asciiMesh&&binaryMesh&&binarySolidMesh;
+		if (same)
+		{
+			const ICPUBuffer* asciiVertices = vertexBuffer(asciiMesh.get());
+			const ICPUBuffer* binaryVertices = vertexBuffer(binaryMesh.get());
+			const ICPUBuffer* binarySolidVertices = vertexBuffer(binarySolidMesh.get());
+			same = asciiVertices->getSize()==16u*3u*facets.size()&&binaryVertices->getSize()==asciiVertices->getSize()&&binarySolidVertices->getSize()==asciiVertices->getSize();
+			same = same&&!memcmp(asciiVertices->getPointer(),binaryVertices->getPointer(),asciiVertices->getSize());
+			same = same&&!memcmp(asciiVertices->getPointer(),binarySolidVertices->getPointer(),asciiVertices->getSize());
+		}
+		passed = check(same,"ASCII and binary files of the same facets give the same vertices")&&passed;
+	}
+
+	// a file cut short keeps the triangles which made it
+	{
+		const std::string truncated = binary.substr(0u,binary.size()-20u);
+		auto mesh = load(am,fs,truncated,IAssetLoader::ELPF_NONE);
+		passed = check(positionsMatch(mesh.get(),facets,facets.size()-1u,true),"truncated binary file loads its complete triangles")&&passed;
+	}
+
+	// right-handed meshes are loaded as they are, normals included
+	{
+		const core::vector<SFacet> unitX = {{"1","0","0", "0","0","0", "0","1","0", "0","0","1"}};
+		auto leftHanded = load(am,fs,asciiSTL(unitX),IAssetLoader::ELPF_NONE);
+		auto rightHanded = load(am,fs,asciiSTL(unitX),IAssetLoader::ELPF_RIGHT_HANDED_MESHES);
+		bool handedness = positionsMatch(leftHanded.get(),unitX,1u,true)&&positionsMatch(rightHanded.get(),unitX,1u,false);
+		core::vectorSIMDf leftNormal, rightNormal;
+		handedness = handedness&&leftHanded->getAttribute(leftNormal,EVAI_ATTR3,0u)&&rightHanded->getAttribute(rightNormal,EVAI_ATTR3,0u);
+		handedness = handedness&&leftNormal.x<-0.99f&&rightNormal.x>0.99f&&std::abs(leftNormal.y)<0.01f&&std::abs(rightNormal.z)<0.01f;
+		passed = check(handedness,"ELPF_RIGHT_HANDED_MESHES keeps x of positions and normals")&&passed;
+	}
+
+	// only vertices with every attribute equal merge, a shared corner with another normal stays separate
+	{
+		const core::vector<SFacet> quad = {
+			{"0","0","1", "0","0","0", "1","0","0", "1","1","0"},
+			{"0","0","1", "0","0","0", "1","1","0", "0","1","0"},
+			{"0","1","0", "0","0","0", "0","0","1", "1","0","0"}
+		};
+		auto mesh = load(am,fs,asciiSTL(quad),IAssetLoader::ELPF_WELD_VERTICES);
+		const bool welded = mesh&&mesh->getMeshDataAndFormat()->getIndexBuffer()&&mesh->getIndexType()==EIT_16BIT&&vertexBuffer(mesh.get())->getSize()==16u*7u;
+		passed = check(welded&&positionsMatch(mesh.get(),quad,quad.size(),true),"welding a quad and a corner leaves 7 vertices and 16 bit indices")&&passed;
+	}
+
+	// far more than 64k unique vertices need 32 bit indices, and indexing gives back every vertex
+	{
+		auto mesh = load(am,fs,binary,IAssetLoader::ELPF_WELD_VERTICES);
+		bool welded = mesh&&binaryMesh&&mesh->getMeshDataAndFormat()->getIndexBuffer()&&mesh->getIndexType()==EIT_32BIT;
+		welded = welded&&vertexBuffer(mesh.get())->getSize()<=vertexBuffer(binaryMesh.get())->getSize();
+		passed = check(welded&&positionsMatch(mesh.get(),facets,facets.size(),true),"welding a large mesh gives 32 bit indices to the same positions")&&passed;
+	}
+
+	// the attribute word is a colour only if every facet says so
+	{
+		const core::vector<SFacet> pair(facets.begin(),facets.begin()+2u);
+		auto allColored = load(am,fs,binarySTL(pair,"colored",[](size_t f) {return uint16_t(0x8000u|0x7c00u);}),IAssetLoader::ELPF_NONE);
+		auto oneColored = load(am,fs,binarySTL(pair,"colored",[](size_t f) {return uint16_t(f ? 0x7c00u:0xfc00u);}),IAssetLoader::ELPF_NONE);
+		bool colors = allColored&&oneColored&&allColored->getMeshDataAndFormat()->getMappedBuffer(EVAI_ATTR1)&&!oneColored->getMeshDataAndFormat()->getMappedBuffer(EVAI_ATTR1);
+		core::vectorSIMDf red;
+		colors = colors&&allColored->getAttribute(red,EVAI_ATTR1,0u)&&red.x>0.99f&&red.y<0.01f&&red.z<0.01f;
+		passed = check(colors&&vertexBuffer(allColored.get())->getSize()==20u*6u,"binary colours are kept only when every facet has one")&&passed;
+	}
+
+	// anything which isn't a facet fails the whole file
+	{
+		const char* broken[] = {
+			"solid broken\nfacet normal 0 0 1\n outer loop\n vertex 0 0 0\n vertex 1 0 x\n vertex 0 1 0\n endloop\nendfacet\nendsolid broken\n",
+			"solid broken\nfacet normal 0 0 1\n outer loop\n vertex 0 0 0\n vertex 1 0 0\n endloop\nendfacet\nendsolid broken\n",
+			"solid broken\nfacet normal 0 0 1\n outer loop\n vertex 0 0 0\n vertex 1 0 0\n vertex 0 1 0\n endloop\n"
+		};
+		bool refused = true;
+		for (auto contents : broken)
+			refused = refused&&!load(am,fs,contents,IAssetLoader::ELPF_NONE);
+		passed = check(refused,"syntax errors and missing tokens fail to load")&&passed;
+	}
+
+	device->drop();
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
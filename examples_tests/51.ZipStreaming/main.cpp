@@ -0,0 +1,265 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+#include "zlib/zlib.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace irr;
+using namespace io;
+
+
+//! Hashed bytes in runs of 8, they still compress but a read of a few runs from the wrong offset won't match
+std::string contents(size_t size, uint32_t seed)
+{
+	std::string retval(size,'\0');
+	for (size_t i=0u; i<size; i++)
+	{
+		uint32_t hash = (uint32_t(i>>3u)+seed)*2654435761u;
+		hash = (hash^(hash>>15u))*0x2c1b3c6du;
+		retval[i] = char(hash^(hash>>12u));
+	}
+	return retval;
+}
+
+//! raw deflate stream without a zlib header, like zip and gzip store it
+std::string deflateRaw(const std::string& data)
+{
+	z_stream stream;
+	memset(&stream,0,sizeof(stream));
+	deflateInit2(&stream,Z_DEFAULT_COMPRESSION,Z_DEFLATED,-MAX_WBITS,8,Z_DEFAULT_STRATEGY);
+	std::string retval(deflateBound(&stream,data.size()),'\0');
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+	stream.avail_in = data.size();
+	stream.next_out = reinterpret_cast<Bytef*>(&retval[0]);
+	stream.avail_out = retval.size();
+	deflate(&stream,Z_FINISH);
+	retval.resize(stream.total_out);
+	deflateEnd(&stream);
+	return retval;
+}
+
+void put16(std::string& out, uint16_t value)
+{
+	out.append(reinterpret_cast<const char*>(&value),2u);
+}
+
+void put32(std::string& out, uint32_t value)
+{
+	out.append(reinterpret_cast<const char*>(&value),4u);
+}
+
+struct SEntry
+{
+	const char* name;
+	const std::string* data;
+	//! only the first half of the compressed stream gets stored
+	bool truncated;
+};
+
+//! A zip archive of deflated entries with their sizes in the local headers and a central directory
+std::string zipArchive(const core::vector<SEntry>& entries)
+{
+	std::string retval, directory;
+	for (const auto& entry : entries)
+	{
+		std::string compressed = deflateRaw(*entry.data);
+		if (entry.truncated)
+			compressed.resize(compressed.size()/2u);
+		const uint32_t crc = crc32(0ul,reinterpret_cast<const Bytef*>(entry.data->data()),entry.data->size());
+		const uint32_t localOffset = retval.size();
+		const uint16_t nameLength = strlen(entry.name);
+
+		put32(retval,0x04034b50u);
+		put16(retval,20u);
+		put16(retval,0u);
+		put16(retval,8u);
+		put32(retval,0u);
+		put32(retval,crc);
+		put32(retval,compressed.size());
+		put32(retval,entry.data->size());
+		put16(retval,nameLength);
+		put16(retval,0u);
+		retval += entry.name;
+		retval += compressed;
+
+		put32(directory,0x02014b50u);
+		put16(directory,20u);
+		put16(directory,20u);
+		put16(directory,0u);
+		put16(directory,8u);
+		put32(directory,0u);
+		put32(directory,crc);
+		put32(directory,compressed.size());
+		put32(directory,entry.data->size());
+		put16(directory,nameLength);
+		put32(directory,0u);
+		put32(directory,0u);
+		put32(directory,0u);
+		put32(directory,localOffset);
+		directory += entry.name;
+	}
+
+	const uint32_t directoryOffset = retval.size();
+	retval += directory;
+	put32(retval,0x06054b50u);
+	put32(retval,0u);
+	put16(retval,entries.size());
+	put16(retval,entries.size());
+	put32(retval,directory.size());
+	put32(retval,directoryOffset);
+	put16(retval,0u);
+	return retval;
+}
+
+//! A gzip member with the file name stored
+std::string gzipFile(const char* name, const std::string& data)
+{
+	std::string retval = "\x1f\x8b\x08\x08";
+	put32(retval,0u);
+	put16(retval,0x0300u);
+	retval.append(name,strlen(name)+1u);
+	retval += deflateRaw(data);
+	put32(retval,crc32(0ul,reinterpret_cast<const Bytef*>(data.data()),data.size()));
+	put32(retval,data.size());
+	return retval;
+}
+
+//! reads `size` bytes at `pos` and compares them with the same range of `expected`
+bool readsAt(IReadFile* file, const std::string& expected, size_t pos, size_t size)
+{
+	if (!file->seek(pos) || file->getPos()!=pos)
+		return false;
+	const size_t available = core::min(size,expected.size()-pos);
+	std::string out(size,'\0');
+	if (file->read(&out[0],size)!=int32_t(available) || file->getPos()!=pos+available)
+		return false;
+	return !expected.compare(pos,available,out,0u,available);
+}
+
+bool check(bool condition, const char* what)
+{
+	printf("%-72s %s\n",what,condition ? "OK":"FAILED");
+	return condition;
+}
+
+//! Reads the whole entry at once, in odd pieces, and with seeks both ways across chunks and checkpoints
+bool checkEntry(IFileArchive* archive, const char* name, const std::string& expected, const std::string& suffix)
+{
+	IReadFile* file = archive ? archive->createAndOpenFile(name):nullptr;
+	bool passed = check(file&&file->getSize()==expected.size(),("entry opens with the right size"+suffix).c_str());
+	if (!file)
+		return false;
+
+	passed = check(readsAt(file,expected,0u,expected.size()),("whole entry in one read"+suffix).c_str())&&passed;
+
+	bool pieces = file->seek(0u);
+	for (size_t pos=0u; pieces&&pos<expected.size(); pos+=100003u)
+		pieces = readsAt(file,expected,pos,100003u);
+	passed = check(pieces,("whole entry in odd pieces"+suffix).c_str())&&passed;
+
+	// both sides of chunk and checkpoint boundaries, far backwards and far forwards
+	const size_t size = expected.size();
+	const size_t positions[] = {size-10u,0u,(3u<<20u)-7u,(2u<<20u)-1u,(64u<<10u)-1u,(9u<<19u)+5u,1u<<20u,size-70000u,(2u<<20u)+(64u<<10u),17u};
+	bool seeks = true;
+	for (auto pos : positions)
+		seeks = seeks&&(pos>=size||readsAt(file,expected,pos,70000u));
+	uint32_t state = 12345u;
+	for (uint32_t i=0u; seeks&&i<200u; i++)
+	{
+		state = state*1664525u+1013904223u;
+		seeks = readsAt(file,expected,state%size,1u+(state>>20u)%5000u);
+	}
+	passed = check(seeks,("reads after seeks in every direction"+suffix).c_str())&&passed;
+
+	char byte;
+	bool bounds = file->seek(size)&&file->read(&byte,1u)==0&&!file->seek(size+1u)&&file->getPos()==size;
+	bounds = bounds&&file->seek(size/2u)&&file->seek(size/4u,true)&&file->getPos()==size/2u+size/4u;
+	passed = check(bounds,("seeks are bounded and relative seeks add up"+suffix).c_str())&&passed;
+
+	file->drop();
+	return passed;
+}
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = core::dimension2d<uint32_t>(640, 480);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+
+	IFileSystem* fs = device->getFileSystem();
+	bool passed = true;
+
+	// big entries stream past a couple of checkpoints, small ones still get inflated upfront
+	const std::string big = contents((5u<<20u)+12345u,1u);
+	const std::string other = contents((3u<<20u)+777u,2u);
+	const std::string small = contents(100000u,3u);
+	const std::string zip = zipArchive({{"big.bin",&big,false},{"small.bin",&small,false},{"other.bin",&other,false},{"broken.bin",&big,true}});
+	const std::string gzip = gzipFile("big.bin",big);
+
+	IFileArchive* zipReader = nullptr;
+	IFileArchive* gzipReader = nullptr;
+	{
+		IReadFile* zipFile = fs->createMemoryReadFile(zip.data(),zip.size(),"streaming.zip");
+		IReadFile* gzipFile = fs->createMemoryReadFile(gzip.data(),gzip.size(),"streaming.gz");
+		passed = check(fs->addFileArchive(zipFile,EFAT_ZIP,"",&zipReader)&&zipReader,"zip archive in memory is added")&&passed;
+		passed = check(fs->addFileArchive(gzipFile,EFAT_GZIP,"",&gzipReader)&&gzipReader,"gzip file in memory is added")&&passed;
+		zipFile->drop();
+		gzipFile->drop();
+	}
+
+	passed = checkEntry(zipReader,"big.bin",big,", big zip entry")&&passed;
+	passed = checkEntry(gzipReader,"big.bin",big,", gzip")&&passed;
+	{
+		IReadFile* file = zipReader ? zipReader->createAndOpenFile("small.bin"):nullptr;
+		passed = check(file&&readsAt(file,small,0u,small.size())&&readsAt(file,small,small.size()/3u,5000u),"small zip entry")&&passed;
+		if (file)
+			file->drop();
+	}
+
+	// readers of the same archive share its file, so each has to seek it before every refill
+	{
+		IReadFile* forward = zipReader ? zipReader->createAndOpenFile("big.bin"):nullptr;
+		IReadFile* backward = zipReader ? zipReader->createAndOpenFile("other.bin"):nullptr;
+		bool interleaved = forward&&backward;
+		for (size_t i=1u; interleaved&&i*70001u<=other.size(); i++)
+		{
+			interleaved = readsAt(forward,big,(i-1u)*70001u,70001u);
+			interleaved = interleaved&&readsAt(backward,other,other.size()-i*70001u,70001u);
+		}
+		passed = check(interleaved,"interleaved reads of two entries of one archive")&&passed;
+		if (forward)
+			forward->drop();
+		if (backward)
+			backward->drop();
+	}
+
+	// a cut off stream gives back what could be inflated and nothing after it
+	{
+		IReadFile* file = zipReader ? zipReader->createAndOpenFile("broken.bin"):nullptr;
+		bool partial = file&&file->getSize()==big.size();
+		if (partial)
+		{
+			std::string out(big.size(),'\0');
+			const int32_t readBytes = file->read(&out[0],out.size());
+			partial = readBytes>0&&size_t(readBytes)<big.size()&&!big.compare(0u,readBytes,out,0u,readBytes);
+			partial = partial&&readsAt(file,big,0u,1000u);
+		}
+		passed = check(partial,"truncated entry reads only up to where its data ends")&&passed;
+		if (file)
+			file->drop();
+	}
+
+	if (zipReader)
+		fs->removeFileArchive(zipReader);
+	if (gzipReader)
+		fs->removeFileArchive(gzipReader);
+	device->drop();
+
+	printf("\n%s\n",passed ? "All tests passed.":"FAILED");
+	return passed ? 0:1;
+}
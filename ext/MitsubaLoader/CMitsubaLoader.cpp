@@ -77,6 +77,7 @@ const char** CMitsubaLoader::getAssociatedFileExtensions() const
 
 asset::SAssetBundle CMitsubaLoader::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
+	IRR_PROFILE_SCOPE("CMitsubaLoader::loadAsset");
 	ParserManager parserManager(manager->getFileSystem(),_override);
 	if (!parserManager.parse(_file))
 		return {};
@@ -91,6 +92,9 @@ asset::SAssetBundle CMitsubaLoader::loadAsset(io::IReadFile* _file, const asset:
 		parserManager.m_globalMetadata.get()
 	};
 
+	// geometry files are the bulk of the loading time, so get them all in flight before instantiating shapes
+	prefetchModels(ctx,_hierarchyLevel,parserManager.shapegroups);
+
 	core::unordered_set<core::smart_refctd_ptr<asset::ICPUMesh>,core::smart_refctd_ptr<asset::ICPUMesh>::hash> meshes;
 
 	for (auto& shapepair : parserManager.shapegroups)
@@ -128,6 +132,58 @@ asset::SAssetBundle CMitsubaLoader::loadAsset(io::IReadFile* _file, const asset:
 	return {meshes};
 }
 
+void CMitsubaLoader::prefetchModels(SContext& ctx, uint32_t hierarchyLevel, const core::vector<std::pair<CElementShape*,std::string> >& shapes)
+{
+	core::vector<const CElementShape*> stack;
+	for (const auto& shapepair : shapes)
+		stack.push_back(shapepair.first);
+	while (!stack.empty())
+	{
+		const CElementShape* shape = stack.back();
+		stack.pop_back();
+		if (!shape)
+			continue;
+
+		const SPropertyElementData* filename = nullptr;
+		switch (shape->type)
+		{
+			case CElementShape::Type::OBJ:
+				filename = &shape->obj.filename;
+				break;
+			case CElementShape::Type::PLY:
+				filename = &shape->ply.filename;
+				break;
+			case CElementShape::Type::SERIALIZED:
+				filename = &shape->serialized.filename;
+				break;
+			case CElementShape::Type::SHAPEGROUP:
+				for (auto i=0u; i<shape->shapegroup.childCount; i++)
+					stack.push_back(shape->shapegroup.children[i]);
+				break;
+			default:
+				break;
+		}
+		if (filename && filename->type==SPropertyElementData::Type::STRING)
+			ctx.modelCache.emplace(filename->svalue,asset::SAssetBundle());
+	}
+	if (ctx.modelCache.empty())
+		return;
+
+	// no insertions happen from now on, so the entries keep their addresses while the workers fill them in
+	core::vector<std::pair<const std::string*,asset::SAssetBundle*> > jobs;
+	jobs.reserve(ctx.modelCache.size());
+	for (auto& entry : ctx.modelCache)
+		jobs.emplace_back(&entry.first,&entry.second);
+
+	// the asset cache is concurrent and the loaders keep their per-file state in local contexts,
+	// loaders which go parallel themselves (.serialized) share the same scheduler instead of oversubscribing
+	core::CTaskScheduler::getGlobal().parallelFor(0u,static_cast<uint32_t>(jobs.size()),1u,[&](uint32_t firstJob, uint32_t lastJob) -> void
+	{
+		for (uint32_t i=firstJob; i<lastJob; i++)
+			*jobs[i].second = interm_getAssetInHierarchy(manager, *jobs[i].first, ctx.params, hierarchyLevel, ctx.override);
+	});
+}
+
 CMitsubaLoader::SContext::shape_ass_type CMitsubaLoader::getMesh(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape)
 {
 	if (!shape)
@@ -196,18 +252,46 @@ CMitsubaLoader::SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext
 	static auto applyTransformToMB = [](asset::ICPUMeshBuffer* meshbuffer, core::matrix3x4SIMD tform) -> void
 	{
 		const auto index = meshbuffer->getPositionAttributeIx();
-		core::vectorSIMDf vpos;
-		for (uint32_t i = 0u; meshbuffer->getAttribute(vpos, index, i); i++)
+		auto* desc = meshbuffer->getMeshDataAndFormat();
+		const asset::ICPUBuffer* buffer = desc ? desc->getMappedBuffer(index):nullptr;
+		const auto format = desc ? desc->getAttribFormat(index):asset::EF_UNKNOWN;
+		uint8_t* it = meshbuffer->getAttribPointer(index);
+		// only the vertices this meshbuffer uses, the rest of the buffer can belong to other meshbuffers sharing it
+		const size_t vertexCount = meshbuffer->calcVertexCount();
+		if (it && (format==asset::EF_R32G32B32_SFLOAT || format==asset::EF_R32G32B32A32_SFLOAT))
 		{
-			tform.transformVect(vpos);
-			meshbuffer->setAttribute(vpos, index, i);
+			// bulk path for the only position format our loaders produce, skips the per-vertex format decode and encode
+			const uint8_t* end = reinterpret_cast<const uint8_t*>(buffer->getPointer())+buffer->getSize();
+			const size_t stride = desc->getMappedBufferStride(index) ? desc->getMappedBufferStride(index):asset::getTexelOrBlockBytesize(format);
+			for (size_t i=0u; i<vertexCount && it+sizeof(float)*3u<=end; i++,it+=stride)
+			{
+				float* pos = reinterpret_cast<float*>(it);
+				core::vectorSIMDf vpos = it+sizeof(core::vectorSIMDf)<=end ? core::vectorSIMDf(_mm_loadu_ps(pos)):core::vectorSIMDf(pos[0],pos[1],pos[2]);
+				vpos.w = 1.f;
+				tform.transformVect(vpos);
+				memcpy(pos,vpos.pointer,sizeof(float)*3u);
+			}
+		}
+		else
+		{
+			core::vectorSIMDf vpos;
+			for (uint32_t i = 0u; i<vertexCount && meshbuffer->getAttribute(vpos, index, i); i++)
+			{
+				tform.transformVect(vpos);
+				meshbuffer->setAttribute(vpos, index, i);
+			}
 		}
 		meshbuffer->recalculateBoundingBox();
 	};
 	auto loadModel = [&](const ext::MitsubaLoader::SPropertyElementData& filename, int64_t index=-1) -> core::smart_refctd_ptr<asset::ICPUMesh>
 	{
 		assert(filename.type==ext::MitsubaLoader::SPropertyElementData::Type::STRING);
-		auto retval = interm_getAssetInHierarchy(manager, filename.svalue, ctx.params, hierarchyLevel/*+ICPUSCene::MESH_HIERARCHY_LEVELS_BELOW*/, ctx.override);
+		asset::SAssetBundle retval;
+		auto prefetched = ctx.modelCache.find(filename.svalue);
+		if (prefetched!=ctx.modelCache.end())
+			retval = prefetched->second;
+		else
+			retval = interm_getAssetInHierarchy(manager, filename.svalue, ctx.params, hierarchyLevel/*+ICPUSCene::MESH_HIERARCHY_LEVELS_BELOW*/, ctx.override);
 		auto contentRange = retval.getContents();
 		//
 		uint32_t actualIndex = 0;
@@ -378,8 +462,26 @@ CMitsubaLoader::SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext
 
 	// flip normals if necessary
 	if (flipNormals)
-	for (auto i=0u; i<mesh->getMeshBufferCount(); i++)
-		ctx.manipulator->flipSurfaces(mesh->getMeshBuffer(i));
+	{
+		// loaded models share their buffers with every other reference to them and identical serialized shapes, so flip a copy
+		const bool sharedBuffers = shape->type==CElementShape::Type::OBJ || shape->type==CElementShape::Type::PLY || shape->type==CElementShape::Type::SERIALIZED;
+		if (sharedBuffers)
+		{
+			auto flipped = core::make_smart_refctd_ptr<asset::CCPUMesh>();
+			for (auto i=0u; i<mesh->getMeshBufferCount(); i++)
+			{
+				auto meshbuffer = ctx.manipulator->createMeshBufferDuplicate(mesh->getMeshBuffer(i));
+				ctx.manipulator->flipSurfaces(meshbuffer.get());
+				flipped->addMeshBuffer(std::move(meshbuffer));
+			}
+			flipped->recalculateBoundingBox();
+			manager->setAssetMetadata(flipped.get(), core::smart_refctd_ptr<asset::IAssetMetadata>(mesh->getMetadata()));
+			mesh = std::move(flipped);
+		}
+		else
+		for (auto i=0u; i<mesh->getMeshBufferCount(); i++)
+			ctx.manipulator->flipSurfaces(mesh->getMeshBuffer(i));
+	}
 	// flip normals if necessary
 #define CRISS_FIX_THIS
 #ifdef CRISS_FIX_THIS
@@ -55,12 +55,15 @@ class CMitsubaLoader : public asset::IAssetLoader
 			//! TODO: even later when texture changes come, might have to return not only a combined sampler but some GLSL sampling code due to the "scale" and offset XML nodes
 			using tex_ass_type = video::SMaterialLayer<asset::ICPUTexture>; // = std::pair<core::smart_refctd_ptr<asset::ICPUTextureView>,core::smart_refctd_ptr<asset::ICPUSampler> >;
 			core::unordered_map<const CElementTexture*, tex_ass_type> textureCache;
+			//! geometry files referenced by the scene, loaded concurrently upfront by `prefetchModels`
+			core::unordered_map<std::string, asset::SAssetBundle> modelCache;
 		};
 
 		//! Destructor
 		virtual ~CMitsubaLoader() = default;
 
 		//
+		void						prefetchModels(SContext& ctx, uint32_t hierarchyLevel, const core::vector<std::pair<CElementShape*,std::string> >& shapes);
 		SContext::shape_ass_type	getMesh(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape);
 		SContext::group_ass_type	loadShapeGroup(SContext& ctx, uint32_t hierarchyLevel, const CElementShape::ShapeGroup* shapegroup);
 		SContext::shape_ass_type	loadBasicShape(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape);
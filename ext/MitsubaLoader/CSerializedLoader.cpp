@@ -1,5 +1,7 @@
 #include "IrrCompileConfig.h"
 
+#include <mutex>
+
 #include "irr/core/core.h"
 #include "IReadFile.h"
 #include "os.h"
@@ -36,10 +38,233 @@ struct alignas(PAGE_SIZE) Page_t
 };
 #undef PAGE_SIZE
 
+namespace
+{
+
+//! Output of a worker, the mesh buffers get assembled (and deduplicated) serially afterwards
+struct SParsedMesh
+{
+	core::smart_refctd_ptr<asset::ICPUBuffer> buffer;
+	std::string name;
+	uint32_t flags = 0u;
+	uint32_t vertexCount = 0u;
+	uint64_t triangleCount = 0ull;
+	core::aabbox3df bbox;
+	uint64_t hash[4] = {};
+	const char* error = nullptr;
+};
+
+//! Every attribute in a `.serialized` mesh is a separate tightly packed stream, so they can be copied wholesale
+void ingestAttributeStream(float* out, const uint8_t* in, size_t scalarCount, bool isDouble)
+{
+	if (!isDouble)
+	{
+		memcpy(out,in,scalarCount*sizeof(float));
+		return;
+	}
+
+	const double* inD = reinterpret_cast<const double*>(in);
+	size_t i=0u;
+	#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+	for (; i+4u<=scalarCount; i+=4u)
+	{
+		const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(inD+i));
+		const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(inD+i+2u));
+		_mm_storeu_ps(out+i,_mm_movelh_ps(lo,hi));
+	}
+	#endif
+	for (; i<scalarCount; i++)
+		out[i] = static_cast<float>(inD[i]);
+}
+
+core::aabbox3df computePositionBounds(const float* positions, uint32_t vertexCount)
+{
+	#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+	// the last vertex is loaded separately to not read past the end of the stream
+	__m128 minEdge = _mm_setr_ps(positions[3u*(vertexCount-1u)],positions[3u*(vertexCount-1u)+1u],positions[3u*(vertexCount-1u)+2u],0.f);
+	__m128 maxEdge = minEdge;
+	for (uint32_t j=0u; j+1u<vertexCount; j++)
+	{
+		const __m128 pos = _mm_loadu_ps(positions+3u*j);
+		minEdge = _mm_min_ps(minEdge,pos);
+		maxEdge = _mm_max_ps(maxEdge,pos);
+	}
+	alignas(16) float tmp[8];
+	_mm_store_ps(tmp,minEdge);
+	_mm_store_ps(tmp+4u,maxEdge);
+	return core::aabbox3df(tmp[0],tmp[1],tmp[2],tmp[4],tmp[5],tmp[6]);
+	#else
+	core::aabbox3df retval(core::vector3df(positions[0],positions[1],positions[2]));
+	for (uint32_t j=1u; j<vertexCount; j++)
+		retval.addInternalPoint(positions[3u*j],positions[3u*j+1u],positions[3u*j+2u]);
+	return retval;
+	#endif
+}
+
+//! Parses one inflated mesh straight into a non-interleaved ICPUBuffer (positions, normals, uvs, colors, indices)
+bool parseMesh(SParsedMesh& result, uint8_t* ptr, const size_t decompressSize)
+{
+	// too small to hold anything
+	if (decompressSize < sizeof(uint8_t)+sizeof(uint64_t)*2ull)
+		return false;
+
+	// some tracking
+	const uint8_t* streamEnd = ptr+decompressSize;
+	// vertex size determination
+	const auto flags = result.flags = *(reinterpret_cast<uint32_t*&>(ptr)++);
+	size_t typeSize;
+	size_t vertexAttributeCount = 3u;
+	{
+		if (flags & MF_SINGLE_FLOAT)
+			typeSize = sizeof(float);
+		else if (flags & MF_DOUBLE_FLOAT)
+			typeSize = sizeof(double);
+		else
+			return false;
+
+		if ((flags & MF_PER_VERTEX_NORMALS) || (flags & MF_FACE_NORMALS))
+			vertexAttributeCount += 3ull;
+		if (flags & MF_TEXTURE_COORDINATES)
+			vertexAttributeCount += 2ull;
+		if (flags & MF_VERTEX_COLORS)
+			vertexAttributeCount += 3ull;
+	}
+
+	// get name
+	char* stringPtr = reinterpret_cast<char*>(ptr);
+	while (ptr < streamEnd)
+	if (! *(ptr++))
+			break;
+	// name too long
+	size_t stringLen = reinterpret_cast<char*>(ptr)-stringPtr;
+	if (ptr+sizeof(uint64_t)*2ull > streamEnd)
+		return false;
+	result.name = std::string(stringPtr,stringLen);
+
+	// 
+	uint64_t vertexCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
+	if (vertexCount<3ull || vertexCount>0xFFFFFFFFull)
+		return false;
+	uint64_t triangleCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
+	if (triangleCount<1ull)
+		return false;
+	// face normals are not stored, they get generated from the triangles
+	const bool generateNormals = !(flags & MF_PER_VERTEX_NORMALS) && (flags & MF_FACE_NORMALS);
+	const size_t inputVertexDataSize = vertexCount*(generateNormals ? (vertexAttributeCount-3u):vertexAttributeCount)*typeSize;
+	const size_t indexDataSize = sizeof(uint32_t)*3ull*triangleCount;
+	if (ptr+inputVertexDataSize+indexDataSize > streamEnd)
+		return false;
+	result.vertexCount = static_cast<uint32_t>(vertexCount);
+	result.triangleCount = triangleCount;
+
+	const size_t vertexDataSize = vertexCount*vertexAttributeCount*sizeof(float);
+	result.buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vertexDataSize+indexDataSize);
+	float* outPtr = reinterpret_cast<float*>(result.buffer->getPointer());
+	auto readAttributeStream = [&](size_t attrCount, bool read = true) -> float*
+	{
+		float* stream = outPtr;
+		const size_t scalarCount = vertexCount*attrCount;
+		if (read)
+		{
+			ingestAttributeStream(stream,ptr,scalarCount,typeSize==sizeof(double));
+			ptr += scalarCount*typeSize;
+		}
+		outPtr += scalarCount;
+		return stream;
+	};
+
+	// pos
+	const float* positions = readAttributeStream(3ull);
+	// normal
+	float* normals = nullptr;
+	if ((flags & MF_PER_VERTEX_NORMALS) || (flags & MF_FACE_NORMALS))
+		normals = readAttributeStream(3ull, flags&MF_PER_VERTEX_NORMALS); // TODO: normal quantization and optimization
+	if (flags & MF_TEXTURE_COORDINATES) // TODO: UV quantization and optimization
+		readAttributeStream(2ull);
+	if (flags & MF_VERTEX_COLORS) // TODO: quantize to 32bit format like RGB9E5
+		readAttributeStream(3ull);
+
+	// read indices in bulk, validate and possibly create per-face normals
+	uint32_t* indexPtr = reinterpret_cast<uint32_t*>(outPtr);
+	memcpy(indexPtr,ptr,indexDataSize);
+	{
+		uint32_t maxIndex = 0u;
+		for (uint64_t j=0ull; j<triangleCount*3ull; j++)
+			maxIndex = core::max(maxIndex,indexPtr[j]);
+		if (maxIndex >= static_cast<uint32_t>(vertexCount))
+			return false;
+	}
+	if (generateNormals)
+	{
+		memset(normals,0,vertexCount*3ull*sizeof(float));
+		for (uint64_t j=0ull; j<triangleCount; j++)
+		{
+			const uint32_t* triangleIndices = indexPtr+j*3ull;
+			const float* p0 = positions+triangleIndices[0]*3u;
+			const float* p1 = positions+triangleIndices[1]*3u;
+			const float* p2 = positions+triangleIndices[2]*3u;
+			const float e0[3] = {p1[0]-p0[0],p1[1]-p0[1],p1[2]-p0[2]};
+			const float e1[3] = {p2[0]-p0[0],p2[1]-p0[1],p2[2]-p0[2]};
+			const float normal[3] = {e0[1]*e1[2]-e0[2]*e1[1],e0[2]*e1[0]-e0[0]*e1[2],e0[0]*e1[1]-e0[1]*e1[0]};
+			for (uint64_t k=0ull; k<3ull; k++)
+				memcpy(normals+triangleIndices[k]*3u,normal,sizeof(normal));
+		}
+	}
+
+	result.bbox = computePositionBounds(positions,result.vertexCount);
+	core::XXHash_256(result.buffer->getPointer(),result.buffer->getSize(),result.hash);
+	return true;
+}
+
+bool inflateMesh(core::vector<Page_t>& decompressed, size_t& decompressSize, const uint8_t* data, size_t localSize)
+{
+	constexpr size_t CHUNK = 256ull*1024ull;
+	if (decompressed.size()*sizeof(Page_t)<CHUNK)
+		decompressed.resize(CHUNK/sizeof(Page_t));
+
+	// Setup the inflate stream.
+	z_stream stream;
+	stream.next_in = (Bytef*)data;
+	stream.avail_in = (uInt)localSize;
+	stream.total_in = 0;
+	stream.next_out = (Bytef*)decompressed.data();
+	stream.avail_out = decompressed.size()*sizeof(Page_t);
+	stream.total_out = 0u;
+	stream.zalloc = (alloc_func)0;
+	stream.zfree = (free_func)0;
+	stream.opaque = (voidpf)0;
+
+	// the meshes are zlib (not raw deflate) streams
+	int32_t err = inflateInit(&stream);
+	if (err == Z_OK)
+	{
+		while (err == Z_OK)
+		{
+			err = inflate(&stream, Z_NO_FLUSH);
+			if (err!=Z_OK || stream.avail_out)
+				continue;
+
+			// the decompressed buffer is reused between meshes, so it only ever grows
+			decompressed.resize(decompressed.size()+CHUNK/sizeof(Page_t));
+			stream.next_out = reinterpret_cast<Bytef*>(decompressed.data())+stream.total_out;
+			stream.avail_out = decompressed.size()*sizeof(Page_t)-stream.total_out;
+		}
+	}
+	decompressSize = stream.total_out;
+	int32_t err2 = inflateEnd(&stream);
+
+	if (err == Z_STREAM_END)
+		err = err2;
+	return err == Z_OK;
+}
+
+}
+
 
 //! creates/loads an animated mesh from the file.
 asset::SAssetBundle CSerializedLoader::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
+	IRR_PROFILE_SCOPE("CSerializedLoader::loadAsset");
 	if (!_file)
         return {};
 
@@ -82,210 +307,124 @@ asset::SAssetBundle CSerializedLoader::loadAsset(io::IReadFile* _file, const ass
 		return {};
 
 
-	core::vector<core::smart_refctd_ptr<asset::CCPUMesh> > meshes;
-	meshes.reserve(ctx.meshCount);
-
-	uint8_t* data = reinterpret_cast<uint8_t*>(_IRR_ALIGNED_MALLOC(maxSize,alignof(double)));
-	constexpr size_t CHUNK = 256ull*1024ull;
-	core::vector<Page_t> decompressed(CHUNK/sizeof(Page_t));
-	for (uint32_t i=0; i<ctx.meshCount; i++)
+	// the offsets of every mesh are known upfront, so the meshes can be inflated and parsed independently
+	core::vector<SParsedMesh> parsed(ctx.meshCount);
 	{
-		auto localSize = ctx.meshOffsets->operator[](i+ctx.meshCount);
-		ctx.file->seek(sizeof(FileHeader)+ctx.meshOffsets->operator[](i));
-		ctx.file->read(data,localSize);
-		// decompress
-		size_t decompressSize;
+		std::mutex fileMutex;
+		// nests fine inside the concurrent prefetch of the Mitsuba loader, waiting tasks run other tasks instead of starting threads
+		core::CTaskScheduler::getGlobal().parallelFor(0u,ctx.meshCount,0u,[&](uint32_t firstMesh, uint32_t lastMesh) -> void
 		{
-			// Setup the inflate stream.
-			z_stream stream;
-			stream.next_in = (Bytef*)data;
-			stream.avail_in = (uInt)localSize;
-			stream.total_in = 0;
-			stream.next_out = (Bytef*)decompressed.data();
-			stream.avail_out = CHUNK;
-			stream.total_out = 0u;
-			stream.zalloc = (alloc_func)0;
-			stream.zfree = (free_func)0;
-
-			int32_t err = inflateInit(&stream, -MAX_WBITS);
-			if (err == Z_OK)
+			uint8_t* data = nullptr;
+			size_t dataCapacity = 0u;
+			core::vector<Page_t> decompressed;
+			for (uint32_t i=firstMesh; i<lastMesh; i++)
 			{
-				while (err == Z_OK && err != Z_STREAM_END)
+				auto& result = parsed[i];
+				const auto localSize = ctx.meshOffsets->operator[](i+ctx.meshCount);
+				if (localSize>dataCapacity)
 				{
-					err = inflate(&stream, Z_SYNC_FLUSH);
-					if (err!=Z_OK || err==Z_STREAM_END || stream.avail_out)
-						continue;
-
-					if (stream.total_out+CHUNK>decompressed.size()*sizeof(Page_t))
-						decompressed.resize(decompressed.size()+CHUNK/sizeof(Page_t));
-					stream.next_out = reinterpret_cast<Bytef*>(decompressed.data())+stream.total_out;
-					stream.avail_out = CHUNK;
+					if (data)
+						_IRR_ALIGNED_FREE(data);
+					dataCapacity = localSize;
+					data = reinterpret_cast<uint8_t*>(_IRR_ALIGNED_MALLOC(dataCapacity,alignof(double)));
+				}
+				// IReadFile is not thread-safe, only the inflate and parse can run concurrently
+				{
+					std::lock_guard<std::mutex> lock(fileMutex);
+					ctx.file->seek(sizeof(FileHeader)+ctx.meshOffsets->operator[](i));
+					ctx.file->read(data,localSize);
 				}
-			}
-			decompressSize = stream.total_out;
-			int32_t err2 = inflateEnd(&stream);
 
-			if (err == Z_OK || err == Z_STREAM_END)
-				err = err2;
-			if (err != Z_OK)
-			{
-				std::wstring msg(L"Error decompressing mesh ix ");
-				msg += std::to_wstring(i);
-				os::Printer::log(msg, ELL_ERROR);
-				continue;
+				size_t decompressSize;
+				if (!inflateMesh(decompressed,decompressSize,data,localSize))
+				{
+					result.error = "Error decompressing mesh ix ";
+					continue;
+				}
+				if (!parseMesh(result,reinterpret_cast<uint8_t*>(decompressed.data()),decompressSize))
+				{
+					result.buffer = nullptr;
+					result.error = "Invalid or truncated data in mesh ix ";
+				}
 			}
-		}
-		// too small to hold anything
-		if (decompressSize < sizeof(uint8_t)+sizeof(uint64_t)*2ull)
-			continue;
-
-		// some tracking
-		uint8_t* ptr = reinterpret_cast<uint8_t*>(decompressed.data());
-		uint8_t* streamEnd = ptr+decompressSize;
-		// vertex size determination
-		auto flags = *(reinterpret_cast<uint32_t*&>(ptr)++);
-		size_t typeSize;
-		size_t vertexAttributeCount = 3u;
-		size_t vertexSize;
-		{
-			if (flags & MF_SINGLE_FLOAT)
-				typeSize = sizeof(float);
-			else if (flags & MF_DOUBLE_FLOAT)
-				typeSize = sizeof(double);
-			else
-				continue;
+			if (data)
+				_IRR_ALIGNED_FREE(data);
+		});
+	}
 
-			if ((flags & MF_PER_VERTEX_NORMALS) || (flags & MF_FACE_NORMALS))
-				vertexAttributeCount += 3ull;
-			if (flags & MF_TEXTURE_COORDINATES)
-				vertexAttributeCount += 2ull;
-			if (flags & MF_VERTEX_COLORS)
-				vertexAttributeCount += 3ull;
 
-			vertexSize = vertexAttributeCount*typeSize;
-		}
-
-		// get name
-		char* stringPtr = reinterpret_cast<char*>(ptr);
-		while (ptr < streamEnd)
-		if (! *(ptr++))
-				break;
-		// name too long
-		size_t stringLen = reinterpret_cast<char*>(ptr)-stringPtr;
-		if (ptr+sizeof(uint64_t)*2ull > streamEnd)
-			continue;
+	core::vector<core::smart_refctd_ptr<asset::CCPUMesh> > meshes;
+	meshes.reserve(ctx.meshCount);
 
-		// 
-		uint64_t vertexCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
-		if (vertexCount<3ull || vertexCount>0xFFFFFFFFull)
-			continue;
-		uint64_t triangleCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
-		if (triangleCount<1ull)
-			continue;
-		size_t vertexDataSize = vertexCount*vertexSize;
-		if (ptr+vertexDataSize > streamEnd)
+	// identical shapes (common with instanced geometry exported from DCC tools) end up sharing the same buffer, whoever mutates one has to copy it first
+	core::unordered_multimap<uint64_t,uint32_t> uniqueBuffers;
+	for (uint32_t i=0; i<ctx.meshCount; i++)
+	{
+		auto& result = parsed[i];
+		if (result.error)
+		{
+			std::string msg(result.error);
+			msg += std::to_string(i);
+			os::Printer::log(msg, ctx.file->getFileName().c_str(), ELL_ERROR);
 			continue;
-		size_t indexDataSize = sizeof(uint32_t)*3ull*triangleCount;
-		size_t totalDataSize = vertexDataSize+indexDataSize;
-		if (ptr+totalDataSize > streamEnd)
+		}
+		if (!result.buffer)
 			continue;
 
-		auto buf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(totalDataSize);
-		void* outPtr = buf->getPointer();
-		auto readAttributes = [&](auto* outPtr, size_t attrOffset, auto* &inPtr, size_t attrCount) -> void
+		bool duplicate = false;
+		auto range = uniqueBuffers.equal_range(result.hash[0]);
+		for (auto it=range.first; it!=range.second && !duplicate; it++)
 		{
-			for (uint64_t j=0ull; j<vertexCount; j++)
-			for (uint64_t k=0ull; k<attrCount; k++)
-				outPtr[j*vertexAttributeCount+attrOffset+k] = *(inPtr++);
-		};
+			const auto& other = parsed[it->second];
+			if (other.flags!=result.flags || other.vertexCount!=result.vertexCount || other.triangleCount!=result.triangleCount)
+				continue;
+			if (memcmp(other.hash,result.hash,sizeof(result.hash)) || other.buffer->getSize()!=result.buffer->getSize())
+				continue;
+			if (memcmp(other.buffer->getPointer(),result.buffer->getPointer(),result.buffer->getSize()))
+				continue;
+			result.buffer = core::smart_refctd_ptr(other.buffer);
+			duplicate = true;
+		}
+		if (!duplicate)
+			uniqueBuffers.emplace(result.hash[0],i);
 
+		const uint32_t flags = result.flags;
 		auto desc = core::make_smart_refctd_ptr<asset::ICPUMeshDataFormatDesc>();
-		size_t attrOffset = 0ull;
-		auto readAttributeDispatch = [&](asset::E_VERTEX_ATTRIBUTE_ID attrId, size_t attrCount, bool read = true) -> void
+		size_t offset = 0ull;
+		auto setAttribute = [&](asset::E_VERTEX_ATTRIBUTE_ID attrId, size_t attrCount) -> void
 		{
-			asset::E_FORMAT format = asset::EF_UNKNOWN;
-			switch (attrCount)
-			{
-				case 2ull:
-					format = typeSize==sizeof(double) ? asset::EF_R64G64_SFLOAT:asset::EF_R32G32_SFLOAT;
-					break;
-				case 3ull:
-					format = typeSize==sizeof(double) ? asset::EF_R64G64B64_SFLOAT:asset::EF_R32G32B32_SFLOAT;
-					break;
-				default:
-					assert(false);
-					break;
-			}
-			desc->setVertexAttrBuffer(core::smart_refctd_ptr(buf), attrId, format, vertexSize, attrOffset*typeSize);
-			if (read)
-			{
-				if (flags & MF_SINGLE_FLOAT)
-					readAttributes(reinterpret_cast<float*>(outPtr), attrOffset, reinterpret_cast<float*&>(ptr), attrCount);
-				else if (flags & MF_DOUBLE_FLOAT)
-					readAttributes(reinterpret_cast<double*>(outPtr), attrOffset, reinterpret_cast<double*&>(ptr), attrCount);
-			}
-			attrOffset += attrCount;
+			const asset::E_FORMAT format = attrCount==2ull ? asset::EF_R32G32_SFLOAT:asset::EF_R32G32B32_SFLOAT;
+			desc->setVertexAttrBuffer(core::smart_refctd_ptr(result.buffer), attrId, format, attrCount*sizeof(float), offset);
+			offset += attrCount*sizeof(float)*result.vertexCount;
 		};
-
 		// pos
-		readAttributeDispatch(asset::EVAI_ATTR0, 3ull);
+		setAttribute(asset::EVAI_ATTR0, 3ull);
 		// normal
 		if ((flags & MF_PER_VERTEX_NORMALS) || (flags & MF_FACE_NORMALS))
-			readAttributeDispatch(asset::EVAI_ATTR3, 3ull, flags&MF_PER_VERTEX_NORMALS); // TODO: normal quantization and optimization
-		if (flags & MF_TEXTURE_COORDINATES) // TODO: UV quantization and optimization
-			readAttributeDispatch(asset::EVAI_ATTR2, 2ull);
-		if (flags & MF_VERTEX_COLORS) // TODO: quantize to 32bit format like RGB9E5
-			readAttributeDispatch(asset::EVAI_ATTR1, 3ull);
+			setAttribute(asset::EVAI_ATTR3, 3ull);
+		if (flags & MF_TEXTURE_COORDINATES)
+			setAttribute(asset::EVAI_ATTR2, 2ull);
+		if (flags & MF_VERTEX_COLORS)
+			setAttribute(asset::EVAI_ATTR1, 3ull);
 
 		// create mesh buffer
-		desc->setIndexBuffer(std::move(buf));
+		desc->setIndexBuffer(core::smart_refctd_ptr(result.buffer));
 		auto mb = core::make_smart_refctd_ptr<asset::ICPUMeshBuffer>();
 		mb->setMeshDataAndFormat(std::move(desc));
-		mb->setIndexBufferOffset(vertexDataSize);
-        mb->setIndexCount(triangleCount*3u);
+		mb->setIndexBufferOffset(offset);
+        mb->setIndexCount(result.triangleCount*3u);
         mb->setIndexType(asset::EIT_32BIT);
         mb->setPrimitiveType(asset::EPT_TRIANGLES);
-
-		// read indices and possibly create per-face normals
-		auto readIndices = [&]() -> bool
-		{
-			uint32_t* indexPtr = reinterpret_cast<uint32_t*>(outPtr)+vertexDataSize/sizeof(uint32_t);
-			for (uint64_t j=0ull; j<triangleCount; j++)
-			{
-				uint32_t* triangleIndices = indexPtr;
-				for (uint64_t k=0ull; k<3ull; k++)
-				{
-					triangleIndices[k] = *(reinterpret_cast<uint32_t*&>(ptr)++);
-					if (triangleIndices[k] >= static_cast<uint32_t>(vertexCount))
-						return false;
-				}
-				indexPtr += 3u;
-
-				if (flags & MF_FACE_NORMALS)
-				{
-					core::vectorSIMDf pos[3];
-					for (uint64_t k=0ull; k<3ull; k++)
-						pos[k] = mb->getPosition(triangleIndices[k]);
-					auto normal = core::cross(pos[1]-pos[0],pos[2]-pos[0]);
-					for (uint64_t k=0ull; k<3ull; k++)
-						mb->setAttribute(normal,asset::EVAI_ATTR3,k);
-				}
-			}
-			return true;
-		};
-		if (!readIndices())
-			continue;
-		mb->recalculateBoundingBox();
+		mb->setBoundingBox(result.bbox);
 
 		// create mesh
 		auto mesh = core::make_smart_refctd_ptr<asset::CCPUMesh>();
 		mesh->addMeshBuffer(std::move(mb));
 		mesh->recalculateBoundingBox();
 
-		manager->setAssetMetadata(mesh.get(), core::make_smart_refctd_ptr<CSerializedMetadata>(std::string(stringPtr,stringLen),i) );
+		manager->setAssetMetadata(mesh.get(), core::make_smart_refctd_ptr<CSerializedMetadata>(std::move(result.name),i) );
 		meshes.push_back(std::move(mesh));
 	}
-	_IRR_ALIGNED_FREE(data);
 
 	return meshes;
 }
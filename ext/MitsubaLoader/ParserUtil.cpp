@@ -56,13 +56,29 @@ bool ParserManager::parse(io::IReadFile* _file)
 	XML_SetUserData(parser, &ctx);
 
 
-	char* buff = (char*)_IRR_ALIGNED_MALLOC(_file->getSize(), 4096u);
-
+	// stream the file through expat's own buffer, so huge scenes never need a second full copy in memory
+	constexpr int ChunkSize = 0x1u<<16u;
+	const size_t fileSize = _file->getSize();
 	_file->seek(0u);
-	_file->read((void*)buff, _file->getSize());
+	XML_Status parseStatus = XML_STATUS_OK;
+	for (size_t offset=0u; parseStatus==XML_STATUS_OK;)
+	{
+		void* buff = XML_GetBuffer(parser, ChunkSize);
+		if (!buff)
+		{
+			parseStatus = XML_STATUS_ERROR;
+			break;
+		}
 
-	XML_Status parseStatus = XML_Parse(parser, buff, _file->getSize(), 0);
-	_IRR_ALIGNED_FREE(buff);
+		const int32_t bytesRead = _file->read(buff, static_cast<uint32_t>(core::min<size_t>(ChunkSize,fileSize-offset)));
+		offset += core::max(bytesRead,0);
+		const bool isFinal = bytesRead<=0 || offset>=fileSize;
+		parseStatus = XML_ParseBuffer(parser, core::max(bytesRead,0), isFinal);
+		if (isFinal)
+			break;
+	}
+	if (parseStatus==XML_STATUS_ERROR)
+		os::Printer::log(XML_ErrorString(XML_GetErrorCode(parser)), _file->getFileName().c_str(), ELL_ERROR);
 	XML_ParserFree(parser);
 	switch (parseStatus)
 	{
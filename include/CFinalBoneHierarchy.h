@@ -33,12 +33,49 @@ namespace asset
                 float Scale[3];
                 float Padding[2];
             } PACK_STRUCT;
+            //! Header of the optional compressed animation storage, which is a single allocation with no pointers in it (ready to be serialized)
+            struct CompressedAnimationsHeader
+            {
+                uint64_t byteSize; //! of the whole storage, including this header
+                uint32_t boneCount;
+                uint32_t keyframeCount;
+            } PACK_STRUCT;
+            //! One track of a bone, `keyCount` sorted global keyframe indices (starting with 0) at `dataOffset` followed by the quantized values of the kept keys
+            struct CompressedChannel
+            {
+                uint32_t keyCount;
+                uint32_t dataOffset;
+                //! bytes per kept value, `CompressedValueSize` or `RawValueSize` if the track's range is too wide to quantize within the error bounds
+                uint32_t valueSize;
+                float base[3];
+                float step[3];
+            } PACK_STRUCT;
             #include "irr/irrunpack.h"
 
+            enum E_COMPRESSED_CHANNEL
+            {
+                ECC_ROTATION = 0,
+                ECC_POSITION,
+                ECC_SCALE,
+                ECC_COUNT
+            };
+            //! every quantized key is 3 uint16_t, positions and scales are stored relative to the range of their track, rotations as the smallest three components
+            _IRR_STATIC_INLINE_CONSTEXPR size_t CompressedValueSize = 6u;
+            //! unquantized keys are 4 floats, the last one unused by positions and scales
+            _IRR_STATIC_INLINE_CONSTEXPR size_t RawValueSize = 16u;
+
+            struct SAnimationCompressionParams
+            {
+                //! largest allowed difference of any quaternion component, a bit more than radians/2 for small angles
+                float maxRotationError = 0.0005f;
+                float maxPositionError = 0.0005f;
+                float maxScaleError = 0.0005f;
+            };
+
 
             CFinalBoneHierarchy(const core::vector<asset::ICPUSkinnedMesh::SJoint*>& inLevelFixedJoints, const core::vector<size_t>& inJointsLevelEnd)
                     : boneCount(inLevelFixedJoints.size()), NumLevelsInHierarchy(inJointsLevelEnd.size()),
-                    keyframeCount(0), keyframes(NULL), interpolatedAnimations(NULL), nonInterpolatedAnimations(NULL), flipXonOutput(false)
+                    keyframeCount(0), keyframes(NULL), interpolatedAnimations(NULL), nonInterpolatedAnimations(NULL), compressedAnimations(NULL), flipXonOutput(false)
             {
                 boneFlatArray = (BoneReferenceData*)malloc(sizeof(BoneReferenceData)*boneCount);
                 boneNames = _IRR_NEW_ARRAY(core::stringc,boneCount);
@@ -82,9 +119,12 @@ namespace asset
 				const std::size_t* _levelsBegin, const std::size_t* _levelsEnd,
 				const float* _keyframesBegin, const float* _keyframesEnd,
 				const void* _interpAnimsBegin, const void* _interpAnimsEnd,
-				const void* _nonInterpAnimsBegin, const void* _nonInterpAnimsEnd, bool _flipXonOutput)
-			: boneCount((BoneReferenceData*)_bonesEnd - (BoneReferenceData*)_bonesBegin), NumLevelsInHierarchy(_levelsEnd - _levelsBegin), keyframeCount(_keyframesEnd - _keyframesBegin), flipXonOutput(_flipXonOutput)
+				const void* _nonInterpAnimsBegin, const void* _nonInterpAnimsEnd, bool _flipXonOutput,
+				const void* _compressedAnimsBegin = nullptr, const void* _compressedAnimsEnd = nullptr)
+			: boneCount((BoneReferenceData*)_bonesEnd - (BoneReferenceData*)_bonesBegin), NumLevelsInHierarchy(_levelsEnd - _levelsBegin), keyframeCount(_keyframesEnd - _keyframesBegin),
+				interpolatedAnimations(NULL), nonInterpolatedAnimations(NULL), compressedAnimations(NULL), flipXonOutput(_flipXonOutput)
 			{
+				const bool compressed = _compressedAnimsBegin!=_compressedAnimsEnd;
 				_IRR_DEBUG_BREAK_IF(_bonesBegin > _bonesEnd ||
 					_boneNamesBegin > _boneNamesEnd ||
 					_levelsBegin > _levelsEnd ||
@@ -93,23 +133,33 @@ namespace asset
 					_nonInterpAnimsBegin > _nonInterpAnimsEnd
 				)
 				_IRR_DEBUG_BREAK_IF(_boneNamesEnd - _boneNamesBegin != static_cast<std::make_signed<decltype(boneCount)>::type>(boneCount))
-				_IRR_DEBUG_BREAK_IF((AnimationKeyData*)_interpAnimsEnd - (AnimationKeyData*)_interpAnimsBegin != static_cast<std::make_signed<decltype(boneCount)>::type>(getAnimationCount()))
-				_IRR_DEBUG_BREAK_IF((AnimationKeyData*)_nonInterpAnimsEnd - (AnimationKeyData*)_nonInterpAnimsBegin != static_cast<std::make_signed<decltype(boneCount)>::type>(getAnimationCount()))
+				_IRR_DEBUG_BREAK_IF((AnimationKeyData*)_interpAnimsEnd - (AnimationKeyData*)_interpAnimsBegin != static_cast<std::make_signed<decltype(boneCount)>::type>(compressed ? 0u:getAnimationCount()))
+				_IRR_DEBUG_BREAK_IF((AnimationKeyData*)_nonInterpAnimsEnd - (AnimationKeyData*)_nonInterpAnimsBegin != static_cast<std::make_signed<decltype(boneCount)>::type>(compressed ? 0u:getAnimationCount()))
+				_IRR_DEBUG_BREAK_IF(compressed && reinterpret_cast<const CompressedAnimationsHeader*>(_compressedAnimsBegin)->byteSize != static_cast<uint64_t>((const uint8_t*)_compressedAnimsEnd-(const uint8_t*)_compressedAnimsBegin))
 
 				boneNames = _IRR_NEW_ARRAY(core::stringc,boneCount);
 				boneFlatArray = (BoneReferenceData*)malloc(sizeof(BoneReferenceData)*boneCount);
 				boneTreeLevelEnd = (size_t*)malloc(sizeof(size_t)*NumLevelsInHierarchy);
 				keyframes = (float*)malloc(sizeof(float)*keyframeCount);
-				interpolatedAnimations = (AnimationKeyData*)malloc(sizeof(AnimationKeyData)*getAnimationCount());
-				nonInterpolatedAnimations = (AnimationKeyData*)malloc(sizeof(AnimationKeyData)*getAnimationCount());
+				if (compressed)
+				{
+					const size_t compressedSize = (const uint8_t*)_compressedAnimsEnd-(const uint8_t*)_compressedAnimsBegin;
+					compressedAnimations = (uint8_t*)_IRR_ALIGNED_MALLOC(compressedSize,_IRR_SIMD_ALIGNMENT);
+					memcpy(compressedAnimations, _compressedAnimsBegin, compressedSize);
+				}
+				else
+				{
+					interpolatedAnimations = (AnimationKeyData*)malloc(sizeof(AnimationKeyData)*getAnimationCount());
+					nonInterpolatedAnimations = (AnimationKeyData*)malloc(sizeof(AnimationKeyData)*getAnimationCount());
+					memcpy(interpolatedAnimations, _interpAnimsBegin, sizeof(AnimationKeyData)*getAnimationCount());
+					memcpy(nonInterpolatedAnimations, _nonInterpAnimsBegin, sizeof(AnimationKeyData)*getAnimationCount());
+				}
 
 				for (size_t i = 0; i < boneCount; ++i)
 					boneNames[i] = _boneNamesBegin[i];
 				memcpy(boneFlatArray, _bonesBegin, sizeof(BoneReferenceData)*boneCount);
 				memcpy(boneTreeLevelEnd, _levelsBegin, sizeof(size_t)*NumLevelsInHierarchy);
 				memcpy(keyframes, _keyframesBegin, sizeof(float)*keyframeCount);
-				memcpy(interpolatedAnimations, _interpAnimsBegin, sizeof(AnimationKeyData)*getAnimationCount());
-				memcpy(nonInterpolatedAnimations, _nonInterpAnimsBegin, sizeof(AnimationKeyData)*getAnimationCount());
 			}
 
 			virtual void* serializeToBlob(void* _stackPtr = NULL, const size_t& _stackSize = 0) const
@@ -224,9 +274,65 @@ namespace asset
                 return getLowerBoundBoneKeyframes(tmpDummy,frame);
             }
 
-            inline const AnimationKeyData* getInterpolatedAnimationData(const size_t& boneID=0) const {return interpolatedAnimations+keyframeCount*boneID;}
+            //! Same as above, but starts looking at `cursor` (the index returned for the previous frame of the same playback) and updates it
+            /** Playback rarely moves by more than a keyframe between calls, so a few linear steps from the cursor replace the binary search,
+            anything further away (seeking, looping back) still falls back to it. */
+            inline size_t getLowerBoundBoneKeyframes(float& interpolationFactor, const float& frame, uint32_t& cursor) const
+            {
+                const uint32_t maxCursorSteps = 4u;
+
+                const float* const keyframesEnd = keyframes+keyframeCount;
+                const float* found = keyframes+core::min<size_t>(cursor,keyframeCount);
+                uint32_t steps = 0u;
+                for (; steps<maxCursorSteps&&found!=keyframesEnd&&*found<frame; steps++)
+                    found++;
+                for (; steps<maxCursorSteps&&found!=keyframes&&!(*(found-1)<frame); steps++)
+                    found--;
+                // lower bound means every key before is less than `frame` and the found one isn't
+                if ((found!=keyframes&&!(*(found-1)<frame)) || (found!=keyframesEnd&&*found<frame))
+                    found = std::lower_bound<const float*>(keyframes,keyframesEnd,frame);
+
+                cursor = found-keyframes;
+                return getLowerBoundBoneKeyframes(interpolationFactor, frame, found);
+            }
+
+            //! Both return nullptr while the animations are compressed, use `getAnimationKey` to read keys regardless of the storage
+            inline const AnimationKeyData* getInterpolatedAnimationData(const size_t& boneID=0) const {return interpolatedAnimations ? (interpolatedAnimations+keyframeCount*boneID):nullptr;}
+
+            inline const AnimationKeyData* getNonInterpolatedAnimationData(const size_t& boneID=0) const {return nonInterpolatedAnimations ? (nonInterpolatedAnimations+keyframeCount*boneID):nullptr;}
+
+            inline AnimationKeyData getAnimationKey(const size_t& boneID, const size_t& keyIx, const bool& interpolated) const
+            {
+                if (!compressedAnimations)
+                    return (interpolated ? interpolatedAnimations:nonInterpolatedAnimations)[keyframeCount*boneID+keyIx];
+
+                const CompressedChannel* channels = getCompressedChannels(boneID,interpolated);
+                const core::vectorSIMDf rotation = sampleCompressedChannel(channels[ECC_ROTATION],keyIx,interpolated,true);
+                const core::vectorSIMDf position = sampleCompressedChannel(channels[ECC_POSITION],keyIx,interpolated,false);
+                const core::vectorSIMDf scale = sampleCompressedChannel(channels[ECC_SCALE],keyIx,interpolated,false);
+
+                AnimationKeyData retval;
+                memcpy(retval.Rotation,rotation.pointer,sizeof(retval.Rotation));
+                memcpy(retval.Position,position.pointer,sizeof(retval.Position));
+                memcpy(retval.Scale,scale.pointer,sizeof(retval.Scale));
+                retval.Padding[0] = retval.Padding[1] = 0.f;
+                return retval;
+            }
+
+            //! Replaces the per bone per keyframe arrays with a much smaller representation
+            /** Keyframes which every track (rotation, position and scale of a bone) can reconstruct by interpolating its neighbours
+            within the error bounds are dropped, rotations are quantized to the smallest three components and positions and scales
+            to 16 bits over the range of their track, the quantized values are accounted for when dropping keys.
+            Tracks whose kept keys can't be quantized within the error bounds keep them as floats.
+            `getAnimationKey` keeps working, modifying the animation decompresses it first. */
+            void compressAnimations(const SAnimationCompressionParams& _params);
+            inline void compressAnimations() { compressAnimations(SAnimationCompressionParams()); }
+            //! Restores the per bone per keyframe arrays (with the compression error)
+            void decompressAnimations();
 
-            inline const AnimationKeyData* getNonInterpolatedAnimationData(const size_t& boneID=0) const {return nonInterpolatedAnimations+keyframeCount*boneID;}
+            inline bool hasCompressedAnimations() const { return compressedAnimations!=nullptr; }
+            inline const uint8_t* getCompressedAnimationData() const { return compressedAnimations; }
+            inline size_t getCompressedAnimationDataSize() const { return compressedAnimations ? reinterpret_cast<const CompressedAnimationsHeader*>(compressedAnimations)->byteSize:0u; }
 
 
             //interpolant of 1 means full B
@@ -272,9 +378,19 @@ namespace asset
                 return getMatrixFromKeys(keyframe,keyframe,1.f,0.25f,0.f);
             }
 
+            //! Local transforms of the bones `[firstBone,firstBone+count)` at the keyframe pair found by `getLowerBoundBoneKeyframes`
+            /** Computes the same as `getMatrixFromKeys` (or `getMatrixFromKey` when not interpolating) for every bone, but transposes
+            the keys of 4 bones at a time so that each SIMD lane holds one bone, the approximate slerp, normalization and the
+            scale-rotation-translation matrix then take a handful of instructions for all 4. */
+            void getLocalMatrices(core::matrix3x4SIMD* outMatrices, const size_t& firstBone, const size_t& count,
+                                  const size_t& keyIx, const float& interpolationFactor, const bool& interpolated) const;
+
             //effectively downsamples our animation
             inline void deleteKeyframes(const size_t& keyframesToRemoveCount, const float* sortedKeyFramesToRemove)
             {
+                if (compressedAnimations)
+                    decompressAnimations();
+
                 const float* keyframesIn = keyframes;
                 const float* const keyframesEnd = keyframes+keyframeCount;
                 const AnimationKeyData* inAnimationsIn = interpolatedAnimations;
@@ -337,6 +453,9 @@ namespace asset
             //effectively upsamples our animation
             inline void insertKeyframes(const size_t& keyframesToAddCount, const float* sortedKeyFramesToAdd)
             {
+                if (compressedAnimations)
+                    decompressAnimations();
+
                 const float* keyframesIn = keyframes;
                 const float* const keyframesEnd = keyframes+keyframeCount;
                 const AnimationKeyData* inAnimationsIn = interpolatedAnimations;
@@ -427,6 +546,9 @@ namespace asset
             inline void transformAnimation(const float& rangeStart, const float& rangeEnd, AnimationKeyframeTransformFunc transformFunc,
                                            const size_t& keyframesToAddCount=0, const float* keyFramesToAdd=NULL)
             {
+                if (compressedAnimations)
+                    decompressAnimations();
+
                 //add keyframes if needed
                 if (keyframesToAddCount)
                     insertKeyframes(keyframesToAddCount,keyFramesToAdd);
@@ -463,6 +585,8 @@ namespace asset
 					free(interpolatedAnimations);
 				if (nonInterpolatedAnimations)
 					free(nonInterpolatedAnimations);
+				if (compressedAnimations)
+					_IRR_ALIGNED_FREE(compressedAnimations);
 			}
 
 			friend class TypedBlob<FinalBoneHierarchyBlobV3, CFinalBoneHierarchy>;
@@ -472,6 +596,69 @@ namespace asset
 			}
 
         private:
+            inline const CompressedChannel* getCompressedChannels(const size_t& boneID, const bool& interpolated) const
+            {
+                return reinterpret_cast<const CompressedChannel*>(compressedAnimations+sizeof(CompressedAnimationsHeader))+(boneID*2u+(interpolated ? 0u:1u))*ECC_COUNT;
+            }
+
+            //! the quantized values are read 8 bytes at a time, so the storage is padded
+            static inline __m128i loadCompressedValue(const uint8_t* value)
+            {
+                return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(value)),_mm_setzero_si128());
+            }
+            static inline core::vectorSIMDf dequantizeVector(const uint8_t* value, const CompressedChannel& channel)
+            {
+                const core::vectorSIMDf base(channel.base[0],channel.base[1],channel.base[2]);
+                const core::vectorSIMDf step(channel.step[0],channel.step[1],channel.step[2]);
+                return core::vectorSIMDf(_mm_cvtepi32_ps(loadCompressedValue(value)))*step+base;
+            }
+            static inline core::vectorSIMDf dequantizeRotation(const uint8_t* value)
+            {
+                const __m128i quantized = loadCompressedValue(value);
+                // top bits of the first two components hold which one is the largest
+                const uint32_t largestIx = (value[1]>>7u)|((value[3]>>7u)<<1u);
+                core::vectorSIMDf smallest = core::vectorSIMDf(_mm_cvtepi32_ps(_mm_and_si128(quantized,_mm_set1_epi32(0x7fff))))*core::vectorSIMDf(core::sqrt(2.f)/32767.f)-core::vectorSIMDf(core::sqrt(0.5f));
+                smallest.w = 0.f;
+                const float largest = core::sqrt(core::max(1.f-core::dot(smallest,smallest).x,0.f));
+
+                core::vectorSIMDf retval;
+                for (uint32_t i=0u,j=0u; i<4u; i++)
+                    retval.pointer[i] = i!=largestIx ? smallest.pointer[j++]:largest;
+                return retval;
+            }
+            static inline core::vectorSIMDf decodeCompressedValue(const uint8_t* values, const size_t& ix, const CompressedChannel& channel, const bool& rotation)
+            {
+                const uint8_t* value = values+ix*channel.valueSize;
+                if (channel.valueSize==RawValueSize)
+                    return core::vectorSIMDf(reinterpret_cast<const float*>(value));
+                return rotation ? dequantizeRotation(value):dequantizeVector(value,channel);
+            }
+            static inline core::vectorSIMDf interpolateCompressed(const core::vectorSIMDf& a, core::vectorSIMDf b, const float& interpolant, const bool& rotation)
+            {
+                if (!rotation)
+                    return (b-a)*interpolant+a;
+
+                if (core::dot(a,b).x<0.f)
+                    b = -b;
+                return core::normalize((b-a)*interpolant+a);
+            }
+            inline core::vectorSIMDf sampleCompressedChannel(const CompressedChannel& channel, const size_t& keyIx, const bool& interpolated, const bool& rotation) const
+            {
+                const uint32_t* indices = reinterpret_cast<const uint32_t*>(compressedAnimations+channel.dataOffset);
+                const uint8_t* values = reinterpret_cast<const uint8_t*>(indices+channel.keyCount);
+                const uint32_t* found = std::upper_bound(indices,indices+channel.keyCount,static_cast<uint32_t>(keyIx));
+                const size_t lowerIx = (found-indices)-1u; // first kept key is always 0
+
+                auto decode = [&](const size_t& ix) {return decodeCompressedValue(values,ix,channel,rotation);};
+                const core::vectorSIMDf lower = decode(lowerIx);
+                // non interpolated animations hold the value of the last key
+                if (!interpolated || indices[lowerIx]==keyIx || found==indices+channel.keyCount)
+                    return lower;
+
+                const float interpolant = (keyframes[keyIx]-keyframes[indices[lowerIx]])/(keyframes[*found]-keyframes[indices[lowerIx]]);
+                return interpolateCompressed(lower,decode(lowerIx+1u),interpolant,rotation);
+            }
+
             inline void createAnimationKeys(const core::vector<asset::ICPUSkinnedMesh::SJoint*>& inLevelFixedJoints)
             {
                 core::unordered_set<float> sortedFrames;
@@ -700,6 +887,7 @@ namespace asset
             float* keyframes;
             AnimationKeyData* interpolatedAnimations;
             AnimationKeyData* nonInterpolatedAnimations;
+            uint8_t* compressedAnimations;
     };
 
 } // end namespace asset
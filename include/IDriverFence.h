@@ -132,6 +132,8 @@ class GPUEventWrapper : public core::Uncopyable
 
 template<class Functor>
 using GPUEventDeferredHandlerST = core::EventDeferredHandlerST<GPUEventWrapper,Functor>;
+template<class Functor>
+using GPUEventTimelineDeferredHandlerST = core::EventDeferredHandlerTimelineST<GPUEventWrapper,Functor>;
 
 } // end namespace scene
 } // end namespace irr
@@ -55,6 +55,13 @@ public:
 	or 0 on failure. */
 	virtual IReadFile* createAndOpenFile(const path& filename) =0;
 
+	//! Opens a file from an entry of this archive's file list
+	/** Same as createAndOpenFile() but skips looking the file up by name.
+	\param entry An entry of getFileList() which is not a directory.
+	\return Returns A pointer to the created file on success,
+	or 0 on failure. */
+	virtual IReadFile* createAndOpenListedFile(const SFileListEntry& entry) { return createAndOpenFile(entry.FullName); }
+
 	//! Returns the complete file tree
 	/** \return Returns the complete directory tree for the archive,
 	including all files and folders */
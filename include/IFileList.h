@@ -74,6 +74,9 @@ public:
 	//!
 	virtual core::vector<SFileListEntry> getFiles() const = 0;
 
+	//! The entries without copying them, they stay at the same address for as long as the list doesn't change
+	virtual const core::vector<SFileListEntry>& getFilesReference() const = 0;
+
     //! If @retval not equal to @param _end then file was found and return value is a valid pointer in the range given
 	virtual ListCIterator findFile(ListCIterator _begin, ListCIterator _end, const io::path& filename, bool isDirectory = false) const = 0;
 
@@ -38,6 +38,16 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IReadFile* createAndOpenFile(const path& filename) =0;
 
+	//! Opens a file for read access by mapping all of it into memory.
+	/** The mapping is copy-on-write, so the file never changes. Its contents are available from
+	IReadFile::getMappedPointer(), which lets loaders use them without copying.
+	Files which are inside of archives or can't be mapped get opened like with createAndOpenFile().
+	\param filename: Name of file to open.
+	\return Pointer to the created file interface.
+	The returned pointer should be dropped when no longer needed.
+	See IReferenceCounted::drop() for more information. */
+	virtual IReadFile* createMappedReadFile(const path& filename) =0;
+
 	//! Creates an IReadFile interface for accessing memory like a file.
 	/** This allows you to use a pointer to memory where an IReadFile is requested.
 	\param memory: A pointer to the start of the file in memory
@@ -89,6 +99,15 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IWriteFile* createAndWriteFile(const path& filename, bool append=false) =0;
 
+	//! Sets up how files opened by createAndWriteFile buffer their writes.
+	/** Writes are gathered in a buffer covering a window of the file, seeking around inside of it
+	costs nothing. Files opened for appending are always written through.
+	\param bufferSize: Bytes gathered before they are handed to the OS, 0 disables buffering.
+	The default is 1MB.
+	\param writeBehind: If true, every file gets a background thread which writes a full buffer
+	while the next one fills up. Off by default. */
+	virtual void setWriteBuffering(uint32_t bufferSize, bool writeBehind=false) =0;
+
 	//! Adds an archive to the file system.
 	/** After calling this, the Irrlicht Engine will also search and open
 	files directly from this archive. This is useful for hiding data from
@@ -239,6 +258,15 @@ public:
 	\return True if file exists, and false if it does not exist or an error occured. */
 	virtual bool existFile(const path& filename) const =0;
 
+	//! Finds the archive that createAndOpenFile() would open a file from, without allocating.
+	/** Archives are searched in the order they were added or moved to, like createAndOpenFile() does,
+	the lookup is a single hash of the path no matter how many archives there are.
+	\param filename Path of the file, the same way it is given to createAndOpenFile(), doesn't need to be null terminated.
+	\param length Length of filename in characters.
+	\param outEntry If not null, receives the entry of the file in the archive's file list, valid until archives change.
+	\return The archive with the file, or nullptr if none of them has it. */
+	virtual IFileArchive* findFileInArchives(const char* filename, size_t length, const SFileListEntry** outEntry = nullptr) const =0;
+
 
 
 	//! Get the directory a file is located in.
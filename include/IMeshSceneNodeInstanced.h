@@ -11,6 +11,7 @@
 #include "irr/video/alloc/ResizableBufferingAllocator.h"
 #include "irr/video/CGPUMesh.h"
 #include "ISceneNode.h"
+#include "SViewFrustum.h"
 
 namespace irr
 {
@@ -95,6 +96,20 @@ class IMeshSceneNodeInstanced : public ISceneNode
         virtual void removeInstance(const uint32_t& instanceID) = 0;
 
         virtual void removeInstances(const size_t& instanceCount, const uint32_t* instanceIDs)= 0;
+
+        //! Range of instance slots, `[begin,end)`
+        struct SInstanceSlotRange
+        {
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        //! Slot an instance occupies for as long as it exists, instance culling reports slots
+        virtual uint32_t getInstanceSlot(const uint32_t& instanceID) const = 0;
+
+        //! Appends the ranges of slots whose instances' boxes intersect the world space `frustum`, neighbouring ranges get merged
+        /** Conservative, a range may contain free slots and instances only partially covered by the frustum are included. */
+        virtual void cullInstances(const SViewFrustum& frustum, core::vector<SInstanceSlotRange>& outRanges) const = 0;
 };
 
 } // end namespace scene
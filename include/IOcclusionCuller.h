@@ -0,0 +1,78 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __I_OCCLUSION_CULLER_H_INCLUDED__
+#define __I_OCCLUSION_CULLER_H_INCLUDED__
+
+#include "irr/core/core.h"
+#include "aabbox3d.h"
+#include "matrix4SIMD.h"
+#include "irr/asset/ICPUMeshBuffer.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IDummyTransformationSceneNode;
+
+	//! Software occlusion culler owned by the scene manager
+	/** Occluders are rasterized on the CPU into a small depth buffer every frame, before nodes register for rendering.
+	Any node with `EAC_BOX` or `EAC_FRUSTUM_BOX` culling whose bounding box lies completely behind the occluders is then
+	rejected by `ISceneManager::registerNodeForRendering`. The test is conservative with respect to the occluder geometry,
+	so occluders should be simple meshes lying inside the visible geometry they stand for (walls, terrain, building shells).
+	Everything happens on the CPU, so it works the same with the null driver. */
+	class IOcclusionCuller : public virtual core::IReferenceCounted
+	{
+		public:
+			struct SStatistics
+			{
+				//! triangles which survived near plane clipping and got rasterized last frame
+				uint32_t rasterizedTriangles = 0u;
+				//! bounding boxes tested against the depth buffer since the last rasterization
+				uint32_t testedBoxes = 0u;
+				//! bounding boxes found to be occluded since the last rasterization
+				uint32_t occludedBoxes = 0u;
+			};
+
+			//! Whether the scene manager runs the occlusion pass, disabled by default
+			virtual void setEnabled(bool enabled) = 0;
+			virtual bool isEnabled() const = 0;
+
+			//! Adds an occluder, only the positions of `meshbuffer` are copied
+			/** \param meshbuffer Triangle list or strip geometry, with or without an index buffer.
+			\param node The absolute transformation of this node places the occluder in the world every frame, can be null for world space geometry.
+			Nodes used as occluders are never occlusion culled themselves.
+			\return An id to pass to `removeOccluder`, or 0xffffffffu if the meshbuffer had no usable triangles. */
+			virtual uint32_t addOccluder(const asset::ICPUMeshBuffer* meshbuffer, IDummyTransformationSceneNode* node=nullptr) = 0;
+
+			//!
+			virtual void removeOccluder(uint32_t id) = 0;
+
+			//!
+			virtual void clearOccluders() = 0;
+
+			//!
+			virtual bool isOccluder(const IDummyTransformationSceneNode* node) const = 0;
+
+			//! Renders all occluders as seen through `viewProj` and rebuilds the hierarchical depth, called by the scene manager
+			virtual void rasterize(const core::matrix4SIMD& viewProj) = 0;
+
+			//! Tests a world space box against the depth of the last `rasterize`, returns true only if it is certainly hidden
+			virtual bool isOccluded(const core::aabbox3df& worldBox) = 0;
+
+			//!
+			virtual const SStatistics& getStatistics() const = 0;
+
+			//! Resolution of the depth buffer
+			virtual uint32_t getWidth() const = 0;
+			virtual uint32_t getHeight() const = 0;
+
+			//! Raw depth buffer of the last frame for debug display, stores 1/w so 0 means no occluder
+			virtual const float* getDepthBuffer() const = 0;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -43,6 +43,13 @@ namespace io
 		//! Get name of file.
 		/** \return File name as zero terminated character string. */
 		virtual const io::path& getFileName() const = 0;
+
+		//! Get the whole contents of the file if they already are in memory.
+		/** Files read from memory and mapped files have them, loaders can then use parts of the file
+		in place instead of reading them into memory of their own. The pointer stays valid as long as
+		the file isn't dropped.
+		\return Pointer to the first byte of the file, or nullptr if it isn't in memory. */
+		virtual const void* getMappedPointer() const { return nullptr; }
 	};
 
 } // end namespace io
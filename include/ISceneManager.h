@@ -16,6 +16,7 @@
 #include "irr/video/IGPUSkinnedMesh.h"
 #include "ISkinnedMeshSceneNode.h"
 #include "irr/asset/ICPUMesh.h"
+#include "IOcclusionCuller.h"
 
 namespace irr
 {
@@ -525,6 +526,21 @@ namespace scene
 		\return True if node is not visible in the current scene, else
 		false. */
 		virtual bool isCulled(ISceneNode* node) const =0;
+
+		//! Returns the software occlusion culler, which is disabled until occluders are added and it gets enabled
+		virtual IOcclusionCuller* getOcclusionCuller() = 0;
+
+		//! Counters of what happened to the nodes which tried to register for the solid and transparent passes
+		struct SCullingStatistics
+		{
+			uint32_t testedNodes = 0u;
+			uint32_t frustumCulledNodes = 0u;
+			uint32_t occlusionCulledNodes = 0u;
+			//! nodes which passed culling and ended up in a render list
+			uint32_t submittedNodes = 0u;
+		};
+		//! Statistics of the last (or currently running) drawAll(), reset at its start
+		virtual const SCullingStatistics& getCullingStatistics() const = 0;
 	};
 
 
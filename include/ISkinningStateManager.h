@@ -340,7 +340,7 @@ namespace scene
             class BoneHierarchyInstanceData : public core::AlignedBase<_IRR_SIMD_ALIGNMENT>
             {
                 public:
-                    BoneHierarchyInstanceData() : refCount(0), frame(0.f), lastAnimatedFrame(-1.f), interpolateAnimation(true), attachedNode(NULL)
+                    BoneHierarchyInstanceData() : refCount(0), frame(0.f), lastAnimatedFrame(-1.f), interpolateAnimation(true), keyframeCursor(0u), attachedNode(NULL)
                     {
                     }
 
@@ -354,6 +354,8 @@ namespace scene
                     };
 
                     bool interpolateAnimation;
+                    //! keyframe found for the last boned frame, where the search for the next one starts
+                    uint32_t keyframeCursor;
                     ISkinnedMeshSceneNode* attachedNode; //can be NULL
             };
             inline core::matrix4x3* getGlobalMatrices(BoneHierarchyInstanceData* currentInstance)
@@ -14,6 +14,7 @@
 #include "IDriverFence.h"
 #include "ITransformFeedback.h"
 #include "SExposedVideoData.h"
+#include "SFrameStatistics.h"
 #include "IDriver.h"
 #include "irr/video/CDerivativeMapCreator.h"
 
@@ -443,6 +444,17 @@ namespace video
 		\return Amount of primitives drawn in the last frame. */
 		virtual uint32_t getPrimitiveCountDrawn( uint32_t mode =0 ) const =0;
 
+		//! Returns the counters of the frame currently being recorded, since the last beginScene()
+		virtual const SFrameStatistics& getCurrentFrameStatistics() const =0;
+
+		//! Returns the counters of a finished frame.
+		/** \param framesAgo 0 is the frame finished by the last endScene(), 1 the one before it and so on.
+		\return nullptr if that frame was not finished yet or fell out of the history. */
+		virtual const SFrameStatistics* getFrameStatistics(uint32_t framesAgo=0u) const =0;
+
+		//! Returns how many finished frames the statistics history keeps
+		virtual uint32_t getFrameStatisticsHistoryLength() const =0;
+
 		//! Returns the maximum amount of primitives
 		/** (mostly vertices) which the device is able to render.
 		\return Maximum amount of primitives. */
@@ -0,0 +1,50 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __S_FRAME_STATISTICS_H_INCLUDED__
+#define __S_FRAME_STATISTICS_H_INCLUDED__
+
+#include <cstdint>
+
+namespace irr
+{
+namespace video
+{
+
+	//! Submission counters of a single frame, gathered by the driver between `beginScene` and `endScene`
+	/** All counters are maintained by `CNullDriver`, so headless tests on `EDT_NULL` see the same
+	draw and material numbers as a real driver would; only `vertexInputBinds` needs an API to count. */
+	struct SFrameStatistics
+	{
+		//! how many frames were finished with `endScene` before this one
+		uint64_t frameNumber = 0u;
+		//! wall clock time from `beginScene` to `endScene`, includes whatever the application did in between
+		uint64_t cpuTimeNs = 0u;
+
+		//! `drawMeshBuffer` calls which drew something
+		uint32_t drawCalls = 0u;
+		//! `drawArraysIndirect` and `drawIndexedIndirect` calls
+		uint32_t indirectDrawCalls = 0u;
+		//! the same count as `IVideoDriver::getPrimitiveCountDrawn`, indirect draws are not included
+		uint64_t primitivesDrawn = 0u;
+
+		//! `setMaterial` calls which actually changed the current material
+		uint32_t materialChanges = 0u;
+		//! the subset of `materialChanges` which switched `MaterialType`, so the shader
+		uint32_t shaderChanges = 0u;
+		//! vertex array object binds, zero on the null driver
+		uint32_t vertexInputBinds = 0u;
+
+		//! `copyBuffer` calls and bytes, including the ones done by `updateBufferRangeViaStagingBuffer`
+		uint32_t bufferCopies = 0u;
+		uint64_t bytesCopied = 0u;
+		//! copies sourced from `getDefaultUpStreamingBuffer()`, so the data streamed from the CPU
+		uint32_t upStreamingCopies = 0u;
+		uint64_t bytesUpStreamed = 0u;
+	};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -34,22 +34,30 @@ public:
 		a way that it'll look correctly in right-handed camera system. If it isn't set, compatibility with 
 		left-handed coordinate camera is assumed.
 		E_LOADER_PARAMETER_FLAGS::ELPF_DONT_COMPILE_GLSL means that GLSL won't be compiled to SPIR-V if it is loaded or generated.
+		E_LOADER_PARAMETER_FLAGS::ELPF_WELD_VERTICES makes loaders of unindexed formats merge vertices with the exact same attributes
+		and emit an index buffer, which is slower to load but smaller and friendlier to the post-transform cache.
+		E_LOADER_PARAMETER_FLAGS::ELPF_ALIAS_MAPPED_FILE_MEMORY lets loaders create buffers which point straight into the contents
+		of files that are in memory (see io::IReadFile::getMappedPointer), instead of copying them. Such buffers keep the file alive.
 	*/
 
 	enum E_LOADER_PARAMETER_FLAGS : uint64_t
 	{
 		ELPF_NONE = 0,											//!< default value, it doesn't do anything
 		ELPF_RIGHT_HANDED_MESHES = 0x1,							//!< specifies that a mesh will be flipped in such a way that it'll look correctly in right-handed camera system
-		ELPF_DONT_COMPILE_GLSL = 0x2							//!< it states that GLSL won't be compiled to SPIR-V if it is loaded or generated						
+		ELPF_DONT_COMPILE_GLSL = 0x2,							//!< it states that GLSL won't be compiled to SPIR-V if it is loaded or generated						
+		ELPF_WELD_VERTICES = 0x4,								//!< loaders of formats without an index buffer (STL) merge identical vertices and emit an indexed mesh
+		ELPF_ALIAS_MAPPED_FILE_MEMORY = 0x8						//!< uncompressed and unencrypted data of files in memory gets used in place instead of copied (.baw buffers)
 	};
 
     struct SAssetLoadParams
     {
         SAssetLoadParams(	size_t _decryptionKeyLen = 0u, const uint8_t* _decryptionKey = nullptr,
 							E_CACHING_FLAGS _cacheFlags = ECF_CACHE_EVERYTHING,
-							const char* _relativeDir = nullptr, const E_LOADER_PARAMETER_FLAGS& _loaderFlags = ELPF_NONE) :
+							const char* _relativeDir = nullptr, const E_LOADER_PARAMETER_FLAGS& _loaderFlags = ELPF_NONE,
+							uint32_t _maxImageResolution = 0u) :
 				decryptionKeyLen(_decryptionKeyLen), decryptionKey(_decryptionKey),
-				cacheFlags(_cacheFlags), relativeDir(_relativeDir), loaderFlags(_loaderFlags)
+				cacheFlags(_cacheFlags), relativeDir(_relativeDir), loaderFlags(_loaderFlags),
+				maxImageResolution(_maxImageResolution)
         {
         }
 
@@ -58,6 +66,7 @@ public:
         const E_CACHING_FLAGS cacheFlags;
         const char* relativeDir;
         const E_LOADER_PARAMETER_FLAGS loaderFlags;				//!< Flags having an impact on extraordinary tasks during loading process
+        const uint32_t maxImageResolution;						//!< longest side the image is needed at, loaders which can decode smaller (JPEG) do so, 0 for full resolution. Cached images don't get reloaded at another size.
     };
 
     //! Struct for keeping the state of the current loadoperation for safe threading
@@ -156,6 +156,7 @@ namespace asset
         //TODO change name
         SAssetBundle getAssetInHierarchy(io::IReadFile* _file, const std::string& _supposedFilename, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override)
         {
+            IRR_PROFILE_SCOPE("IAssetManager::getAssetInHierarchy");
             IAssetLoader::SAssetLoadContext ctx{_params, _file};
 
             std::string filename = _file ? _file->getFileName().c_str() : _supposedFilename;
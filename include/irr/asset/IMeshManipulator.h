@@ -147,7 +147,7 @@ namespace asset
 		which were previously shared are now duplicated. */
 		static core::smart_refctd_ptr<ICPUMeshBuffer> createMeshBufferUniquePrimitives(ICPUMeshBuffer* inbuffer, bool _makeIndexBuf = false);
 
-		//
+		//! `vxcmp` gets called from several threads at once, so it can't modify anything it shares
 		static core::smart_refctd_ptr<ICPUMeshBuffer> calculateSmoothNormals(ICPUMeshBuffer* inbuffer, bool makeNewMesh = false, float epsilon = 1.525e-5f,
 				E_VERTEX_ATTRIBUTE_ID normalAttrID = E_VERTEX_ATTRIBUTE_ID::EVAI_ATTR3, 
 				VxCmpFunction vxcmp = [](const IMeshManipulator::SSNGVertexData& v0, const IMeshManipulator::SSNGVertexData& v1, ICPUMeshBuffer* buffer) 
@@ -19,6 +19,7 @@
 
 // images
 #include "irr/asset/CImageData.h"
+#include "irr/asset/format/decodeImageFiles.h"
 #include "irr/asset/ICPUTexture.h"
 // shaders
 #include "irr/asset/ShaderCommons.h"
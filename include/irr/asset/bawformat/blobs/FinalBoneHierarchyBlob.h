@@ -17,7 +17,9 @@ struct IRR_FORCE_EBO FinalBoneHierarchyBlobV3 : VariableSizeBlob<FinalBoneHierar
 public:
 	enum E_BLOB_FINAL_BONE_HIERARCHY_FLAG : uint32_t
 	{
-		EBFBHF_RIGHT_HANDED = 0x1u
+		EBFBHF_RIGHT_HANDED = 0x1u,
+		//! interpolated animations block holds the compressed animations (see CFinalBoneHierarchy::compressAnimations), non interpolated one is empty
+		EBFBHF_COMPRESSED_ANIMATIONS = 0x2u
 	};
 
 	FinalBoneHierarchyBlobV3(const CFinalBoneHierarchy* _fbh);
@@ -0,0 +1,51 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __IRR_COMPRESS_BLOCKS_H_INCLUDED__
+#define __IRR_COMPRESS_BLOCKS_H_INCLUDED__
+
+#include <cstdint>
+#include <cstddef>
+
+#include "irr/asset/format/EFormat.h"
+
+namespace irr { namespace asset
+{
+
+class ICPUTexture;
+
+enum E_BLOCK_COMPRESSION_QUALITY : uint8_t
+{
+	//! endpoints along the axis after a single power iteration from the bounding box diagonal, no refinement, for previews and quick iteration
+	EBCQ_FAST,
+	//! endpoints along the principal axis of the block (8 power iterations), refined by least squares
+	EBCQ_NORMAL
+};
+
+struct SBlockCompressionParams
+{
+	E_BLOCK_COMPRESSION_QUALITY quality = EBCQ_NORMAL;
+	//! rows of blocks per task on core::CTaskScheduler::getGlobal(), 0 lets the scheduler pick
+	uint32_t grain = 0u;
+};
+
+//! Whether `compressBlocks` can produce `_fmt`, which is any variant of BC1, BC2, BC3, BC4, BC5 and BC7
+bool isBlockCompressionEncodable(E_FORMAT _fmt);
+
+//! Compresses texels of 4 channels with 8 bits each into tightly packed 4x4 blocks of `_dstFormat`
+/** The texels are in RGBA order and unsigned, except for the SNORM variants of BC4 and BC5 which take signed bytes.
+BC4 only reads red, BC5 red and green, BC1 without alpha and BC7 never drop alpha if it's there.
+Blocks sticking out of the image repeat its last row and column. Slices are `_height` rows of `_srcRowPitch` bytes apart.
+BC7 only ever uses mode 6 (one subset, RGBA endpoints with 4 bit indices), which is its fastest mode to encode.
+\return false if the format can't be encoded. */
+bool compressBlocks(E_FORMAT _dstFormat, void* _dst, const void* _src, size_t _srcRowPitch, uint32_t _width, uint32_t _height, uint32_t _depth, const SBlockCompressionParams& _params = SBlockCompressionParams());
+
+//! Creates a copy of the texture with every mip level range converted with `convertColor` and compressed to `_dstFormat`
+/** \return nullptr if the format can't be encoded or the texture is already block compressed or planar.
+The returned texture should be dropped when no longer needed. */
+ICPUTexture* createBlockCompressedTexture(const ICPUTexture* _texture, E_FORMAT _dstFormat, const SBlockCompressionParams& _params = SBlockCompressionParams());
+
+}} //irr::asset
+
+#endif
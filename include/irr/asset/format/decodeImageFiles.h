@@ -0,0 +1,49 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __IRR_DECODE_IMAGE_FILES_H_INCLUDED__
+#define __IRR_DECODE_IMAGE_FILES_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "irr/asset/CImageData.h"
+
+namespace irr
+{
+namespace io
+{
+	class IReadFile;
+}
+namespace asset
+{
+
+// Decode straight to a CImageData without going through IAssetManager, its cache or an ICPUTexture,
+// the loaders of these formats decode with the same functions.
+
+#ifdef _IRR_COMPILE_WITH_JPG_LOADER_
+//! Decodes a JPEG on the calling thread straight into a new image, reusing the decompressor and input buffer of the thread
+/** \param _maxResolution longest side the caller needs, the image gets scaled by 1/2, 1/4 or 1/8 in the DCT domain
+for as long as its longest side stays at least that large, 0 decodes at full resolution
+\return image the caller has to drop, or null if the file couldn't be decoded */
+CImageData* decodeJPEG(io::IReadFile* _file, uint32_t _maxResolution = 0u);
+
+//! Decodes `_fileCount` JPEGs concurrently on core::CTaskScheduler::getGlobal(), see `decodeJPEG`
+/** \param _outImages receives the image of every file, or null for the ones which couldn't be decoded */
+void decodeJPEGBatch(io::IReadFile* const* _files, uint32_t _fileCount, uint32_t _maxResolution, CImageData** _outImages);
+#endif // _IRR_COMPILE_WITH_JPG_LOADER_
+
+#ifdef _IRR_COMPILE_WITH_PNG_LOADER_
+//! Decodes a PNG on the calling thread straight into a new image, all conversions happen in libpng's row transforms
+/** PNG has no reduced resolution decoding, so unlike `decodeJPEG` this always decodes the full image.
+\return image the caller has to drop, or null if the file couldn't be decoded */
+CImageData* decodePNG(io::IReadFile* _file);
+
+//! Decodes `_fileCount` PNGs concurrently on core::CTaskScheduler::getGlobal(), see `decodePNG`
+/** \param _outImages receives the image of every file, or null for the ones which couldn't be decoded */
+void decodePNGBatch(io::IReadFile* const* _files, uint32_t _fileCount, CImageData** _outImages);
+#endif // _IRR_COMPILE_WITH_PNG_LOADER_
+
+}
+}
+
+#endif
@@ -0,0 +1,45 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __IRR_GENERATE_MIP_MAPS_H_INCLUDED__
+#define __IRR_GENERATE_MIP_MAPS_H_INCLUDED__
+
+#include <cstdint>
+
+#include "irr/asset/format/EFormat.h"
+
+namespace irr { namespace asset
+{
+
+class ICPUTexture;
+
+enum E_MIP_MAP_FILTER : uint8_t
+{
+	//! average of the texels each output texel covers, same as the GPU does
+	EMMF_BOX,
+	//! Kaiser windowed sinc of radius 3, sharper than box with little ringing
+	EMMF_KAISER,
+	//! Lanczos of radius 3, sharpest but rings the most around hard edges
+	EMMF_LANCZOS
+};
+
+struct SMipMapGenerationParams
+{
+	E_MIP_MAP_FILTER filter = EMMF_BOX;
+	//! rows per task on core::CTaskScheduler::getGlobal() in every pass, 0 lets the scheduler pick
+	uint32_t grain = 0u;
+};
+
+//! Creates a copy of the texture with a full mip chain computed from its level 0 on the CPU
+/** Level 0 ranges are shared with `_texture`, any levels it already had are replaced.
+Filtering happens on 4 float channels in linear space, so sRGB formats are linearized on decode and re-encoded after,
+the results are clamped to the range of normalized formats, integer formats are rounded and always use the box filter.
+Array layers and cube map faces are filtered independently, only 3D textures get filtered in depth.
+\return nullptr if the format is block compressed or planar, compress the result with `createBlockCompressedTexture` instead.
+The returned texture should be dropped when no longer needed. */
+ICPUTexture* createMipMappedTexture(const ICPUTexture* _texture, const SMipMapGenerationParams& _params = SMipMapGenerationParams());
+
+}} //irr::asset
+
+#endif
@@ -10,6 +10,7 @@
 #include <fstream>
 #include <iterator>
 #include <algorithm>
+#include <mutex>
 
 namespace irr
 {
@@ -52,11 +53,149 @@ namespace asset
 
 	using QuantizationCacheEntryHalfFloat = QuantizationCacheEntry16_16_16;
 
+	//! Thread-safe memoization of normal quantization results
+	/** Replaces the old sorted `core::vector` caches which needed O(n) inserts and could not be used from multiple threads.
+	The map is split into shards with their own lock, so parallel loaders rarely contend. */
+	template<class CacheEntry>
+	class CNormalQuantizationCache
+	{
+		public:
+			using entry_type = CacheEntry;
+			using value_type = decltype(CacheEntry::value);
+
+			inline bool find(const core::vectorSIMDf& normal, value_type& outValue) const
+			{
+				const Key key(normal);
+				const auto& shard = getShard(key);
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				auto found = shard.map.find(key);
+				if (found==shard.map.end())
+					return false;
+				outValue = found->second;
+				return true;
+			}
+
+			inline void insert(const core::vectorSIMDf& normal, const value_type& value)
+			{
+				const Key key(normal);
+				auto& shard = getShard(key);
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				shard.map.emplace(key,value);
+			}
+
+			inline size_t size() const
+			{
+				size_t retval = 0u;
+				for (const auto& shard : shards)
+				{
+					std::lock_guard<std::mutex> lock(shard.mutex);
+					retval += shard.map.size();
+				}
+				return retval;
+			}
+
+			inline void clear()
+			{
+				for (auto& shard : shards)
+				{
+					std::lock_guard<std::mutex> lock(shard.mutex);
+					shard.map.clear();
+				}
+			}
+
+			//! For saving the cache to disk, the entries come out sorted just like the old vector cache was
+			inline core::vector<CacheEntry> getEntries() const
+			{
+				core::vector<CacheEntry> retval;
+				retval.reserve(size());
+				for (const auto& shard : shards)
+				{
+					std::lock_guard<std::mutex> lock(shard.mutex);
+					for (const auto& item : shard.map)
+					{
+						CacheEntry entry;
+						entry.key = item.first.getAsVector();
+						entry.value = item.second;
+						retval.push_back(entry);
+					}
+				}
+				std::sort(retval.begin(),retval.end());
+				return retval;
+			}
+
+			//! For loading a cache previously saved with `getEntries`
+			template<class Iterator>
+			inline void insertEntries(Iterator begin, Iterator end)
+			{
+				for (auto it=begin; it!=end; it++)
+					insert(it->key,it->value);
+			}
+
+		private:
+			// bitwise key, so we don't have to store an aligned `vectorSIMDf` in the map
+			struct Key
+			{
+				Key(const core::vectorSIMDf& normal)
+				{
+					const auto bits = reinterpret_cast<const uint32_t*>(normal.pointer);
+					x = bits[0];
+					y = bits[1];
+					z = bits[2];
+				}
+
+				inline bool operator==(const Key& other) const
+				{
+					return x==other.x && y==other.y && z==other.z;
+				}
+
+				inline core::vectorSIMDf getAsVector() const
+				{
+					core::vectorSIMDf retval;
+					auto bits = reinterpret_cast<uint32_t*>(retval.pointer);
+					bits[0] = x;
+					bits[1] = y;
+					bits[2] = z;
+					bits[3] = 0u;
+					return retval;
+				}
+
+				uint32_t x, y, z;
+			};
+			struct KeyHash
+			{
+				inline size_t operator()(const Key& key) const
+				{
+					uint64_t hash = key.x*0x9e3779b97f4a7c15ull;
+					hash = (hash^(hash>>29u)^key.y)*0xbf58476d1ce4e5b9ull;
+					hash = (hash^(hash>>32u)^key.z)*0x94d049bb133111ebull;
+					return static_cast<size_t>(hash^(hash>>31u));
+				}
+			};
+
+			_IRR_STATIC_INLINE_CONSTEXPR uint32_t ShardCount = 64u;
+			struct Shard
+			{
+				mutable std::mutex mutex;
+				core::unordered_map<Key,value_type,KeyHash> map;
+			};
+
+			inline Shard& getShard(const Key& key)
+			{
+				return shards[(KeyHash()(key)>>24u)%ShardCount];
+			}
+			inline const Shard& getShard(const Key& key) const
+			{
+				return shards[(KeyHash()(key)>>24u)%ShardCount];
+			}
+
+			Shard shards[ShardCount];
+	};
+
 	// defined in CMeshManipulator.cpp
-    extern core::vector<QuantizationCacheEntry2_10_10_10>   normalCacheFor2_10_10_10Quant;
-	extern core::vector<QuantizationCacheEntry8_8_8>        normalCacheFor8_8_8Quant;
-	extern core::vector<QuantizationCacheEntry16_16_16>     normalCacheFor16_16_16Quant;
-	extern core::vector<QuantizationCacheEntryHalfFloat>    normalCacheForHalfFloatQuant;
+	extern CNormalQuantizationCache<QuantizationCacheEntry2_10_10_10>	normalCacheFor2_10_10_10Quant;
+	extern CNormalQuantizationCache<QuantizationCacheEntry8_8_8>		normalCacheFor8_8_8Quant;
+	extern CNormalQuantizationCache<QuantizationCacheEntry16_16_16>		normalCacheFor16_16_16Quant;
+	extern CNormalQuantizationCache<QuantizationCacheEntryHalfFloat>	normalCacheForHalfFloatQuant;
 
     inline core::vectorSIMDf findBestFit(const uint32_t& bits, const core::vectorSIMDf& normal)
     {
@@ -140,107 +279,105 @@ namespace asset
 		return bestFit;
     }
 
-	inline uint32_t quantizeNormal2_10_10_10(const core::vectorSIMDf &normal)
+	namespace impl
 	{
-        QuantizationCacheEntry2_10_10_10 dummySearchVal;
-        dummySearchVal.key = normal;
-        auto found = std::lower_bound(normalCacheFor2_10_10_10Quant.begin(),normalCacheFor2_10_10_10Quant.end(),dummySearchVal);
-        if (found!=normalCacheFor2_10_10_10Quant.end()&&(found->key==normal).all())
-        {
-            return found->value;
-        }
+		template<uint32_t quantizationBits>
+		inline core::vectorSIMDu32 quantizeNormalToSNORM(const core::vectorSIMDf& normal)
+		{
+			const auto xorflag = core::vectorSIMDu32((0x1u<<quantizationBits)-1u);
+			core::vectorSIMDf fit = findBestFit(quantizationBits, normal);
+			auto negativeMask = normal < core::vectorSIMDf(0.f);
+			auto absIntFit = core::vectorSIMDu32(core::abs(fit))^core::mix(core::vectorSIMDu32(0u),xorflag,negativeMask);
+			return (absIntFit+core::mix(core::vectorSIMDu32(0u),core::vectorSIMDu32(1u),negativeMask))&xorflag;
+		}
 
-		constexpr uint32_t quantizationBits = 10u;
-		const auto xorflag = core::vectorSIMDu32((0x1u<<quantizationBits)-1u);
-        core::vectorSIMDf fit = findBestFit(quantizationBits, normal);
-		auto negativeMask = normal < core::vectorSIMDf(0.f);
-		auto absIntFit = core::vectorSIMDu32(core::abs(fit))^core::mix(core::vectorSIMDu32(0u),core::vectorSIMDu32(xorflag),negativeMask);
-		auto snormVec = (absIntFit+core::mix(core::vectorSIMDu32(0u),core::vectorSIMDu32(1u),negativeMask))&xorflag;
-        
-        uint32_t bestFit = snormVec[0]|(snormVec[1]<<quantizationBits)|(snormVec[2]<<(quantizationBits*2u));
+		template<class Cache, typename QuantizeF>
+		inline typename Cache::value_type quantizeNormalCached(Cache& cache, const core::vectorSIMDf& normal, QuantizeF quantize)
+		{
+			typename Cache::value_type retval;
+			if (cache.find(normal,retval))
+				return retval;
 
-		dummySearchVal.value = bestFit;
-        normalCacheFor2_10_10_10Quant.insert(found,dummySearchVal);
+			retval = quantize(normal);
+			cache.insert(normal,retval);
+			return retval;
+		}
 
+		//! consecutive normals repeat a lot (flat shaded faces, duplicated vertices), so we skip the cache for those
+		template<typename OutType, typename QuantizeF>
+		inline void quantizeNormals(OutType* out, const core::vectorSIMDf* normals, size_t count, QuantizeF quantize)
+		{
+			for (size_t i=0u; i<count; i++)
+			{
+				if (i && (normals[i]==normals[i-1u]).all())
+					out[i] = out[i-1u];
+				else
+					out[i] = quantize(normals[i]);
+			}
+		}
+	}
 
-	    return bestFit;
+	inline uint32_t quantizeNormal2_10_10_10(const core::vectorSIMDf &normal)
+	{
+		return impl::quantizeNormalCached(normalCacheFor2_10_10_10Quant,normal,[](const core::vectorSIMDf& _normal) -> uint32_t
+		{
+			constexpr uint32_t quantizationBits = 10u;
+			auto snormVec = impl::quantizeNormalToSNORM<quantizationBits>(_normal);
+			return snormVec[0]|(snormVec[1]<<quantizationBits)|(snormVec[2]<<(quantizationBits*2u));
+		});
 	}
 
 	inline uint32_t quantizeNormal888(const core::vectorSIMDf &normal)
 	{
-		QuantizationCacheEntry8_8_8 dummySearchVal;
-		dummySearchVal.key = normal;
-		auto found = std::lower_bound(normalCacheFor8_8_8Quant.begin(), normalCacheFor8_8_8Quant.end(), dummySearchVal);
-		if (found != normalCacheFor8_8_8Quant.end() && (found->key == normal).all())
+		return impl::quantizeNormalCached(normalCacheFor8_8_8Quant,normal,[](const core::vectorSIMDf& _normal) -> uint32_t
 		{
-			return found->value;
-		}
-		
-		constexpr uint32_t quantizationBits = 8u;
-		const auto xorflag = core::vectorSIMDu32((0x1u<<quantizationBits)-1u);
-        core::vectorSIMDf fit = findBestFit(quantizationBits, normal);
-		auto negativeMask = normal < core::vectorSIMDf(0.f);
-		auto absIntFit = core::vectorSIMDu32(core::abs(fit))^core::mix(core::vectorSIMDu32(0u),xorflag,negativeMask);
-		auto snormVec = (absIntFit+core::mix(core::vectorSIMDu32(0u),core::vectorSIMDu32(1u),negativeMask))&xorflag;
-        
-        uint32_t bestFit = snormVec[0]|(snormVec[1]<<quantizationBits)|(snormVec[2]<<(quantizationBits*2u));
-
-		dummySearchVal.value = bestFit;
-		normalCacheFor8_8_8Quant.insert(found, dummySearchVal);
-
-	    return bestFit;
+			constexpr uint32_t quantizationBits = 8u;
+			auto snormVec = impl::quantizeNormalToSNORM<quantizationBits>(_normal);
+			return snormVec[0]|(snormVec[1]<<quantizationBits)|(snormVec[2]<<(quantizationBits*2u));
+		});
 	}
 
 	inline uint64_t quantizeNormal16_16_16(const core::vectorSIMDf& normal)
 	{
-		QuantizationCacheEntry16_16_16 dummySearchVal;
-		dummySearchVal.key = normal;
-		auto found = std::lower_bound(normalCacheFor16_16_16Quant.begin(), normalCacheFor16_16_16Quant.end(), dummySearchVal);
-		if (found != normalCacheFor16_16_16Quant.end() && (found->key == normal).all())
+		return impl::quantizeNormalCached(normalCacheFor16_16_16Quant,normal,[](const core::vectorSIMDf& _normal) -> uint64_t
 		{
-			return found->value;
-		}
-
-		uint16_t bestFit[4]{0u,0u,0u,0u};
-
-		constexpr uint32_t quantizationBits = 10u;
-		const auto xorflag = core::vectorSIMDu32((0x1u<<quantizationBits)-1u);
-        core::vectorSIMDf fit = findBestFit(quantizationBits, normal);
-		auto negativeMask = normal < core::vectorSIMDf(0.f);
-		auto absIntFit = core::vectorSIMDu32(core::abs(fit))^core::mix(core::vectorSIMDu32(0u),core::vectorSIMDu32(xorflag),negativeMask);
-		auto snormVec = (absIntFit+core::mix(core::vectorSIMDu32(0u),core::vectorSIMDu32(1u),negativeMask))&xorflag;
-        
-		bestFit[0] = snormVec[0];
-		bestFit[1] = snormVec[1];
-		bestFit[2] = snormVec[2];
-
-		dummySearchVal.value = *reinterpret_cast<uint64_t*>(bestFit);
-		normalCacheFor16_16_16Quant.insert(found, dummySearchVal);
-
-		return *reinterpret_cast<uint64_t*>(bestFit);
+			constexpr uint32_t quantizationBits = 10u;
+			auto snormVec = impl::quantizeNormalToSNORM<quantizationBits>(_normal);
+			uint16_t bestFit[4]{uint16_t(snormVec[0]),uint16_t(snormVec[1]),uint16_t(snormVec[2]),0u};
+			return *reinterpret_cast<uint64_t*>(bestFit);
+		});
 	}
 
 	inline uint64_t quantizeNormalHalfFloat(const core::vectorSIMDf& normal)
 	{
-		QuantizationCacheEntryHalfFloat dummySearchVal;
-		dummySearchVal.key = normal;
-		auto found = std::lower_bound(normalCacheForHalfFloatQuant.begin(), normalCacheForHalfFloatQuant.end(), dummySearchVal);
-		if (found != normalCacheForHalfFloatQuant.end() && (found->key == normal).all())
+		return impl::quantizeNormalCached(normalCacheForHalfFloatQuant,normal,[](const core::vectorSIMDf& _normal) -> uint64_t
 		{
-			return found->value;
-		}
-
-		uint16_t bestFit[4] {
-			core::Float16Compressor::compress(normal.x),
-			core::Float16Compressor::compress(normal.y),
-			core::Float16Compressor::compress(normal.z),
-			0u
-		};
-
-		dummySearchVal.value = *reinterpret_cast<uint64_t*>(bestFit);
-		normalCacheForHalfFloatQuant.insert(found, dummySearchVal);
+			uint16_t bestFit[4] {
+				core::Float16Compressor::compress(_normal.x),
+				core::Float16Compressor::compress(_normal.y),
+				core::Float16Compressor::compress(_normal.z),
+				0u
+			};
+			return *reinterpret_cast<uint64_t*>(bestFit);
+		});
+	}
 
-		return *reinterpret_cast<uint64_t*>(bestFit);
+	//! Batch versions of the above, safe to call from multiple threads at once
+	inline void quantizeNormals2_10_10_10(uint32_t* out, const core::vectorSIMDf* normals, size_t count)
+	{
+		impl::quantizeNormals(out,normals,count,quantizeNormal2_10_10_10);
+	}
+	inline void quantizeNormals888(uint32_t* out, const core::vectorSIMDf* normals, size_t count)
+	{
+		impl::quantizeNormals(out,normals,count,quantizeNormal888);
+	}
+	inline void quantizeNormals16_16_16(uint64_t* out, const core::vectorSIMDf* normals, size_t count)
+	{
+		impl::quantizeNormals(out,normals,count,quantizeNormal16_16_16);
+	}
+	inline void quantizeNormalsHalfFloat(uint64_t* out, const core::vectorSIMDf* normals, size_t count)
+	{
+		impl::quantizeNormals(out,normals,count,quantizeNormalHalfFloat);
 	}
 
 } // end namespace scene
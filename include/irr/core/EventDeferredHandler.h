@@ -3,6 +3,7 @@
 
 
 #include "irr/core/Types.h"
+#include "irr/void_t.h"
 
 namespace irr
 {
@@ -186,6 +187,134 @@ class EventDeferredHandlerST
         }
 };
 
+namespace impl
+{
+    template<class Functor, class=void>
+    struct is_functor_absorbable : std::false_type {};
+    template<class Functor>
+    struct is_functor_absorbable<Functor,void_t<decltype(std::declval<Functor&>().absorb(std::declval<Functor&&>()))> > : std::true_type {};
+}
+
+//! Variant of EventDeferredHandlerST for events which complete in the same order they were added, such as fences on a single queue
+/** Functors are grouped by event in a ring, polling only ever looks at the oldest group and stops at the first one not ready,
+so it costs O(1) no matter how many functors are pending. All functors of a group run as soon as its event is ready.
+Consecutive functors deferred on the same event are merged into one if `Functor` has a `void absorb(Functor&&)` method.
+An event added out of order is still safe, its functors merely wait for all events before it. */
+template<class Event, class Functor>
+class EventDeferredHandlerTimelineST
+{
+    protected:
+        struct EventGroup
+        {
+            EventGroup(Event&& _event) : event(std::move(_event)), firstPending(0u) {}
+
+            Event                       event;
+            core::vector<Functor>       functors;
+            //! functors before this one already ran, but a functor asked to stop before the rest
+            uint32_t                    firstPending;
+        };
+        typedef core::deque<EventGroup> EventContainerType;
+        uint32_t                                mEventsCount;
+        EventContainerType                      mGroups;
+
+        //! runs the pending functors of the oldest group, \return true if one of them asked to stop early
+        template<typename... Args>
+        inline bool retireOldestGroup(Args&... args)
+        {
+            auto& group = mGroups.front();
+            while (group.firstPending<group.functors.size())
+            {
+                bool earlyQuit = group.functors[group.firstPending++](args...);
+                mEventsCount--;
+                if (earlyQuit)
+                {
+                    if (group.firstPending==group.functors.size())
+                        mGroups.pop_front();
+                    return true;
+                }
+            }
+            mGroups.pop_front();
+            return false;
+        }
+
+        //! runs all the pending functors of the oldest group without letting them stop early
+        inline void flushOldestGroup()
+        {
+            auto& group = mGroups.front();
+            for (auto i=group.firstPending; i<group.functors.size(); i++)
+                group.functors[i]();
+            mEventsCount -= group.functors.size()-group.firstPending;
+            mGroups.pop_front();
+        }
+
+        static inline bool absorb(Functor& dst, Functor& src, std::true_type)
+        {
+            dst.absorb(std::move(src));
+            return true;
+        }
+        static inline bool absorb(Functor& dst, Functor& src, std::false_type) {return false;}
+    public:
+        EventDeferredHandlerTimelineST() : mEventsCount(0u) {}
+
+        virtual ~EventDeferredHandlerTimelineST()
+        {
+            while (mGroups.size())
+            {
+                while (!mGroups.front().event.wait_until(std::chrono::high_resolution_clock::now()+std::chrono::microseconds(250ull))) {}
+                flushOldestGroup();
+            }
+        }
+
+        inline uint32_t getEventsCount() const {return mEventsCount;}
+
+        inline void     addEvent(Event&& event, Functor&& functor)
+        {
+            if (mGroups.empty() || !(mGroups.back().event==event))
+                mGroups.emplace_back(std::forward<Event>(event));
+
+            auto& group = mGroups.back();
+            if (group.functors.size()>group.firstPending && absorb(group.functors.back(),functor,impl::is_functor_absorbable<Functor>()))
+                return;
+            group.functors.push_back(std::forward<Functor>(functor));
+            mEventsCount++;
+        }
+
+        template<class Clock, class Duration, typename... Args>
+        inline uint32_t waitUntilForReadyEvents(const std::chrono::time_point<Clock, Duration>& timeout_time, Args&... args)
+        {
+            while (mGroups.size())
+            {
+                // later events can't be ready before the oldest, so there's only ever one to wait for
+                bool success = Clock::now()<timeout_time ? mGroups.front().event.wait_until(timeout_time):mGroups.front().event.poll();
+                if (!success || retireOldestGroup(args...))
+                    return mEventsCount;
+            }
+
+            return 0u;
+        }
+
+        template<typename... Args>
+        inline uint32_t pollForReadyEvents(Args&... args)
+        {
+            while (mGroups.size() && mGroups.front().event.poll())
+            {
+                if (retireOldestGroup(args...))
+                    break;
+            }
+
+            return mEventsCount;
+        }
+
+        //! Will try to poll enough events so that the number of events in the queue is less or equal to maxEventCount
+        inline uint32_t cullEvents(uint32_t maxEventCount)
+        {
+            while (mEventsCount>maxEventCount && mGroups.size() && mGroups.front().event.poll())
+                flushOldestGroup();
+
+            return mEventsCount;
+        }
+};
+
 //! EventDeferredHandlerMT coming later
 
 }
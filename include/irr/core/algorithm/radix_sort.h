@@ -0,0 +1,69 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __IRR_RADIX_SORT_H_INCLUDED__
+#define __IRR_RADIX_SORT_H_INCLUDED__
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace irr
+{
+namespace core
+{
+
+//! Stable LSD radix sort of `[begin,end)` by the unsigned integer `getKey(element)`, 8 bits per pass
+/** `scratch` must have room for `end-begin` elements and is used as the ping-pong buffer, nothing gets allocated.
+Returns `begin` or `scratch`, whichever holds the sorted sequence after the last pass.
+The histograms of all digits are gathered in a single read of the input and every digit in which all keys agree is skipped,
+so keys which only use a few of their bytes (or are mostly equal) cost far fewer than `sizeof(key)` scatter passes. */
+template<typename T, class KeyGetter>
+inline T* radix_sort(T* begin, T* end, T* scratch, KeyGetter&& getKey)
+{
+	using key_t = typename std::decay<decltype(getKey(*begin))>::type;
+	static_assert(std::is_integral<key_t>::value&&std::is_unsigned<key_t>::value, "Radix sort needs unsigned integer keys.");
+	constexpr size_t DigitCount = sizeof(key_t);
+	constexpr size_t BucketCount = 256u;
+
+	const size_t count = end-begin;
+	if (count<2u)
+		return begin;
+
+	size_t histogram[DigitCount][BucketCount] = {};
+	for (const T* it=begin; it!=end; it++)
+	{
+		const key_t key = getKey(*it);
+		for (size_t d=0u; d<DigitCount; d++)
+			histogram[d][(key>>(d*8u))&0xffu]++;
+	}
+
+	const key_t firstKey = getKey(*begin);
+	T* src = begin;
+	T* dst = scratch;
+	for (size_t d=0u; d<DigitCount; d++)
+	{
+		size_t* offsets = histogram[d];
+		if (offsets[(firstKey>>(d*8u))&0xffu]==count)
+			continue;
+
+		size_t sum = 0u;
+		for (size_t b=0u; b<BucketCount; b++)
+		{
+			const size_t tmp = offsets[b];
+			offsets[b] = sum;
+			sum += tmp;
+		}
+		for (const T* it=src; it!=src+count; it++)
+			dst[offsets[(getKey(*it)>>(d*8u))&0xffu]++] = *it;
+		std::swap(src,dst);
+	}
+	return src;
+}
+
+} // end namespace core
+} // end namespace irr
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "irr/core/math/intutil.h"
 #include "irr/core/math/glslFunctions.h"
+#include "irr/core/algorithm/radix_sort.h"
 
 #include "irr/core/alloc/AddressAllocatorBase.h"
 
@@ -234,22 +235,16 @@ class GeneralpurposeAddressAllocatorBase
         }
 
 
-        //! Return index of freelist or one past the end for nothing
-        inline decltype(freeListCount)  findMinimum(const Block* const* listOfLists, const Block* const* listOfListsEnd) noexcept
+        //! The reserved space holds two sets of free lists, returns the start of the one not in use
+        inline Block*                   getOtherFreeListBuffer(void* startPtr) const noexcept
         {
-            size_type               minval = ~size_type(0u);
-            decltype(freeListCount) retval = freeListCount;
+            Block* retval = reinterpret_cast<Block*>(startPtr);
+            if (!usingFirstBuffer)
+                return retval;
 
-            for (decltype(freeListCount) i=0; i<freeListCount; i++)
-            {
-                if (listOfLists[i]==listOfListsEnd[i] || listOfLists[i]->startOffset>=minval)
-                    continue;
-
-                minval = listOfLists[i]->startOffset;
-                retval = i;
-            }
-
-            return retval;
+            for (decltype(freeListCount) i=0u; i<freeListCount; i++)
+                retval += bufferSize/(minBlockSize<<size_type(i));
+            return retval+1u; // base level dwarf-blocks
         }
 
 
@@ -510,6 +505,87 @@ class GeneralpurposeAddressAllocator : public AddressAllocatorBase<Generalpurpos
         }
 
 
+        //! A range of allocations `compact` wants moved
+        struct Move
+        {
+            size_type oldOffset;
+            size_type newOffset;
+            size_type size;
+        };
+
+        //! Upper bound on the number of moves `compact` can plan
+        inline size_type        max_compaction_moves() const noexcept
+        {
+            size_type retval = 1u;
+            for (decltype(AllocStrategy::freeListCount) i=0u; i<AllocStrategy::freeListCount; i++)
+                retval += AllocStrategy::freeListStackCtr[i];
+            return retval;
+        }
+
+        //! Opt-in, plans moving the allocations towards the start of the buffer so that the free space becomes one block at the end
+        /** The allocator does not know individual allocations, so it moves each run of adjacent allocations between two free blocks as a whole,
+        by a multiple of `alignment` (the largest alignment any of the allocations needs). Runs which could only move by less than the minimum block size stay put.
+        The free lists get updated straight away as if the moves had happened, the owner then has to execute the moves in the order given,
+        with `memmove` semantics as a range may overlap its old place, and patch every address it holds which falls in `[oldOffset,oldOffset+size)`
+        by adding `newOffset-oldOffset`, all before the next allocation. The offsets have the address offset applied, like the ones `alloc_addr` returns.
+        \param outMoves needs room for `max_compaction_moves()` entries
+        \param alignment has to be non-zero, otherwise nothing gets planned and the free lists stay as they are
+        \return the number of moves written to `outMoves`, sorted on both offsets */
+        inline size_type        compact(Move* outMoves, size_type alignment) noexcept
+        {
+            // every offset is a multiple of 1, but there is no offset modulo 0 to keep
+            if (!alignment)
+                return 0u;
+
+            size_type count;
+            const Block* sorted = sortFreeBlocks(count);
+
+            size_type moveCount = 0u;
+            size_type compactedEnd = 0u;
+            auto placeLiveRange = [&](size_type start, size_type end) -> void
+            {
+                // lowest spot keeping the offset modulo `alignment` which doesn't leave a hole smaller than a block, same as `calcSubAllocation`
+                size_type target = start-((start-compactedEnd)/alignment)*alignment;
+                if (target!=compactedEnd && target-compactedEnd<AllocStrategy::minBlockSize)
+                    target += core::roundUp(AllocStrategy::minBlockSize-(target-compactedEnd),alignment);
+                // the space freed at the end of the range has to make a block too
+                if (target+AllocStrategy::minBlockSize>start)
+                    target = start;
+
+                if (target!=compactedEnd)
+                    AllocStrategy::insertFreeBlock(Block{compactedEnd,target});
+                if (target!=start)
+                    outMoves[moveCount++] = Move{start+Base::combinedOffset,target+Base::combinedOffset,end-start};
+                compactedEnd = target+(end-start);
+            };
+
+            // allocations fill the space between coalesced free blocks
+            size_type liveStart = 0u;
+            for (const Block* it=sorted; it!=sorted+count; )
+            {
+                const size_type freeStart = it->startOffset;
+                size_type freeEnd = (it++)->endOffset;
+                for (; it!=sorted+count && it->startOffset==freeEnd; it++)
+                    freeEnd = it->endOffset;
+
+                if (freeStart!=liveStart)
+                    placeLiveRange(liveStart,freeStart);
+                liveStart = freeEnd;
+            }
+            if (liveStart!=AllocStrategy::bufferSize)
+                placeLiveRange(liveStart,AllocStrategy::bufferSize);
+
+            if (compactedEnd!=AllocStrategy::bufferSize)
+                AllocStrategy::insertFreeBlock(Block{compactedEnd,AllocStrategy::bufferSize});
+
+            return moveCount;
+        }
+        inline size_type        compact(Move* outMoves) noexcept
+        {
+            return compact(outMoves,Base::maxRequestableAlignment);
+        }
+
+
         static inline size_type reserved_size(size_type maxAlignment, size_type bufSz, size_type minBlockSize) noexcept
         {
             size_type reserved = 0u;
@@ -540,55 +616,57 @@ class GeneralpurposeAddressAllocator : public AddressAllocatorBase<Generalpurpos
             return AllocStrategy::is_double_free(addr-Base::combinedOffset,bytes);
         }
     protected:
-        inline size_type        defragment() noexcept
-        {
-            // TODO: radix sort the whole thing on the block-start value and do a coalesce without `AllocStrategy::findMinimum`
-            // also add the blocks in reverse order
-            Block* freeListOld[AllocStrategy::maxListLevels];
-            const Block* freeListOldEnd[AllocStrategy::maxListLevels];
+        //! Gathers every free block into one array sorted on the start offset and empties the free lists, ready for the blocks to go back in
+        inline const Block*     sortFreeBlocks(size_type& count) noexcept
+        {
+            // either set of free lists has room for every free block there can be, so the unused one gathers them and the used one is the sort's scratch
+            Block* gathered = AllocStrategy::getOtherFreeListBuffer(Base::reservedSpace);
+            count = 0u;
             for (decltype(AllocStrategy::freeListCount) i=0u; i<AllocStrategy::freeListCount; i++)
             {
-                freeListOld[i] = AllocStrategy::freeListStack[i];
-                freeListOldEnd[i] = freeListOld[i]+AllocStrategy::freeListStackCtr[i];
-                std::sort(freeListOld[i],const_cast<Block*>(freeListOldEnd[i]));
+                std::copy(AllocStrategy::freeListStack[i],AllocStrategy::freeListStack[i]+AllocStrategy::freeListStackCtr[i],gathered+count);
+                count += AllocStrategy::freeListStackCtr[i];
             }
+            const Block* sorted = core::radix_sort(gathered,gathered+count,AllocStrategy::freeListStack[0],[](const Block& block) {return block.startOffset;});
 
+            // `swapFreeLists` moves to the other set of lists, which must not be the one holding the sorted blocks
+            if (sorted==gathered)
+                AllocStrategy::usingFirstBuffer ^= 1u;
             AllocStrategy::swapFreeLists(Base::reservedSpace);
+            return sorted;
+        }
 
-            // begin the coalesce
-            Block lastBlock{0u,0u};
-            auto minimum = AllocStrategy::findMinimum(freeListOld,freeListOldEnd);
-            while (minimum!=AllocStrategy::freeListCount)
-            {
-                // find next free block and pop it
-                const Block* nextBlock = freeListOld[minimum]++;
+        inline size_type        defragment() noexcept
+        {
+            size_type count;
+            const Block* sorted = sortFreeBlocks(count);
 
+            // coalesce back to front, so the lowest addresses end up on top of the free list stacks
+            size_type retval = AllocStrategy::bufferSize;
+            Block lastBlock{invalid_address,invalid_address};
+            for (const Block* it=sorted+count; it!=sorted; )
+            {
+                const Block& prevBlock = *(--it);
                 // check if broke continuity
-                if (nextBlock->startOffset!=lastBlock.endOffset)
+                if (prevBlock.endOffset!=lastBlock.startOffset)
                 {
                     // put old on correct free list
-                    if (lastBlock.getLength())
+                    if (lastBlock.startOffset!=invalid_address)
                         AllocStrategy::insertFreeBlock(lastBlock);
 
-                    lastBlock.startOffset = nextBlock->startOffset;
+                    lastBlock.endOffset = prevBlock.endOffset;
                 }
 
-                lastBlock.endOffset = nextBlock->endOffset;
-                minimum = AllocStrategy::findMinimum(freeListOld,freeListOldEnd);
-            }
-            #ifdef _IRR_DEBUG
-            for (decltype(AllocStrategy::freeListCount) i=0u; i<AllocStrategy::freeListCount; i++)
-                assert(freeListOld[i]==freeListOldEnd[i]);
-            #endif // _IRR_DEBUG
-            // put last block on correct free list
-            if (lastBlock.getLength())
-            {
-                AllocStrategy::insertFreeBlock(lastBlock);
+                lastBlock.startOffset = prevBlock.startOffset;
+                // only the first block formed can reach the end of the buffer
                 if (lastBlock.endOffset==AllocStrategy::bufferSize)
-                    return lastBlock.startOffset;
+                    retval = lastBlock.startOffset;
             }
+            // put last block on correct free list
+            if (lastBlock.startOffset!=invalid_address)
+                AllocStrategy::insertFreeBlock(lastBlock);
 
-            return AllocStrategy::bufferSize;
+            return retval;
         }
 };
 
@@ -8,6 +8,8 @@
 #include "irr/switch_constexpr.h"
 #include "irr/type_traits.h"
 #include "irr/void_t.h"
+// algorithm
+#include "irr/core/algorithm/radix_sort.h"
 // allocator
 #include "irr/core/alloc/AddressAllocatorBase.h"
 #include "irr/core/alloc/AddressAllocatorConcurrencyAdaptors.h"
@@ -44,9 +46,13 @@
 #include "irr/core/sampling/RandomSampler.h"
 #include "irr/core/sampling/SobolSampler.h"
 #include "irr/core/sampling/OwenSampler.h"
+#include "irr/core/sampling/HashedOwenSampler.h"
 // parallel
+#include "irr/core/parallel/CTaskScheduler.h"
 #include "irr/core/parallel/IThreadBound.h"
 #include "irr/core/parallel/unlock_guard.h"
+// profiling
+#include "irr/core/profiling/CProfiler.h"
 // string
 #include "irr/core/string/stringutil.h"
 #include "irr/core/string/UniqueStringLiteralType.h"
@@ -0,0 +1,273 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __IRR_C_TASK_SCHEDULER_H_INCLUDED__
+#define __IRR_C_TASK_SCHEDULER_H_INCLUDED__
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "irr/core/Types.h"
+#include "irr/core/memory/new_delete.h"
+
+namespace irr
+{
+namespace core
+{
+
+//! Work-stealing task scheduler
+/** Every worker thread owns a deque of tasks, it pushes and pops the back of it so the most recently spawned (cache-hot) work runs first,
+while idle workers steal the oldest tasks from the front of the other deques. Tasks submitted from threads which aren't workers go to a shared queue.
+Waiting for a task executes other tasks until it finishes, so tasks may wait on the work they spawned without deadlocking,
+and threads which aren't workers lend a hand while they wait.
+A task counts as finished once its functor returned and all the children it spawned with `spawnChild` have finished.
+Tasks, their functors and the deques are allocated with `core::allocator`. */
+class CTaskScheduler
+{
+	public:
+		class Task;
+
+		//! Shared ownership of a task, which stays valid for waiting on and as a dependency after the task finished
+		class TaskHandle
+		{
+			public:
+				TaskHandle() : task(nullptr) {}
+				TaskHandle(const TaskHandle& other) : task(other.task) { grab(); }
+				TaskHandle(TaskHandle&& other) : task(other.task) { other.task = nullptr; }
+				~TaskHandle() { release(); }
+
+				inline TaskHandle& operator=(const TaskHandle& other)
+				{
+					if (task!=other.task)
+					{
+						release();
+						task = other.task;
+						grab();
+					}
+					return *this;
+				}
+				inline TaskHandle& operator=(TaskHandle&& other)
+				{
+					std::swap(task,other.task);
+					return *this;
+				}
+
+				inline explicit operator bool() const { return task!=nullptr; }
+
+				//! True once the functor and all children of the task finished
+				bool isDone() const;
+
+			private:
+				friend class CTaskScheduler;
+				//! adopts a reference the caller already holds
+				explicit TaskHandle(Task* _task) : task(_task) {}
+
+				void grab();
+				void release();
+
+				Task* task;
+		};
+
+		class Task
+		{
+			public:
+				virtual ~Task() {}
+
+			protected:
+				Task() : refCount(1u), pendingDependencies(1u), unfinished(1u), done(false), scheduler(nullptr) {}
+
+				virtual void execute() = 0;
+
+			private:
+				friend class CTaskScheduler;
+				friend class TaskHandle;
+
+				//! handles plus one held by the scheduler until the functor returned
+				std::atomic<uint32_t> refCount;
+				//! dependencies which haven't finished, plus one until all of them got registered
+				std::atomic<uint32_t> pendingDependencies;
+				//! the functor itself plus children which haven't finished
+				std::atomic<uint32_t> unfinished;
+				std::atomic<bool> done;
+				//! the scheduler it was submitted to, which runs it even if a dependency finishes on another one
+				CTaskScheduler* scheduler;
+				TaskHandle parent;
+				//! tasks depending on this one, each entry holds the scheduler's reference of that task
+				std::mutex continuationMutex;
+				core::vector<Task*> continuations;
+		};
+
+		//! Summed over all threads since construction or the last `resetStatistics`
+		struct SStatistics
+		{
+			//! tasks given to the scheduler, including children such as the subranges of `parallelFor`
+			uint64_t submitted;
+			uint64_t executed;
+			//! tasks a thread took from the deque of another
+			uint64_t stolen;
+			//! times a thread looked for work in every deque and found none
+			uint64_t failedSteals;
+		};
+
+		//! \param workerCount threads to create besides the ones which wait, 0 for one less than the hardware threads
+		explicit CTaskScheduler(uint32_t workerCount=0u);
+		//! Finishes all submitted tasks before returning, including the ones still waiting on dependencies
+		~CTaskScheduler();
+
+		CTaskScheduler(const CTaskScheduler&) = delete;
+		CTaskScheduler& operator=(const CTaskScheduler&) = delete;
+
+		//! Scheduler shared by the engine's subsystems, created with the default worker count on first use
+		static CTaskScheduler& getGlobal();
+
+		inline uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+		//! Runs `f()` on any thread
+		template<class F>
+		inline TaskHandle submit(F&& f)
+		{
+			return submitAfter(nullptr,0u,std::forward<F>(f));
+		}
+
+		//! Runs `f()` on any thread once all of `dependencies` finished, null handles are ignored
+		template<class F>
+		inline TaskHandle submitAfter(const TaskHandle* dependencies, uint32_t dependencyCount, F&& f)
+		{
+			TaskHandle retval(createTask(std::forward<F>(f)));
+			enqueueAfter(retval.task,dependencies,dependencyCount);
+			return retval;
+		}
+
+		//! Continuation, runs `f()` once `dependency` finished
+		template<class F>
+		inline TaskHandle then(const TaskHandle& dependency, F&& f)
+		{
+			return submitAfter(&dependency,1u,std::forward<F>(f));
+		}
+
+		//! Runs `f()` as a child of the task executing on this thread, which won't count as finished until `f` returned
+		/** Called outside of a task it is the same as `submit`. */
+		template<class F>
+		inline void spawnChild(F&& f)
+		{
+			enqueueChild(createTask(std::forward<F>(f)));
+		}
+
+		//! Executes other tasks until `task` finished
+		void wait(const TaskHandle& task);
+
+		//! Calls `f(rangeBegin,rangeEnd)` on disjoint subranges covering `[begin,end)`, in parallel
+		/** The range gets halved until it is at most `grain` long, the halves not processed right away can be stolen by other threads.
+		\param grain the longest subrange to call `f` with, 0 picks one giving every thread about 8 subranges */
+		template<class F>
+		inline TaskHandle parallelForAsync(uint32_t begin, uint32_t end, uint32_t grain, F&& f)
+		{
+			// an empty range still gives back a task to wait on, `f` just never gets called
+			if (begin>end)
+				end = begin;
+			if (!grain)
+				grain = core::max((end-begin)/((getWorkerCount()+1u)*8u),1u);
+
+			// children only keep a pointer to `f`, the root task keeps it alive until they all finished
+			typedef typename std::decay<F>::type Functor;
+			struct SRoot
+			{
+				CTaskScheduler* scheduler;
+				Functor f;
+				uint32_t begin, end, grain;
+
+				void operator()() const { scheduler->runRange(&f,begin,end,grain); }
+			};
+			return submit(SRoot{this,std::forward<F>(f),begin,end,grain});
+		}
+
+		//! Blocking version of `parallelForAsync`, the calling thread takes part
+		template<class F>
+		inline void parallelFor(uint32_t begin, uint32_t end, uint32_t grain, F&& f)
+		{
+			if (begin>=end)
+				return;
+			if (end-begin<=core::max(grain,1u))
+			{
+				f(begin,end);
+				return;
+			}
+			wait(parallelForAsync(begin,end,grain,std::forward<F>(f)));
+		}
+
+		SStatistics getStatistics() const;
+		void resetStatistics();
+
+	private:
+		template<class F>
+		class TaskImpl final : public Task
+		{
+			public:
+				template<class G>
+				TaskImpl(G&& _f) : f(std::forward<G>(_f)) {}
+
+			protected:
+				void execute() override { f(); }
+
+			private:
+				F f;
+		};
+
+		struct SThreadQueue;
+
+		template<class F>
+		static inline Task* createTask(F&& f)
+		{
+			// _IRR_NEW can't name a dependent type
+			typedef TaskImpl<typename std::decay<F>::type> TaskType;
+			return core::impl::AlignedWithAllocator<TaskType>::new_(_IRR_DEFAULT_ALIGNMENT(TaskType),_IRR_DEFAULT_ALLOCATOR_METATYPE<TaskType>(),std::forward<F>(f));
+		}
+
+		template<class F>
+		inline void runRange(const F* f, uint32_t begin, uint32_t end, uint32_t grain)
+		{
+			if (begin==end)
+				return;
+			while (end-begin>grain)
+			{
+				const uint32_t middle = begin+(end-begin)/2u;
+				spawnChild([this,f,middle,end,grain]() {runRange(f,middle,end,grain);});
+				end = middle;
+			}
+			(*f)(begin,end);
+		}
+
+		void enqueueAfter(Task* task, const TaskHandle* dependencies, uint32_t dependencyCount);
+		void enqueueChild(Task* task);
+		//! hands a task whose dependencies finished to the queue of this thread
+		void push(Task* task);
+		Task* findTask(SThreadQueue* queue);
+		void execute(Task* task);
+		//! counts down `unfinished`, on the last one marks the task done and releases its continuations
+		void finishOne(Task* task);
+		//! counts down `liveTasks`, waking up the workers of a scheduler being destroyed on the last one
+		void releaseLiveTask();
+		void workerLoop(SThreadQueue* queue);
+		SThreadQueue* getLocalQueue();
+
+		//! one per worker followed by the queue shared by all other threads
+		core::vector<SThreadQueue*> queues;
+		core::vector<std::thread> workers;
+
+		//! tasks in any queue, workers only sleep while it is 0
+		std::atomic<uint32_t> queuedTasks;
+		//! submitted tasks whose functor hasn't returned yet, including the ones waiting on dependencies, workers only quit once it is 0
+		std::atomic<uint32_t> liveTasks;
+		std::atomic<uint32_t> sleepingWorkers;
+		std::atomic<bool> stopping;
+		std::mutex sleepMutex;
+		std::condition_variable wakeUp;
+};
+
+} // end namespace core
+} // end namespace irr
+
+#endif
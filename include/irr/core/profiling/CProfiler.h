@@ -0,0 +1,113 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __C_PROFILER_H_INCLUDED__
+#define __C_PROFILER_H_INCLUDED__
+
+#include <atomic>
+#include <ostream>
+#include <string>
+
+#include "IrrCompileConfig.h"
+#include "irr/core/Types.h"
+#include "../source/Irrlicht/FW_Mutex.h"
+
+namespace irr
+{
+namespace core
+{
+
+//! Hierarchical CPU zone profiler, every thread records the zones it finishes into its own ring buffer
+/** Place zones with `IRR_PROFILE_SCOPE("name")` or `IRR_PROFILE_FUNCTION()`, the name is not copied so it has to be a string literal.
+Without `_IRR_COMPILE_WITH_PROFILER_` the macros expand to nothing, with it a zone costs one relaxed atomic load until
+recording gets enabled with `setEnabled(true)`, and two `FW_GetTimestampNs` calls plus a ring buffer write after.
+Each thread keeps the last `ThreadRingCapacity` zones. `exportChromeTrace`, `getSummary` and `clear` walk the rings of all threads,
+so call them while no zones are being recorded (i.e. between frames or after `setEnabled(false)`). */
+class CProfiler
+{
+	public:
+		_IRR_STATIC_INLINE_CONSTEXPR uint32_t ThreadRingCapacity = 0x1u<<16u;
+
+		struct SZone
+		{
+			const char* name;
+			uint64_t beginNs;
+			uint64_t endNs;
+			//! how many zones enclosed this one on its thread
+			uint32_t depth;
+		};
+		struct SZoneSummary
+		{
+			std::string name;
+			uint32_t calls;
+			uint64_t totalNs;
+			//! total time minus the time spent in directly nested zones
+			uint64_t selfNs;
+			uint64_t minNs;
+			uint64_t maxNs;
+		};
+
+		//! Zone recording is disabled by default
+		static void setEnabled(bool enabled);
+		static inline bool isEnabled() { return Enabled.load(std::memory_order_relaxed); }
+
+		//! Forgets all recorded zones
+		static void clear();
+
+		//! Writes all recorded zones in the Chrome trace event JSON format, opens in chrome://tracing and Perfetto
+		static void exportChromeTrace(std::ostream& out);
+
+		//! Per zone name statistics over all threads, sorted by total time
+		static core::vector<SZoneSummary> getSummary();
+
+		//! Writes `getSummary()` as a text table
+		static void printSummary(std::ostream& out);
+
+		//! RAII zone, use through the macros so it disappears when the profiler is compiled out
+		class ScopedZone
+		{
+			public:
+				ScopedZone(const char* _name) : name(_name), beginNs(0ull)
+				{
+					if (isEnabled())
+					{
+						beginZone();
+						beginNs = FW_GetTimestampNs();
+					}
+				}
+				~ScopedZone()
+				{
+					if (beginNs)
+						endZone(name,beginNs,FW_GetTimestampNs());
+				}
+
+				ScopedZone(const ScopedZone&) = delete;
+				ScopedZone& operator=(const ScopedZone&) = delete;
+
+			private:
+				const char* name;
+				uint64_t beginNs;
+		};
+
+	private:
+		static void beginZone();
+		static void endZone(const char* name, uint64_t beginNs, uint64_t endNs);
+
+		static std::atomic<bool> Enabled;
+};
+
+} // end namespace core
+} // end namespace irr
+
+#define _IRR_PROFILE_CONCAT_IMPL(X,Y) X##Y
+#define _IRR_PROFILE_CONCAT(X,Y) _IRR_PROFILE_CONCAT_IMPL(X,Y)
+#ifdef _IRR_COMPILE_WITH_PROFILER_
+	#define IRR_PROFILE_SCOPE(NAME) irr::core::CProfiler::ScopedZone _IRR_PROFILE_CONCAT(_irrProfileZone,__LINE__)(NAME)
+	#define IRR_PROFILE_FUNCTION() IRR_PROFILE_SCOPE(__FUNCTION__)
+#else
+	#define IRR_PROFILE_SCOPE(NAME)
+	#define IRR_PROFILE_FUNCTION()
+#endif
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef _IRR_CORE_HASHED_OWEN_SAMPLER_H_
+#define _IRR_CORE_HASHED_OWEN_SAMPLER_H_
+
+#include "irr/core/sampling/SobolSampler.h"
+
+namespace irr
+{
+namespace core
+{
+
+	//! Stateless Owen scrambling, every method is const so one instance can be shared between threads
+	/** Unlike `OwenSampler` there is no cached flip tree, so dimensions can be visited in any order without `resetDimensionCounter`.
+	Scrambling is the nested uniform scramble from "Practical Hash-based Owen Scrambling" (Burley 2020),
+	it produces different (but equally well distributed) values than `OwenSampler` for the same seed. */
+	template<class SequenceSampler=SobolSampler>
+	class HashedOwenSampler : protected SequenceSampler
+	{
+	public:
+		HashedOwenSampler(uint32_t _dimensions, uint32_t _seed) : SequenceSampler(_dimensions), seed(hash(_seed))
+		{
+		}
+		~HashedOwenSampler()
+		{
+		}
+
+		//
+		inline uint32_t sample(uint32_t dim, uint32_t sampleNum) const
+		{
+			return scramble(SequenceSampler::sample(dim,sampleNum),getDimensionSeed(dim));
+		}
+
+		//! Writes `sample(dim,firstSample+i)` to `out[i*outStride]` for all `i<sampleCount`
+		inline void sampleRange(uint32_t* out, uint32_t dim, uint32_t firstSample, uint32_t sampleCount, uint32_t outStride=1u) const
+		{
+			SequenceSampler::sampleRange(out,dim,firstSample,sampleCount,outStride);
+
+			const uint32_t dimSeed = getDimensionSeed(dim);
+			for (uint32_t i=0u; i<sampleCount; i++)
+			{
+				auto& value = out[i*outStride];
+				value = scramble(value,dimSeed);
+			}
+		}
+
+		//! Writes `sample(firstDim+j,firstSample+i)` to `out[i*outStride+j]` for all `j<dimCount` and `i<sampleCount`
+		inline void sampleRange(uint32_t* out, uint32_t firstDim, uint32_t dimCount, uint32_t firstSample, uint32_t sampleCount, uint32_t outStride) const
+		{
+			SequenceSampler::sampleRange(out,firstDim,dimCount,firstSample,sampleCount,outStride);
+
+			uint32_t j=0u;
+			#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+			for (; j+4u<=dimCount; j+=4u)
+			{
+				const __m128i dimSeeds = _mm_setr_epi32(getDimensionSeed(firstDim+j),getDimensionSeed(firstDim+j+1u),getDimensionSeed(firstDim+j+2u),getDimensionSeed(firstDim+j+3u));
+				uint32_t* outIt = out+j;
+				for (uint32_t i=0u; i<sampleCount; i++,outIt+=outStride)
+				{
+					__m128i* ptr = reinterpret_cast<__m128i*>(outIt);
+					_mm_storeu_si128(ptr,scramble(_mm_loadu_si128(ptr),dimSeeds));
+				}
+			}
+			#endif
+			for (; j<dimCount; j++)
+			{
+				const uint32_t dimSeed = getDimensionSeed(firstDim+j);
+				for (uint32_t i=0u; i<sampleCount; i++)
+				{
+					auto& value = out[i*outStride+j];
+					value = scramble(value,dimSeed);
+				}
+			}
+		}
+
+	protected:
+		// lowbias32 by Chris Wellons
+		static inline uint32_t hash(uint32_t x)
+		{
+			x ^= x>>16u;
+			x *= 0x7feb352du;
+			x ^= x>>15u;
+			x *= 0x846ca68bu;
+			x ^= x>>16u;
+			return x;
+		}
+		inline uint32_t getDimensionSeed(uint32_t dim) const
+		{
+			return hash(seed^hash(dim));
+		}
+
+		static inline uint32_t reverseBits(uint32_t x)
+		{
+			x = ((x>>1u)&0x55555555u)|((x&0x55555555u)<<1u);
+			x = ((x>>2u)&0x33333333u)|((x&0x33333333u)<<2u);
+			x = ((x>>4u)&0x0f0f0f0fu)|((x&0x0f0f0f0fu)<<4u);
+			x = ((x>>8u)&0x00ff00ffu)|((x&0x00ff00ffu)<<8u);
+			return (x>>16u)|(x<<16u);
+		}
+		// Laine-Karras style permutation, every bit only depends on the bits below it
+		static inline uint32_t laineKarrasPermutation(uint32_t x, uint32_t dimSeed)
+		{
+			x += dimSeed;
+			x ^= x*0x6c50b47cu;
+			x ^= x*0xb82f1e52u;
+			x ^= x*0xc7afe638u;
+			x ^= x*0x8d22f6e6u;
+			return x;
+		}
+		// our samples are fixed point with the most significant bit being the first binary digit, hence the reversals
+		static inline uint32_t scramble(uint32_t oldsample, uint32_t dimSeed)
+		{
+			return reverseBits(laineKarrasPermutation(reverseBits(oldsample),dimSeed));
+		}
+
+		#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+		static inline __m128i reverseBits(__m128i x)
+		{
+			const __m128i byteSwap = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+			const __m128i nibbleMask = _mm_set1_epi8(0x0f);
+			const __m128i reversedLoNibble = _mm_setr_epi8(0x00,0x80,0x40,0xc0,0x20,0xa0,0x60,0xe0,0x10,0x90,0x50,0xd0,0x30,0xb0,0x70,0xf0);
+			const __m128i reversedHiNibble = _mm_setr_epi8(0x0,0x8,0x4,0xc,0x2,0xa,0x6,0xe,0x1,0x9,0x5,0xd,0x3,0xb,0x7,0xf);
+
+			x = _mm_shuffle_epi8(x,byteSwap);
+			const __m128i lo = _mm_and_si128(x,nibbleMask);
+			const __m128i hi = _mm_and_si128(_mm_srli_epi16(x,4),nibbleMask);
+			return _mm_or_si128(_mm_shuffle_epi8(reversedLoNibble,lo),_mm_shuffle_epi8(reversedHiNibble,hi));
+		}
+		static inline __m128i laineKarrasPermutation(__m128i x, __m128i dimSeeds)
+		{
+			x = _mm_add_epi32(x,dimSeeds);
+			x = _mm_xor_si128(x,_mm_mullo_epi32(x,_mm_set1_epi32(0x6c50b47cu)));
+			x = _mm_xor_si128(x,_mm_mullo_epi32(x,_mm_set1_epi32(0xb82f1e52u)));
+			x = _mm_xor_si128(x,_mm_mullo_epi32(x,_mm_set1_epi32(0xc7afe638u)));
+			x = _mm_xor_si128(x,_mm_mullo_epi32(x,_mm_set1_epi32(0x8d22f6e6u)));
+			return x;
+		}
+		static inline __m128i scramble(__m128i oldsamples, __m128i dimSeeds)
+		{
+			return reverseBits(laineKarrasPermutation(reverseBits(oldsamples),dimSeeds));
+		}
+		#endif
+
+		uint32_t seed;
+	};
+
+
+}
+}
+
+#endif // _IRR_CORE_HASHED_OWEN_SAMPLER_H_
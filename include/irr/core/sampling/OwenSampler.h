@@ -40,11 +40,26 @@ namespace core
 				else
 					assert(oldsample == 0u);
 			#endif
-			constexpr uint32_t lastLevelStart = MAX_SAMPLES/2u-1u;
-			uint32_t index = oldsample>>(OUT_BITS+1u - MAX_SAMPLES_LOG2);
-			index += lastLevelStart;
+			return scramble(oldsample);
+		}
 
-			return oldsample^cachedFlip[index];
+		//! Bulk version of `sample`, writes `sample(dim,firstSample+i)` to `out[i*outStride]` for all `i<sampleCount`
+		inline void sampleRange(uint32_t* out, uint32_t dim, uint32_t firstSample, uint32_t sampleCount, uint32_t outStride=1u)
+		{
+			if (dim>lastDim)
+				resetDimensionCounter(dim);
+			else if (dim<lastDim)
+				assert(false);
+
+			#ifdef _IRR_DEBUG
+				assert(firstSample+sampleCount<=MAX_SAMPLES);
+			#endif
+			SequenceSampler::sampleRange(out,dim,firstSample,sampleCount,outStride);
+			for (uint32_t i=0u; i<sampleCount; i++)
+			{
+				auto& value = out[i*outStride];
+				value = scramble(value);
+			}
 		}
 
 		//!
@@ -93,6 +108,15 @@ namespace core
 			return core::findMSB(sampleNum+1u);
 		}
 
+		inline uint32_t scramble(uint32_t oldsample) const
+		{
+			constexpr uint32_t lastLevelStart = MAX_SAMPLES/2u-1u;
+			uint32_t index = oldsample>>(OUT_BITS+1u - MAX_SAMPLES_LOG2);
+			index += lastLevelStart;
+
+			return oldsample^cachedFlip[index];
+		}
+
 		std::mt19937 mersenneTwister;
 		uint32_t lastDim;
 		core::vector<uint32_t> cachedFlip;
@@ -66,7 +66,8 @@ class SobolSampler
 
 		SobolSampler(uint32_t _dimensions) : dimensions(_dimensions)
 		{
-			directions = _IRR_ALIGNED_MALLOC(dimensions*SOBOL_BITS*sizeof(uint32_t), 64u);
+			// second half of the allocation holds the prefix XORs of the direction vectors for `sampleRange`
+			directions = _IRR_ALIGNED_MALLOC(dimensions*SOBOL_BITS*sizeof(uint32_t)*2u, 64u);
 			generate_direction_vectors();
 		}
 		~SobolSampler()
@@ -75,12 +76,12 @@ class SobolSampler
 		}
 		
 		// Idea for optimization, do PoT samples per pass, then can precompute most of the `retval`
-		inline uint32_t sample(uint32_t dim, uint32_t sampleNum)
+		inline uint32_t sample(uint32_t dim, uint32_t sampleNum) const
 		{
 			#ifdef _DEBUG
 				assert(dim<dimensions);
 			#endif
-			auto vectors = *reinterpret_cast<uint32_t(*)[][SOBOL_BITS]>(directions);
+			auto vectors = *reinterpret_cast<const uint32_t(*)[][SOBOL_BITS]>(directions);
 
 			uint32_t retval = (sampleNum & 0x1u) ? vectors[dim][0] : 0u;
 			for (uint32_t i=1u; i<SOBOL_BITS; i++)
@@ -89,6 +90,74 @@ class SobolSampler
 			return retval;
 		}
 
+		//! Writes `sample(dim,firstSample+i)` to `out[i*outStride]` for all `i<sampleCount`
+		/** Same trick as Gray Code enumeration, going from `sampleNum` to `sampleNum+1` flips bits [0,findLSB(sampleNum+1)],
+		so XOR-ing with a precomputed prefix XOR of the direction vectors costs one XOR per sample while keeping the natural order. */
+		inline void sampleRange(uint32_t* out, uint32_t dim, uint32_t firstSample, uint32_t sampleCount, uint32_t outStride=1u) const
+		{
+			#ifdef _DEBUG
+				assert(dim<dimensions);
+				assert(sampleCount==0u || firstSample+(sampleCount-1u)>=firstSample); // no overflow
+			#endif
+			if (!sampleCount)
+				return;
+
+			auto deltas = getDeltaVectors()[dim];
+			uint32_t retval = sample(dim,firstSample);
+			*out = retval;
+			for (uint32_t i=1u; i<sampleCount; i++)
+			{
+				retval ^= deltas[core::findLSB(firstSample+i)];
+				out[i*outStride] = retval;
+			}
+		}
+
+		//! Writes `sample(firstDim+j,firstSample+i)` to `out[i*outStride+j]` for all `j<dimCount` and `i<sampleCount`
+		/** Dimensions are processed 8 at a time in SIMD registers, `outStride` needs to be at least `dimCount`.*/
+		inline void sampleRange(uint32_t* out, uint32_t firstDim, uint32_t dimCount, uint32_t firstSample, uint32_t sampleCount, uint32_t outStride) const
+		{
+			#ifdef _DEBUG
+				assert(firstDim+dimCount<=dimensions);
+				assert(outStride>=dimCount);
+			#endif
+			if (!sampleCount)
+				return;
+
+			uint32_t j=0u;
+			#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+			auto deltas = getDeltaVectors();
+			for (; j+8u<=dimCount; j+=8u)
+			{
+				const uint32_t dim = firstDim+j;
+
+				// transpose the delta vectors of 8 dimensions, so a single sample advances with 2 XORs
+				__m128i transposed[SOBOL_BITS][2];
+				for (uint32_t k=0u; k<SOBOL_BITS; k++)
+				{
+					transposed[k][0] = _mm_setr_epi32(deltas[dim+0u][k],deltas[dim+1u][k],deltas[dim+2u][k],deltas[dim+3u][k]);
+					transposed[k][1] = _mm_setr_epi32(deltas[dim+4u][k],deltas[dim+5u][k],deltas[dim+6u][k],deltas[dim+7u][k]);
+				}
+
+				__m128i lo = _mm_setr_epi32(sample(dim+0u,firstSample),sample(dim+1u,firstSample),sample(dim+2u,firstSample),sample(dim+3u,firstSample));
+				__m128i hi = _mm_setr_epi32(sample(dim+4u,firstSample),sample(dim+5u,firstSample),sample(dim+6u,firstSample),sample(dim+7u,firstSample));
+				uint32_t* outIt = out+j;
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(outIt),lo);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(outIt+4u),hi);
+				for (uint32_t i=1u; i<sampleCount; i++)
+				{
+					const auto& delta = transposed[core::findLSB(firstSample+i)];
+					lo = _mm_xor_si128(lo,delta[0]);
+					hi = _mm_xor_si128(hi,delta[1]);
+					outIt += outStride;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(outIt),lo);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(outIt+4u),hi);
+				}
+			}
+			#endif
+			for (; j<dimCount; j++)
+				sampleRange(out+j,firstDim+j,firstSample,sampleCount,outStride);
+		}
+
 	protected:
 		typedef struct SobolDirectionNumbers {
 			uint32_t d, s, a;
@@ -8296,6 +8365,11 @@ class SobolSampler
 		uint32_t dimensions;
 		void* directions;
 
+		inline const uint32_t (&getDeltaVectors() const)[][SOBOL_BITS]
+		{
+			return *reinterpret_cast<const uint32_t(*)[][SOBOL_BITS]>(reinterpret_cast<const uint32_t*>(directions)+dimensions*SOBOL_BITS);
+		}
+
 		void generate_direction_vectors()
 		{
 			assert(dimensions <= SOBOL_MAX_DIMENSIONS);
@@ -8341,6 +8415,14 @@ class SobolSampler
 						assert((v[i]&(0x7fffffffu>>i)) == 0u);
 				#endif
 			}
+
+			auto deltas = *reinterpret_cast<uint32_t(*)[][SOBOL_BITS]>(reinterpret_cast<uint32_t*>(directions)+dimensions*SOBOL_BITS);
+			for(uint32_t dim=0u; dim<dimensions; dim++)
+			{
+				deltas[dim][0] = vectors[dim][0];
+				for(uint32_t i=1u; i<L; i++)
+					deltas[dim][i] = deltas[dim][i-1u]^vectors[dim][i];
+			}
 		}
 };
 
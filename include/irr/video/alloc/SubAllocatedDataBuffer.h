@@ -66,54 +66,80 @@ class SubAllocatedDataBuffer : public virtual core::IReferenceCounted, protected
         {
             private:
                 ThisType*   sadbRef;
+                //! addresses in the first `capacity` entries, sizes in the next `capacity`
                 size_type*  rangeData;
                 size_type   numAllocs;
+                size_type   capacity;
+
+                inline void freeRangeData()
+                {
+                    if (rangeData)
+                    {
+                        auto alloctr = sadbRef->getFunctorAllocator();
+                        alloctr.deallocate(reinterpret_cast<typename std::remove_pointer<decltype(alloctr)>::type::pointer>(rangeData),capacity);
+                    }
+                }
             public:
                 DefaultDeferredFreeFunctor(ThisType* _this, size_type numAllocsToFree, const size_type* addrs, const size_type* bytes)
-                                                    : sadbRef(_this), rangeData(nullptr), numAllocs(numAllocsToFree)
+                                                    : sadbRef(_this), rangeData(nullptr), numAllocs(numAllocsToFree), capacity(numAllocsToFree)
                 {
-                    rangeData = reinterpret_cast<size_type*>(sadbRef->getFunctorAllocator().allocate(numAllocs,sizeof(size_type)));
+                    rangeData = reinterpret_cast<size_type*>(sadbRef->getFunctorAllocator().allocate(capacity,sizeof(size_type)));
                     memcpy(rangeData            ,addrs,sizeof(size_type)*numAllocs);
-                    memcpy(rangeData+numAllocs  ,bytes,sizeof(size_type)*numAllocs);
+                    memcpy(rangeData+capacity   ,bytes,sizeof(size_type)*numAllocs);
                 }
                 DefaultDeferredFreeFunctor(const DefaultDeferredFreeFunctor& other) = delete;
-                DefaultDeferredFreeFunctor(DefaultDeferredFreeFunctor&& other) : sadbRef(nullptr), rangeData(nullptr), numAllocs(0u)
+                DefaultDeferredFreeFunctor(DefaultDeferredFreeFunctor&& other) : sadbRef(nullptr), rangeData(nullptr), numAllocs(0u), capacity(0u)
                 {
                     this->operator=(std::forward<DefaultDeferredFreeFunctor>(other));
                 }
 
                 ~DefaultDeferredFreeFunctor()
                 {
-                    if (rangeData)
-                    {
-                        auto alloctr = sadbRef->getFunctorAllocator();
-                        alloctr.deallocate(reinterpret_cast<typename std::remove_pointer<decltype(alloctr)>::type::pointer>(rangeData),numAllocs);
-                    }
+                    freeRangeData();
                 }
 
                 DefaultDeferredFreeFunctor& operator=(const DefaultDeferredFreeFunctor& other) = delete;
                 inline DefaultDeferredFreeFunctor& operator=(DefaultDeferredFreeFunctor&& other)
                 {
-                    if (rangeData)
-                    {
-                        auto alloctr = sadbRef->getFunctorAllocator();
-                        alloctr.deallocate(reinterpret_cast<typename std::remove_pointer<decltype(alloctr)>::type::pointer>(rangeData),numAllocs);
-                    }
+                    freeRangeData();
                     sadbRef    = other.sadbRef;
                     rangeData   = other.rangeData;
                     numAllocs   = other.numAllocs;
+                    capacity    = other.capacity;
                     other.sadbRef  = nullptr;
                     other.rangeData = nullptr;
                     other.numAllocs = 0u;
+                    other.capacity = 0u;
                     return *this;
                 }
 
+                //! Takes over the ranges of another functor deferred on the same fence, so they get freed with one `multi_free_addr`
+                /** The storage grows geometrically, so absorbing n frees costs O(n) in total. */
+                inline void absorb(DefaultDeferredFreeFunctor&& other)
+                {
+                    const size_type totalAllocs = numAllocs+other.numAllocs;
+                    if (totalAllocs>capacity)
+                    {
+                        auto alloctr = sadbRef->getFunctorAllocator();
+                        const size_type newCapacity = core::max(totalAllocs,capacity*2u);
+                        size_type* grown = reinterpret_cast<size_type*>(alloctr.allocate(newCapacity,sizeof(size_type)));
+                        memcpy(grown                ,rangeData          ,sizeof(size_type)*numAllocs);
+                        memcpy(grown+newCapacity    ,rangeData+capacity ,sizeof(size_type)*numAllocs);
+                        freeRangeData();
+                        rangeData = grown;
+                        capacity = newCapacity;
+                    }
+                    memcpy(rangeData+numAllocs          ,other.rangeData                ,sizeof(size_type)*other.numAllocs);
+                    memcpy(rangeData+capacity+numAllocs ,other.rangeData+other.capacity ,sizeof(size_type)*other.numAllocs);
+                    numAllocs = totalAllocs;
+                }
+
                 inline bool operator()(size_type& unallocatedSize)
                 {
                     operator()();
                     for (size_type i=0u; i<numAllocs; i++)
                     {
-                        auto freedSize = rangeData[numAllocs+i];
+                        auto freedSize = rangeData[capacity+i];
                         if (unallocatedSize>freedSize)
                             unallocatedSize -= freedSize;
                         else
@@ -131,12 +157,13 @@ class SubAllocatedDataBuffer : public virtual core::IReferenceCounted, protected
                     assert(sadbRef && rangeData);
                     #endif // _IRR_DEBUG
                     HeterogenousMemoryAddressAllocator& alloctr = sadbRef->getAllocator();
-                    alloctr.multi_free_addr(numAllocs,rangeData,rangeData+numAllocs);
+                    alloctr.multi_free_addr(numAllocs,rangeData,rangeData+capacity);
                 }
         };
         constexpr static bool UsingDefaultFunctor = std::is_same<CustomDeferredFreeFunctor,void>::value;
         typedef typename std::conditional<UsingDefaultFunctor,DefaultDeferredFreeFunctor,CustomDeferredFreeFunctor>::type DeferredFreeFunctor;
-        GPUEventDeferredHandlerST<DeferredFreeFunctor> deferredFrees;
+        // fences are signalled in submission order, so only the oldest one needs polling
+        GPUEventTimelineDeferredHandlerST<DeferredFreeFunctor> deferredFrees;
         core::allocator<std::tuple<size_type,size_type> > functorAllocator; // TODO : RobustGeneralpurposeAllocator a-la naughty dog, unbounded allocation, but without resize, use blocks
 
     public:
@@ -67,6 +67,7 @@
 #include "IMaterialRendererServices.h"
 #include "IMeshSceneNode.h"
 #include "IMeshSceneNodeInstanced.h"
+#include "IOcclusionCuller.h"
 #include "IOSOperator.h"
 #include "IReadFile.h"
 #include "IrrlichtDevice.h"
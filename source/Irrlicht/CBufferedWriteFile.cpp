@@ -0,0 +1,175 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#include "CBufferedWriteFile.h"
+#include "os.h"
+
+#include <cstring>
+
+namespace irr
+{
+namespace io
+{
+
+
+CBufferedWriteFile::CBufferedWriteFile(IWriteFile* file, uint32_t bufferSize, bool writeBehind)
+	: File(file), BufferSize(core::max(bufferSize,1u)), Active(0u), Pos(file->getPos()), WriteFailed(false),
+	WriteBehind(writeBehind), Pending(~0u), Quit(false)
+{
+	#ifdef _IRR_DEBUG
+	setDebugName("CBufferedWriteFile");
+	#endif
+
+	File->grab();
+	Buffers[0].data.resize(BufferSize);
+	if (WriteBehind)
+	{
+		Buffers[1].data.resize(BufferSize);
+		Writer = std::thread(&CBufferedWriteFile::writerThread,this);
+	}
+}
+
+
+
+CBufferedWriteFile::~CBufferedWriteFile()
+{
+	flushActive();
+	if (WriteBehind)
+	{
+		{
+			std::unique_lock<std::mutex> lock(Mutex);
+			waitForPending(lock);
+			Quit = true;
+		}
+		Cond.notify_all();
+		Writer.join();
+	}
+	File->drop();
+}
+
+
+
+int32_t CBufferedWriteFile::write(const void* buffer, uint32_t sizeToWrite)
+{
+	if (WriteFailed.load(std::memory_order_relaxed))
+		return 0;
+
+	// anything which does not touch or continue the window starts a new one
+	if (Buffers[Active].size && (Pos<Buffers[Active].fileOffset || Pos>Buffers[Active].fileOffset+Buffers[Active].size))
+		flushActive();
+
+	const uint8_t* src = reinterpret_cast<const uint8_t*>(buffer);
+	size_t remaining = sizeToWrite;
+	while (remaining)
+	{
+		SBuffer& active = Buffers[Active];
+		if (!active.size)
+			active.fileOffset = Pos;
+
+		const size_t offsetInBuffer = Pos-active.fileOffset;
+		if (offsetInBuffer==BufferSize)
+		{
+			flushActive();
+			continue;
+		}
+
+		const size_t count = core::min(remaining,BufferSize-offsetInBuffer);
+		memcpy(active.data.data()+offsetInBuffer,src,count);
+		active.size = core::max(active.size,offsetInBuffer+count);
+		Pos += count;
+		src += count;
+		remaining -= count;
+	}
+	return static_cast<int32_t>(sizeToWrite);
+}
+
+
+
+bool CBufferedWriteFile::seek(const size_t& finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+	{
+		// negative movements come in wrapped around
+		const size_t newPos = Pos+finalPos;
+		if (finalPos>(~size_t(0u)>>1u) && newPos>Pos)
+			return false;
+		Pos = newPos;
+	}
+	else
+		Pos = finalPos;
+	return true;
+}
+
+
+
+void CBufferedWriteFile::flushActive()
+{
+	SBuffer& active = Buffers[Active];
+	if (!active.size)
+		return;
+
+	if (WriteBehind)
+	{
+		{
+			std::unique_lock<std::mutex> lock(Mutex);
+			waitForPending(lock);
+			Pending = Active;
+		}
+		Cond.notify_all();
+		Active ^= 1u;
+	}
+	else
+		writeOut(active);
+	Buffers[Active].size = 0u;
+}
+
+
+
+void CBufferedWriteFile::waitForPending(std::unique_lock<std::mutex>& lock)
+{
+	Cond.wait(lock,[this]() {return Pending==~0u;});
+}
+
+
+
+void CBufferedWriteFile::writeOut(SBuffer& buffer)
+{
+	if (WriteFailed.load(std::memory_order_relaxed))
+		return;
+
+	const int32_t expected = static_cast<int32_t>(buffer.size);
+	if (!File->seek(buffer.fileOffset) || File->write(buffer.data.data(),static_cast<uint32_t>(buffer.size))!=expected)
+	{
+		os::Printer::log("Could not write to file", File->getFileName().c_str(), ELL_ERROR);
+		WriteFailed.store(true,std::memory_order_relaxed);
+	}
+	buffer.size = 0u;
+}
+
+
+
+void CBufferedWriteFile::writerThread()
+{
+	std::unique_lock<std::mutex> lock(Mutex);
+	for (;;)
+	{
+		Cond.wait(lock,[this]() {return Pending!=~0u||Quit;});
+		if (Pending!=~0u)
+		{
+			SBuffer& buffer = Buffers[Pending];
+			lock.unlock();
+			writeOut(buffer);
+			lock.lock();
+			Pending = ~0u;
+			Cond.notify_all();
+		}
+		else
+			return;
+	}
+}
+
+
+} // end namespace io
+} // end namespace irr
+
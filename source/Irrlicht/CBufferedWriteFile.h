@@ -0,0 +1,87 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __C_BUFFERED_WRITE_FILE_H_INCLUDED__
+#define __C_BUFFERED_WRITE_FILE_H_INCLUDED__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "IWriteFile.h"
+#include "irr/core/core.h"
+
+namespace irr
+{
+
+namespace io
+{
+
+	/*!
+		Gathers small writes into a large buffer before passing them on to another IWriteFile.
+		The buffer covers a contiguous window of the file, seeking and writing anywhere inside of it
+		(or right at its end) never touches the file, so patching a header which was just written is free.
+		With write-behind a full buffer is written by a background thread while the other one fills up.
+		A failed write is only noticed once the buffer gets flushed, after that all writes return 0.
+	*/
+	class CBufferedWriteFile : public IWriteFile
+	{
+        protected:
+            virtual ~CBufferedWriteFile();
+
+        public:
+            //! The file gets grabbed, and must not be used directly anymore
+            CBufferedWriteFile(IWriteFile* file, uint32_t bufferSize, bool writeBehind);
+
+            //! buffers the bytes, writes out the buffer first if they don't continue its window
+            virtual int32_t write(const void* buffer, uint32_t sizeToWrite) override;
+
+            //! only moves the position, returns false if it would go before the start of the file
+            virtual bool seek(const size_t& finalPos, bool relativeMovement = false) override;
+
+            //! Returns the current position in the file.
+            virtual size_t getPos() const override { return Pos; }
+
+            //! Returns name of file.
+            virtual const io::path& getFileName() const override { return File->getFileName(); }
+
+        private:
+            struct SBuffer
+            {
+                core::vector<uint8_t> data;
+                //! where in the file `data[0]` goes
+                size_t fileOffset = 0u;
+                //! bytes of `data` in use
+                size_t size = 0u;
+            };
+
+            //! hands the active buffer over to be written and empties it
+            void flushActive();
+            //! waits for the background write to finish, if there is one, `lock` must hold `Mutex`
+            void waitForPending(std::unique_lock<std::mutex>& lock);
+            void writeOut(SBuffer& buffer);
+            void writerThread();
+
+            IWriteFile* File;
+            const size_t BufferSize;
+            SBuffer Buffers[2];
+            uint32_t Active;
+            size_t Pos;
+            std::atomic<bool> WriteFailed;
+
+            const bool WriteBehind;
+            std::thread Writer;
+            std::mutex Mutex;
+            std::condition_variable Cond;
+            //! index of the buffer the background thread is writing, or ~0u
+            uint32_t Pending;
+            bool Quit;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
+
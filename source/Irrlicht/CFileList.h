@@ -37,7 +37,7 @@ class CFileList : public IFileList
         virtual uint32_t getFileCount() const override {return Files.size();}
 
         //!
-        inline const core::vector<SFileListEntry>& getFilesReference() const {return Files;}
+        virtual const core::vector<SFileListEntry>& getFilesReference() const override {return Files;}
 
         //!
         virtual core::vector<SFileListEntry> getFiles() const override {return Files;}
@@ -6,6 +6,7 @@
 #include <list>
 #include "CFileSystem.h"
 #include "CReadFile.h"
+#include "CMappedReadFile.h"
 #include "IWriteFile.h"
 #include "CZipReader.h"
 #include "CMountPointReader.h"
@@ -16,6 +17,7 @@
 #include "os.h"
 #include "CMemoryFile.h"
 #include "CLimitReadFile.h"
+#include "CBufferedWriteFile.h"
 
 
 #if defined (_IRR_WINDOWS_API_)
@@ -42,8 +44,57 @@ namespace irr
 namespace io
 {
 
+namespace
+{
+	//! file lists have forward slashes and compare paths without case
+	inline uint32_t normalizePathChar(char c)
+	{
+		return c=='\\' ? '/':core::locale_lower(c);
+	}
+
+	//! FNV-1a of the normalized path
+	inline size_t hashPath(const char* filename, size_t length)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (size_t i=0u; i<length; i++)
+		{
+			hash ^= normalizePathChar(filename[i]);
+			hash *= 0x100000001b3ull;
+		}
+		return static_cast<size_t>(hash);
+	}
+
+	inline bool pathsEqual(const char* filename, size_t length, const io::path& other)
+	{
+		if (length!=other.size())
+			return false;
+		for (size_t i=0u; i<length; i++)
+		if (normalizePathChar(filename[i])!=normalizePathChar(other[i]))
+			return false;
+		return true;
+	}
+
+	inline bool isSlash(char c) {return c=='/' || c=='\\';}
+
+	//! "." and ".." segments and doubled slashes get flattened by some archives, the index doesn't do that
+	inline bool needsFlattening(const char* filename, size_t length)
+	{
+		for (size_t i=0u; i<length; i++)
+		{
+			if (i && isSlash(filename[i]) && isSlash(filename[i-1u]))
+				return true;
+			if (filename[i]!='.' || (i && !isSlash(filename[i-1u])))
+				continue;
+			const size_t next = i+1u<length && filename[i+1u]=='.' ? i+2u:i+1u;
+			if (next==length || isSlash(filename[next]))
+				return true;
+		}
+		return false;
+	}
+}
+
 //! constructor
-CFileSystem::CFileSystem()
+CFileSystem::CFileSystem() : WriteBufferSize(0x1u<<20u), WriteBehind(false)
 {
 	#ifdef _IRR_DEBUG
 	setDebugName("CFileSystem");
@@ -93,13 +144,22 @@ CFileSystem::~CFileSystem()
 IReadFile* CFileSystem::createAndOpenFile(const io::path& filename)
 {
 	IReadFile* file = 0;
-	uint32_t i;
 
-	for (i=0; i< FileArchives.size(); ++i)
+	if (needsFlattening(filename.c_str(),filename.size()))
 	{
-		file = FileArchives[i]->createAndOpenFile(filename);
-		if (file)
-			return file;
+		for (uint32_t i=0; i< FileArchives.size(); ++i)
+		{
+			file = FileArchives[i]->createAndOpenFile(filename);
+			if (file)
+				return file;
+		}
+	}
+	else
+	{
+		const SFileListEntry* entry;
+		IFileArchive* archive = findFileInArchives(filename.c_str(),filename.size(),&entry);
+		if (archive)
+			return archive->createAndOpenListedFile(*entry);
 	}
 
 	// Create the file using an absolute path so that it matches
@@ -113,6 +173,22 @@ IReadFile* CFileSystem::createAndOpenFile(const io::path& filename)
 }
 
 
+//! opens a file for read access through a mapping of it
+IReadFile* CFileSystem::createMappedReadFile(const io::path& filename)
+{
+	// archives give out files of their own
+	if (needsFlattening(filename.c_str(),filename.size()) || findFileInArchives(filename.c_str(),filename.size()))
+		return createAndOpenFile(filename);
+
+	CMappedReadFile* file = new CMappedReadFile(getAbsolutePath(filename));
+	if (file->isOpen())
+		return file;
+
+	file->drop();
+	return createAndOpenFile(filename);
+}
+
+
 //! Creates an IReadFile interface for treating memory like a file.
 IReadFile* CFileSystem::createMemoryReadFile(const void* contents, size_t len, const io::path& fileName)
 {
@@ -144,7 +220,22 @@ IWriteFile* CFileSystem::createMemoryWriteFile(size_t len, const io::path& fileN
 //! Opens a file for write access.
 IWriteFile* CFileSystem::createAndWriteFile(const io::path& filename, bool append)
 {
-	return createWriteFile(filename, append);
+	IWriteFile* file = createWriteFile(filename, append);
+	// appended writes land at the end no matter where the file was seeked to, a buffer window would break that
+	if (!file || append || WriteBufferSize==0u)
+		return file;
+
+	IWriteFile* buffered = new CBufferedWriteFile(file, WriteBufferSize, WriteBehind);
+	file->drop();
+	return buffered;
+}
+
+
+//! Sets up how files opened by createAndWriteFile buffer their writes.
+void CFileSystem::setWriteBuffering(uint32_t bufferSize, bool writeBehind)
+{
+	WriteBufferSize = bufferSize;
+	WriteBehind = writeBehind;
 }
 
 
@@ -192,6 +283,8 @@ bool CFileSystem::moveFileArchive(uint32_t sourceIndex, int32_t relative)
 		FileArchives[s] = t;
 		r = true;
 	}
+	if (r)
+		rebuildArchiveIndex();
 	return r;
 }
 
@@ -288,6 +381,7 @@ bool CFileSystem::addFileArchive(const io::path& filename, E_FILE_ARCHIVE_TYPE a
 	if (archive)
 	{
 		FileArchives.push_back(archive);
+		indexArchive(archive);
 		if (password.size())
 			archive->Password=password;
 		if (retArchive)
@@ -392,6 +486,7 @@ bool CFileSystem::addFileArchive(IReadFile* file, E_FILE_ARCHIVE_TYPE archiveTyp
 		if (archive)
 		{
 			FileArchives.push_back(archive);
+			indexArchive(archive);
 			if (password.size())
 				archive->Password=password;
 			if (retArchive)
@@ -417,6 +512,7 @@ bool CFileSystem::addFileArchive(IFileArchive* archive)
 			return false;
 	}
 	FileArchives.push_back(archive);
+	indexArchive(archive);
 	return true;
 }
 
@@ -430,6 +526,7 @@ bool CFileSystem::removeFileArchive(uint32_t index)
 	    auto it = FileArchives.begin()+index;
 		(*it)->drop();
 		FileArchives.erase(it);
+		rebuildArchiveIndex();
 		ret = true;
 	}
 
@@ -853,9 +950,59 @@ IFileList* CFileSystem::createEmptyFileList(const io::path& path)
 }
 
 
+void CFileSystem::indexArchive(IFileArchive* archive)
+{
+	const IFileList* list = archive->getFileList();
+	ArchiveIndex.reserve(ArchiveIndex.size()+list->getFileCount());
+	for (const auto& entry : list->getFilesReference())
+	{
+		if (entry.IsDirectory)
+			continue;
+
+		// archives added earlier take precedence
+		const size_t hash = hashPath(entry.FullName.c_str(),entry.FullName.size());
+		auto range = ArchiveIndex.equal_range(hash);
+		if (std::find_if(range.first,range.second,[&](const auto& other){return pathsEqual(entry.FullName.c_str(),entry.FullName.size(),other.second.entry->FullName);})!=range.second)
+			continue;
+		ArchiveIndex.emplace(hash,SArchiveIndexEntry{archive,&entry});
+	}
+}
+
+void CFileSystem::rebuildArchiveIndex()
+{
+	ArchiveIndex.clear();
+	for (auto archive : FileArchives)
+		indexArchive(archive);
+}
+
+
+//! finds the archive that createAndOpenFile would open a file from
+IFileArchive* CFileSystem::findFileInArchives(const char* filename, size_t length, const SFileListEntry** outEntry) const
+{
+	auto range = ArchiveIndex.equal_range(hashPath(filename,length));
+	for (auto it=range.first; it!=range.second; it++)
+	{
+		if (!pathsEqual(filename,length,it->second.entry->FullName))
+			continue;
+
+		if (outEntry)
+			*outEntry = it->second.entry;
+		return it->second.archive;
+	}
+	return nullptr;
+}
+
+
 //! determines if a file exists and would be able to be opened.
 bool CFileSystem::existFile(const io::path& filename) const
 {
+	const char lastChar = filename.size() ? filename.lastChar():0;
+	if (lastChar!='/' && lastChar!='\\')
+	{
+		if (findFileInArchives(filename.c_str(),filename.size()))
+			return true;
+	}
+	else // directories aren't indexed
 	for (uint32_t i=0; i < FileArchives.size(); ++i)
 	{
         auto _list = FileArchives[i]->getFileList();
@@ -32,6 +32,9 @@ class CFileSystem : public IFileSystem
         //! opens a file for read access
         virtual IReadFile* createAndOpenFile(const io::path& filename);
 
+        //! opens a file for read access through a mapping of it
+        virtual IReadFile* createMappedReadFile(const io::path& filename) override;
+
         //! Creates an IReadFile interface for accessing memory like a file.
         virtual IReadFile* createMemoryReadFile(const void* contents, size_t len, const io::path& fileName) override;
 
@@ -44,6 +47,9 @@ class CFileSystem : public IFileSystem
         //! Opens a file for write access.
         virtual IWriteFile* createAndWriteFile(const io::path& filename, bool append=false);
 
+        //! Sets up how files opened by createAndWriteFile buffer their writes.
+        virtual void setWriteBuffering(uint32_t bufferSize, bool writeBehind=false) override;
+
         //! Adds an archive to the file system.
         virtual bool addFileArchive(const io::path& filename,
                 E_FILE_ARCHIVE_TYPE archiveType = EFAT_UNKNOWN,
@@ -112,6 +118,9 @@ class CFileSystem : public IFileSystem
         //! determines if a file exists and would be able to be opened.
         virtual bool existFile(const io::path& filename) const;
 
+        //! finds the archive that createAndOpenFile would open a file from
+        virtual IFileArchive* findFileInArchives(const char* filename, size_t length, const SFileListEntry** outEntry = nullptr) const override;
+
     private:
 
         // don't expose, needs refactoring
@@ -127,6 +136,21 @@ class CFileSystem : public IFileSystem
         core::vector<IArchiveLoader*> ArchiveLoader;
         //! currently attached Archives
         core::vector<IFileArchive*> FileArchives;
+        //! all files of the archives, keyed by hash of their normalized path, only the first archive with a file has it here
+        struct SArchiveIndexEntry
+        {
+            IFileArchive* archive;
+            //! points into the file list of `archive`, which doesn't change once the archive got created
+            const SFileListEntry* entry;
+        };
+        core::unordered_multimap<size_t,SArchiveIndexEntry> ArchiveIndex;
+        //! adds the files of an archive appended to FileArchives which aren't in the earlier ones
+        void indexArchive(IFileArchive* archive);
+        //! has to be called whenever FileArchives get removed or reordered
+        void rebuildArchiveIndex();
+        //! settings for the files from createAndWriteFile
+        uint32_t WriteBufferSize;
+        bool WriteBehind;
 };
 
 
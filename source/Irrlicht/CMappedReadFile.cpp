@@ -0,0 +1,121 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#include "CMappedReadFile.h"
+
+#include <cstring>
+
+#if defined(_IRR_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+
+CMappedReadFile::CMappedReadFile(const io::path& fileName)
+: Data(nullptr), FileSize(0), Pos(0), Filename(fileName)
+{
+	#ifdef _IRR_DEBUG
+	setDebugName("CMappedReadFile");
+	#endif
+
+	if (Filename.size() == 0)
+		return;
+
+#if defined(_IRR_WINDOWS_API_)
+	#if defined(_IRR_WCHAR_FILESYSTEM)
+	HANDLE file = CreateFileW(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	#else
+	HANDLE file = CreateFileA(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	#endif
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+	{
+		// the view keeps the mapping alive after its handle gets closed
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if (mapping)
+		{
+			Data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			if (Data)
+				FileSize = static_cast<size_t>(size.QuadPart);
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	const int fd = open(Filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		// private mapping, so pages written to get copied instead of changing the file
+		void* mapped = mmap(nullptr, info.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (mapped != MAP_FAILED)
+		{
+			Data = mapped;
+			FileSize = static_cast<size_t>(info.st_size);
+		}
+	}
+	close(fd);
+#endif
+}
+
+
+CMappedReadFile::~CMappedReadFile()
+{
+	if (!Data)
+		return;
+
+#if defined(_IRR_WINDOWS_API_)
+	UnmapViewOfFile(Data);
+#else
+	munmap(Data, FileSize);
+#endif
+}
+
+
+//! returns how much was read
+int32_t CMappedReadFile::read(void* buffer, uint32_t sizeToRead)
+{
+	const size_t amount = core::min<size_t>(sizeToRead, FileSize-Pos);
+	if (!amount)
+		return 0;
+
+	memcpy(buffer, reinterpret_cast<const uint8_t*>(Data)+Pos, amount);
+	Pos += amount;
+	return static_cast<int32_t>(amount);
+}
+
+
+//! changes position in file, returns true if successful
+//! if relativeMovement==true, the pos is changed relative to current pos,
+//! otherwise from begin of file
+bool CMappedReadFile::seek(const size_t& finalPos, bool relativeMovement)
+{
+	const size_t newPos = relativeMovement ? Pos+finalPos : finalPos;
+	if (newPos > FileSize)
+		return false;
+
+	Pos = newPos;
+	return true;
+}
+
+
+} // end namespace io
+} // end namespace irr
+
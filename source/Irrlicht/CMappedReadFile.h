@@ -0,0 +1,64 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __C_MAPPED_READ_FILE_H_INCLUDED__
+#define __C_MAPPED_READ_FILE_H_INCLUDED__
+
+#include "IReadFile.h"
+
+#include "irr/core/core.h"
+
+namespace irr
+{
+namespace io
+{
+
+	/*!
+		Class for reading a real file from disk through a copy-on-write mapping of the whole file.
+		Reads are memcpy's and getMappedPointer() lets loaders use the contents in place,
+		writing through that pointer never reaches the file.
+	*/
+	class CMappedReadFile : public IReadFile
+	{
+        protected:
+            virtual ~CMappedReadFile();
+
+        public:
+            CMappedReadFile(const io::path& fileName);
+
+            //! returns how much was read
+            virtual int32_t read(void* buffer, uint32_t sizeToRead) override;
+
+            //! changes position in file, returns true if successful
+            virtual bool seek(const size_t& finalPos, bool relativeMovement = false) override;
+
+            //! returns size of file
+            virtual size_t getSize() const override { return FileSize; }
+
+            //! returns if file is open, empty files never are because they can't be mapped
+            virtual bool isOpen() const
+            {
+                return Data != nullptr;
+            }
+
+            //! returns where in the file we are.
+            virtual size_t getPos() const override { return Pos; }
+
+            //! returns name of file
+            virtual const io::path& getFileName() const override { return Filename; }
+
+            //! returns the mapped contents of the file
+            virtual const void* getMappedPointer() const override { return Data; }
+
+        private:
+            void* Data;
+            size_t FileSize;
+            size_t Pos;
+            io::path Filename;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
@@ -156,6 +156,8 @@ namespace io
 
         const void* getData() const {return m_storage;}
 
+        virtual const void* getMappedPointer() const override { return m_storage; }
+
     protected:
         void* m_storage;
         size_t m_length;
@@ -21,11 +21,26 @@ namespace scene
 
 uint32_t CMeshSceneNodeInstanced::recullOrder;
 
+namespace
+{
+    inline core::aabbox3df getInvertedBox()
+    {
+        return core::aabbox3df(FLT_MAX,FLT_MAX,FLT_MAX,-FLT_MAX,-FLT_MAX,-FLT_MAX);
+    }
+
+    //! inverted boxes of free slots don't affect the result
+    inline core::aabbox3df getUnion(const core::aabbox3df& a, const core::aabbox3df& b)
+    {
+        return core::aabbox3df( core::min(a.MinEdge.X,b.MinEdge.X),core::min(a.MinEdge.Y,b.MinEdge.Y),core::min(a.MinEdge.Z,b.MinEdge.Z),
+                                core::max(a.MaxEdge.X,b.MaxEdge.X),core::max(a.MaxEdge.Y,b.MaxEdge.Y),core::max(a.MaxEdge.Z,b.MaxEdge.Z));
+    }
+}
+
 //!constructor
 CMeshSceneNodeInstanced::CMeshSceneNodeInstanced(IDummyTransformationSceneNode* parent, ISceneManager* mgr, int32_t id,
         const core::vector3df& position, const core::vector3df& rotation, const core::vector3df& scale)
     : IMeshSceneNodeInstanced(parent, mgr, id, position, rotation, scale),
-    instanceBBoxes(nullptr), instanceBBoxesCount(0), flagQueryForRetrieval(false),
+    instanceBBoxesCount(0), instanceBVH(nullptr), instanceBVHLeafCount(0), flagQueryForRetrieval(false),
     gpuCulledLodInstanceDataBuffer(), dataPerInstanceOutputSize(0),
     extraDataInstanceSize(0), dataPerInstanceInputSize(0)
 {
@@ -43,8 +58,8 @@ CMeshSceneNodeInstanced::CMeshSceneNodeInstanced(IDummyTransformationSceneNode*
 //! destructor
 CMeshSceneNodeInstanced::~CMeshSceneNodeInstanced()
 {
-    if (instanceBBoxes)
-        _IRR_ALIGNED_FREE(instanceBBoxes);
+    if (instanceBVH)
+        _IRR_ALIGNED_FREE(instanceBVH);
 }
 
 
@@ -54,10 +69,12 @@ bool CMeshSceneNodeInstanced::setLoDMeshes(const core::vector<MeshLoD>& levelsOf
     LoD.clear();
     xfb.clear();
 
-    if (instanceBBoxes)
-        _IRR_ALIGNED_FREE(instanceBBoxes);
+    if (instanceBVH)
+        _IRR_ALIGNED_FREE(instanceBVH);
     instanceDataAllocator = nullptr;
-    instanceBBoxes = nullptr;
+    instanceBVH = nullptr;
+    instanceBVHLeafCount = 0;
+    instanceBBoxesCount = 0;
     gpuCulledLodInstanceDataBuffer = nullptr;
     extraDataInstanceSize = 0;
 
@@ -90,13 +107,7 @@ bool CMeshSceneNodeInstanced::setLoDMeshes(const core::vector<MeshLoD>& levelsOf
     dataPerInstanceInputSize = extraDataInstanceSize+visibilityPadding+48+36;
     auto buffSize = dataPerInstanceInputSize*512u;
     instanceDataAllocator = core::make_smart_refctd_ptr<decltype(instanceDataAllocator)::pointee>(driver,core::allocator<uint8_t>(),0u,0u,core::roundDownToPoT(dataPerInstanceInputSize),buffSize,dataPerInstanceInputSize,nullptr);
-	instanceBBoxesCount = getCurrentInstanceCapacity();
-	instanceBBoxes = (core::aabbox3df*)_IRR_ALIGNED_MALLOC(instanceBBoxesCount*sizeof(core::aabbox3df),_IRR_SIMD_ALIGNMENT);
-	for (size_t i=0; i<instanceBBoxesCount; i++)
-    {
-        instanceBBoxes[i].MinEdge.set( FLT_MAX, FLT_MAX, FLT_MAX);
-        instanceBBoxes[i].MaxEdge.set(-FLT_MAX,-FLT_MAX,-FLT_MAX);
-    }
+	resizeInstanceBVH(getCurrentInstanceCapacity());
 
     xfb.resize((levelsOfDetail.size()+gpuLoDsPerPass-1)/gpuLoDsPerPass);
 
@@ -238,32 +249,12 @@ bool CMeshSceneNodeInstanced::addInstances(uint32_t* instanceIDs, const size_t&
     }// end of arbitrary scope
 
     if (getCurrentInstanceCapacity()!=instanceBBoxesCount)
-    {
-        size_t newCount = getCurrentInstanceCapacity();
-        // kind-of realloc
-        {
-            size_t newSize = newCount*sizeof(core::aabbox3df);
-            void* newPtr = _IRR_ALIGNED_MALLOC(newSize,_IRR_SIMD_ALIGNMENT);
-            memcpy(newPtr,instanceBBoxes,std::min(instanceBBoxesCount*sizeof(core::aabbox3df),newSize));
-            _IRR_ALIGNED_FREE(instanceBBoxes);
-            instanceBBoxes = (core::aabbox3df*)newPtr;
-        }
-        for (size_t i=instanceBBoxesCount; i<newCount; i++)
-        {
-            instanceBBoxes[i].MinEdge.set( FLT_MAX, FLT_MAX, FLT_MAX);
-            instanceBBoxes[i].MaxEdge.set(-FLT_MAX,-FLT_MAX,-FLT_MAX);
-        }
-        instanceBBoxesCount = newCount;
-    }
-    needsBBoxRecompute = true;
+        resizeInstanceBVH(getCurrentInstanceCapacity());
 
     uint8_t* base_pointer = reinterpret_cast<uint8_t*>(instanceDataAllocator->getBackBufferPointer());
     for (size_t i=0; i<instanceCount; i++)
     {
-        {
-            uint32_t blockID = getBlockIDFromAddr(instanceIDs[i]);
-            instanceBBoxes[blockID] = core::transformBoxEx(LoDInvariantBox,relativeTransforms[i]);
-        }
+        setInstanceBBox(getBlockIDFromAddr(instanceIDs[i]),core::transformBoxEx(LoDInvariantBox,relativeTransforms[i]));
         size_t redirect = instanceDataAllocator->getAddressAllocator().get_real_addr(instanceIDs[i]);
         instanceDataAllocator->markRangeForPush(redirect,redirect+dataPerInstanceInputSize);
         uint8_t* ptr = base_pointer+redirect;
@@ -293,10 +284,7 @@ bool CMeshSceneNodeInstanced::addInstances(uint32_t* instanceIDs, const size_t&
 
 void CMeshSceneNodeInstanced::setInstanceTransform(const uint32_t& instanceID, const core::matrix3x4SIMD& relativeTransform)
 {
-    {
-        uint32_t blockID = getBlockIDFromAddr(instanceID);
-        instanceBBoxes[blockID] = core::transformBoxEx(LoDInvariantBox,relativeTransform);
-    }
+    setInstanceBBox(getBlockIDFromAddr(instanceID),core::transformBoxEx(LoDInvariantBox,relativeTransform));
 
     size_t redirect = instanceDataAllocator->getAddressAllocator().get_real_addr(instanceID);
     instanceDataAllocator->markRangeForPush(redirect,redirect+48+36);
@@ -315,8 +303,6 @@ void CMeshSceneNodeInstanced::setInstanceTransform(const uint32_t& instanceID, c
     instance3x3TranposeInverse[6] = instanceInverse(2,0);
     instance3x3TranposeInverse[7] = instanceInverse(2,1);
     instance3x3TranposeInverse[8] = instanceInverse(2,2);
-
-    needsBBoxRecompute = true;
 }
 
 core::matrix3x4SIMD CMeshSceneNodeInstanced::getInstanceTransform(const uint32_t& instanceID)
@@ -373,9 +359,7 @@ void CMeshSceneNodeInstanced::removeInstances(const size_t& instanceCount, const
         }
 		IRR_PSEUDO_IF_CONSTEXPR_END
 
-        uint32_t blockID = getBlockIDFromAddr(instanceIDs[i]);
-        instanceBBoxes[blockID].MinEdge.set( FLT_MAX, FLT_MAX, FLT_MAX);
-        instanceBBoxes[blockID].MaxEdge.set(-FLT_MAX,-FLT_MAX,-FLT_MAX);
+        setInstanceBBox(getBlockIDFromAddr(instanceIDs[i]),getInvertedBox());
     }
 
     {// dummyBytes scope
@@ -393,25 +377,120 @@ void CMeshSceneNodeInstanced::removeInstances(const size_t& instanceCount, const
 	IRR_PSEUDO_IF_CONSTEXPR_END
 
     if (getCurrentInstanceCapacity()!=instanceBBoxesCount)
+        resizeInstanceBVH(getCurrentInstanceCapacity());
+
+    lodCullingPointMesh->setIndexCount(lodCullingPointMesh->getIndexCount()-instanceCount);
+}
+
+void CMeshSceneNodeInstanced::cullInstances(const SViewFrustum& frustum, core::vector<SInstanceSlotRange>& outRanges) const
+{
+    if (!instanceBVH)
+        return;
+
+    // the boxes are in the node's space, so the planes get moved there instead of transforming every box
+    const core::matrix3x4SIMD toWorld = core::matrix3x4SIMD().set(AbsoluteTransformation);
+    core::vectorSIMDf planes[SViewFrustum::VF_PLANE_COUNT];
+    for (uint32_t i=0; i<SViewFrustum::VF_PLANE_COUNT; i++)
     {
-        size_t newCount = getCurrentInstanceCapacity();
-        { // kind-of realloc
-            size_t newSize = newCount*sizeof(core::aabbox3df);
-            void* newPtr = _IRR_ALIGNED_MALLOC(newSize,_IRR_SIMD_ALIGNMENT);
-            memcpy(newPtr,instanceBBoxes,newSize);
-            _IRR_ALIGNED_FREE(instanceBBoxes);
-            instanceBBoxes = (core::aabbox3df*)newPtr;
+        const core::vectorSIMDf& plane = reinterpret_cast<const core::vectorSIMDf&>(frustum.planes[i]);
+        planes[i] = toWorld.rows[0]*plane.xxxx()+toWorld.rows[1]*plane.yyyy()+toWorld.rows[2]*plane.zzzz();
+        planes[i].w += plane.w;
+    }
+
+    struct SNode
+    {
+        size_t index;
+        uint32_t begin, end;
+    };
+    // depth first, so the stack never holds more than one node per level and a sibling
+    SNode stack[64];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = {1u,0u,static_cast<uint32_t>(instanceBVHLeafCount)};
+
+    const size_t firstNewRange = outRanges.size();
+    const core::vectorSIMDf zero(0.f);
+    while (stackSize)
+    {
+        const SNode node = stack[--stackSize];
+        const core::aabbox3df& box = instanceBVH[node.index];
+        if (box.MinEdge.X>box.MaxEdge.X)
+            continue;
+
+        const core::vectorSIMDf minPt(box.MinEdge.X,box.MinEdge.Y,box.MinEdge.Z,1.f);
+        const core::vectorSIMDf maxPt(box.MaxEdge.X,box.MaxEdge.Y,box.MaxEdge.Z,1.f);
+        bool outside = false;
+        bool inside = true;
+        for (uint32_t i=0; i<SViewFrustum::VF_PLANE_COUNT&&!outside; i++)
+        {
+            const auto positive = planes[i]>zero;
+            const core::vectorSIMDf farthest = core::mix(minPt,maxPt,positive)*planes[i];
+            const core::vectorSIMDf nearest = core::mix(maxPt,minPt,positive)*planes[i];
+            outside = farthest.x+farthest.y+farthest.z+farthest.w<0.f;
+            inside = inside&&nearest.x+nearest.y+nearest.z+nearest.w>=0.f;
         }
-        for (size_t i=instanceBBoxesCount; i<newCount; i++)
+        if (outside)
+            continue;
+
+        // a subtree completely in the frustum is reported whole
+        if (inside||node.index>=instanceBVHLeafCount)
         {
-            instanceBBoxes[i].MinEdge.set( FLT_MAX, FLT_MAX, FLT_MAX);
-            instanceBBoxes[i].MaxEdge.set(-FLT_MAX,-FLT_MAX,-FLT_MAX);
+            const uint32_t end = core::min(node.end,static_cast<uint32_t>(instanceBBoxesCount));
+            if (outRanges.size()>firstNewRange&&outRanges.back().end==node.begin)
+                outRanges.back().end = end;
+            else
+                outRanges.push_back({node.begin,end});
+            continue;
         }
-        instanceBBoxesCount = newCount;
+
+        // right child goes first, so that the ranges come out sorted
+        const uint32_t middle = node.begin+(node.end-node.begin)/2u;
+        stack[stackSize++] = {2u*node.index+1u,middle,node.end};
+        stack[stackSize++] = {2u*node.index,node.begin,middle};
     }
-    needsBBoxRecompute = true;
+}
 
-    lodCullingPointMesh->setIndexCount(lodCullingPointMesh->getIndexCount()-instanceCount);
+void CMeshSceneNodeInstanced::resizeInstanceBVH(size_t slotCount)
+{
+    const size_t leafCount = core::roundUpToPoT<size_t>(core::max<size_t>(slotCount,1u));
+    if (leafCount!=instanceBVHLeafCount)
+    {
+        auto newBVH = reinterpret_cast<core::aabbox3df*>(_IRR_ALIGNED_MALLOC(2u*leafCount*sizeof(core::aabbox3df),_IRR_SIMD_ALIGNMENT));
+        const size_t keptLeaves = core::min(slotCount,instanceBBoxesCount);
+        if (instanceBVH)
+        {
+            memcpy(newBVH+leafCount,instanceBVH+instanceBVHLeafCount,keptLeaves*sizeof(core::aabbox3df));
+            _IRR_ALIGNED_FREE(instanceBVH);
+        }
+        for (size_t i=keptLeaves; i<leafCount; i++)
+            newBVH[leafCount+i] = getInvertedBox();
+        // only happens when the capacity crosses a power of two, so a full rebuild is fine
+        newBVH[0] = getInvertedBox();
+        for (size_t i=leafCount-1u; i; i--)
+            newBVH[i] = getUnion(newBVH[2u*i],newBVH[2u*i+1u]);
+
+        instanceBVH = newBVH;
+        instanceBVHLeafCount = leafCount;
+    }
+    else
+    {
+        for (size_t i=slotCount; i<instanceBBoxesCount; i++)
+            setInstanceBBox(i,getInvertedBox());
+    }
+    instanceBBoxesCount = slotCount;
+}
+
+void CMeshSceneNodeInstanced::setInstanceBBox(size_t slot, const core::aabbox3df& box)
+{
+    size_t node = instanceBVHLeafCount+slot;
+    instanceBVH[node] = box;
+    // once an ancestor doesn't change, neither will the ones above it
+    for (node>>=1u; node; node>>=1u)
+    {
+        const core::aabbox3df refitted = getUnion(instanceBVH[2u*node],instanceBVH[2u*node+1u]);
+        if (refitted==instanceBVH[node])
+            break;
+        instanceBVH[node] = refitted;
+    }
 }
 
 void CMeshSceneNodeInstanced::RecullInstances()
@@ -428,6 +507,20 @@ void CMeshSceneNodeInstanced::RecullInstances()
         return;
     }
 
+    // whole node outside of the view, no point running the transform feedback pass
+    if (const ICameraSceneNode* camera = SceneManager->getActiveCamera())
+    {
+        core::aabbox3df box = instanceBVH[1];
+        AbsoluteTransformation.transformBoxEx(box);
+        if (!camera->getViewFrustum()->intersectsAABB(box))
+        {
+            for (size_t i=0; i<LoD.size(); i++)
+            for (size_t j=0; j<LoD[i].mesh->getMeshBufferCount(); j++)
+                LoD[i].mesh->getMeshBuffer(j)->setInstanceCount(0);
+            return;
+        }
+    }
+
     video::IVideoDriver* driver = SceneManager->getVideoDriver();
 
     {
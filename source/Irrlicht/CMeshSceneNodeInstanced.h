@@ -88,40 +88,21 @@ class CMeshSceneNodeInstanced : public IMeshSceneNodeInstanced
         //! returns the axis aligned bounding box of this node
         virtual const core::aabbox3d<float>& getBoundingBox()
         {
-            if (wantBBoxUpdate&&needsBBoxRecompute)
+            // the root of the hierarchy already bounds every instance
+            if (wantBBoxUpdate)
             {
-                Box.reset(0,0,0);
-                size_t instanceCount = getInstanceCount();
-                size_t allocCapacity = getCurrentInstanceCapacity();
-
-                size_t optimCount = 0;
-                for (size_t i=0; optimCount<instanceCount&&i<allocCapacity; i++)
-                {
-                    if (instanceBBoxes[i].MinEdge.X>instanceBBoxes[i].MaxEdge.X)
-                        continue;
-
-                    size_t tmp = optimCount++;
-                    if (tmp)
-                    {
-                        for (size_t j=0; j<3; j++)
-                        {
-                            if (reinterpret_cast<float*>(&instanceBBoxes[i].MinEdge)[j]<reinterpret_cast<float*>(&Box.MinEdge)[j])
-                                reinterpret_cast<float*>(&Box.MinEdge)[j] = reinterpret_cast<float*>(&instanceBBoxes[i].MinEdge)[j];
-                        }
-                        for (size_t j=0; j<3; j++)
-                        {
-                            if (reinterpret_cast<float*>(&instanceBBoxes[i].MaxEdge)[j]>reinterpret_cast<float*>(&Box.MaxEdge)[j])
-                                reinterpret_cast<float*>(&Box.MaxEdge)[j] = reinterpret_cast<float*>(&instanceBBoxes[i].MaxEdge)[j];
-                        }
-                    }
-                    else
-                        Box = instanceBBoxes[i];
-                }
-                needsBBoxRecompute = false;
+                if (instanceBVH&&instanceBVH[1].MinEdge.X<=instanceBVH[1].MaxEdge.X)
+                    Box = instanceBVH[1];
+                else
+                    Box.reset(0,0,0);
             }
             return Box;
         }
 
+        virtual uint32_t getInstanceSlot(const uint32_t& instanceID) const override {return getBlockIDFromAddr(instanceID);}
+
+        virtual void cullInstances(const SViewFrustum& frustum, core::vector<SInstanceSlotRange>& outRanges) const override;
+
         //! Returns type of the scene node
         virtual ESCENE_NODE_TYPE getType() const { return ESNT_MESH_INSTANCED; }
 
@@ -144,9 +125,17 @@ class CMeshSceneNodeInstanced : public IMeshSceneNodeInstanced
         core::vector< core::smart_refctd_ptr<video::ITransformFeedback>> xfb;
         size_t gpuLoDsPerPass;
 
-        bool needsBBoxRecompute;
+        //! slots of the instance allocator, all of which have a leaf
         size_t instanceBBoxesCount;
-        core::aabbox3df* instanceBBoxes;
+        //! Bounding volume hierarchy over the instance slots, an implicit binary tree where node `i` has the children `2i` and `2i+1`
+        /** Node 1 is the root and the leaves `[instanceBVHLeafCount,2*instanceBVHLeafCount)` are the boxes of the slots.
+        Free slots have inverted boxes which every union ignores, so changing a slot only refits its ancestors. */
+        core::aabbox3df* instanceBVH;
+        size_t instanceBVHLeafCount;
+
+        //! keeps the leaves of the slots which still exist
+        void resizeInstanceBVH(size_t slotCount);
+        void setInstanceBBox(size_t slot, const core::aabbox3df& box);
         bool flagQueryForRetrieval;
         core::smart_refctd_ptr<video::IGPUMeshBuffer> lodCullingPointMesh;
         core::smart_refctd_ptr<video::IGPUBuffer> gpuCulledLodInstanceDataBuffer;
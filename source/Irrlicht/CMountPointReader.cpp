@@ -153,12 +153,18 @@ IReadFile* CMountPointReader::createAndOpenFile(const io::path& filename)
     auto found = findFile(Files.begin(),Files.end(),filename,false);
 	if (found != Files.end())
     {
-        return Parent->createAndOpenFile(RealFileNames[found->ID]);
+        return createAndOpenListedFile(*found);
     }
 	
 	return nullptr;
 }
 
+//! opens a file from an entry of the file list
+IReadFile* CMountPointReader::createAndOpenListedFile(const SFileListEntry& entry)
+{
+	return Parent->createAndOpenFile(RealFileNames[entry.ID]);
+}
+
 
 } // io
 } // irr
@@ -33,7 +33,7 @@ int32_t CNullDriver::incrementAndFetchReallocCounter()
 //! constructor
 CNullDriver::CNullDriver(IrrlichtDevice* dev, io::IFileSystem* io, const core::dimension2d<uint32_t>& screenSize)
 : IVideoDriver(dev), FileSystem(io), ViewPort(0,0,0,0), ScreenSize(screenSize), boxLineMesh(0),
-	PrimitivesDrawn(0), TextureCreationFlags(0),
+	PrimitivesDrawn(0), FinishedFrames(0u), TextureCreationFlags(0),
 	OverrideMaterial2DEnabled(false),
 	matrixModifiedBits(0)
 {
@@ -120,6 +120,9 @@ bool CNullDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 	scene::CMeshSceneNodeInstanced::recullOrder = 0;
 
 	PrimitivesDrawn = 0;
+	FrameStatistics = SFrameStatistics();
+	FrameStatistics.frameNumber = FinishedFrames;
+	FrameBeginTime = std::chrono::high_resolution_clock::now();
 	return true;
 }
 
@@ -127,7 +130,12 @@ bool CNullDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 //! applications must call this method after performing any rendering. returns false if failed.
 bool CNullDriver::endScene()
 {
-	FPSCounter.registerFrame(std::chrono::high_resolution_clock::now(), PrimitivesDrawn);
+	const auto now = std::chrono::high_resolution_clock::now();
+	FPSCounter.registerFrame(now, PrimitivesDrawn);
+
+	FrameStatistics.cpuTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now-FrameBeginTime).count();
+	FrameStatisticsHistory[FinishedFrames%FrameStatisticsHistoryLength] = FrameStatistics;
+	FinishedFrames++;
 
 	return true;
 }
@@ -307,6 +315,13 @@ const core::matrix4SIMD& CNullDriver::getTransform(const E_PROJECTION_TRANSFORMA
 //! sets a material
 void CNullDriver::setMaterial(const SGPUMaterial& material)
 {
+	if (material==Material)
+		return;
+
+	FrameStatistics.materialChanges++;
+	if (material.MaterialType!=Material.MaterialType)
+		FrameStatistics.shaderChanges++;
+	Material = material;
 }
 
 void CNullDriver::removeMultisampleTexture(IMultisampleTexture* tex)
@@ -546,6 +561,27 @@ uint32_t CNullDriver::getPrimitiveCountDrawn( uint32_t param ) const
 }
 
 
+const SFrameStatistics* CNullDriver::getFrameStatistics(uint32_t framesAgo) const
+{
+	if (framesAgo>=FrameStatisticsHistoryLength || framesAgo>=FinishedFrames)
+		return nullptr;
+
+	return FrameStatisticsHistory+(FinishedFrames-1u-framesAgo)%FrameStatisticsHistoryLength;
+}
+
+
+void CNullDriver::copyBuffer(IGPUBuffer* readBuffer, IGPUBuffer* writeBuffer, size_t readOffset, size_t writeOffset, size_t length)
+{
+	FrameStatistics.bufferCopies++;
+	FrameStatistics.bytesCopied += length;
+	if (defaultUploadBuffer && readBuffer==defaultUploadBuffer->getBuffer())
+	{
+		FrameStatistics.upStreamingCopies++;
+		FrameStatistics.bytesUpStreamed += length;
+	}
+}
+
+
 
 //! \return Returns the name of the video driver. Example: In case of the DIRECT3D8
 //! driver, it would return "Direct3D8".
@@ -620,6 +656,9 @@ void CNullDriver::drawMeshBuffer(const IGPUMeshBuffer* mb)
             break;
     }
     PrimitivesDrawn += increment;
+
+    FrameStatistics.drawCalls++;
+    FrameStatistics.primitivesDrawn += increment;
 }
 
 
@@ -629,6 +668,8 @@ void CNullDriver::drawArraysIndirect(const asset::IMeshDataFormatDesc<video::IGP
                                      const IGPUBuffer* indirectDrawBuff,
                                      const size_t& offset, const size_t& count, const size_t& stride)
 {
+    if (indirectDrawBuff)
+        FrameStatistics.indirectDrawCalls++;
 }
 
 void CNullDriver::drawIndexedIndirect(  const asset::IMeshDataFormatDesc<video::IGPUBuffer>* vao,
@@ -637,6 +678,8 @@ void CNullDriver::drawIndexedIndirect(  const asset::IMeshDataFormatDesc<video::
                                         const IGPUBuffer* indirectDrawBuff,
                                         const size_t& offset, const size_t& count, const size_t& stride)
 {
+    if (indirectDrawBuff)
+        FrameStatistics.indirectDrawCalls++;
 }
 
 
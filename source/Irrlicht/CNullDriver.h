@@ -271,6 +271,18 @@ namespace video
 		//! very useful method for statistics.
 		virtual uint32_t getPrimitiveCountDrawn( uint32_t param = 0 ) const;
 
+		//!
+		virtual const SFrameStatistics& getCurrentFrameStatistics() const override { return FrameStatistics; }
+
+		//!
+		virtual const SFrameStatistics* getFrameStatistics(uint32_t framesAgo=0u) const override;
+
+		//!
+		virtual uint32_t getFrameStatisticsHistoryLength() const override { return FrameStatisticsHistoryLength; }
+
+		//! counts the copy in the frame statistics, does not copy anything
+		virtual void copyBuffer(IGPUBuffer* readBuffer, IGPUBuffer* writeBuffer, size_t readOffset, size_t writeOffset, size_t length) override;
+
 		//! \return Returns the name of the video driver. Example: In case of the DIRECT3D8
 		//! driver, it would return "Direct3D8.1".
 		virtual const wchar_t* getName() const;
@@ -556,6 +568,16 @@ namespace video
 
 		uint32_t PrimitivesDrawn;
 
+		//! material of the last setMaterial call
+		SGPUMaterial Material;
+
+		_IRR_STATIC_INLINE_CONSTEXPR uint32_t FrameStatisticsHistoryLength = 64u;
+		SFrameStatistics FrameStatistics;
+		//! ring buffer indexed by frame number
+		SFrameStatistics FrameStatisticsHistory[FrameStatisticsHistoryLength];
+		uint64_t FinishedFrames;
+		std::chrono::high_resolution_clock::time_point FrameBeginTime;
+
 		uint32_t TextureCreationFlags;
 
 		SExposedVideoData ExposedData;
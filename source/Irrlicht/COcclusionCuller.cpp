@@ -0,0 +1,393 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#include "COcclusionCuller.h"
+#include "irr/core/parallel/CTaskScheduler.h"
+
+#include <cfloat>
+#include <algorithm>
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! clip space w of the plane triangles get clipped against, boxes reaching in front of it are never culled
+	constexpr float NearW = 1.f/65536.f;
+	constexpr uint32_t InvalidOccluder = 0xffffffffu;
+}
+
+COcclusionCuller::COcclusionCuller(uint32_t width, uint32_t height)
+	: Enabled(false), HasDepth(false), Width(core::max((width+3u)&~3u,4u)), Height(core::max(height,1u)), NextOccluderId(0u)
+{
+	#ifdef _IRR_DEBUG
+	setDebugName("COcclusionCuller");
+	#endif
+
+	size_t total = 0u;
+	for (uint32_t w=Width,h=Height; ; w=(w+1u)>>1u,h=(h+1u)>>1u)
+	{
+		Levels.push_back({total,w,h});
+		total += size_t(w)*h;
+		if (w==1u && h==1u)
+			break;
+	}
+	Depth.resize(total,0.f);
+}
+
+COcclusionCuller::~COcclusionCuller()
+{
+	clearOccluders();
+}
+
+
+uint32_t COcclusionCuller::addOccluder(const asset::ICPUMeshBuffer* meshbuffer, IDummyTransformationSceneNode* node)
+{
+	if (!meshbuffer)
+		return InvalidOccluder;
+
+	SOccluder occluder;
+	occluder.id = NextOccluderId;
+	occluder.node = node;
+
+	const auto indexCount = meshbuffer->getIndexCount();
+	auto getVertex = [&](uint32_t i) -> core::vectorSIMDf
+	{
+		core::vectorSIMDf pos = meshbuffer->getPosition(meshbuffer->getIndexValue(i));
+		pos.w = 1.f;
+		return pos;
+	};
+	switch (meshbuffer->getPrimitiveType())
+	{
+		case asset::EPT_TRIANGLES:
+			for (uint32_t i=0u; i+2u<indexCount; i+=3u)
+			for (uint32_t k=0u; k<3u; k++)
+				occluder.vertices.push_back(getVertex(i+k));
+			break;
+		case asset::EPT_TRIANGLE_STRIP:
+			// winding does not matter, occluders are double sided
+			for (uint32_t i=0u; i+2u<indexCount; i++)
+			for (uint32_t k=0u; k<3u; k++)
+				occluder.vertices.push_back(getVertex(i+k));
+			break;
+		case asset::EPT_TRIANGLE_FAN:
+			for (uint32_t i=1u; i+1u<indexCount; i++)
+			{
+				occluder.vertices.push_back(getVertex(0u));
+				occluder.vertices.push_back(getVertex(i));
+				occluder.vertices.push_back(getVertex(i+1u));
+			}
+			break;
+		default:
+			break;
+	}
+	if (occluder.vertices.empty())
+		return InvalidOccluder;
+
+	if (node)
+	{
+		node->grab();
+		OccluderNodes[node]++;
+	}
+	NextOccluderId++;
+	Occluders.push_back(std::move(occluder));
+	return Occluders.back().id;
+}
+
+void COcclusionCuller::removeOccluder(uint32_t id)
+{
+	auto found = std::find_if(Occluders.begin(),Occluders.end(),[id](const SOccluder& occluder) {return occluder.id==id;});
+	if (found==Occluders.end())
+		return;
+
+	if (found->node)
+	{
+		auto nodeIt = OccluderNodes.find(found->node);
+		if ((--nodeIt->second)==0u)
+			OccluderNodes.erase(nodeIt);
+		found->node->drop();
+	}
+	Occluders.erase(found);
+}
+
+void COcclusionCuller::clearOccluders()
+{
+	for (auto& occluder : Occluders)
+	if (occluder.node)
+		occluder.node->drop();
+	Occluders.clear();
+	OccluderNodes.clear();
+	HasDepth = false;
+}
+
+
+void COcclusionCuller::rasterize(const core::matrix4SIMD& viewProj)
+{
+	ViewProj = viewProj;
+	Statistics = SStatistics();
+
+	Triangles.clear();
+	for (auto& occluder : Occluders)
+	{
+		core::matrix4SIMD mvp = viewProj;
+		if (occluder.node)
+			mvp = core::concatenateBFollowedByA(viewProj,core::matrix4SIMD(core::matrix3x4SIMD().set(occluder.node->getAbsoluteTransformation())));
+
+		core::vectorSIMDf clip[3];
+		for (auto it=occluder.vertices.begin(); it!=occluder.vertices.end(); it+=3)
+		{
+			for (uint32_t k=0u; k<3u; k++)
+				mvp.transformVect(clip[k],it[k]);
+			setupTriangle(clip);
+		}
+	}
+	Statistics.rasterizedTriangles = Triangles.size();
+
+	std::fill(Depth.begin(),Depth.begin()+size_t(Width)*Height,0.f);
+
+	const uint32_t bandCount = (Height+BandHeight-1u)/BandHeight;
+	// bands never overlap, so the tasks share nothing but the read-only triangle list
+	if (Triangles.size()>=MultithreadingTriangleThreshold)
+	{
+		core::CTaskScheduler::getGlobal().parallelFor(0u,bandCount,1u,[this](uint32_t firstBand, uint32_t lastBand)
+		{
+			for (uint32_t band=firstBand; band<lastBand; band++)
+				rasterizeBand(band);
+		});
+	}
+	else
+	for (uint32_t band=0u; band<bandCount; band++)
+		rasterizeBand(band);
+
+	buildHierarchicalDepth();
+	HasDepth = true;
+}
+
+void COcclusionCuller::setupTriangle(const core::vectorSIMDf* clip)
+{
+	// Sutherland-Hodgman against the w=NearW plane, a triangle becomes at most a quad
+	core::vectorSIMDf poly[4];
+	uint32_t vertexCount = 0u;
+	for (uint32_t k=0u; k<3u; k++)
+	{
+		const auto& a = clip[k];
+		const auto& b = clip[(k+1u)%3u];
+		const bool aInside = a.w>=NearW;
+		const bool bInside = b.w>=NearW;
+		if (aInside)
+			poly[vertexCount++] = a;
+		if (aInside!=bInside)
+		{
+			const float t = (NearW-a.w)/(b.w-a.w);
+			poly[vertexCount++] = a+(b-a)*t;
+		}
+	}
+	if (vertexCount<3u)
+		return;
+
+	float x[4],y[4],invW[4];
+	for (uint32_t k=0u; k<vertexCount; k++)
+	{
+		invW[k] = 1.f/poly[k].w;
+		toScreen(x[k],y[k],poly[k],invW[k]);
+	}
+	for (uint32_t k=2u; k<vertexCount; k++)
+	{
+		STriangle tri;
+		const uint32_t ix[3] = {0u,k-1u,k};
+		float minX = FLT_MAX, maxX = -FLT_MAX, minY = FLT_MAX, maxY = -FLT_MAX;
+		for (uint32_t j=0u; j<3u; j++)
+		{
+			tri.x[j] = x[ix[j]];
+			tri.y[j] = y[ix[j]];
+			tri.invW[j] = invW[ix[j]];
+			minX = core::min(minX,tri.x[j]);
+			maxX = core::max(maxX,tri.x[j]);
+			minY = core::min(minY,tri.y[j]);
+			maxY = core::max(maxY,tri.y[j]);
+		}
+		// completely off-screen
+		if (maxX<0.f || minX>=float(Width) || maxY<0.f || minY>=float(Height))
+			continue;
+
+		const float area = (tri.x[1]-tri.x[0])*(tri.y[2]-tri.y[0])-(tri.x[2]-tri.x[0])*(tri.y[1]-tri.y[0]);
+		if (area==0.f)
+			continue;
+		// double sided, make all triangles wind the same way so the edge functions are positive inside
+		if (area<0.f)
+		{
+			std::swap(tri.x[1],tri.x[2]);
+			std::swap(tri.y[1],tri.y[2]);
+			std::swap(tri.invW[1],tri.invW[2]);
+		}
+		tri.minY = static_cast<int32_t>(core::max(minY,0.f));
+		tri.maxY = static_cast<int32_t>(core::min(maxY,float(Height-1u)));
+		Triangles.push_back(tri);
+	}
+}
+
+void COcclusionCuller::rasterizeBand(uint32_t band)
+{
+	const int32_t firstRow = band*BandHeight;
+	const int32_t lastRow = core::min<int32_t>(firstRow+BandHeight,Height)-1;
+	for (const auto& tri : Triangles)
+	{
+		if (tri.maxY<firstRow || tri.minY>lastRow)
+			continue;
+		rasterizeTriangle(tri,core::max(tri.minY,firstRow),core::min(tri.maxY,lastRow));
+	}
+}
+
+void COcclusionCuller::rasterizeTriangle(const STriangle& tri, int32_t firstRow, int32_t lastRow)
+{
+	// edge function of edge i (from vertex i to i+1) is A*x+B*y+C, the barycentric weight of vertex (i+2)%3 is proportional to it
+	float A[3],B[3],C[3];
+	for (uint32_t i=0u; i<3u; i++)
+	{
+		const uint32_t j = (i+1u)%3u;
+		A[i] = tri.y[i]-tri.y[j];
+		B[i] = tri.x[j]-tri.x[i];
+		C[i] = tri.x[i]*tri.y[j]-tri.x[j]*tri.y[i];
+	}
+	const float area = C[0]+C[1]+C[2];
+	if (area<=0.f)
+		return;
+
+	// 1/w is affine in screen space
+	const float invArea = 1.f/area;
+	const float zA = (A[1]*tri.invW[0]+A[2]*tri.invW[1]+A[0]*tri.invW[2])*invArea;
+	const float zB = (B[1]*tri.invW[0]+B[2]*tri.invW[1]+B[0]*tri.invW[2])*invArea;
+	const float zC = (C[1]*tri.invW[0]+C[2]*tri.invW[1]+C[0]*tri.invW[2])*invArea;
+
+	const float minX = core::min(core::min(tri.x[0],tri.x[1]),tri.x[2]);
+	const float maxX = core::max(core::max(tri.x[0],tri.x[1]),tri.x[2]);
+	const int32_t firstColumn = static_cast<int32_t>(core::max(minX,0.f))&~3;
+	const int32_t lastColumn = static_cast<int32_t>(core::min(maxX,float(Width-1u)));
+
+	#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+	const __m128 pixelOffsets = _mm_setr_ps(0.5f,1.5f,2.5f,3.5f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 stepX = _mm_set1_ps(4.f);
+	__m128 edgeStepX[3];
+	for (uint32_t i=0u; i<3u; i++)
+		edgeStepX[i] = _mm_mul_ps(_mm_set1_ps(A[i]),stepX);
+	const __m128 zStepX = _mm_mul_ps(_mm_set1_ps(zA),stepX);
+	#endif
+	for (int32_t row=firstRow; row<=lastRow; row++)
+	{
+		const float py = float(row)+0.5f;
+		float* depthRow = Depth.data()+size_t(row)*Width;
+		#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+		const __m128 px = _mm_add_ps(_mm_set1_ps(float(firstColumn)),pixelOffsets);
+		__m128 edge[3];
+		for (uint32_t i=0u; i<3u; i++)
+			edge[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[i]),px),_mm_set1_ps(B[i]*py+C[i]));
+		__m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zA),px),_mm_set1_ps(zB*py+zC));
+		for (int32_t column=firstColumn; column<=lastColumn; column+=4)
+		{
+			const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge[0],zero),_mm_cmpge_ps(edge[1],zero)),_mm_cmpge_ps(edge[2],zero));
+			if (_mm_movemask_ps(inside))
+			{
+				const __m128 old = _mm_loadu_ps(depthRow+column);
+				_mm_storeu_ps(depthRow+column,_mm_blendv_ps(old,_mm_max_ps(old,z),inside));
+			}
+			for (uint32_t i=0u; i<3u; i++)
+				edge[i] = _mm_add_ps(edge[i],edgeStepX[i]);
+			z = _mm_add_ps(z,zStepX);
+		}
+		#else
+		for (int32_t column=firstColumn; column<=lastColumn; column++)
+		{
+			const float px = float(column)+0.5f;
+			if (A[0]*px+B[0]*py+C[0]<0.f || A[1]*px+B[1]*py+C[1]<0.f || A[2]*px+B[2]*py+C[2]<0.f)
+				continue;
+			depthRow[column] = core::max(depthRow[column],zA*px+zB*py+zC);
+		}
+		#endif
+	}
+}
+
+void COcclusionCuller::buildHierarchicalDepth()
+{
+	for (size_t l=1u; l<Levels.size(); l++)
+	{
+		const auto& src = Levels[l-1u];
+		const auto& dst = Levels[l];
+		const float* in = Depth.data()+src.offset;
+		float* out = Depth.data()+dst.offset;
+		for (uint32_t y=0u; y<dst.height; y++)
+		{
+			const uint32_t y0 = y*2u;
+			const uint32_t y1 = core::min(y0+1u,src.height-1u);
+			for (uint32_t x=0u; x<dst.width; x++)
+			{
+				const uint32_t x0 = x*2u;
+				const uint32_t x1 = core::min(x0+1u,src.width-1u);
+				out[y*dst.width+x] = core::min(core::min(in[y0*src.width+x0],in[y0*src.width+x1]),core::min(in[y1*src.width+x0],in[y1*src.width+x1]));
+			}
+		}
+	}
+}
+
+
+bool COcclusionCuller::isOccluded(const core::aabbox3df& worldBox)
+{
+	if (!HasDepth)
+		return false;
+	Statistics.testedBoxes++;
+
+	float minX = FLT_MAX, maxX = -FLT_MAX, minY = FLT_MAX, maxY = -FLT_MAX;
+	float maxInvW = 0.f;
+	for (uint32_t i=0u; i<8u; i++)
+	{
+		const core::vectorSIMDf corner((i&0x1u) ? worldBox.MaxEdge.X:worldBox.MinEdge.X,
+										(i&0x2u) ? worldBox.MaxEdge.Y:worldBox.MinEdge.Y,
+										(i&0x4u) ? worldBox.MaxEdge.Z:worldBox.MinEdge.Z, 1.f);
+		core::vectorSIMDf clip;
+		ViewProj.transformVect(clip,corner);
+		// box reaches the camera, nothing can be in front of it
+		if (clip.w<NearW)
+			return false;
+
+		const float invW = 1.f/clip.w;
+		float x,y;
+		toScreen(x,y,clip,invW);
+		minX = core::min(minX,x);
+		maxX = core::max(maxX,x);
+		minY = core::min(minY,y);
+		maxY = core::max(maxY,y);
+		maxInvW = core::max(maxInvW,invW);
+	}
+	// off-screen boxes are the frustum test's business
+	if (maxX<0.f || minX>=float(Width) || maxY<0.f || minY>=float(Height))
+		return false;
+
+	uint32_t x0 = static_cast<uint32_t>(core::max(minX,0.f));
+	uint32_t x1 = static_cast<uint32_t>(core::min(maxX,float(Width-1u)));
+	uint32_t y0 = static_cast<uint32_t>(core::max(minY,0.f));
+	uint32_t y1 = static_cast<uint32_t>(core::min(maxY,float(Height-1u)));
+	// go up the hierarchy until the footprint is at most 4x4 texels
+	size_t level = 0u;
+	while (level+1u<Levels.size() && ((x1>>level)-(x0>>level)>=4u || (y1>>level)-(y0>>level)>=4u))
+		level++;
+	x0 >>= level; x1 >>= level;
+	y0 >>= level; y1 >>= level;
+
+	const auto& mip = Levels[level];
+	const float* depth = Depth.data()+mip.offset;
+	for (uint32_t y=y0; y<=y1; y++)
+	for (uint32_t x=x0; x<=x1; x++)
+	{
+		// the nearest point of the box is in front of the farthest occluder sample here
+		if (maxInvW>=depth[y*mip.width+x])
+			return false;
+	}
+	Statistics.occludedBoxes++;
+	return true;
+}
+
+} // end namespace scene
+} // end namespace irr
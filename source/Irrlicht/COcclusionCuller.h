@@ -0,0 +1,105 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __C_OCCLUSION_CULLER_H_INCLUDED__
+#define __C_OCCLUSION_CULLER_H_INCLUDED__
+
+#include "IOcclusionCuller.h"
+#include "IDummyTransformationSceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Tiled SSE rasterizer of occluder triangles into a 1/w depth buffer, with a min-reduced hierarchical depth for box tests
+	/** The depth buffer is split into bands of `BandHeight` rows, with many occluder triangles the bands get rasterized in
+	parallel on core::CTaskScheduler::getGlobal(). Storing 1/w instead of z makes the depth linear in screen space and independent of the projection's depth range. */
+	class COcclusionCuller : public IOcclusionCuller
+	{
+		protected:
+			virtual ~COcclusionCuller();
+
+		public:
+			_IRR_STATIC_INLINE_CONSTEXPR uint32_t BandHeight = 16u;
+			//! below this many triangles the calling thread rasterizes everything
+			_IRR_STATIC_INLINE_CONSTEXPR uint32_t MultithreadingTriangleThreshold = 512u;
+
+			//! `width` gets rounded up to a multiple of 4
+			COcclusionCuller(uint32_t width=256u, uint32_t height=128u);
+
+			void setEnabled(bool enabled) override { Enabled = enabled; }
+			bool isEnabled() const override { return Enabled; }
+
+			uint32_t addOccluder(const asset::ICPUMeshBuffer* meshbuffer, IDummyTransformationSceneNode* node=nullptr) override;
+			void removeOccluder(uint32_t id) override;
+			void clearOccluders() override;
+			bool isOccluder(const IDummyTransformationSceneNode* node) const override
+			{
+				return OccluderNodes.find(node)!=OccluderNodes.end();
+			}
+
+			void rasterize(const core::matrix4SIMD& viewProj) override;
+			bool isOccluded(const core::aabbox3df& worldBox) override;
+
+			const SStatistics& getStatistics() const override { return Statistics; }
+
+			uint32_t getWidth() const override { return Width; }
+			uint32_t getHeight() const override { return Height; }
+			const float* getDepthBuffer() const override { return Depth.data(); }
+
+		private:
+			struct SOccluder
+			{
+				uint32_t id;
+				IDummyTransformationSceneNode* node;
+				//! object space triangle list, `w` is always 1
+				core::vector<core::vectorSIMDf> vertices;
+			};
+			//! screen space triangle, ready for edge function setup
+			struct STriangle
+			{
+				float x[3];
+				float y[3];
+				float invW[3];
+				int32_t minY, maxY;
+			};
+			struct SMipLevel
+			{
+				size_t offset;
+				uint32_t width, height;
+			};
+
+			//! clips against the w near plane and appends up to two screen space triangles
+			void setupTriangle(const core::vectorSIMDf* clip);
+			void rasterizeBand(uint32_t band);
+			void rasterizeTriangle(const STriangle& tri, int32_t firstRow, int32_t lastRow);
+			void buildHierarchicalDepth();
+
+			inline void toScreen(float& outX, float& outY, const core::vectorSIMDf& clip, float invW) const
+			{
+				outX = (clip.x*invW*0.5f+0.5f)*float(Width);
+				outY = (0.5f-clip.y*invW*0.5f)*float(Height);
+			}
+
+			bool Enabled;
+			bool HasDepth;
+			uint32_t Width, Height;
+			uint32_t NextOccluderId;
+			core::vector<SOccluder> Occluders;
+			core::unordered_map<const IDummyTransformationSceneNode*,uint32_t> OccluderNodes;
+
+			core::matrix4SIMD ViewProj;
+			core::vector<STriangle> Triangles;
+			//! level 0 is the depth buffer itself, every next level stores the minimum (farthest) of 2x2 texels of the previous
+			core::vector<float> Depth;
+			core::vector<SMipLevel> Levels;
+
+			SStatistics Statistics;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
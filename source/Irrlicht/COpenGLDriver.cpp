@@ -1299,6 +1299,7 @@ void COpenGLDriver::copyBuffer(IGPUBuffer* readBuffer, IGPUBuffer* writeBuffer,
 {
     COpenGLBuffer* readbuffer = static_cast<COpenGLBuffer*>(readBuffer);
     COpenGLBuffer* writebuffer = static_cast<COpenGLBuffer*>(writeBuffer);
+    CNullDriver::copyBuffer(readBuffer,writeBuffer,readOffset,writeOffset,length);
     extGlCopyNamedBufferSubData(readbuffer->getOpenGLName(),writebuffer->getOpenGLName(),readOffset,writeOffset,length);
 }
 
@@ -1429,7 +1430,7 @@ void COpenGLDriver::drawMeshBuffer(const IGPUMeshBuffer* mb)
         return;
 
     const COpenGLVAOSpec* meshLayoutVAO = static_cast<const COpenGLVAOSpec*>(mb->getMeshDataAndFormat());
-    if (!found->setActiveVAO(meshLayoutVAO))
+    if (!found->setActiveVAO(meshLayoutVAO,&FrameStatistics.vertexInputBinds))
         return;
 
 #ifdef _IRR_DEBUG
@@ -1513,11 +1514,13 @@ void COpenGLDriver::drawArraysIndirect(  const asset::IMeshDataFormatDesc<video:
         return;
 
     const COpenGLVAOSpec* meshLayoutVAO = static_cast<const COpenGLVAOSpec*>(vao);
-    if (!found->setActiveVAO(meshLayoutVAO))
+    if (!found->setActiveVAO(meshLayoutVAO,&FrameStatistics.vertexInputBinds))
         return;
 
     found->setActiveIndirectDrawBuffer(static_cast<const COpenGLBuffer*>(indirectDrawBuff));
 
+	CNullDriver::drawArraysIndirect(vao,mode,indirectDrawBuff,offset,count,stride);
+
 	// draw everything
 	setRenderStates3DMode();
 
@@ -1603,11 +1606,13 @@ void COpenGLDriver::drawIndexedIndirect(const asset::IMeshDataFormatDesc<video::
         return;
 
     const COpenGLVAOSpec* meshLayoutVAO = static_cast<const COpenGLVAOSpec*>(vao);
-    if (!found->setActiveVAO(meshLayoutVAO))
+    if (!found->setActiveVAO(meshLayoutVAO,&FrameStatistics.vertexInputBinds))
         return;
 
     found->setActiveIndirectDrawBuffer(static_cast<const COpenGLBuffer*>(indirectDrawBuff));
 
+	CNullDriver::drawIndexedIndirect(vao,mode,type,indirectDrawBuff,offset,count,stride);
+
 	// draw everything
 	setRenderStates3DMode();
 
@@ -1968,7 +1973,7 @@ void COpenGLDriver::SAuxContext::COpenGLVAO::bindBuffers(   const COpenGLBuffer*
     lastValidated = beginStamp;
 }
 
-bool COpenGLDriver::SAuxContext::setActiveVAO(const COpenGLVAOSpec* const spec)
+bool COpenGLDriver::SAuxContext::setActiveVAO(const COpenGLVAOSpec* const spec, uint32_t* bindCount)
 {
     if (!spec)
     {
@@ -1996,6 +2001,8 @@ bool COpenGLDriver::SAuxContext::setActiveVAO(const COpenGLVAOSpec* const spec)
         #endif // _IRR_DEBUG
 
         extGlBindVertexArray(CurrentVAO.second->getOpenGLName());
+        if (bindCount)
+            (*bindCount)++;
     }
 
     CurrentVAO.second->bindBuffers(static_cast<const COpenGLBuffer*>(spec->getIndexBuffer()),reinterpret_cast<const COpenGLBuffer* const*>(spec->getMappedBuffers()),&spec->getMappedBufferOffset(asset::EVAI_ATTR0),&spec->getMappedBufferStride(asset::EVAI_ATTR0));
@@ -2302,8 +2309,7 @@ void COpenGLDriver::setMaterial(const SGPUMaterial& material)
     if (!found)
         return;
 
-
-	Material = material;
+	CNullDriver::setMaterial(material);
 
 	for (int32_t i = MaxTextureUnits-1; i>= 0; --i)
 	{
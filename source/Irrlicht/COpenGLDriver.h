@@ -664,7 +664,8 @@ namespace video
                 indirectDraw.set(buff);
             }
 
-            bool setActiveVAO(const COpenGLVAOSpec* const spec);
+            //! `bindCount` gets incremented if the VAO had to be changed
+            bool setActiveVAO(const COpenGLVAOSpec* const spec, uint32_t* bindCount=nullptr);
 
             //! sets the current Texture
             //! Returns whether setting was a success or not.
@@ -959,7 +960,7 @@ namespace video
 		//! bool to make all renderstates reset if set to true.
 		bool ResetRenderStates;
 
-		SGPUMaterial Material, LastMaterial;
+		SGPUMaterial LastMaterial;
 
 
 
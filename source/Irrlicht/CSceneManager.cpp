@@ -22,6 +22,7 @@
 #include "CMeshSceneNodeInstanced.h"
 #include "CSkyBoxSceneNode.h"
 #include "CSkyDomeSceneNode.h"
+#include "COcclusionCuller.h"
 
 #include "CSceneNodeAnimatorRotation.h"
 #include "CSceneNodeAnimatorFlyCircle.h"
@@ -42,7 +43,7 @@ CSceneManager::CSceneManager(IrrlichtDevice* device, video::IVideoDriver* driver
 		gui::ICursorControl* cursorControl)
 : ISceneNode(0, 0), Driver(driver), Timer(timer), FileSystem(fs), Device(device),
 	CursorControl(cursorControl),
-	ActiveCamera(0), CurrentRendertime(ESNRP_NONE),
+	ActiveCamera(0), OcclusionCuller(new COcclusionCuller()), CurrentRendertime(ESNRP_NONE),
 	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type")
 {
 	#ifdef _IRR_DEBUG
@@ -203,6 +204,8 @@ CSceneManager::~CSceneManager()
 		ActiveCamera->drop();
 	ActiveCamera = 0;
 
+	OcclusionCuller->drop();
+
 	// remove all nodes and animators before dropping the driver
 	// as render targets may be destroyed twice
 
@@ -508,16 +511,21 @@ const core::aabbox3d<float>& CSceneManager::getBoundingBox()
 
 //! returns if node is culled
 bool CSceneManager::isCulled(ISceneNode* node) const
+{
+	return getCullResult(node)!=ECR_VISIBLE;
+}
+
+CSceneManager::E_CULL_RESULT CSceneManager::getCullResult(ISceneNode* node) const
 {
 	const ICameraSceneNode* cam = getActiveCamera();
 	if (!cam)
 	{
-		return false;
+		return ECR_VISIBLE;
 	}
 
     core::aabbox3d<float> tbox = node->getBoundingBox();
     if (tbox.MinEdge==tbox.MaxEdge)
-        return true;
+        return ECR_FRUSTUM;
 
     auto cullMode = node->getAutomaticCulling();
     if (cullMode & (scene::EAC_BOX|scene::EAC_FRUSTUM_BOX))
@@ -525,16 +533,51 @@ bool CSceneManager::isCulled(ISceneNode* node) const
 		node->getAbsoluteTransformation().transformBoxEx(tbox);
         // can be seen by a bounding box ?
         if ((cullMode & scene::EAC_BOX) && !tbox.intersectsWithBox(cam->getViewFrustum()->getBoundingBox()))
-            return true;
+            return ECR_FRUSTUM;
         // can be seen by cam pyramid planes ?
         if ((cullMode & scene::EAC_FRUSTUM_BOX) && !cam->getViewFrustum()->intersectsAABB(tbox))
-            return true;
+            return ECR_FRUSTUM;
+        // hidden behind the occluders rasterized this frame ?
+        if (OcclusionCuller->isEnabled() && !OcclusionCuller->isOccluder(node) && OcclusionCuller->isOccluded(tbox))
+            return ECR_OCCLUDED;
 	}
 
+	return ECR_VISIBLE;
+}
+
+bool CSceneManager::cullForRegistration(ISceneNode* node)
+{
+	CullingStatistics.testedNodes++;
+	switch (getCullResult(node))
+	{
+		case ECR_FRUSTUM:
+			CullingStatistics.frustumCulledNodes++;
+			return true;
+		case ECR_OCCLUDED:
+			CullingStatistics.occlusionCulledNodes++;
+			return true;
+		default:
+			break;
+	}
+	CullingStatistics.submittedNodes++;
 	return false;
 }
 
 
+float CSceneManager::getDistanceToCameraSQ(ISceneNode* node) const
+{
+	if (!ActiveCamera)
+		return 0.f;
+	return node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(ActiveCamera->getAbsolutePosition());
+}
+
+const CSceneManager::SRenderListEntry* CSceneManager::sortRenderList(core::vector<SRenderListEntry>& list)
+{
+	if (RenderListScratch.size()<list.size())
+		RenderListScratch.resize(list.size());
+	return core::radix_sort(list.data(),list.data()+list.size(),RenderListScratch.data(),[](const SRenderListEntry& entry) {return entry.Key;});
+}
+
 //! registers a node for rendering it at a specific time.
 uint32_t CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
 {
@@ -566,28 +609,28 @@ uint32_t CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_
 			taken = 1;
 			break;
 		case ESNRP_SOLID:
-			if (!isCulled(node))
+			if (!cullForRegistration(node))
 			{
-				SolidNodeList.push_back(node);
+				SolidNodeList.push_back({getSolidSortKey(node->getRenderPriorityScore(),getDistanceToCameraSQ(node)),node});
 				taken = 1;
 			}
 			break;
 		case ESNRP_TRANSPARENT:
-			if (!isCulled(node))
+			if (!cullForRegistration(node))
 			{
-				TransparentNodeList.push_back(TransparentNodeEntry(node, ActiveCamera->getAbsolutePosition()));
+				TransparentNodeList.push_back({getTransparentSortKey(getDistanceToCameraSQ(node)),node});
 				taken = 1;
 			}
 			break;
 		case ESNRP_TRANSPARENT_EFFECT:
-			if (!isCulled(node))
+			if (!cullForRegistration(node))
 			{
-				TransparentEffectNodeList.push_back(TransparentNodeEntry(node, ActiveCamera->getAbsolutePosition()));
+				TransparentEffectNodeList.push_back({getTransparentSortKey(getDistanceToCameraSQ(node)),node});
 				taken = 1;
 			}
 			break;
 		case ESNRP_AUTOMATIC:
-			if (!isCulled(node))
+			if (!cullForRegistration(node))
 			{
 	#ifdef REIMPLEMENT_THIS
 				taken = 0;
@@ -599,8 +642,7 @@ uint32_t CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_
 					if (rnd && rnd->isTransparent())
 					{
 						// register as transparent node
-						TransparentNodeEntry e(node, ActiveCamera->getAbsolutePosition());
-						TransparentNodeList.push_back(e);
+						TransparentNodeList.push_back({getTransparentSortKey(getDistanceToCameraSQ(node)),node});
 						taken = 1;
 						break;
 					}
@@ -609,7 +651,7 @@ uint32_t CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_
 				// not transparent, register as solid
 				if (!taken)
 				{
-					SolidNodeList.push_back(node);
+					SolidNodeList.push_back({getSolidSortKey(node->getRenderPriorityScore(),getDistanceToCameraSQ(node)),node});
 					taken = 1;
 				}
 			}
@@ -645,6 +687,7 @@ void CSceneManager::OnAnimate(uint32_t timeMs)
 //! draws all scene nodes
 void CSceneManager::drawAll()
 {
+	IRR_PROFILE_SCOPE("CSceneManager::drawAll");
 	if (!Driver)
 		return;
 
@@ -657,7 +700,10 @@ void CSceneManager::drawAll()
 	Driver->setTransform(video::E4X3TS_WORLD,core::matrix3x4SIMD());
 
 	// do animations and other stuff.
-	OnAnimate(std::chrono::duration_cast<std::chrono::milliseconds>(Timer->getTime()).count());
+	{
+		IRR_PROFILE_SCOPE("CSceneManager::OnAnimate");
+		OnAnimate(std::chrono::duration_cast<std::chrono::milliseconds>(Timer->getTime()).count());
+	}
 
 	/*!
 		First Scene Node for prerendering should be the active camera
@@ -668,8 +714,19 @@ void CSceneManager::drawAll()
 		ActiveCamera->render();
 	}
 
+	// occluders go into the depth buffer before any node gets tested against it
+	CullingStatistics = SCullingStatistics();
+	if (ActiveCamera && OcclusionCuller->isEnabled())
+	{
+		IRR_PROFILE_SCOPE("IOcclusionCuller::rasterize");
+		OcclusionCuller->rasterize(ActiveCamera->getConcatenatedMatrix());
+	}
+
 	// let all nodes register themselves
-	OnRegisterSceneNode();
+	{
+		IRR_PROFILE_SCOPE("CSceneManager::OnRegisterSceneNode");
+		OnRegisterSceneNode();
+	}
 
 	//render camera scenes
 	{
@@ -694,34 +751,36 @@ void CSceneManager::drawAll()
 
 	// render default objects
 	{
+		IRR_PROFILE_SCOPE("CSceneManager::drawAll solid");
 		CurrentRendertime = ESNRP_SOLID;
 
-		std::stable_sort(SolidNodeList.begin(),SolidNodeList.end()); // sort by textures
-
-        for (i=0; i<SolidNodeList.size(); ++i)
-            SolidNodeList[i].Node->render();
+		const SRenderListEntry* sorted = sortRenderList(SolidNodeList); // sort by priority, then front to back
+		for (i=0; i<SolidNodeList.size(); ++i)
+			sorted[i].Node->render();
 
 		SolidNodeList.clear();
 	}
 
 	// render transparent objects.
 	{
+		IRR_PROFILE_SCOPE("CSceneManager::drawAll transparent");
 		CurrentRendertime = ESNRP_TRANSPARENT;
 
-		std::stable_sort(TransparentNodeList.begin(),TransparentNodeList.end()); // sort by distance from camera
-        for (i=0; i<TransparentNodeList.size(); ++i)
-            TransparentNodeList[i].Node->render();
+		const SRenderListEntry* sorted = sortRenderList(TransparentNodeList); // sort by distance from camera
+		for (i=0; i<TransparentNodeList.size(); ++i)
+			sorted[i].Node->render();
 
 		TransparentNodeList.clear();
 	}
 
 	// render transparent effect objects.
 	{
+		IRR_PROFILE_SCOPE("CSceneManager::drawAll transparent effect");
 		CurrentRendertime = ESNRP_TRANSPARENT_EFFECT;
 
-		std::stable_sort(TransparentEffectNodeList.begin(),TransparentEffectNodeList.end()); // sort by distance from camera
-        for (i=0; i<TransparentEffectNodeList.size(); ++i)
-            TransparentEffectNodeList[i].Node->render();
+		const SRenderListEntry* sorted = sortRenderList(TransparentEffectNodeList); // sort by distance from camera
+		for (i=0; i<TransparentEffectNodeList.size(); ++i)
+			sorted[i].Node->render();
 
 		TransparentEffectNodeList.clear();
 	}
@@ -234,84 +234,48 @@ namespace scene
 		//! returns if node is culled
 		virtual bool isCulled(ISceneNode* node) const;
 
-	protected:
+		virtual IOcclusionCuller* getOcclusionCuller() override { return OcclusionCuller; }
 
-		//! clears the deletion list
-		void clearDeletionList();
+		virtual const SCullingStatistics& getCullingStatistics() const override { return CullingStatistics; }
 
-		struct DefaultNodeEntry
+	protected:
+		enum E_CULL_RESULT
 		{
-				DefaultNodeEntry(ISceneNode* n) :
-					Node(n), renderPriority(0x80000000u)
-				{
-					renderPriority = n->getRenderPriorityScore();
-#ifdef REIMPLEMENT_THIS
-					if (n->getMaterialCount())
-						Material = n->getMaterial(0).MaterialType;
-#endif
-				}
-
-				bool operator < (const DefaultNodeEntry& other) const
-				{
-#ifdef REIMPLEMENT_THIS
-					return (renderPriority < other.renderPriority)||(renderPriority==other.renderPriority && Material<other.Material);
-#else
-					return renderPriority < other.renderPriority;
-#endif
-				}
-
-				ISceneNode* Node;
-			private:
-				uint32_t renderPriority;
-#ifdef REIMPLEMENT_THIS
-				video::E_MATERIAL_TYPE Material;
-#endif
+			ECR_VISIBLE = 0,
+			ECR_FRUSTUM,
+			ECR_OCCLUDED
 		};
+		//! the actual culling tests behind isCulled
+		E_CULL_RESULT getCullResult(ISceneNode* node) const;
+		//! culls and keeps the statistics, returns true if culled
+		bool cullForRegistration(ISceneNode* node);
 
-		//! sort on distance (center) to camera
-		struct TransparentNodeEntry
-		{
-			TransparentNodeEntry(ISceneNode* n, const core::vector3df& camera)
-				: Node(n)
-			{
-				Distance = Node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camera);
-			}
-
-			bool operator < (const TransparentNodeEntry& other) const
-			{
-				return Distance > other.Distance;
-			}
+		//! clears the deletion list
+		void clearDeletionList();
 
+		//! render list entry, every list gets radix sorted on `Key` before drawing
+		struct SRenderListEntry
+		{
+			uint64_t Key;
 			ISceneNode* Node;
-			private:
-				double Distance;
 		};
 
-		//! sort on distance (sphere) to camera
-		struct DistanceNodeEntry
+		//! render priority in the upper half, then front to back by distance quantized to 16 bits (exponent and 7 bits of mantissa)
+		static inline uint64_t getSolidSortKey(uint32_t renderPriority, float distanceSQ)
+		{
+			return (uint64_t(renderPriority)<<32ull)|(core::IR(distanceSQ)>>16u);
+		}
+		//! back to front at full precision, the bit pattern of a positive float grows with its value
+		static inline uint64_t getTransparentSortKey(float distanceSQ)
 		{
-			DistanceNodeEntry(ISceneNode* n, const core::vector3df& cameraPos)
-				: Node(n)
-			{
-				setNodeAndDistanceFromPosition(n, cameraPos);
-			}
-
-			bool operator < (const DistanceNodeEntry& other) const
-			{
-				return Distance < other.Distance;
-			}
-
-			void setNodeAndDistanceFromPosition(ISceneNode* n, const core::vector3df & fromPosition)
-			{
-				Node = n;
-				Distance = Node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(fromPosition);
-				Distance -= Node->getBoundingBox().getExtent().getLengthSQ() * 0.5;
-			}
+			return ~core::IR(distanceSQ);
+		}
 
-			ISceneNode* Node;
-			private:
-			double Distance;
-		};
+		//! squared distance from the node's origin to the active camera, 0 if there is none
+		float getDistanceToCameraSQ(ISceneNode* node) const;
+
+		//! sorts the list and returns where the sorted entries ended up, either in `list` or in `RenderListScratch`
+		const SRenderListEntry* sortRenderList(core::vector<SRenderListEntry>& list);
 
 		//! video driver
 		video::IVideoDriver* Driver;
@@ -332,15 +296,21 @@ namespace scene
 		core::vector<ISceneNode*> CameraList;
 		core::vector<ISceneNode*> LightList;
 		core::vector<ISceneNode*> SkyBoxList;
-		core::vector<DefaultNodeEntry> SolidNodeList;
-		core::vector<TransparentNodeEntry> TransparentNodeList;
-		core::vector<TransparentNodeEntry> TransparentEffectNodeList;
+		//! only ever cleared, so after the first few frames registering nodes does not allocate
+		core::vector<SRenderListEntry> SolidNodeList;
+		core::vector<SRenderListEntry> TransparentNodeList;
+		core::vector<SRenderListEntry> TransparentEffectNodeList;
+		//! ping-pong buffer of the radix sort, shared by all lists
+		core::vector<SRenderListEntry> RenderListScratch;
 
 		core::vector<IDummyTransformationSceneNode*> DeletionList;
 
 		//! current active camera
 		ICameraSceneNode* ActiveCamera;
 
+		IOcclusionCuller* OcclusionCuller;
+		SCullingStatistics CullingStatistics;
+
 		core::smart_refctd_ptr<video::IGPUBuffer> redundantMeshDataBuf;
 
 		E_SCENE_NODE_RENDER_PASS CurrentRendertime;
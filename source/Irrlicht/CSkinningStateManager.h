@@ -20,6 +20,8 @@ namespace scene
 #ifdef _IRR_COMPILE_WITH_OPENGL_
             video::ITextureBufferObject* TBO;
 #endif
+            //! scratch for the local transforms of all bones of the instance being boned
+            core::vector<core::matrix3x4SIMD> localTransforms;
         protected:
             virtual ~CSkinningStateManager()
             {
@@ -30,7 +32,7 @@ namespace scene
 
         public:
             CSkinningStateManager(const E_BONE_UPDATE_MODE& boneControl, video::IVideoDriver* driver, const asset::CFinalBoneHierarchy* sourceHierarchy)
-                                    : ISkinningStateManager(boneControl,driver,sourceHierarchy), Driver(driver)
+                                    : ISkinningStateManager(boneControl,driver,sourceHierarchy), Driver(driver), localTransforms(sourceHierarchy->getBoneCount())
             {
 #ifdef _IRR_COMPILE_WITH_OPENGL_
                 TBO = driver->addTextureBufferObject(instanceBoneDataAllocator->getFrontBuffer(),video::ITextureBufferObject::ETBOF_RGBA32F);
@@ -86,6 +88,7 @@ namespace scene
                 tmp->refCount = 1;
                 tmp->frame = 0.f;
                 tmp->interpolateAnimation = true;
+                tmp->keyframeCursor = 0u;
                 tmp->attachedNode = attachedNode;
                 if (boneControlMode!=EBUM_CONTROL)
                 {
@@ -114,7 +117,7 @@ namespace scene
                         for (size_t i=0; i<referenceHierarchy->getBoneCount(); i++)
                         {
                             const asset::CFinalBoneHierarchy::BoneReferenceData& boneData = referenceHierarchy->getBoneData()[i];
-                            core::matrix4x3 localMatrix = asset::CFinalBoneHierarchy::getMatrixFromKey(referenceHierarchy->getNonInterpolatedAnimationData(i)[0]).getAsRetardedIrrlichtMatrix();
+                            core::matrix4x3 localMatrix = asset::CFinalBoneHierarchy::getMatrixFromKey(referenceHierarchy->getAnimationKey(i,0u,false)).getAsRetardedIrrlichtMatrix();
 
                             IBoneSceneNode* tmpBone; //! TODO: change to placement new
                             if (boneData.parentOffsetRelative)
@@ -217,19 +220,19 @@ namespace scene
 
 
                 float interpolationFactor;
-                size_t foundKeyIx = referenceHierarchy->getLowerBoundBoneKeyframes(interpolationFactor,currentInstance->frame);
+                size_t foundKeyIx = referenceHierarchy->getLowerBoundBoneKeyframes(interpolationFactor,currentInstance->frame,currentInstance->keyframeCursor);
                 float interpolantPrecalcTerm2,interpolantPrecalcTerm3;
                 core::quaternion::flerp_interpolant_terms(interpolantPrecalcTerm2,interpolantPrecalcTerm3,interpolationFactor);
 
                 while (boneStackSize--)
                 {
                     size_t j = boneStack[boneStackSize];
-					asset::CFinalBoneHierarchy::AnimationKeyData upperFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundKeyIx];
+					asset::CFinalBoneHierarchy::AnimationKeyData upperFrame = referenceHierarchy->getAnimationKey(j,foundKeyIx,currentInstance->interpolateAnimation);
 
                     core::matrix3x4SIMD interpolatedLocalTform;
                     if (currentInstance->interpolateAnimation&&interpolationFactor<1.f)
                     {
-						asset::CFinalBoneHierarchy::AnimationKeyData lowerFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundKeyIx-1];
+						asset::CFinalBoneHierarchy::AnimationKeyData lowerFrame = referenceHierarchy->getAnimationKey(j,foundKeyIx-1,currentInstance->interpolateAnimation);
                         interpolatedLocalTform = referenceHierarchy->getMatrixFromKeys(lowerFrame,upperFrame,interpolationFactor,interpolantPrecalcTerm2,interpolantPrecalcTerm3);
                     }
                     else
@@ -293,6 +296,7 @@ namespace scene
 
             virtual void performBoning()
             {
+                IRR_PROFILE_SCOPE("CSkinningStateManager::performBoning");
                 if (referenceHierarchy->getHierarchyLevels()==0||instanceBoneDataAllocator->getAddressAllocator().get_allocated_size()==0)
                     return;
 
@@ -324,9 +328,8 @@ namespace scene
 
 
                                     float interpolationFactor;
-                                    size_t foundKeyIx = referenceHierarchy->getLowerBoundBoneKeyframes(interpolationFactor,currentInstance->frame);
-                                    float interpolantPrecalcTerm2,interpolantPrecalcTerm3;
-                                    core::quaternion::flerp_interpolant_terms(interpolantPrecalcTerm2,interpolantPrecalcTerm3,interpolationFactor);
+                                    size_t foundKeyIx = referenceHierarchy->getLowerBoundBoneKeyframes(interpolationFactor,currentInstance->frame,currentInstance->keyframeCursor);
+                                    referenceHierarchy->getLocalMatrices(localTransforms.data(),0u,localTransforms.size(),foundKeyIx,interpolationFactor,currentInstance->interpolateAnimation);
 
 
                                     FinalBoneData* boneDataForInstance = reinterpret_cast<FinalBoneData*>(boneData+i);
@@ -342,16 +345,7 @@ namespace scene
                                         localLastDirtyInstance = i;
                                         boneDataForInstance[j].lastAnimatedFrame = currentInstance->frame;
 
-                                        asset::CFinalBoneHierarchy::AnimationKeyData upperFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundKeyIx];
-
-                                        core::matrix3x4SIMD interpolatedLocalTform;
-                                        if (currentInstance->interpolateAnimation&&interpolationFactor<1.f)
-                                        {
-											asset::CFinalBoneHierarchy::AnimationKeyData lowerFrame =  (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundKeyIx-1];
-                                            interpolatedLocalTform = referenceHierarchy->getMatrixFromKeys(lowerFrame,upperFrame,interpolationFactor,interpolantPrecalcTerm2,interpolantPrecalcTerm3);
-                                        }
-                                        else
-                                            interpolatedLocalTform = referenceHierarchy->getMatrixFromKey(upperFrame);
+                                        const core::matrix3x4SIMD& interpolatedLocalTform = localTransforms[j];
 
                                         if (j < referenceHierarchy->getBoneLevelRangeEnd(0))
                                             getGlobalMatrices(currentInstance)[j] = interpolatedLocalTform.getAsRetardedIrrlichtMatrix();
@@ -230,10 +230,17 @@ IReadFile* CTarReader::createAndOpenFile(const io::path& filename)
 {
     auto it = findFile(Files.begin(),Files.end(),filename,false);
 	if (it!=Files.end())
-        return new CLimitReadFile(File, it->Offset, it->Size, it->FullName);
+        return createAndOpenListedFile(*it);
 
 	return 0;
 }
+
+
+//! opens a file from an entry of the file list
+IReadFile* CTarReader::createAndOpenListedFile(const SFileListEntry& entry)
+{
+	return new CLimitReadFile(File, entry.Offset, entry.Size, entry.FullName);
+}
 } // end namespace io
 } // end namespace irr
 
@@ -0,0 +1,245 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#include "CZipInflateReadFile.h"
+
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+
+#include "os.h"
+
+namespace irr
+{
+namespace io
+{
+
+static_assert(CZipInflateReadFile::CheckpointInterval%CZipInflateReadFile::ChunkSize==0u, "Checkpoints need to fall on chunk boundaries!");
+
+namespace
+{
+	constexpr size_t InvalidChunk = ~size_t(0u);
+}
+
+CZipInflateReadFile::CZipInflateReadFile(IReadFile* compressedFile, size_t compressedOffset, size_t compressedSize, size_t uncompressedSize, const io::path& fileName)
+	:	File(compressedFile), CompressedOffset(compressedOffset), CompressedSize(compressedSize), UncompressedSize(uncompressedSize), Pos(0u), Filename(fileName),
+		StreamValid(false), StreamPos(0u), InputPos(0u), UseCounter(0u)
+{
+	#ifdef _IRR_DEBUG
+	setDebugName("CZipInflateReadFile");
+	#endif
+
+	for (auto& chunk : Cache)
+	{
+		chunk.index = InvalidChunk;
+		chunk.lastUse = 0u;
+		chunk.data = nullptr;
+	}
+
+	if (!File)
+		return;
+	File->grab();
+
+	memset(&Stream,0,sizeof(z_stream));
+	Stream.zalloc = (alloc_func)0;
+	Stream.zfree = (free_func)0;
+	Stream.next_in = InputBuffer;
+	Stream.avail_in = 0u;
+
+	// wbits < 0 indicates no zlib header inside the data.
+	if (inflateInit2(&Stream,-MAX_WBITS)!=Z_OK)
+		return;
+
+	if (!pushCheckpoint())
+	{
+		inflateEnd(&Stream);
+		return;
+	}
+	StreamValid = true;
+}
+
+CZipInflateReadFile::~CZipInflateReadFile()
+{
+	if (StreamValid)
+		inflateEnd(&Stream);
+	for (auto& checkpoint : Checkpoints)
+		inflateEnd(&checkpoint.stream);
+	for (auto& chunk : Cache)
+	if (chunk.data)
+		_IRR_ALIGNED_FREE(chunk.data);
+
+	if (File)
+		File->drop();
+}
+
+
+//! returns how much was read
+int32_t CZipInflateReadFile::read(void* buffer, uint32_t sizeToRead)
+{
+	if (!StreamValid || Pos>=UncompressedSize)
+		return 0;
+
+	const size_t toRead = core::min<size_t>(sizeToRead,UncompressedSize-Pos);
+	uint8_t* out = reinterpret_cast<uint8_t*>(buffer);
+	size_t done = 0u;
+	while (done<toRead)
+	{
+		const size_t chunkIx = Pos/ChunkSize;
+		const size_t chunkStart = chunkIx*ChunkSize;
+		const size_t chunkLength = core::min(ChunkSize,UncompressedSize-chunkStart);
+		const size_t offsetInChunk = Pos-chunkStart;
+		const size_t amount = core::min(chunkLength-offsetInChunk,toRead-done);
+
+		// large sequential reads inflate straight into the output and skip the cache
+		if (offsetInChunk==0u && amount==chunkLength && StreamPos==chunkStart)
+		{
+			if (!inflateNextChunk(out+done))
+			{
+				os::Printer::log("Error decompressing", Filename, ELL_ERROR);
+				break;
+			}
+		}
+		else
+		{
+			const uint8_t* chunk = getChunk(chunkIx);
+			if (!chunk)
+			{
+				os::Printer::log("Error decompressing", Filename, ELL_ERROR);
+				break;
+			}
+			memcpy(out+done,chunk+offsetInChunk,amount);
+		}
+		done += amount;
+		Pos += amount;
+	}
+	return static_cast<int32_t>(done);
+}
+
+
+//! changes position in file, returns true if successful
+bool CZipInflateReadFile::seek(const size_t& finalPos, bool relativeMovement)
+{
+	const size_t newPos = relativeMovement ? (Pos+finalPos):finalPos;
+	if (newPos>UncompressedSize)
+		return false;
+
+	Pos = newPos;
+	return true;
+}
+
+
+const uint8_t* CZipInflateReadFile::getChunk(size_t chunkIx)
+{
+	UseCounter++;
+
+	SCachedChunk* leastRecentlyUsed = Cache;
+	for (auto& chunk : Cache)
+	{
+		if (chunk.index==chunkIx)
+		{
+			chunk.lastUse = UseCounter;
+			return chunk.data;
+		}
+		if (chunk.lastUse<leastRecentlyUsed->lastUse)
+			leastRecentlyUsed = &chunk;
+	}
+
+	auto& slot = *leastRecentlyUsed;
+	slot.index = InvalidChunk;
+	if (!slot.data)
+		slot.data = reinterpret_cast<uint8_t*>(_IRR_ALIGNED_MALLOC(ChunkSize,_IRR_SIMD_ALIGNMENT));
+
+	const size_t chunkStart = chunkIx*ChunkSize;
+	if (!rewindStream(chunkStart))
+		return nullptr;
+	// the slot doubles as scratch memory for the chunks we need to skip over
+	while (StreamPos<=chunkStart)
+	{
+		if (!inflateNextChunk(slot.data))
+			return nullptr;
+	}
+
+	slot.index = chunkIx;
+	slot.lastUse = UseCounter;
+	return slot.data;
+}
+
+bool CZipInflateReadFile::inflateNextChunk(uint8_t* out)
+{
+	const size_t outSize = core::min(ChunkSize,UncompressedSize-StreamPos);
+	Stream.next_out = reinterpret_cast<Bytef*>(out);
+	Stream.avail_out = static_cast<uInt>(outSize);
+	while (Stream.avail_out)
+	{
+		if (!Stream.avail_in && InputPos<CompressedSize)
+		{
+			const uint32_t toRead = static_cast<uint32_t>(core::min<size_t>(sizeof(InputBuffer),CompressedSize-InputPos));
+			File->seek(CompressedOffset+InputPos);
+			const int32_t actuallyRead = File->read(InputBuffer,toRead);
+			if (actuallyRead<=0)
+				break;
+			InputPos += actuallyRead;
+			Stream.next_in = InputBuffer;
+			Stream.avail_in = actuallyRead;
+		}
+
+		const int32_t err = inflate(&Stream,Z_NO_FLUSH);
+		if (err==Z_STREAM_END)
+			break;
+		else if (err!=Z_OK)
+			break;
+	}
+
+	if (Stream.avail_out)
+	{
+		// the stream is in an unknown state now, force a rewind on next use
+		StreamPos = InvalidChunk;
+		return false;
+	}
+
+	StreamPos += outSize;
+	if (StreamPos<UncompressedSize && StreamPos%CheckpointInterval==0u && StreamPos/CheckpointInterval==Checkpoints.size())
+		pushCheckpoint();
+	return true;
+}
+
+bool CZipInflateReadFile::pushCheckpoint()
+{
+	// zlib keeps a pointer to the owning z_stream inside its state, so copy straight into the final (stable) address
+	Checkpoints.emplace_back();
+	auto& checkpoint = Checkpoints.back();
+	if (inflateCopy(&checkpoint.stream,&Stream)!=Z_OK)
+	{
+		Checkpoints.pop_back();
+		return false;
+	}
+	checkpoint.compressedPos = InputPos-Stream.avail_in;
+	return true;
+}
+
+bool CZipInflateReadFile::rewindStream(size_t uncompressedPos)
+{
+	const size_t checkpointIx = core::min<size_t>(uncompressedPos/CheckpointInterval,Checkpoints.size()-1u);
+	const size_t checkpointPos = checkpointIx*CheckpointInterval;
+	// already in between the best checkpoint and the target, just inflate forward
+	if (StreamPos<=uncompressedPos && StreamPos>=checkpointPos)
+		return true;
+
+	auto& checkpoint = Checkpoints[checkpointIx];
+	inflateEnd(&Stream);
+	if (inflateCopy(&Stream,&checkpoint.stream)!=Z_OK)
+	{
+		StreamValid = false;
+		return false;
+	}
+	StreamPos = checkpointPos;
+	InputPos = checkpoint.compressedPos;
+	Stream.next_in = InputBuffer;
+	Stream.avail_in = 0u;
+	return true;
+}
+
+
+} // end namespace io
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_ZLIB_
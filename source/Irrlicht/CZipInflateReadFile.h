@@ -0,0 +1,107 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef __C_ZIP_INFLATE_READ_FILE_H_INCLUDED__
+#define __C_ZIP_INFLATE_READ_FILE_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+
+#include "IReadFile.h"
+#include "irr/core/core.h"
+
+#include "zlib/zlib.h"
+
+namespace irr
+{
+namespace io
+{
+
+	//! Read file which inflates a raw deflate stream (zip or gzip entry) on demand
+	/** Instead of inflating the whole entry upfront, the data is decompressed in chunks of `ChunkSize` as reads reach them.
+	Recently used chunks are kept in a small LRU cache, so loaders which read a header and then jump around stay cheap.
+	Every `CheckpointInterval` bytes of output a copy of the inflate state is stored, so a backwards seek only needs
+	to re-inflate from the closest checkpoint instead of from the start of the entry.
+	Memory use is bounded by `CacheSize` chunks plus the checkpoints (around 40kb each) created so far. */
+	class CZipInflateReadFile : public IReadFile
+	{
+		protected:
+			virtual ~CZipInflateReadFile();
+
+		public:
+			_IRR_STATIC_INLINE_CONSTEXPR size_t ChunkSize = 0x1u<<16u;
+			_IRR_STATIC_INLINE_CONSTEXPR uint32_t CacheSize = 8u;
+			_IRR_STATIC_INLINE_CONSTEXPR size_t CheckpointInterval = 0x1u<<21u;
+
+			//! `compressedFile` is grabbed and always seeked to an absolute position before reading, so it can be shared with other readers
+			CZipInflateReadFile(IReadFile* compressedFile, size_t compressedOffset, size_t compressedSize, size_t uncompressedSize, const io::path& fileName);
+
+			//! returns how much was read
+			virtual int32_t read(void* buffer, uint32_t sizeToRead) override;
+
+			//! changes position in file, returns true if successful
+			virtual bool seek(const size_t& finalPos, bool relativeMovement = false) override;
+
+			//! returns size of file
+			virtual size_t getSize() const override { return UncompressedSize; }
+
+			//! returns where in the file we are.
+			virtual size_t getPos() const override { return Pos; }
+
+			//! returns name of file
+			virtual const io::path& getFileName() const override { return Filename; }
+
+			//! whether the inflate stream could be initialized
+			inline bool isValid() const { return StreamValid; }
+
+		private:
+			struct SCheckpoint
+			{
+				z_stream stream;
+				size_t compressedPos;
+			};
+			struct SCachedChunk
+			{
+				size_t index;
+				uint64_t lastUse;
+				uint8_t* data;
+			};
+
+			//! returns nullptr if the data could not be inflated
+			const uint8_t* getChunk(size_t chunkIx);
+			//! inflates the chunk at `StreamPos` into `out` and advances the stream
+			bool inflateNextChunk(uint8_t* out);
+			//! restores the stream to the closest checkpoint at or before `uncompressedPos`
+			bool rewindStream(size_t uncompressedPos);
+			//! saves a copy of the current stream state
+			bool pushCheckpoint();
+
+			IReadFile* File;
+			size_t CompressedOffset;
+			size_t CompressedSize;
+			size_t UncompressedSize;
+			size_t Pos;
+			io::path Filename;
+
+			z_stream Stream;
+			bool StreamValid;
+			//! uncompressed offset the inflate stream has reached, always a multiple of `ChunkSize`
+			size_t StreamPos;
+			//! offset within the compressed data of the next byte to be read into `InputBuffer`
+			size_t InputPos;
+			uint8_t InputBuffer[ChunkSize];
+
+			//! checkpoint `i` is at uncompressed offset `i*CheckpointInterval`, the first one is the freshly initialized stream
+			core::deque<SCheckpoint> Checkpoints;
+			SCachedChunk Cache[CacheSize];
+			uint64_t UseCounter;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_ZLIB_
+
+#endif
@@ -21,6 +21,7 @@ extern "C" void bz_internal_error(int errorCode)
 
 #include "CFileList.h"
 #include "CReadFile.h"
+#include "CZipInflateReadFile.h"
 
 #include "IrrCompileConfig.h"
 #ifdef _IRR_COMPILE_WITH_ZLIB_
@@ -407,7 +408,13 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
     auto found = findFile(Files.begin(),Files.end(),io::IFileSystem::flattenFilename(filename),false);
 	if (found==Files.end())
         return nullptr;
+	return createAndOpenListedFile(*found);
+}
+
 
+//! opens a file from an entry of the file list
+IReadFile* CZipReader::createAndOpenListedFile(const SFileListEntry& entry)
+{
 	// Irrlicht supports 0, 8, 12, 14, 99
 	//0 - The file is stored (no compression)
 	//1 - The file is Shrunk
@@ -427,7 +434,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 	//98 - PPMd - Compression Method, WinZip 10
 	//99 - AES encryption, WinZip 9
 
-	const SZipFileEntry &e = FileInfo[found->ID];
+	const SZipFileEntry &e = FileInfo[entry.ID];
 	wchar_t buf[64];
 	int16_t actualCompressionMethod=e.header.CompressionMethod;
 	IReadFile* decrypted=0;
@@ -493,7 +500,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 			delete [] decryptedBuf;
 			return 0;
 		}
-        decrypted = new io::CMemoryReadFile(decryptedBuf, decryptedSize, found->FullName);
+        decrypted = new io::CMemoryReadFile(decryptedBuf, decryptedSize, entry.FullName);
 		actualCompressionMethod = (e.header.Sig & 0xffff);
 #if 0
 		if ((e.header.Sig & 0xff000000)==0x01000000)
@@ -518,17 +525,35 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 			if (decrypted)
 				return decrypted;
 			else
-                return new CLimitReadFile(File, e.Offset, decryptedSize, found->FullName);
+                return new CLimitReadFile(File, e.Offset, decryptedSize, entry.FullName);
 		}
 	case 8:
 		{
   			#ifdef _IRR_COMPILE_WITH_ZLIB_
 
 			const uint32_t uncompressedSize = e.header.DataDescriptor.UncompressedSize;
+			// big entries get inflated on demand, so the first bytes are available immediately and memory use stays bounded
+			if (uncompressedSize>CZipInflateReadFile::ChunkSize*CZipInflateReadFile::CacheSize)
+			{
+				delete[] decryptedBuf;
+				auto ret = decrypted ?	new CZipInflateReadFile(decrypted, 0u, decryptedSize, uncompressedSize, entry.FullName):
+										new CZipInflateReadFile(File, e.Offset, decryptedSize, uncompressedSize, entry.FullName);
+				if (decrypted)
+					decrypted->drop();
+				if (!ret->isValid())
+				{
+					swprintf ( buf, 64, L"Error decompressing %s", entry.FullName.c_str() );
+					os::Printer::log( buf, ELL_ERROR);
+					ret->drop();
+					return 0;
+				}
+				return ret;
+			}
+
 			char* pBuf = new char[ uncompressedSize ];
 			if (!pBuf)
 			{
-				swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
+				swprintf ( buf, 64, L"Not enough memory for decompressing %s", entry.FullName.c_str() );
 				os::Printer::log( buf, ELL_ERROR);
                 delete[] decryptedBuf;
 				if (decrypted)
@@ -542,7 +567,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 				pcData = new uint8_t[decryptedSize];
 				if (!pcData)
 				{
-					swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
+					swprintf ( buf, 64, L"Not enough memory for decompressing %s", entry.FullName.c_str() );
 					os::Printer::log( buf, ELL_ERROR);
                     delete[] decryptedBuf;
 					delete [] pBuf;
@@ -585,14 +610,14 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
             delete[] decryptedBuf;
 			if (err != Z_OK)
 			{
-				swprintf ( buf, 64, L"Error decompressing %s", found->FullName.c_str() );
+				swprintf ( buf, 64, L"Error decompressing %s", entry.FullName.c_str() );
 				os::Printer::log( buf, ELL_ERROR);
 				delete [] pBuf;
 				return 0;
 			}
             else
             {
-                auto ret = new io::CMemoryReadFile(pBuf, uncompressedSize, found->FullName);
+                auto ret = new io::CMemoryReadFile(pBuf, uncompressedSize, entry.FullName);
                 delete[] pBuf;
                 return ret;
             }
@@ -609,7 +634,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 			char* pBuf = new char[ uncompressedSize ];
 			if (!pBuf)
 			{
-				swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
+				swprintf ( buf, 64, L"Not enough memory for decompressing %s", entry.FullName.c_str() );
 				os::Printer::log( buf, ELL_ERROR);
                 delete[] decryptedBuf;
 				if (decrypted)
@@ -623,7 +648,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 				pcData = new uint8_t[decryptedSize];
 				if (!pcData)
 				{
-					swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
+					swprintf ( buf, 64, L"Not enough memory for decompressing %s", entry.FullName.c_str() );
 					os::Printer::log( buf, ELL_ERROR);
 					delete [] pBuf;
                     delete[] decryptedBuf;
@@ -663,7 +688,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 
 			if (err != BZ_OK)
 			{
-				swprintf ( buf, 64, L"Error decompressing %s", found->FullName.c_str() );
+				swprintf ( buf, 64, L"Error decompressing %s", entry.FullName.c_str() );
 				os::Printer::log( buf, ELL_ERROR);
 				delete [] pBuf;
                 delete[] decryptedBuf;
@@ -671,7 +696,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 			}
             else
             {
-                auto ret = new io::CMemoryReadFile(pBuf, uncompressedSize, found->FullName);
+                auto ret = new io::CMemoryReadFile(pBuf, uncompressedSize, entry.FullName);
                 delete[] pBuf;
                 return ret;
             }
@@ -690,7 +715,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 			char* pBuf = new char[ uncompressedSize ];
 			if (!pBuf)
 			{
-				swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
+				swprintf ( buf, 64, L"Not enough memory for decompressing %s", entry.FullName.c_str() );
 				os::Printer::log( buf, ELL_ERROR);
                 delete[] decryptedBuf;
 				if (decrypted)
@@ -704,7 +729,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 				pcData = new uint8_t[decryptedSize];
 				if (!pcData)
 				{
-					swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
+					swprintf ( buf, 64, L"Not enough memory for decompressing %s", entry.FullName.c_str() );
 					os::Printer::log( buf, ELL_ERROR);
 					delete [] pBuf;
 					return 0;
@@ -735,12 +760,12 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
             delete[] decryptedBuf;
 			if (err != SZ_OK)
 			{
-				os::Printer::log( "Error decompressing", found->FullName, ELL_ERROR);
+				os::Printer::log( "Error decompressing", entry.FullName, ELL_ERROR);
 				delete [] pBuf;
 				return 0;
 			}
 			else
-				return io::createMemoryReadFile(pBuf, uncompressedSize, found->FullName, true);
+				return io::createMemoryReadFile(pBuf, uncompressedSize, entry.FullName, true);
 
 			#else
             delete[] decryptedBuf;
@@ -754,7 +779,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
         delete[] decryptedBuf;
 		return 0;
 	default:
-		swprintf ( buf, 64, L"file has unsupported compression method. %s", found->FullName.c_str() );
+		swprintf ( buf, 64, L"file has unsupported compression method. %s", entry.FullName.c_str() );
 		os::Printer::log( buf, ELL_ERROR);
         delete[] decryptedBuf;
 		return 0;
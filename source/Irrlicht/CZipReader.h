@@ -187,6 +187,9 @@ namespace io
             //! opens a file by file name
             virtual IReadFile* createAndOpenFile(const io::path& filename);
 
+            //! opens a file from an entry of the file list
+            virtual IReadFile* createAndOpenListedFile(const SFileListEntry& entry) override;
+
             //! returns the list of files
             virtual const IFileList* getFileList() const;
 
@@ -25,6 +25,24 @@ namespace irr
 namespace asset
 {
 
+namespace
+{
+	//! Memory of buffers aliasing a file belongs to the file, the buffers just keep it alive
+	class CFileAliasingAllocator
+	{
+		public:
+			using value_type = uint8_t;
+			using pointer = uint8_t*;
+
+			explicit CFileAliasingAllocator(io::IReadFile* _file) : m_file(_file) {}
+
+			void deallocate(pointer, size_t) { m_file = nullptr; }
+
+		private:
+			core::smart_refctd_ptr<io::IReadFile> m_file;
+	};
+}
+
 struct LzmaMemMngmnt
 {
         static void *alloc(ISzAllocPtr, size_t _size) { return _IRR_ALIGNED_MALLOC(_size,_IRR_SIMD_ALIGNMENT); }
@@ -47,6 +65,7 @@ CBAWMeshFileLoader::CBAWMeshFileLoader(IAssetManager* _manager) : m_manager(_man
 
 SAssetBundle CBAWMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
+    IRR_PROFILE_SCOPE("CBAWMeshFileLoader::loadAsset");
 #ifdef _IRR_DEBUG
     auto time = std::chrono::high_resolution_clock::now();
 #endif // _IRR_DEBUG
@@ -124,9 +143,9 @@ SAssetBundle CBAWMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IA
         uint8_t decrKey[16];
         size_t decrKeyLen = 16u;
         uint32_t attempt = 0u;
-        const void* blob = nullptr;
+        const void* blob = blobType==asset::Blob::EBT_RAW_DATA_BUFFER ? tryAliasBlobInFile(*data, ctx) : nullptr;
         // todo: supposedFilename arg is missing (empty string) - what is it?
-        while (_override->getDecryptionKey(decrKey, decrKeyLen, attempt, ctx.inner.mainFile, "", thisCacheKey, ctx.inner, hierLvl))
+        while (!blob && _override->getDecryptionKey(decrKey, decrKeyLen, attempt, ctx.inner.mainFile, "", thisCacheKey, ctx.inner, hierLvl))
         {
             if (!((data->header->compressionType & asset::Blob::EBCT_AES128_GCM) && decrKeyLen != 16u))
                 blob = data->heapBlob = tryReadBlobOnStack(*data, ctx, decrKey);
@@ -157,7 +176,12 @@ SAssetBundle CBAWMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IA
             continue;
         }
 
-		bool fail = !(ctx.createdObjs[handle] = ctx.loadingMgr.instantiateEmpty(blobType, blob, size, params));
+		void* created;
+		if (blobType == asset::Blob::EBT_RAW_DATA_BUFFER)
+			created = createBufferAroundBlob(*data, blob, ctx);
+		else
+			created = ctx.loadingMgr.instantiateEmpty(blobType, blob, size, params);
+		bool fail = !(ctx.createdObjs[handle] = created);
 
 		if (fail)
 		{
@@ -224,14 +248,16 @@ SAssetBundle CBAWMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IA
 			core::vector<core::stringc> boneNames(boneCount);
 			for (auto k = 0; k < boneCount; k++)
 				boneNames[k] = fbhRef->getBoneName(k);
+			const size_t rawAnimationCount = fbhRef->hasCompressedAnimations() ? 0u:fbhRef->getAnimationCount();
 			auto fbhCopy = core::make_smart_refctd_ptr<CFinalBoneHierarchy>(
 				bones, bones + boneCount,
 				boneNames.data(), boneNames.data() + boneCount,
 				fbhRef->getBoneTreeLevelEnd(), fbhRef->getBoneTreeLevelEnd() + fbhRef->getHierarchyLevels(),
 				fbhRef->getKeys(), fbhRef->getKeys() + fbhRef->getKeyFrameCount(),
-				fbhRef->getInterpolatedAnimationData(), fbhRef->getInterpolatedAnimationData() + fbhRef->getAnimationCount(),
-				fbhRef->getNonInterpolatedAnimationData(), fbhRef->getNonInterpolatedAnimationData() + fbhRef->getAnimationCount(),
-				!fbhRef->flipsXOnOutput()
+				fbhRef->getInterpolatedAnimationData(), fbhRef->getInterpolatedAnimationData() + rawAnimationCount,
+				fbhRef->getNonInterpolatedAnimationData(), fbhRef->getNonInterpolatedAnimationData() + rawAnimationCount,
+				!fbhRef->flipsXOnOutput(),
+				fbhRef->getCompressedAnimationData(), fbhRef->getCompressedAnimationData() + fbhRef->getCompressedAnimationDataSize()
 			);
 
 			// flip
@@ -378,4 +404,43 @@ bool CBAWMeshFileLoader::decompressLz4(void * _dst, size_t _dstSize, const void
 	return res >= 0;
 }
 
+const void* CBAWMeshFileLoader::tryAliasBlobInFile(const SBlobData& _data, SContext& _ctx) const
+{
+	if (!(_ctx.inner.params.loaderFlags & IAssetLoader::ELPF_ALIAS_MAPPED_FILE_MEMORY))
+		return nullptr;
+	if (_data.header->compressionType != asset::Blob::EBCT_RAW)
+		return nullptr;
+
+	const uint8_t* mapped = reinterpret_cast<const uint8_t*>(_ctx.inner.mainFile->getMappedPointer());
+	if (!mapped || _data.absOffset+_data.header->blobSize > static_cast<size_t>(_ctx.inner.mainFile->getSize()))
+		return nullptr;
+
+	const uint8_t* blob = mapped+_data.absOffset;
+	// buffers are expected to be SIMD aligned, otherwise it's better to pay for the copy
+	if (reinterpret_cast<size_t>(blob)&(_IRR_SIMD_ALIGNMENT-1u))
+		return nullptr;
+
+	if (!_data.header->validate(blob))
+	{
+#ifdef _IRR_DEBUG
+		os::Printer::log("Blob validation failed!", ELL_ERROR);
+#endif
+		return nullptr;
+	}
+	return blob;
+}
+
+asset::ICPUBuffer* CBAWMeshFileLoader::createBufferAroundBlob(SBlobData& _data, const void* _blob, SContext& _ctx) const
+{
+	const size_t size = _data.header->blobSizeDecompr;
+	if (_data.heapBlob)
+	{
+		void* mem = _data.heapBlob;
+		_data.heapBlob = nullptr; // the buffer frees it now
+		return new CCustomAllocatorCPUBuffer<core::aligned_allocator<uint8_t> >(size, mem, core::adopt_memory);
+	}
+	// copy-on-write mapping (or memory file), so writes to the buffer never reach the file on disk
+	return new CCustomAllocatorCPUBuffer<CFileAliasingAllocator>(size, const_cast<void*>(_blob), core::adopt_memory, CFileAliasingAllocator(_ctx.inner.mainFile));
+}
+
 }} // irr::scene
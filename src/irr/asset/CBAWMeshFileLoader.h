@@ -166,6 +166,13 @@ private:
 	bool decompressLzma(void* _dst, size_t _dstSize, const void* _src, size_t _srcSize) const;
 	bool decompressLz4(void* _dst, size_t _dstSize, const void* _src, size_t _srcSize) const;
 
+	//! Returns a pointer to the blob inside of the file if it's raw (neither compressed nor encrypted), suitably aligned,
+	//! the file is in memory and `ELPF_ALIAS_MAPPED_FILE_MEMORY` is set, nullptr otherwise.
+	const void* tryAliasBlobInFile(const SBlobData& _data, SContext& _ctx) const;
+	//! Creates the buffer of a `EBT_RAW_DATA_BUFFER` blob around the memory the blob is already in, instead of copying it.
+	//! Takes over `_data.heapBlob` if the blob was read, otherwise `_blob` points into the file which the buffer then keeps alive.
+	asset::ICPUBuffer* createBufferAroundBlob(SBlobData& _data, const void* _blob, SContext& _ctx) const;
+
     inline std::string genSubAssetCacheKey(const std::string& _rootKey, uint64_t _handle) const { return _rootKey + "?" + std::to_string(_handle); }
 
     static inline void* toAddrUsedByBlobsLoadingMgr(asset::IAsset* _assetAddr, uint32_t _blobType)
@@ -403,10 +410,18 @@ void* CBAWMeshFileLoader::tryReadBlobOnStack(const SBlobData_t<HeaderT> & _data,
     const bool encrypted = (_data.header->compressionType & asset::Blob::EBCT_AES128_GCM);
     const bool compressed = (_data.header->compressionType & asset::Blob::EBCT_LZ4) || (_data.header->compressionType & asset::Blob::EBCT_LZMA);
 
+    // uncompressed blobs are read straight into `dst`, so it can be handed over to whatever gets created from the blob
     void* dstCompressed = dst; // ptr to mem to load possibly compressed data
     if (compressed)
         dstCompressed = _IRR_ALIGNED_MALLOC(_data.header->effectiveSize(), _IRR_SIMD_ALIGNMENT);
 
+    auto freeAll = [&]() {
+        if (dstCompressed != dst)
+            _IRR_ALIGNED_FREE(dstCompressed);
+        if (dst != _stackPtr)
+            _IRR_ALIGNED_FREE(dst);
+    };
+
     _ctx.inner.mainFile->seek(_data.absOffset);
     _ctx.inner.mainFile->read(dstCompressed, _data.header->effectiveSize());
 
@@ -415,47 +430,25 @@ void* CBAWMeshFileLoader::tryReadBlobOnStack(const SBlobData_t<HeaderT> & _data,
 #ifdef _IRR_DEBUG
         os::Printer::log("Blob validation failed!", ELL_ERROR);
 #endif
-        if (compressed)
-        {
-            _IRR_ALIGNED_FREE(dstCompressed);
-            if (dst != _stackPtr)
-                _IRR_ALIGNED_FREE(dst);
-        }
-        else if (dst != _stackPtr)
-            _IRR_ALIGNED_FREE(dstCompressed);
+        freeAll();
         return NULL;
     }
 
     if (encrypted)
     {
 #ifdef _IRR_COMPILE_WITH_OPENSSL_
+        // GCM is a stream mode, so it decrypts in place
         const size_t size = _data.header->effectiveSize();
-        void* out = _IRR_ALIGNED_MALLOC(size, _IRR_SIMD_ALIGNMENT);
-        const bool ok = asset::decAes128gcm(dstCompressed, size, out, size, _pwd, _ctx.iv, _data.header->gcmTag);
-        if (dstCompressed != _stackPtr)
-            _IRR_ALIGNED_FREE(dstCompressed);
-        if (!ok)
+        if (!asset::decAes128gcm(dstCompressed, size, dstCompressed, size, _pwd, _ctx.iv, _data.header->gcmTag))
         {
-            if (dst != _stackPtr && dstCompressed != dst)
-                _IRR_ALIGNED_FREE(dst);
-            _IRR_ALIGNED_FREE(out);
+            freeAll();
 #ifdef _IRR_DEBUG
             os::Printer::log("Blob decryption failed!", ELL_ERROR);
 #       endif
             return nullptr;
         }
-        dstCompressed = out;
-        if (!compressed)
-            dst = dstCompressed;
 #else
-        if (compressed)
-        {
-            _IRR_ALIGNED_FREE(dstCompressed);
-            if (dst != _stackPtr)
-                _IRR_ALIGNED_FREE(dst);
-        }
-        else if (dst != _stackPtr)
-            _IRR_ALIGNED_FREE(dstCompressed);
+        freeAll();
         return NULL;
 #endif
     }
@@ -471,10 +464,10 @@ void* CBAWMeshFileLoader::tryReadBlobOnStack(const SBlobData_t<HeaderT> & _data,
             res = decompressLzma(dst, _data.header->blobSizeDecompr, dstCompressed, _data.header->blobSize);
 
         _IRR_ALIGNED_FREE(dstCompressed);
+        dstCompressed = dst;
         if (!res)
         {
-            if (dst != _stackPtr && dst != dstCompressed)
-                _IRR_ALIGNED_FREE(dst);
+            freeAll();
 #ifdef _IRR_DEBUG
             os::Printer::log("Blob decompression failed!", ELL_ERROR);
 #endif
@@ -0,0 +1,349 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#include "CFinalBoneHierarchy.h"
+
+namespace irr
+{
+namespace asset
+{
+
+namespace
+{
+	inline core::vectorSIMDf fetchChannel(const CFinalBoneHierarchy::AnimationKeyData& _key, uint32_t _channel)
+	{
+		switch (_channel)
+		{
+			case CFinalBoneHierarchy::ECC_ROTATION:
+				return core::normalize(core::vectorSIMDf(_key.Rotation));
+			case CFinalBoneHierarchy::ECC_POSITION:
+				return core::vectorSIMDf(_key.Position[0],_key.Position[1],_key.Position[2]);
+			default:
+				return core::vectorSIMDf(_key.Scale[0],_key.Scale[1],_key.Scale[2]);
+		}
+	}
+
+	//! largest difference of any component, quaternions are compared with the sign that makes them closest
+	inline float channelError(const core::vectorSIMDf& _a, core::vectorSIMDf _b, bool _rotation)
+	{
+		if (_rotation && core::dot(_a,_b).x<0.f)
+			_b = -_b;
+		const core::vectorSIMDf diff = core::abs(_a-_b);
+		return core::max(core::max(diff.x,diff.y),core::max(diff.z,diff.w));
+	}
+
+	void quantizeVector(uint8_t* _out, const core::vectorSIMDf& _value, const CFinalBoneHierarchy::CompressedChannel& _channel)
+	{
+		uint16_t quantized[3];
+		for (uint32_t i=0u; i<3u; i++)
+			quantized[i] = _channel.step[i]!=0.f ? static_cast<uint16_t>(core::clamp((_value.pointer[i]-_channel.base[i])/_channel.step[i]+0.5f,0.f,65535.f)):0u;
+		memcpy(_out,quantized,sizeof(quantized));
+	}
+
+	void quantizeRotation(uint8_t* _out, core::vectorSIMDf _value)
+	{
+		uint32_t largestIx = 0u;
+		for (uint32_t i=1u; i<4u; i++)
+		if (core::abs(_value.pointer[i])>core::abs(_value.pointer[largestIx]))
+			largestIx = i;
+		// q and -q are the same rotation, so the dropped component can always be positive
+		if (_value.pointer[largestIx]<0.f)
+			_value = -_value;
+
+		uint16_t quantized[3];
+		for (uint32_t i=0u,j=0u; i<4u; i++)
+		{
+			if (i==largestIx)
+				continue;
+			quantized[j++] = static_cast<uint16_t>(core::clamp((_value.pointer[i]+core::sqrt(0.5f))*(32767.f/core::sqrt(2.f))+0.5f,0.f,32767.f));
+		}
+		quantized[0] |= (largestIx&0x1u)<<15u;
+		quantized[1] |= (largestIx>>1u)<<15u;
+		memcpy(_out,quantized,sizeof(quantized));
+	}
+
+	//! keys of 4 bones transposed, lane `i` of every member belongs to bone `i`
+	struct SKeysSoA
+	{
+		core::vectorSIMDf rotation[4];
+		core::vectorSIMDf position[3];
+		core::vectorSIMDf scale[3];
+	};
+
+	inline void transposeKeys(SKeysSoA& _out, const CFinalBoneHierarchy::AnimationKeyData* _keys)
+	{
+		// the 4th float loaded after position and scale is the next member, it ends up in a lane nobody reads
+		__m128 r0 = _mm_loadu_ps(_keys[0].Rotation), r1 = _mm_loadu_ps(_keys[1].Rotation), r2 = _mm_loadu_ps(_keys[2].Rotation), r3 = _mm_loadu_ps(_keys[3].Rotation);
+		_MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+		_out.rotation[0] = r0, _out.rotation[1] = r1, _out.rotation[2] = r2, _out.rotation[3] = r3;
+
+		r0 = _mm_loadu_ps(_keys[0].Position), r1 = _mm_loadu_ps(_keys[1].Position), r2 = _mm_loadu_ps(_keys[2].Position), r3 = _mm_loadu_ps(_keys[3].Position);
+		_MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+		_out.position[0] = r0, _out.position[1] = r1, _out.position[2] = r2;
+
+		r0 = _mm_loadu_ps(_keys[0].Scale), r1 = _mm_loadu_ps(_keys[1].Scale), r2 = _mm_loadu_ps(_keys[2].Scale), r3 = _mm_loadu_ps(_keys[3].Scale);
+		_MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+		_out.scale[0] = r0, _out.scale[1] = r1, _out.scale[2] = r2;
+	}
+
+	//! transposes the columns of 4 matrices back into rows
+	inline void transposeRow(core::matrix3x4SIMD* _out, uint32_t _count, uint32_t _row, const core::vectorSIMDf& _c0, const core::vectorSIMDf& _c1, const core::vectorSIMDf& _c2, const core::vectorSIMDf& _c3)
+	{
+		__m128 r0 = _c0.getAsRegister(), r1 = _c1.getAsRegister(), r2 = _c2.getAsRegister(), r3 = _c3.getAsRegister();
+		_MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+		const __m128 rows[4] = {r0,r1,r2,r3};
+		for (uint32_t i=0u; i<_count; i++)
+			_out[i].rows[_row] = rows[i];
+	}
+}
+
+void CFinalBoneHierarchy::getLocalMatrices(core::matrix3x4SIMD* outMatrices, const size_t& firstBone, const size_t& count,
+										   const size_t& keyIx, const float& interpolationFactor, const bool& interpolated) const
+{
+	// `getMatrixFromKey` is the degenerate case of interpolating a key with itself
+	const bool blend = interpolated&&interpolationFactor<1.f;
+	float interpolant = 1.f, interpolantPrecalcTerm2 = 0.25f, interpolantPrecalcTerm3 = 0.f;
+	if (blend)
+	{
+		interpolant = interpolationFactor;
+		core::quaternion::flerp_interpolant_terms(interpolantPrecalcTerm2,interpolantPrecalcTerm3,interpolant);
+	}
+	const core::vectorSIMDf t(interpolant), term2(interpolantPrecalcTerm2), term3(interpolantPrecalcTerm3);
+	const __m128 signMask = _mm_set1_ps(-0.f);
+
+	AnimationKeyData lowerKeys[4], upperKeys[4];
+	SKeysSoA a, b;
+	for (size_t base=0u; base<count; base+=4u)
+	{
+		const uint32_t batchSize = static_cast<uint32_t>(core::min<size_t>(count-base,4u));
+		// a partial batch repeats its last bone in the unused lanes
+		for (uint32_t i=0u; i<4u; i++)
+		{
+			const size_t boneID = firstBone+base+core::min(i,batchSize-1u);
+			upperKeys[i] = getAnimationKey(boneID,keyIx,interpolated);
+			lowerKeys[i] = blend ? getAnimationKey(boneID,keyIx-1u,interpolated):upperKeys[i];
+		}
+		transposeKeys(a,lowerKeys);
+		transposeKeys(b,upperKeys);
+
+		// approximate slerp, see `core::quaternion::flerp`
+		const core::vectorSIMDf angle = a.rotation[0]*b.rotation[0]+a.rotation[1]*b.rotation[1]+a.rotation[2]*b.rotation[2]+a.rotation[3]*b.rotation[3];
+		const __m128 angleSign = _mm_and_ps(angle.getAsRegister(),signMask);
+		const core::vectorSIMDf absAngle = _mm_andnot_ps(signMask,angle.getAsRegister());
+		const core::vectorSIMDf A = core::vectorSIMDf(1.0904f)+absAngle*(core::vectorSIMDf(-3.2452f)+absAngle*(core::vectorSIMDf(3.55645f)-absAngle*1.43519f));
+		const core::vectorSIMDf B = core::vectorSIMDf(0.848013f)+absAngle*(core::vectorSIMDf(-1.06021f)+absAngle*0.215638f);
+		const core::vectorSIMDf rotationInterpolant = t+term3*(A*term2+B);
+
+		core::vectorSIMDf q[4];
+		for (uint32_t i=0u; i<4u; i++)
+		{
+			// takes the shorter way around
+			const core::vectorSIMDf target = _mm_xor_ps(b.rotation[i].getAsRegister(),angleSign);
+			q[i] = a.rotation[i]+(target-a.rotation[i])*rotationInterpolant;
+		}
+		const core::vectorSIMDf length = core::sqrt(q[0]*q[0]+q[1]*q[1]+q[2]*q[2]+q[3]*q[3]);
+		for (uint32_t i=0u; i<4u; i++)
+			q[i] /= length;
+
+		core::vectorSIMDf position[3], scale[3], dblScale[3];
+		for (uint32_t i=0u; i<3u; i++)
+		{
+			position[i] = a.position[i]+(b.position[i]-a.position[i])*t;
+			scale[i] = a.scale[i]+(b.scale[i]-a.scale[i])*t;
+			dblScale[i] = scale[i]*2.f;
+		}
+
+		// same as `core::matrix3x4SIMD::setScaleRotationAndTranslation`, written out per element
+		const core::vectorSIMDf& x = q[0];
+		const core::vectorSIMDf& y = q[1];
+		const core::vectorSIMDf& z = q[2];
+		const core::vectorSIMDf& w = q[3];
+		const core::vectorSIMDf xx = x*x, yy = y*y, zz = z*z;
+		const core::vectorSIMDf xy = x*y, xz = x*z, yz = y*z;
+		const core::vectorSIMDf wx = w*x, wy = w*y, wz = w*z;
+
+		core::matrix3x4SIMD* out = outMatrices+base;
+		transposeRow(out,batchSize,0u,scale[0]-dblScale[0]*(yy+zz),dblScale[1]*(xy-wz),dblScale[2]*(xz+wy),position[0]);
+		transposeRow(out,batchSize,1u,dblScale[0]*(xy+wz),scale[1]-dblScale[1]*(xx+zz),dblScale[2]*(yz-wx),position[1]);
+		transposeRow(out,batchSize,2u,dblScale[0]*(xz-wy),dblScale[1]*(yz+wx),scale[2]-dblScale[2]*(xx+yy),position[2]);
+	}
+}
+
+void CFinalBoneHierarchy::compressAnimations(const SAnimationCompressionParams& _params)
+{
+	// without keyframes there is nothing to decode a track from
+	if (compressedAnimations || !interpolatedAnimations || !nonInterpolatedAnimations || !keyframeCount)
+		return;
+
+	const size_t channelCount = boneCount*2u*ECC_COUNT;
+	const size_t dataStart = sizeof(CompressedAnimationsHeader)+sizeof(CompressedChannel)*channelCount;
+	core::vector<CompressedChannel> channels(channelCount);
+	core::vector<uint8_t> data;
+
+	core::vector<core::vectorSIMDf> original(keyframeCount);
+	core::vector<uint8_t> quantized(keyframeCount*CompressedValueSize+sizeof(uint64_t)); // padded for the 8 byte loads
+	core::vector<uint32_t> kept;
+	kept.reserve(keyframeCount);
+	for (size_t boneID=0u; boneID<boneCount; boneID++)
+	for (uint32_t track=0u; track<2u; track++)
+	{
+		const bool interpolated = track==0u;
+		const AnimationKeyData* keys = (interpolated ? interpolatedAnimations:nonInterpolatedAnimations)+keyframeCount*boneID;
+		for (uint32_t channelID=0u; channelID<ECC_COUNT; channelID++)
+		{
+			const bool rotation = channelID==ECC_ROTATION;
+			const float maxError = rotation ? _params.maxRotationError:(channelID==ECC_POSITION ? _params.maxPositionError:_params.maxScaleError);
+			CompressedChannel& channel = channels[(boneID*2u+track)*ECC_COUNT+channelID];
+
+			// quantize every key first, so that dropping keys accounts for the quantization error
+			core::vectorSIMDf minimum(FLT_MAX),maximum(-FLT_MAX);
+			for (size_t i=0u; i<keyframeCount; i++)
+			{
+				original[i] = fetchChannel(keys[i],channelID);
+				minimum = core::min(minimum,original[i]);
+				maximum = core::max(maximum,original[i]);
+			}
+			for (uint32_t i=0u; i<3u; i++)
+			{
+				channel.base[i] = minimum.pointer[i];
+				channel.step[i] = (maximum.pointer[i]-minimum.pointer[i])/65535.f;
+			}
+			for (size_t i=0u; i<keyframeCount; i++)
+			{
+				if (rotation)
+					quantizeRotation(quantized.data()+i*CompressedValueSize,original[i]);
+				else
+					quantizeVector(quantized.data()+i*CompressedValueSize,original[i],channel);
+			}
+			channel.valueSize = CompressedValueSize;
+			auto decode = [&](size_t ix) -> core::vectorSIMDf
+			{
+				if (channel.valueSize==RawValueSize)
+					return original[ix];
+				return rotation ? dequantizeRotation(quantized.data()+ix*CompressedValueSize):dequantizeVector(quantized.data()+ix*CompressedValueSize,channel);
+			};
+			// whether interpolating the decoded keys `begin` and `end` reproduces all keys in between
+			auto fits = [&](uint32_t begin, uint32_t end) -> bool
+			{
+				const core::vectorSIMDf beginValue = decode(begin), endValue = decode(end);
+				for (uint32_t i=begin+1u; i<end; i++)
+				{
+					const float interpolant = (keyframes[i]-keyframes[begin])/(keyframes[end]-keyframes[begin]);
+					if (channelError(interpolateCompressed(beginValue,endValue,interpolant,rotation),original[i],rotation)>maxError)
+						return false;
+				}
+				return true;
+			};
+
+			while (true)
+			{
+				kept.clear();
+				kept.push_back(0u);
+				bool constant = true;
+				{
+					const core::vectorSIMDf first = decode(0u);
+					for (size_t i=1u; constant&&i<keyframeCount; i++)
+						constant = channelError(first,original[i],rotation)<=maxError;
+				}
+				if (!constant && interpolated)
+				{
+					// extend every segment as far as possible, galloping ahead and then bisecting keeps it O(n log n) rather than trying every end
+					for (uint32_t begin=0u; begin+1u<keyframeCount; )
+					{
+						uint32_t good = begin+1u, bad = keyframeCount;
+						for (uint32_t step=1u; good+step<keyframeCount; step*=2u)
+						{
+							if (!fits(begin,good+step))
+							{
+								bad = good+step;
+								break;
+							}
+							good += step;
+						}
+						while (bad-good>1u)
+						{
+							const uint32_t middle = good+(bad-good)/2u;
+							if (fits(begin,middle))
+								good = middle;
+							else
+								bad = middle;
+						}
+						kept.push_back(good);
+						begin = good;
+					}
+				}
+				else if (!constant)
+				{
+					// steps only need a key where the value changes
+					for (uint32_t i=1u; i<keyframeCount; i++)
+					if (channelError(decode(kept.back()),original[i],rotation)>maxError)
+						kept.push_back(i);
+				}
+
+				// everything in between got checked against the original keys, the kept keys themselves carry the quantization error
+				if (channel.valueSize==RawValueSize)
+					break;
+				bool keptInBounds = true;
+				for (size_t i=0u; keptInBounds&&i<kept.size(); i++)
+					keptInBounds = channelError(decode(kept[i]),original[kept[i]],rotation)<=maxError;
+				if (keptInBounds)
+					break;
+				// a range too wide for 16 bits, store the keys as they are
+				channel.valueSize = RawValueSize;
+			}
+
+			channel.keyCount = kept.size();
+			channel.dataOffset = dataStart+data.size();
+			const size_t indicesSize = sizeof(uint32_t)*kept.size();
+			const size_t valuesSize = (channel.valueSize*kept.size()+sizeof(uint32_t)-1u)&~(sizeof(uint32_t)-1u);
+			data.resize(data.size()+indicesSize+valuesSize);
+			uint8_t* out = data.data()+channel.dataOffset-dataStart;
+			memcpy(out,kept.data(),indicesSize);
+			out += indicesSize;
+			for (auto ix : kept)
+			{
+				memcpy(out,channel.valueSize==RawValueSize ? static_cast<const void*>(original[ix].pointer):quantized.data()+ix*CompressedValueSize,channel.valueSize);
+				out += channel.valueSize;
+			}
+		}
+	}
+
+	CompressedAnimationsHeader header;
+	header.byteSize = dataStart+data.size()+sizeof(uint64_t);
+	header.boneCount = boneCount;
+	header.keyframeCount = keyframeCount;
+
+	compressedAnimations = (uint8_t*)_IRR_ALIGNED_MALLOC(header.byteSize,_IRR_SIMD_ALIGNMENT);
+	memcpy(compressedAnimations,&header,sizeof(header));
+	memcpy(compressedAnimations+sizeof(header),channels.data(),sizeof(CompressedChannel)*channelCount);
+	memcpy(compressedAnimations+dataStart,data.data(),data.size());
+	memset(compressedAnimations+dataStart+data.size(),0,sizeof(uint64_t));
+
+	free(interpolatedAnimations);
+	free(nonInterpolatedAnimations);
+	interpolatedAnimations = nonInterpolatedAnimations = nullptr;
+}
+
+void CFinalBoneHierarchy::decompressAnimations()
+{
+	if (!compressedAnimations)
+		return;
+
+	AnimationKeyData* interpolated = (AnimationKeyData*)malloc(sizeof(AnimationKeyData)*getAnimationCount());
+	AnimationKeyData* nonInterpolated = (AnimationKeyData*)malloc(sizeof(AnimationKeyData)*getAnimationCount());
+	for (size_t boneID=0u; boneID<boneCount; boneID++)
+	for (size_t keyIx=0u; keyIx<keyframeCount; keyIx++)
+	{
+		interpolated[keyframeCount*boneID+keyIx] = getAnimationKey(boneID,keyIx,true);
+		nonInterpolated[keyframeCount*boneID+keyIx] = getAnimationKey(boneID,keyIx,false);
+	}
+
+	_IRR_ALIGNED_FREE(compressedAnimations);
+	compressedAnimations = nullptr;
+	interpolatedAnimations = interpolated;
+	nonInterpolatedAnimations = nonInterpolated;
+}
+
+} // end namespace asset
+} // end namespace irr
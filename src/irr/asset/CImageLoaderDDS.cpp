@@ -96,6 +96,16 @@ static bool DDSGetInfo(CImageLoaderDDS::ddsBuffer *dds, int32_t *width, int32_t
 		*pf = CImageLoaderDDS::DDS_PF_DXT4;
 	else if( fourCC == *((uint32_t*) "DXT5") )
 		*pf = CImageLoaderDDS::DDS_PF_DXT5;
+	else if( fourCC == *((uint32_t*) "ATI1") || fourCC == *((uint32_t*) "BC4U") )
+		*pf = CImageLoaderDDS::DDS_PF_BC4_UNORM;
+	else if( fourCC == *((uint32_t*) "BC4S") )
+		*pf = CImageLoaderDDS::DDS_PF_BC4_SNORM;
+	else if( fourCC == *((uint32_t*) "ATI2") || fourCC == *((uint32_t*) "BC5U") )
+		*pf = CImageLoaderDDS::DDS_PF_BC5_UNORM;
+	else if( fourCC == *((uint32_t*) "BC5S") )
+		*pf = CImageLoaderDDS::DDS_PF_BC5_SNORM;
+	else if( fourCC == *((uint32_t*) "DX10") )
+		*pf = CImageLoaderDDS::DDS_PF_DX10;
 	else
 		return false;
 	
@@ -120,143 +130,289 @@ bool CImageLoaderDDS::isALoadableFileFormat(io::IReadFile* _file) const
 	return DDSGetInfo(&header, &width, &height, &depth, &pixelFormat);
 }
 
+enum : uint32_t
+{
+	DDSD_MIPMAPCOUNT = 0x20000u,
+	DDSCAPS2_CUBEMAP = 0x200u,
+	DDSCAPS2_CUBEMAP_ALLFACES = 0xfc00u,
+	DDSCAPS2_VOLUME = 0x200000u,
+	DDS_DIMENSION_TEXTURE1D = 2u,
+	DDS_DIMENSION_TEXTURE2D = 3u,
+	DDS_DIMENSION_TEXTURE3D = 4u,
+	DDS_RESOURCE_MISC_TEXTURECUBE = 0x4u
+};
+
+//! typeless formats are loaded as UNORM
+static asset::E_FORMAT DDSGetFormatFromDXGI(uint32_t dxgiFormat)
+{
+	switch (dxgiFormat)
+	{
+		case 2u: return asset::EF_R32G32B32A32_SFLOAT;
+		case 3u: return asset::EF_R32G32B32A32_UINT;
+		case 4u: return asset::EF_R32G32B32A32_SINT;
+		case 6u: return asset::EF_R32G32B32_SFLOAT;
+		case 7u: return asset::EF_R32G32B32_UINT;
+		case 8u: return asset::EF_R32G32B32_SINT;
+		case 10u: return asset::EF_R16G16B16A16_SFLOAT;
+		case 11u: return asset::EF_R16G16B16A16_UNORM;
+		case 12u: return asset::EF_R16G16B16A16_UINT;
+		case 13u: return asset::EF_R16G16B16A16_SNORM;
+		case 14u: return asset::EF_R16G16B16A16_SINT;
+		case 16u: return asset::EF_R32G32_SFLOAT;
+		case 17u: return asset::EF_R32G32_UINT;
+		case 18u: return asset::EF_R32G32_SINT;
+		case 24u: return asset::EF_A2B10G10R10_UNORM_PACK32;
+		case 25u: return asset::EF_A2B10G10R10_UINT_PACK32;
+		case 26u: return asset::EF_B10G11R11_UFLOAT_PACK32;
+		case 27u:
+		case 28u: return asset::EF_R8G8B8A8_UNORM;
+		case 29u: return asset::EF_R8G8B8A8_SRGB;
+		case 30u: return asset::EF_R8G8B8A8_UINT;
+		case 31u: return asset::EF_R8G8B8A8_SNORM;
+		case 32u: return asset::EF_R8G8B8A8_SINT;
+		case 34u: return asset::EF_R16G16_SFLOAT;
+		case 35u: return asset::EF_R16G16_UNORM;
+		case 36u: return asset::EF_R16G16_UINT;
+		case 37u: return asset::EF_R16G16_SNORM;
+		case 38u: return asset::EF_R16G16_SINT;
+		case 41u: return asset::EF_R32_SFLOAT;
+		case 42u: return asset::EF_R32_UINT;
+		case 43u: return asset::EF_R32_SINT;
+		case 49u: return asset::EF_R8G8_UNORM;
+		case 50u: return asset::EF_R8G8_UINT;
+		case 51u: return asset::EF_R8G8_SNORM;
+		case 52u: return asset::EF_R8G8_SINT;
+		case 54u: return asset::EF_R16_SFLOAT;
+		case 56u: return asset::EF_R16_UNORM;
+		case 57u: return asset::EF_R16_UINT;
+		case 58u: return asset::EF_R16_SNORM;
+		case 59u: return asset::EF_R16_SINT;
+		case 61u: return asset::EF_R8_UNORM;
+		case 62u: return asset::EF_R8_UINT;
+		case 63u: return asset::EF_R8_SNORM;
+		case 64u: return asset::EF_R8_SINT;
+		case 67u: return asset::EF_E5B9G9R9_UFLOAT_PACK32;
+		case 70u:
+		case 71u: return asset::EF_BC1_RGBA_UNORM_BLOCK;
+		case 72u: return asset::EF_BC1_RGBA_SRGB_BLOCK;
+		case 73u:
+		case 74u: return asset::EF_BC2_UNORM_BLOCK;
+		case 75u: return asset::EF_BC2_SRGB_BLOCK;
+		case 76u:
+		case 77u: return asset::EF_BC3_UNORM_BLOCK;
+		case 78u: return asset::EF_BC3_SRGB_BLOCK;
+		case 79u:
+		case 80u: return asset::EF_BC4_UNORM_BLOCK;
+		case 81u: return asset::EF_BC4_SNORM_BLOCK;
+		case 82u:
+		case 83u: return asset::EF_BC5_UNORM_BLOCK;
+		case 84u: return asset::EF_BC5_SNORM_BLOCK;
+		case 85u: return asset::EF_R5G6B5_UNORM_PACK16;
+		case 86u: return asset::EF_A1R5G5B5_UNORM_PACK16;
+		case 87u: return asset::EF_B8G8R8A8_UNORM;
+		case 90u:
+		case 91u: return asset::EF_B8G8R8A8_SRGB;
+		case 94u:
+		case 95u: return asset::EF_BC6H_UFLOAT_BLOCK;
+		case 96u: return asset::EF_BC6H_SFLOAT_BLOCK;
+		case 97u:
+		case 98u: return asset::EF_BC7_UNORM_BLOCK;
+		case 99u: return asset::EF_BC7_SRGB_BLOCK;
+		default: return asset::EF_UNKNOWN;
+	}
+}
+
+//! the layouts of the original header are all byte for byte some format, except for 24bit BGR which gets swizzled to RGB after loading
+static asset::E_FORMAT DDSGetFormatFromLegacy(CImageLoaderDDS::eDDSPixelFormat pf)
+{
+	switch (pf)
+	{
+		case CImageLoaderDDS::DDS_PF_ARGB8888:
+			return asset::EF_B8G8R8A8_SRGB;
+		case CImageLoaderDDS::DDS_PF_ABGR8888:
+			return asset::EF_R8G8B8A8_SRGB;
+		case CImageLoaderDDS::DDS_PF_RGB888:
+			return asset::EF_R8G8B8_SRGB;
+		case CImageLoaderDDS::DDS_PF_ARGB1555:
+			return asset::EF_A1R5G5B5_UNORM_PACK16;
+		case CImageLoaderDDS::DDS_PF_RGB565:
+			return asset::EF_R5G6B5_UNORM_PACK16;
+		case CImageLoaderDDS::DDS_PF_LA88:
+			os::Printer::log("Unsure of your DDS file's OETF/gamma value, please double check the brightness on the output.", ELL_WARNING);
+			return asset::EF_R8G8_UNORM; // is it really R8G8_SRGB instead?
+		case CImageLoaderDDS::DDS_PF_L8:
+		case CImageLoaderDDS::DDS_PF_A8:
+			os::Printer::log("Unsure of your DDS file's OETF/gamma value, please double check the brightness on the output.", ELL_WARNING);
+			return asset::EF_R8_UNORM; // is it really R8_SRGB instead?
+		case CImageLoaderDDS::DDS_PF_DXT1:
+			return asset::EF_BC1_RGB_SRGB_BLOCK;
+		case CImageLoaderDDS::DDS_PF_DXT1_ALPHA:
+			return asset::EF_BC1_RGBA_SRGB_BLOCK;
+		case CImageLoaderDDS::DDS_PF_DXT2:
+		case CImageLoaderDDS::DDS_PF_DXT3:
+			return asset::EF_BC2_SRGB_BLOCK;
+		case CImageLoaderDDS::DDS_PF_DXT4:
+		case CImageLoaderDDS::DDS_PF_DXT5:
+			return asset::EF_BC3_SRGB_BLOCK;
+		case CImageLoaderDDS::DDS_PF_BC4_UNORM:
+			return asset::EF_BC4_UNORM_BLOCK;
+		case CImageLoaderDDS::DDS_PF_BC4_SNORM:
+			return asset::EF_BC4_SNORM_BLOCK;
+		case CImageLoaderDDS::DDS_PF_BC5_UNORM:
+			return asset::EF_BC5_UNORM_BLOCK;
+		case CImageLoaderDDS::DDS_PF_BC5_SNORM:
+			return asset::EF_BC5_SNORM_BLOCK;
+		default:
+			return asset::EF_UNKNOWN;
+	}
+}
+
 //! creates a surface from the file
 asset::SAssetBundle CImageLoaderDDS::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
-	core::vector<asset::CImageData*> images;
-
     CImageLoaderDDS::eDDSPixelFormat pixelFormat;
-    int32_t width, height, depth, mipmapCnt;
+    int32_t width, height, depth;
 
 	ddsBuffer header;
 	_file->read(&header, sizeof(header)-4);
 
-	if (DDSGetInfo(&header, &width, &height, &depth, &pixelFormat))
+	if (!DDSGetInfo(&header, &width, &height, &depth, &pixelFormat))
+		return {};
+
+	const uint32_t mipmapCnt = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount ? header.mipMapCount : 1u;
+
+	asset::E_FORMAT colorFormat = asset::EF_UNKNOWN;
+	video::ITexture::E_TEXTURE_TYPE type = video::ITexture::ETT_2D;
+	uint32_t layers = 1u; // cube map faces count as layers
+	if (pixelFormat == DDS_PF_DX10)
+	{
+		ddsHeaderDX10 headerDX10;
+		if (_file->read(&headerDX10, sizeof(headerDX10)) != sizeof(headerDX10))
+			return {};
+
+		colorFormat = DDSGetFormatFromDXGI(headerDX10.dxgiFormat);
+		const uint32_t arraySize = core::max(headerDX10.arraySize, 1u);
+		switch (headerDX10.resourceDimension)
+		{
+			case DDS_DIMENSION_TEXTURE1D:
+				type = arraySize > 1u ? video::ITexture::ETT_1D_ARRAY : video::ITexture::ETT_1D;
+				layers = arraySize;
+				break;
+			case DDS_DIMENSION_TEXTURE2D:
+				if (headerDX10.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE)
+				{
+					type = arraySize > 1u ? video::ITexture::ETT_CUBE_MAP_ARRAY : video::ITexture::ETT_CUBE_MAP;
+					layers = arraySize*6u;
+				}
+				else
+				{
+					type = arraySize > 1u ? video::ITexture::ETT_2D_ARRAY : video::ITexture::ETT_2D;
+					layers = arraySize;
+				}
+				break;
+			case DDS_DIMENSION_TEXTURE3D:
+				type = video::ITexture::ETT_3D;
+				break;
+			default:
+				colorFormat = asset::EF_UNKNOWN;
+				break;
+		}
+	}
+	else
+	{
+		colorFormat = DDSGetFormatFromLegacy(pixelFormat);
+		if (header.caps.caps2 & DDSCAPS2_CUBEMAP)
+		{
+			if ((header.caps.caps2 & DDSCAPS2_CUBEMAP_ALLFACES) != DDSCAPS2_CUBEMAP_ALLFACES)
+			{
+				os::Printer::log("DDS cube maps without all 6 faces are not supported.", ELL_ERROR);
+				return {};
+			}
+			type = video::ITexture::ETT_CUBE_MAP;
+			layers = 6u;
+		}
+		else if (depth > 1 || (header.caps.caps2 & DDSCAPS2_VOLUME))
+			type = video::ITexture::ETT_3D;
+	}
+
+	if (colorFormat == asset::EF_UNKNOWN)
+	{
+		os::Printer::log("Unsupported DDS texture format.", ELL_ERROR);
+		return {};
+	}
+	if (type != video::ITexture::ETT_3D)
+		depth = 1;
+	const bool is1D = type == video::ITexture::ETT_1D || type == video::ITexture::ETT_1D_ARRAY;
+
+	// every mip level holds all layers, arrays of 1D textures have their layers in the second dimension
+	core::vector<asset::CImageData*> images(mipmapCnt);
+	core::vector<size_t> layerBytes(mipmapCnt);
+	size_t payloadBytes = 0u;
+	for (uint32_t i = 0u; i < mipmapCnt; i++)
+	{
+		const uint32_t zeroDummy[3] = { 0u,0u,0u };
+		uint32_t mipSize[3] = { core::max(uint32_t(width) >> i, 1u), core::max(uint32_t(height) >> i, 1u), core::max(uint32_t(depth) >> i, 1u) };
+		if (is1D)
+			mipSize[1] = layers;
+		else if (type != video::ITexture::ETT_3D)
+			mipSize[2] = layers;
+
+		images[i] = new asset::CImageData(NULL, zeroDummy, mipSize, i, colorFormat, 1u);
+		layerBytes[i] = images[i]->getImageDataSizeInBytes()/layers;
+		payloadBytes += images[i]->getImageDataSizeInBytes();
+	}
+	auto dropImages = [&images]()
+	{
+		for (auto& img : images)
+			img->drop();
+	};
+
+	const size_t payloadOffset = _file->getPos();
+	if (payloadOffset + payloadBytes > static_cast<size_t>(_file->getSize()))
+	{
+		os::Printer::log("DDS file is too small for its header.", ELL_ERROR);
+		dropImages();
+		return {};
+	}
+
+	// files in memory are copied out of in place, others are read with a single call
+	const uint8_t* payload = reinterpret_cast<const uint8_t*>(_file->getMappedPointer());
+	uint8_t* staging = nullptr;
+	if (payload)
+		payload += payloadOffset;
+	else if (mipmapCnt == 1u && layers == 1u)
+		_file->read(images[0]->getData(), static_cast<uint32_t>(payloadBytes)); // already laid out as the image
+	else
+	{
+		staging = reinterpret_cast<uint8_t*>(_IRR_ALIGNED_MALLOC(payloadBytes, _IRR_SIMD_ALIGNMENT));
+		_file->read(staging, static_cast<uint32_t>(payloadBytes));
+		payload = staging;
+	}
+
+	// file has layers (and cube faces) one after the other, each with its whole mip chain
+	if (payload)
+	for (uint32_t layer = 0u; layer < layers; layer++)
+	for (uint32_t i = 0u; i < mipmapCnt; i++)
+	{
+		memcpy(reinterpret_cast<uint8_t*>(images[i]->getData()) + layer*layerBytes[i], payload, layerBytes[i]);
+		payload += layerBytes[i];
+	}
+	if (staging)
+		_IRR_ALIGNED_FREE(staging);
+
+	// the GL driver has no BGR upload path, so swap the red and blue bytes in place
+	if (pixelFormat == DDS_PF_RGB888)
+	for (auto& img : images)
 	{
-	    if (header.flags & 0x20000)//DDSD_MIPMAPCOUNT)
-            mipmapCnt = header.mipMapCount;
-	    else
-            mipmapCnt = 1;
-
-
-        for (int32_t i=0; i<mipmapCnt; i++)
-        {
-            uint32_t zeroDummy[3] = {0,0,0};
-            uint32_t mipSize[3] = {0,height,depth};
-            uint32_t& tmpWidth = mipSize[0];
-            switch( pixelFormat )
-            {
-                case DDS_PF_DXT1:
-                case DDS_PF_DXT2:
-                case DDS_PF_DXT3:
-                case DDS_PF_DXT4:
-                case DDS_PF_DXT5:
-                    tmpWidth = width;
-                    break;
-                default:
-                    tmpWidth = header.pitch;
-                    break;
-            }
-            uint32_t& tmpHeight = mipSize[1];
-            uint32_t& tmpDepth = mipSize[2];
-            tmpWidth += (uint32_t(1)<<i)-1;
-            tmpHeight += (uint32_t(1)<<i)-1;
-            if (false) //! Should only happen for 3D textures
-                tmpDepth += (uint32_t(1)<<i)-1;
-            tmpWidth /= uint32_t(1)<<i;
-            tmpHeight /= uint32_t(1)<<i;
-            if (false) //! should only happen for 3D textures
-                tmpDepth /= uint32_t(1)<<i;
-
-            /* decompress */
-            asset::E_FORMAT colorFormat = asset::EF_UNKNOWN;
-            switch( pixelFormat )
-            {
-                case DDS_PF_ARGB8888:
-                case DDS_PF_ABGR8888:
-                    {
-                        colorFormat = pixelFormat==DDS_PF_ABGR8888 ? asset::EF_R8G8B8A8_SRGB:asset::EF_B8G8R8A8_SRGB;
-                        asset::CImageData* data = new asset::CImageData(NULL,zeroDummy,mipSize,i,colorFormat,4u); // could be higher alignment if we checked mip offset and width
-                        _file->read(data->getData(),data->getImageDataSizeInBytes());
-                        images.push_back(data);
-                    }
-                    break;
-                case DDS_PF_RGB888:
-                    {
-                        colorFormat = asset::EF_R8G8B8_SRGB;
-                        asset::CImageData* data = new asset::CImageData(NULL,zeroDummy,mipSize,i,colorFormat,1u);
-                        _file->read(data->getData(),data->getImageDataSizeInBytes());
-                        images.push_back(data);
-
-                        uint8_t* dataToManipulate = reinterpret_cast<uint8_t*>(data->getData());
-                        for (uint32_t j=0; j<data->getImageDataSizeInBytes(); j+=3)
-                        {
-                            uint8_t byte1 = dataToManipulate[j+0];
-                            uint8_t byte2 = dataToManipulate[j+1];
-                            uint8_t byte3 = dataToManipulate[j+2];
-
-                            dataToManipulate[j+0] = byte3;
-                            dataToManipulate[j+1] = byte2;
-                            dataToManipulate[j+2] = byte1;
-                        }
-                    }
-                    break;
-				/* fixme: support other [a]rgb formats */
-                case DDS_PF_LA88:
-                    {
-						os::Printer::log("Unsure of your DDS file's OETF/gamma value, please double check the brightness on the output.", ELL_WARNING);
-                        colorFormat = asset::EF_R8G8_UNORM; // is it really R8G8_SRGB instead?
-                        asset::CImageData* data = new asset::CImageData(NULL,zeroDummy,mipSize,i,colorFormat,2);
-                        _file->read(data->getData(),data->getImageDataSizeInBytes());
-                        images.push_back(data);
-                    }
-                    break;
-                case DDS_PF_L8:
-                case DDS_PF_A8:
-                    {
-						os::Printer::log("Unsure of your DDS file's OETF/gamma value, please double check the brightness on the output.", ELL_WARNING);
-                        colorFormat = asset::EF_R8_UNORM; // is it really R8_SRGB instead?
-                        asset::CImageData* data = new asset::CImageData(NULL,zeroDummy,mipSize,i,colorFormat,1);
-                        _file->read(data->getData(),data->getImageDataSizeInBytes());
-                        images.push_back(data);
-                    }
-                    break;
-
-                case DDS_PF_DXT1:
-                case DDS_PF_DXT2:
-                case DDS_PF_DXT3:
-                case DDS_PF_DXT4:
-                case DDS_PF_DXT5:
-                    {
-                        if (pixelFormat==CImageLoaderDDS::DDS_PF_DXT2||pixelFormat==CImageLoaderDDS::DDS_PF_DXT3)
-                            colorFormat = asset::EF_BC2_SRGB_BLOCK;
-                        else if (pixelFormat==CImageLoaderDDS::DDS_PF_DXT4||pixelFormat==CImageLoaderDDS::DDS_PF_DXT5)
-                            colorFormat = asset::EF_BC3_SRGB_BLOCK;
-                        else if (pixelFormat==CImageLoaderDDS::DDS_PF_DXT1_ALPHA)
-                            colorFormat = asset::EF_BC1_RGBA_SRGB_BLOCK;
-                        else if (pixelFormat==CImageLoaderDDS::DDS_PF_DXT1)
-                            colorFormat = asset::EF_BC1_RGB_SRGB_BLOCK;
-
-                        asset::CImageData* data = new asset::CImageData(NULL,zeroDummy,mipSize,i,colorFormat,1);
-                        _file->read(data->getData(),data->getImageDataSizeInBytes());
-                        images.push_back(data);
-                    }
-                    break;
-
-                default:
-					{
-						os::Printer::log("Unsupported DDS texture format, 16bit uncompressed is not an option here.", ELL_ERROR);
-                        return {};
-					}
-					break;
-            }
-        }
+		uint8_t* texel = reinterpret_cast<uint8_t*>(img->getData());
+		const uint8_t* const end = texel + img->getImageDataSizeInBytes();
+		for (; texel < end; texel += 3)
+			std::swap(texel[0], texel[2]);
 	}
 
-	asset::ICPUTexture* tex = asset::ICPUTexture::create(images, _file->getFileName().c_str());
-    for (auto& img : images)
-        img->drop();
-    return SAssetBundle({core::smart_refctd_ptr<IAsset>(tex, core::dont_grab)});
+	asset::ICPUTexture* tex = asset::ICPUTexture::create(images, _file->getFileName().c_str(), type);
+	dropImages();
+	return SAssetBundle({core::smart_refctd_ptr<IAsset>(tex, core::dont_grab)});
 }
 
 
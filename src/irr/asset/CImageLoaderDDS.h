@@ -17,7 +17,7 @@ namespace asset
 {
 
 /*!
-	Surface Loader for DDS images
+	Surface Loader for DDS images, including the DX10 header (BC4-BC7, arrays of textures and cube maps), cube maps and volume textures
 */
 class CImageLoaderDDS : public asset::IAssetLoader
 {
@@ -38,6 +38,11 @@ public:
         DDS_PF_DXT3,
         DDS_PF_DXT4,
         DDS_PF_DXT5,
+        DDS_PF_BC4_UNORM,
+        DDS_PF_BC4_SNORM,
+        DDS_PF_BC5_UNORM,
+        DDS_PF_BC5_SNORM,
+        DDS_PF_DX10,
         DDS_PF_UNKNOWN
     };
 
@@ -160,6 +165,16 @@ public:
         uint8_t		data[4];
     } PACK_STRUCT;
 
+    //! follows `ddsBuffer` when the FourCC is 'DX10'
+    struct ddsHeaderDX10
+    {
+        uint32_t		dxgiFormat;
+        uint32_t		resourceDimension;
+        uint32_t		miscFlag;
+        uint32_t		arraySize;
+        uint32_t		miscFlags2;
+    } PACK_STRUCT;
+
 
 #include "irr/irrunpack.h"
 
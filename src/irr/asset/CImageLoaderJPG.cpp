@@ -8,14 +8,16 @@
 
 #include "IReadFile.h"
 #include "os.h"
-#include "irr/asset/ICPUBuffer.h"
 #include "irr/asset/ICPUTexture.h"
+#include "irr/asset/format/decodeImageFiles.h"
+#include "irr/core/parallel/CTaskScheduler.h"
 #include <string>
 
 #include <stdio.h> // required for jpeglib.h
 #ifdef _IRR_COMPILE_WITH_LIBJPEG_
 extern "C" {
 #include "libjpeg/jpeglib.h" // use irrlicht jpeglib
+#include "libjpeg/jerror.h"
 #include <setjmp.h>
 }
 #endif // _IRR_COMPILE_WITH_LIBJPEG_
@@ -108,7 +110,12 @@ namespace jpeg
 	suspension is desired (this mode is discussed in the next section). */
 	boolean fill_input_buffer(j_decompress_ptr cinfo)
 	{
-		// DO NOTHING
+		// the whole file is in the buffer, so this only happens on truncated files
+		// and inserting a fake EOI marker keeps the decoder from reading past the end
+		static const JOCTET fakeEOI[2] = {0xFFu,JPEG_EOI};
+		WARNMS(cinfo, JWRN_JPEG_EOF);
+		cinfo->src->next_input_byte = fakeEOI;
+		cinfo->src->bytes_in_buffer = 2u;
 		return TRUE;
 	}
 
@@ -125,6 +132,11 @@ namespace jpeg
 		jpeg_source_mgr* src = cinfo->src;
 		if (num_bytes > 0)
 		{
+			while (static_cast<size_t>(num_bytes) > src->bytes_in_buffer)
+			{
+				num_bytes -= static_cast<long>(src->bytes_in_buffer);
+				src->fill_input_buffer(cinfo);
+			}
 			src->bytes_in_buffer -= num_bytes;
 			src->next_input_byte += num_bytes;
 		}
@@ -137,6 +149,55 @@ namespace jpeg
 		// DO NOTHING
 	}
 
+	//! Decompressor and input buffer every thread keeps for all the files it decodes
+	struct SDecodeContext
+	{
+		SDecodeContext() : created(false)
+		{
+			// the error handler has to be set up first, in case the creation fails
+			cinfo.err = jpeg_std_error(&jerr.pub);
+			cinfo.err->error_exit = error_exit;
+			cinfo.err->output_message = output_message;
+
+			jsrc.init_source = init_source;
+			jsrc.fill_input_buffer = fill_input_buffer;
+			jsrc.skip_input_data = skip_input_data;
+			jsrc.resync_to_restart = jpeg_resync_to_restart;
+			jsrc.term_source = term_source;
+		}
+		~SDecodeContext()
+		{
+			if (created)
+				jpeg_destroy_decompress(&cinfo);
+		}
+
+		struct jpeg_decompress_struct cinfo;
+		struct irr_jpeg_error_mgr jerr;
+		jpeg_source_mgr jsrc;
+		//! created lazily, so that it happens within setjmp
+		bool created;
+		core::vector<uint8_t> input;
+
+		//! files up to this size keep the input buffer of the thread around for the next one
+		static constexpr size_t MaxKeptInputSize = 4u<<20u;
+		inline void releaseLargeInput()
+		{
+			if (input.capacity()>MaxKeptInputSize)
+				core::vector<uint8_t>().swap(input);
+		}
+
+		//! leaves the decompressor ready for the next file of this thread
+		inline void abort()
+		{
+			// a failed creation leaves nothing to abort, only to destroy so the next file creates it anew
+			if (created)
+				jpeg_abort_decompress(&cinfo);
+			else
+				jpeg_destroy_decompress(&cinfo);
+			releaseLargeInput();
+		}
+	};
+	thread_local SDecodeContext LocalDecodeContext;
 }
 #endif // _IRR_COMPILE_WITH_LIBJPEG_
 
@@ -161,168 +222,156 @@ bool CImageLoaderJPG::isALoadableFileFormat(io::IReadFile* _file) const
 
 //! creates a surface from the file
 asset::SAssetBundle CImageLoaderJPG::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+{
+	IRR_PROFILE_SCOPE("CImageLoaderJPG::loadAsset");
+	asset::CImageData* image = decodeJPEG(_file, _params.maxImageResolution);
+	if (!image)
+		return {};
+
+	ICPUTexture* tex = ICPUTexture::create({image}, _file->getFileName().c_str());
+	image->drop();
+	return SAssetBundle({core::smart_refctd_ptr<IAsset>(tex, core::dont_grab)});
+}
+
+asset::CImageData* decodeJPEG(io::IReadFile* _file, uint32_t _maxResolution)
 {
 #ifndef _IRR_COMPILE_WITH_LIBJPEG_
 	os::Printer::log("Can't load as not compiled with _IRR_COMPILE_WITH_LIBJPEG_:", _file->getFileName().c_str(), ELL_DEBUG);
-	return nullptr
+	return nullptr;
 #else
 	if (!_file || _file->getSize()>0xffffffffull)
-        return {};
-
-	const io::path& Filename = _file->getFileName();
-
-	uint8_t* input = new uint8_t[_file->getSize()];
-	_file->read(input, static_cast<uint32_t>(_file->getSize()));
-
-	// allocate and initialize JPEG decompression object
-	struct jpeg_decompress_struct cinfo;
-	struct jpeg::irr_jpeg_error_mgr jerr;
+		return nullptr;
 
-	//We have to set up the error handler first, in case the initialization
-	//step fails.  (Unlikely, but it could happen if you are out of memory.)
-	//This routine fills in the contents of struct jerr, and returns jerr's
-	//address which we place into the link field in cinfo.
+	jpeg::SDecodeContext& context = jpeg::LocalDecodeContext;
+	jpeg_decompress_struct& cinfo = context.cinfo;
+	cinfo.client_data = const_cast<char*>(_file->getFileName().c_str());
 
-	cinfo.err = jpeg_std_error(&jerr.pub);
-	cinfo.err->error_exit = jpeg::error_exit;
-	cinfo.err->output_message = jpeg::output_message;
-    cinfo.client_data = const_cast<char*>(Filename.c_str());
+	// files in memory are decoded in place, others get read into the buffer of this thread
+	const size_t inputSize = _file->getSize();
+	const uint8_t* input = reinterpret_cast<const uint8_t*>(_file->getMappedPointer());
+	if (!input)
+	{
+		context.input.resize(inputSize);
+		_file->read(context.input.data(), static_cast<uint32_t>(inputSize));
+		input = context.input.data();
+	}
 
-	auto exitRoutine = [&] {
-		jpeg_destroy_decompress(&cinfo);
-		delete[] input;
-	};
-	auto exiter = core::makeRAIIExiter(exitRoutine);
+	// changed between setjmp and longjmp
+	asset::CImageData* volatile image = nullptr;
 	// compatibility fudge:
 	// we need to use setjmp/longjmp for error handling as gcc-linux
 	// crashes when throwing within external c code
-	if (setjmp(jerr.setjmp_buffer))
+	if (setjmp(context.jerr.setjmp_buffer))
 	{
 		os::Printer::log("Can't load libjpeg threw an error:", _file->getFileName().c_str(), ELL_ERROR);
-		// RAIIExiter takes care of cleanup
-        return {};
+		context.abort();
+		if (image)
+			image->drop();
+		return nullptr;
 	}
 
-	// Now we can initialize the JPEG decompression object.
-	jpeg_create_decompress(&cinfo);
-
-	// specify data source
-	jpeg_source_mgr jsrc;
+	if (!context.created)
+	{
+		jpeg_create_decompress(&cinfo);
+		context.created = true;
+	}
 
 	// Set up data pointer
-	jsrc.bytes_in_buffer = _file->getSize();
-	jsrc.next_input_byte = (JOCTET*)input;
-	cinfo.src = &jsrc;
-
-	jsrc.init_source = jpeg::init_source;
-	jsrc.fill_input_buffer = jpeg::fill_input_buffer;
-	jsrc.skip_input_data = jpeg::skip_input_data;
-	jsrc.resync_to_restart = jpeg_resync_to_restart;
-	jsrc.term_source = jpeg::term_source;
-
-	// Decodes JPG input from whatever source
-	// Does everything AFTER jpeg_create_decompress
-	// and BEFORE jpeg_destroy_decompress
-	// Caller is responsible for arranging these + setting up cinfo
+	context.jsrc.bytes_in_buffer = inputSize;
+	context.jsrc.next_input_byte = reinterpret_cast<const JOCTET*>(input);
+	cinfo.src = &context.jsrc;
 
 	// read _file parameters with jpeg_read_header()
 	jpeg_read_header(&cinfo, TRUE);
 
+	asset::E_FORMAT format = asset::EF_UNKNOWN;
 	switch (cinfo.jpeg_color_space)
 	{
 		case JCS_GRAYSCALE:
-			cinfo.out_color_components = 1;
-			cinfo.output_gamma = 1.0; // output_gamma is a dead variable in libjpegturbo and jpeglib
+			// https://github.com/buildaworldnet/IrrlichtBAW/pull/273#issuecomment-491492010
+			format = asset::EF_R8_SRGB;
 			break;
 		case JCS_RGB:
-			cinfo.out_color_components = 3;
-			cinfo.output_gamma = 2.2333333f; // output_gamma is a dead variable in libjpegturbo and jpeglib
+			format = asset::EF_R8G8B8_SRGB;
 			break;
 		case JCS_YCbCr:
-			cinfo.out_color_components = 3;
-			cinfo.output_gamma = 2.2333333f; // output_gamma is a dead variable in libjpegturbo and jpeglib
 			// it seems that libjpeg does Y'UV to R'G'B'conversion automagically
 			// however be prepared that the colors might be a bit "off"
 			// https://en.wikipedia.org/wiki/YCbCr#JPEG_conversion
+			format = asset::EF_R8G8B8_SRGB;
 			break;
 		case JCS_CMYK:
 			os::Printer::log("CMYK color space is unsupported:", _file->getFileName().c_str(), ELL_ERROR);
-			return {};
 			break;
 		case JCS_YCCK: // this I have no resources on
 			os::Printer::log("YCCK color space is unsupported:", _file->getFileName().c_str(), ELL_ERROR);
-			return {};
 			break;
 		case JCS_BG_RGB: // interesting
 			os::Printer::log("Loading JPEG Big Gamut RGB is not implemented yet:", _file->getFileName().c_str(), ELL_ERROR);
-			return {};
 			break;
 		case JCS_BG_YCC: // interesting
 			os::Printer::log("Loading JPEG Big Gamut YCbCr is not implemented yet:", _file->getFileName().c_str(), ELL_ERROR);
-			return {};
 			break;
 		default:
 			os::Printer::log("Can't load as color space is unknown:", _file->getFileName().c_str(), ELL_ERROR);
-			return {};
 			break;
 	}
+	if (format==asset::EF_UNKNOWN)
+	{
+		context.abort();
+		return nullptr;
+	}
 	cinfo.do_fancy_upsampling = TRUE;
-	
-	// Start decompressor
+
+	// the IDCT can output 1/2, 1/4 or 1/8 of the size at a fraction of the cost of decoding it all
+	cinfo.scale_num = 1u;
+	cinfo.scale_denom = 1u;
+	if (_maxResolution)
+	{
+		const uint32_t longestSide = core::max<uint32_t>(cinfo.image_width, cinfo.image_height);
+		while (cinfo.scale_denom<8u && (longestSide+cinfo.scale_denom*2u-1u)/(cinfo.scale_denom*2u)>=_maxResolution)
+			cinfo.scale_denom *= 2u;
+	}
+
+	// Start decompressor, which also computes the scaled output size
 	jpeg_start_decompress(&cinfo);
-	
-	// Get image data
-	uint32_t rowspan = cinfo.image_width * cinfo.out_color_components;
-	uint32_t imageSize[3] = {cinfo.image_width,cinfo.image_height,1};
-	uint32_t& width = imageSize[0];
-	uint32_t& height = imageSize[1];
 
-	// Allocate memory for buffer
-	auto output = core::make_smart_refctd_ptr<asset::ICPUBuffer>(rowspan*height);
+	uint32_t nullOffset[3] = {0,0,0};
+	uint32_t imageSize[3] = {cinfo.output_width,cinfo.output_height,1};
+	image = new asset::CImageData(nullptr,nullOffset,imageSize,0u,format,1);
 
 	// Here we use the library's state variable cinfo.output_scanline as the
 	// loop counter, so that we don't have to keep track ourselves.
-	// Create array of row pointers for lib
-	constexpr uint32_t MaxJPEGResolution = 65535u;
-	uint8_t* rowPtr[MaxJPEGResolution];
-	for (uint32_t i = 0; i < height; ++i)
-		rowPtr[i] = &reinterpret_cast<uint8_t*>(output->getPointer())[i*rowspan];
-
-	// Read rows from bottom order to match OpenGL coords
-	uint32_t rowsRead = 0;
+	// The rows get decoded straight into the image, a few at a time.
+	const size_t rowspan = size_t(cinfo.output_width)*cinfo.output_components;
+	uint8_t* const data = reinterpret_cast<uint8_t*>(image->getData());
+	constexpr uint32_t MaxRowsPerRead = 16u;
+	JSAMPROW rows[MaxRowsPerRead];
 	while (cinfo.output_scanline < cinfo.output_height)
-		rowsRead += jpeg_read_scanlines(&cinfo, &rowPtr[rowsRead], 1);
-	
-	// Finish decompression
-	jpeg_finish_decompress(&cinfo);
-	
-	asset::CImageData* image = nullptr;
-	uint32_t nullOffset[3] = {0,0,0};
-	switch (cinfo.jpeg_color_space)
 	{
-		case JCS_GRAYSCALE:
-			// https://github.com/buildaworldnet/IrrlichtBAW/pull/273#issuecomment-491492010
-			image = new asset::CImageData(output->getPointer(),nullOffset,imageSize,0u,asset::EF_R8_SRGB,1);
-			break;
-		case JCS_RGB:
-			image = new asset::CImageData(output->getPointer(),nullOffset,imageSize,0u,asset::EF_R8G8B8_SRGB,1);
-			break;
-		case JCS_YCbCr:
-			// libjpeg does implicit conversion to R'G'B'
-			image = new asset::CImageData(output->getPointer(),nullOffset,imageSize,0u,asset::EF_R8G8B8_SRGB,1);
-			break;
-		default: // should never get here
-			os::Printer::log("Unsupported color space, operation aborted.", ELL_ERROR);
-            return {};
-			break;
+		const uint32_t rowCount = core::min(cinfo.output_height-cinfo.output_scanline,MaxRowsPerRead);
+		for (uint32_t i=0u; i<rowCount; i++)
+			rows[i] = data+(cinfo.output_scanline+i)*rowspan;
+		jpeg_read_scanlines(&cinfo, rows, rowCount);
 	}
 
-	ICPUTexture* tex = ICPUTexture::create({image}, _file->getFileName().c_str());
-	image->drop();
-    return SAssetBundle({core::smart_refctd_ptr<IAsset>(tex, core::dont_grab)});
+	// Finish decompression
+	jpeg_finish_decompress(&cinfo);
+	context.releaseLargeInput();
+	return image;
 #endif
 }
 
+void decodeJPEGBatch(io::IReadFile* const* _files, uint32_t _fileCount, uint32_t _maxResolution, asset::CImageData** _outImages)
+{
+	// every file is worth a task of its own
+	core::CTaskScheduler::getGlobal().parallelFor(0u,_fileCount,1u,[=](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i=begin; i<end; i++)
+			_outImages[i] = decodeJPEG(_files[i],_maxResolution);
+	});
+}
+
 } // end namespace video
 } // end namespace irr
 
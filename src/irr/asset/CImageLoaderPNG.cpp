@@ -12,6 +12,8 @@
 
 #include "irr/asset/ICPUTexture.h"
 #include "irr/asset/CImageData.h"
+#include "irr/asset/format/decodeImageFiles.h"
+#include "irr/core/parallel/CTaskScheduler.h"
 #include "CReadFile.h"
 #include "os.h"
 
@@ -47,6 +49,9 @@ void PNGAPI user_read_data_fcn(png_structp png_ptr, png_bytep data, png_size_t l
 	if (check != length)
 		png_error(png_ptr, "Read Error");
 }
+
+// row pointers every thread reuses for all the files it decodes, libpng's read structs can't be reused
+static thread_local core::vector<png_bytep> LocalRowPointers;
 #endif // _IRR_COMPILE_WITH_LIBPNG_
 
 
@@ -79,27 +84,35 @@ bool CImageLoaderPng::isALoadableFileFormat(io::IReadFile* _file) const
 // load in the image data
 asset::SAssetBundle CImageLoaderPng::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
-    core::vector<asset::CImageData*> images;
+    IRR_PROFILE_SCOPE("CImageLoaderPng::loadAsset");
+    asset::CImageData* image = decodePNG(_file);
+    if (!image)
+        return {};
+
+    ICPUTexture* tex = ICPUTexture::create({image}, _file->getFileName().c_str());
+    image->drop();
+    return SAssetBundle({core::smart_refctd_ptr<IAsset>(tex, core::dont_grab)});
+}
+
+asset::CImageData* decodePNG(io::IReadFile* _file)
+{
 #ifdef _IRR_COMPILE_WITH_LIBPNG_
 	if (!_file)
-        return {};
-	
-	//Used to point to image rows
-	uint8_t** RowPointers = 0;
+		return nullptr;
 
 	png_byte buffer[8];
 	// Read the first few bytes of the PNG _file
 	if( _file->read(buffer, 8) != 8 )
 	{
 		os::Printer::log("LOAD PNG: can't read _file\n", _file->getFileName().c_str(), ELL_ERROR);
-        return {};
+		return nullptr;
 	}
 
 	// Check if it really is a PNG _file
 	if( png_sig_cmp(buffer, 0, 8) )
 	{
 		os::Printer::log("LOAD PNG: not really a png\n", _file->getFileName().c_str(), ELL_ERROR);
-        return {};
+		return nullptr;
 	}
 
 	// Allocate the png read struct
@@ -108,7 +121,7 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(io::IReadFile* _file, const asset
 	if (!png_ptr)
 	{
 		os::Printer::log("LOAD PNG: Internal PNG create read struct failure\n", _file->getFileName().c_str(), ELL_ERROR);
-        return {};
+		return nullptr;
 	}
 
 	// Allocate the png info struct
@@ -117,16 +130,18 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(io::IReadFile* _file, const asset
 	{
 		os::Printer::log("LOAD PNG: Internal PNG create info struct failure\n", _file->getFileName().c_str(), ELL_ERROR);
 		png_destroy_read_struct(&png_ptr, nullptr, nullptr);
-        return {};
+		return nullptr;
 	}
 
+	// changed between setjmp and longjmp
+	asset::CImageData* volatile image = nullptr;
 	// for proper error handling
 	if (setjmp(png_jmpbuf(png_ptr)))
 	{
 		png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-		if (RowPointers)
-			delete [] RowPointers;
-        return {};
+		if (image)
+			image->drop();
+		return nullptr;
 	}
 
 	// changed by zola so we don't need to have public FILE pointers
@@ -169,9 +184,14 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(io::IReadFile* _file, const asset
 	}
 	
 	// Add an alpha channel if transparency information is found in tRNS chunk
-	if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
+	const bool hasTRNS = png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS);
+	if (hasTRNS)
 		png_set_tRNS_to_alpha(png_ptr);
 
+	// there is no two channel sRGB format, libpng expands luma-alpha to LLLA while decoding the rows
+	if (ColorType == PNG_COLOR_TYPE_GRAY_ALPHA || (ColorType == PNG_COLOR_TYPE_GRAY && hasTRNS))
+		png_set_gray_to_rgb(png_ptr);
+
 	// Convert high bit colors to 8 bit colors
 	if (BitDepth == 16)
 		png_set_strip_16(png_ptr);
@@ -204,9 +224,7 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(io::IReadFile* _file, const asset
 
 	// Create the image structure to be filled by png data
 	uint32_t nullOffset[3] = {0,0,0};
-	asset::CImageData* image = nullptr;
 
-	bool lumaAlphaType = false;
 	switch (ColorType) {
 		case PNG_COLOR_TYPE_RGB_ALPHA:
 			image = new asset::CImageData(nullptr, nullOffset, imageSize, 0, asset::EF_R8G8B8A8_SRGB);
@@ -217,35 +235,17 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(io::IReadFile* _file, const asset
 		case PNG_COLOR_TYPE_GRAY:
 			image = new asset::CImageData(nullptr, nullOffset, imageSize, 0, asset::EF_R8_SRGB);
 			break;
-		case PNG_COLOR_TYPE_GRAY_ALPHA:
-			image = new asset::CImageData(nullptr, nullOffset, imageSize, 0, asset::EF_R8G8B8A8_SRGB);
-			lumaAlphaType = true;
-			break;
 		default:
 			{
 				os::Printer::log("Unsupported PNG colorspace (only RGB/RGBA/8-bit grayscale), operation aborted.", ELL_ERROR);
-                return {};
+				png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+				return nullptr;
 			}
 	}
-	
-	if (!image)
-	{
-		os::Printer::log("LOAD PNG: Internal PNG create image struct failure\n", _file->getFileName().c_str(), ELL_ERROR);
-		png_destroy_read_struct(&png_ptr, nullptr, nullptr);
-        return {};
-	}
-
-	// Create array of pointers to rows in image data
-	RowPointers = new png_bytep[Height];
-	if (!RowPointers)
-	{
-		os::Printer::log("LOAD PNG: Internal PNG create row pointers failure\n", _file->getFileName().c_str(), ELL_ERROR);
-		png_destroy_read_struct(&png_ptr, nullptr, nullptr);
-		image->drop();
-        return {};
-	}
 
-	// Fill array of pointers to rows in image data
+	// Fill array of pointers to rows in image data, the array is kept by the thread for the next file
+	core::vector<png_bytep>& RowPointers = LocalRowPointers;
+	RowPointers.resize(Height);
 	const uint32_t pitch = image->getPitchIncludingAlignment();
 	uint8_t* data = reinterpret_cast<uint8_t*>(image->getData());
 	for (uint32_t i=0; i<Height; ++i)
@@ -254,43 +254,26 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(io::IReadFile* _file, const asset
 		data += pitch;
 	}
 
-	// for proper error handling
-	if (setjmp(png_jmpbuf(png_ptr)))
-	{
-		png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-		delete [] RowPointers;
-		image->drop();
-        return {};
-	}
-
 	// Read data using the library function that handles all transformations including interlacing
-	png_read_image(png_ptr, RowPointers);
+	png_read_image(png_ptr, RowPointers.data());
 
 	png_read_end(png_ptr, nullptr);
-	if (lumaAlphaType)
-	{
-		assert(image->getColorFormat()==asset::EF_R8G8B8A8_SRGB);
-		for (uint32_t i=0u; i<Height; ++i)
-		for (uint32_t j=0u; j<Width;)
-		{
-			uint32_t in = reinterpret_cast<uint16_t*>(RowPointers[i])[j];
-			j++;
-			auto& out = reinterpret_cast<uint32_t*>(RowPointers[i])[Width-j];
-			out = in|(in << 16u); // LXLA
-			out &= 0xffff00ffu;
-			out |= (in&0xffu) << 8u;
-		}
-	}
-	delete [] RowPointers;
 	png_destroy_read_struct(&png_ptr,&info_ptr, 0); // Clean up memory
 
-	images.push_back(image);
+	return image;
+#else
+	return nullptr;
 #endif // _IRR_COMPILE_WITH_LIBPNG_
+}
 
-    ICPUTexture* tex = ICPUTexture::create(images, _file->getFileName().c_str());
-    for (auto& img : images)
-        img->drop();
-    return SAssetBundle({core::smart_refctd_ptr<IAsset>(tex, core::dont_grab)});
+void decodePNGBatch(io::IReadFile* const* _files, uint32_t _fileCount, asset::CImageData** _outImages)
+{
+	// every file is worth a task of its own
+	core::CTaskScheduler::getGlobal().parallelFor(0u,_fileCount,1u,[=](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i=begin; i<end; i++)
+			_outImages[i] = decodePNG(_files[i]);
+	});
 }
 
 
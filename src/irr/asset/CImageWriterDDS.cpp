@@ -0,0 +1,423 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#include "CImageWriterDDS.h"
+
+#ifdef _IRR_COMPILE_WITH_DDS_WRITER_
+
+#include "IWriteFile.h"
+#include "irr/asset/ICPUTexture.h"
+#include "irr/asset/format/compressBlocks.h"
+
+#include "os.h"
+
+namespace irr
+{
+namespace asset
+{
+
+namespace
+{
+#include "irr/irrpack.h"
+	struct SDDSPixelFormat
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t rBitMask;
+		uint32_t gBitMask;
+		uint32_t bBitMask;
+		uint32_t aBitMask;
+	} PACK_STRUCT;
+
+	struct SDDSHeader
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];
+		SDDSPixelFormat pixelFormat;
+		uint32_t caps;
+		uint32_t caps2;
+		uint32_t caps3;
+		uint32_t caps4;
+		uint32_t reserved2;
+	} PACK_STRUCT;
+
+	struct SDDSHeaderDX10
+	{
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	} PACK_STRUCT;
+#include "irr/irrunpack.h"
+	static_assert(sizeof(SDDSHeader)==124u, "DDS header has to be 124 bytes");
+
+	constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+	{
+		return uint32_t(a)|(uint32_t(b)<<8u)|(uint32_t(c)<<16u)|(uint32_t(d)<<24u);
+	}
+
+	enum : uint32_t
+	{
+		DDSD_CAPS = 0x1u,
+		DDSD_HEIGHT = 0x2u,
+		DDSD_WIDTH = 0x4u,
+		DDSD_PITCH = 0x8u,
+		DDSD_PIXELFORMAT = 0x1000u,
+		DDSD_MIPMAPCOUNT = 0x20000u,
+		DDSD_LINEARSIZE = 0x80000u,
+		DDSD_DEPTH = 0x800000u,
+
+		DDPF_ALPHAPIXELS = 0x1u,
+		DDPF_FOURCC = 0x4u,
+		DDPF_RGB = 0x40u,
+		DDPF_LUMINANCE = 0x20000u,
+
+		DDSCAPS_COMPLEX = 0x8u,
+		DDSCAPS_TEXTURE = 0x1000u,
+		DDSCAPS_MIPMAP = 0x400000u,
+		DDSCAPS2_CUBEMAP = 0x200u,
+		DDSCAPS2_CUBEMAP_ALLFACES = 0xfc00u,
+		DDSCAPS2_VOLUME = 0x200000u,
+
+		DDS_DIMENSION_TEXTURE1D = 2u,
+		DDS_DIMENSION_TEXTURE2D = 3u,
+		DDS_DIMENSION_TEXTURE3D = 4u,
+		DDS_RESOURCE_MISC_TEXTURECUBE = 0x4u
+	};
+
+	//! DXGI_FORMAT of the format, 0 if it has none
+	uint32_t getDXGIFormat(E_FORMAT _fmt)
+	{
+		switch (_fmt)
+		{
+			case EF_R32G32B32A32_SFLOAT: return 2u;
+			case EF_R16G16B16A16_SFLOAT: return 10u;
+			case EF_R16G16B16A16_UNORM: return 11u;
+			case EF_R32G32_SFLOAT: return 16u;
+			case EF_A2B10G10R10_UNORM_PACK32: return 24u;
+			case EF_B10G11R11_UFLOAT_PACK32: return 26u;
+			case EF_R8G8B8A8_UNORM: return 28u;
+			case EF_R8G8B8A8_SRGB: return 29u;
+			case EF_R8G8B8A8_SNORM: return 31u;
+			case EF_R16G16_SFLOAT: return 34u;
+			case EF_R16G16_UNORM: return 35u;
+			case EF_R32_SFLOAT: return 41u;
+			case EF_R8G8_UNORM: return 49u;
+			case EF_R8G8_SNORM: return 51u;
+			case EF_R16_SFLOAT: return 54u;
+			case EF_R16_UNORM: return 56u;
+			case EF_R8_UNORM: return 61u;
+			case EF_R8_SNORM: return 63u;
+			case EF_E5B9G9R9_UFLOAT_PACK32: return 67u;
+			case EF_BC1_RGB_UNORM_BLOCK:
+			case EF_BC1_RGBA_UNORM_BLOCK: return 71u;
+			case EF_BC1_RGB_SRGB_BLOCK:
+			case EF_BC1_RGBA_SRGB_BLOCK: return 72u;
+			case EF_BC2_UNORM_BLOCK: return 74u;
+			case EF_BC2_SRGB_BLOCK: return 75u;
+			case EF_BC3_UNORM_BLOCK: return 77u;
+			case EF_BC3_SRGB_BLOCK: return 78u;
+			case EF_BC4_UNORM_BLOCK: return 80u;
+			case EF_BC4_SNORM_BLOCK: return 81u;
+			case EF_BC5_UNORM_BLOCK: return 83u;
+			case EF_BC5_SNORM_BLOCK: return 84u;
+			case EF_B8G8R8A8_UNORM: return 87u;
+			case EF_B8G8R8A8_SRGB: return 91u;
+			case EF_BC6H_UFLOAT_BLOCK: return 95u;
+			case EF_BC6H_SFLOAT_BLOCK: return 96u;
+			case EF_BC7_UNORM_BLOCK: return 98u;
+			case EF_BC7_SRGB_BLOCK: return 99u;
+			default: return 0u;
+		}
+	}
+
+	//! Pixel format of the original header, false if the format needs the DX10 header
+	/** Only formats that CImageLoaderDDS reads back as exactly the same format get one, it takes legacy 8 bit color and DXTn as sRGB.
+	`_swapRedBlue` is set when the texels have to be written as BGR, which is the only byte order of 24 bit legacy files. */
+	bool getLegacyPixelFormat(E_FORMAT _fmt, SDDSPixelFormat& _out, bool& _swapRedBlue)
+	{
+		_out = {};
+		_out.size = sizeof(SDDSPixelFormat);
+		_swapRedBlue = false;
+		auto fourCC = [&_out](uint32_t _code) { _out.flags = DDPF_FOURCC; _out.fourCC = _code; return true; };
+		auto masks = [&_out](uint32_t _flags, uint32_t _bits, uint32_t _r, uint32_t _g, uint32_t _b, uint32_t _a)
+		{
+			_out.flags = _flags;
+			_out.rgbBitCount = _bits;
+			_out.rBitMask = _r;
+			_out.gBitMask = _g;
+			_out.bBitMask = _b;
+			_out.aBitMask = _a;
+			return true;
+		};
+		switch (_fmt)
+		{
+			case EF_BC1_RGB_SRGB_BLOCK: return fourCC(makeFourCC('D','X','T','1'));
+			case EF_BC2_SRGB_BLOCK: return fourCC(makeFourCC('D','X','T','3'));
+			case EF_BC3_SRGB_BLOCK: return fourCC(makeFourCC('D','X','T','5'));
+			case EF_BC4_UNORM_BLOCK: return fourCC(makeFourCC('A','T','I','1'));
+			case EF_BC4_SNORM_BLOCK: return fourCC(makeFourCC('B','C','4','S'));
+			case EF_BC5_UNORM_BLOCK: return fourCC(makeFourCC('A','T','I','2'));
+			case EF_BC5_SNORM_BLOCK: return fourCC(makeFourCC('B','C','5','S'));
+			case EF_R8G8B8A8_SRGB: return masks(DDPF_RGB|DDPF_ALPHAPIXELS,32u,0xffu,0xff00u,0xff0000u,0xff000000u);
+			case EF_B8G8R8A8_SRGB: return masks(DDPF_RGB|DDPF_ALPHAPIXELS,32u,0xff0000u,0xff00u,0xffu,0xff000000u);
+			case EF_R8G8B8_SRGB:
+				_swapRedBlue = true;
+				return masks(DDPF_RGB,24u,0xff0000u,0xff00u,0xffu,0u);
+			default: return false;
+		}
+	}
+
+	//! What `EWF_COMPRESSED` turns an uncompressed format into, EF_UNKNOWN if no block format we can encode would keep its values
+	E_FORMAT getBlockCompressedFormat(E_FORMAT _fmt)
+	{
+		// BC6H has no encoder, and integer or scaled values don't survive going through normalized texels
+		if (isFloatingPointFormat(_fmt) || isIntegerFormat(_fmt) || isScaledFormat(_fmt))
+			return EF_UNKNOWN;
+
+		const bool srgb = isSRGBFormat(_fmt);
+		const uint32_t channels = getFormatChannelCount(_fmt);
+		if (isSignedFormat(_fmt))
+		{
+			switch (channels)
+			{
+				case 1u: return EF_BC4_SNORM_BLOCK;
+				case 2u: return EF_BC5_SNORM_BLOCK;
+				default: return EF_UNKNOWN;
+			}
+		}
+		switch (channels)
+		{
+			case 1u: return EF_BC4_UNORM_BLOCK;
+			case 2u: return EF_BC5_UNORM_BLOCK;
+			// opaque texels never use the punch through, and linear BC1 only reads back from the DX10 header as RGBA
+			case 3u: return srgb ? EF_BC1_RGB_SRGB_BLOCK:EF_BC1_RGBA_UNORM_BLOCK;
+			default: return srgb ? EF_BC3_SRGB_BLOCK:EF_BC3_UNORM_BLOCK;
+		}
+	}
+}
+
+CImageWriterDDS::CImageWriterDDS()
+{
+#ifdef _IRR_DEBUG
+	setDebugName("CImageWriterDDS");
+#endif
+}
+
+bool CImageWriterDDS::writeAsset(io::IWriteFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override)
+{
+    if (!_override)
+        getDefaultOverride(_override);
+
+    SAssetWriteContext ctx{_params, _file};
+
+    io::IWriteFile* file = _override->getOutputFile(_file, ctx, { _params.rootAsset, 0u });
+
+	core::smart_refctd_ptr<ICPUTexture> texture;
+	if (_params.rootAsset->getAssetType() == IAsset::ET_SUB_IMAGE)
+	{
+		// a lone image gets written as a texture without mip maps
+		CImageData* image = const_cast<CImageData*>(static_cast<const CImageData*>(_params.rootAsset));
+		if (image->getSupposedMipLevel() != 0u)
+		{
+			os::Printer::log("DDS writer needs the image to be mip level 0, operation aborted.", ELL_ERROR);
+			return false;
+		}
+		texture = core::smart_refctd_ptr<ICPUTexture>(ICPUTexture::create(core::vector<CImageData*>{ image }, ""), core::dont_grab);
+	}
+	else
+		texture = core::smart_refctd_ptr<ICPUTexture>(const_cast<ICPUTexture*>(static_cast<const ICPUTexture*>(_params.rootAsset)));
+	if (!texture)
+		return false;
+
+	if ((_override->getAssetWritingFlags(ctx, _params.rootAsset, 0u) & EWF_COMPRESSED) && !isBlockCompressionFormat(texture->getColorFormat()))
+	{
+		const E_FORMAT compressedFormat = getBlockCompressedFormat(texture->getColorFormat());
+		if (compressedFormat == EF_UNKNOWN)
+		{
+			os::Printer::log("No block compressed format can hold the texture's values, operation aborted.", ELL_ERROR);
+			return false;
+		}
+		texture = core::smart_refctd_ptr<ICPUTexture>(createBlockCompressedTexture(texture.get(), compressedFormat), core::dont_grab);
+		if (!texture)
+		{
+			os::Printer::log("Could not block compress the texture, operation aborted.", ELL_ERROR);
+			return false;
+		}
+	}
+
+	const E_FORMAT format = texture->getColorFormat();
+	const auto type = texture->getType();
+	const uint32_t* size = texture->getSize();
+
+	uint32_t layers = 1u;
+	switch (type)
+	{
+		case video::ITexture::ETT_1D:
+		case video::ITexture::ETT_2D:
+		case video::ITexture::ETT_3D:
+			break;
+		case video::ITexture::ETT_2D_ARRAY:
+		case video::ITexture::ETT_CUBE_MAP:
+		case video::ITexture::ETT_CUBE_MAP_ARRAY:
+			layers = size[2];
+			break;
+		default:
+			os::Printer::log("DDS can't store 1D array textures, operation aborted.", ELL_ERROR);
+			return false;
+	}
+	const bool isCube = type == video::ITexture::ETT_CUBE_MAP || type == video::ITexture::ETT_CUBE_MAP_ARRAY;
+	const bool is3D = type == video::ITexture::ETT_3D;
+
+	// every mip level has to be a single range covering all of it
+	const uint32_t mipCount = texture->getHighestMip() + 1u;
+	core::vector<const CImageData*> levels(mipCount);
+	for (uint32_t level = 0u; level < mipCount; ++level)
+	{
+		const auto range = texture->getMipMap(level);
+		const uint32_t extent[3] = { core::max(size[0] >> level, 1u), core::max(size[1] >> level, 1u), is3D ? core::max(size[2] >> level, 1u) : layers };
+		bool valid = range.second - range.first == 1 && (*range.first)->getSupposedMipLevel() == level && (*range.first)->getData();
+		for (uint32_t d = 0u; valid && d < 3u; ++d)
+			valid = (*range.first)->getSliceMin()[d] == 0u && (*range.first)->getSliceMax()[d] == extent[d];
+		if (!valid)
+		{
+			os::Printer::log("DDS writer needs every mip level as one whole image, operation aborted.", ELL_ERROR);
+			return false;
+		}
+		levels[level] = *range.first;
+	}
+
+	SDDSPixelFormat pixelFormat;
+	bool swapRedBlue = false;
+	const bool needsDX10 = (layers > 1u && !(type == video::ITexture::ETT_CUBE_MAP && layers == 6u)) || !getLegacyPixelFormat(format, pixelFormat, swapRedBlue);
+	const uint32_t dxgiFormat = getDXGIFormat(format);
+	if (needsDX10)
+	{
+		if (!dxgiFormat)
+		{
+			os::Printer::log("Unsupported color format, operation aborted.", ELL_ERROR);
+			return false;
+		}
+		pixelFormat = {};
+		pixelFormat.size = sizeof(SDDSPixelFormat);
+		pixelFormat.flags = DDPF_FOURCC;
+		pixelFormat.fourCC = makeFourCC('D','X','1','0');
+	}
+
+	const bool compressed = isBlockCompressionFormat(format);
+	const auto blockDims = getBlockDimensions(format);
+	const uint32_t blockBytes = getTexelOrBlockBytesize(format);
+	// bytes of one row of texels, or of blocks
+	auto getRowBytes = [&](uint32_t _width) -> size_t
+	{
+		if (compressed)
+			return size_t((_width + blockDims[0] - 1u) / blockDims[0]) * blockBytes;
+		return (getBytesPerPixel(format) * _width).getIntegerApprox();
+	};
+	auto getRowCount = [&](uint32_t _height) -> uint32_t
+	{
+		return compressed ? (_height + blockDims[1] - 1u) / blockDims[1] : _height;
+	};
+
+	SDDSHeader header = {};
+	header.size = sizeof(SDDSHeader);
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | (compressed ? DDSD_LINEARSIZE : DDSD_PITCH);
+	header.height = size[1];
+	header.width = size[0];
+	header.pitchOrLinearSize = static_cast<uint32_t>(compressed ? getRowBytes(size[0]) * getRowCount(size[1]) : getRowBytes(size[0]));
+	header.caps = DDSCAPS_TEXTURE;
+	if (mipCount > 1u)
+	{
+		header.flags |= DDSD_MIPMAPCOUNT;
+		header.mipMapCount = mipCount;
+		header.caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+	}
+	if (is3D)
+	{
+		header.flags |= DDSD_DEPTH;
+		header.depth = size[2];
+		header.caps |= DDSCAPS_COMPLEX;
+		header.caps2 = DDSCAPS2_VOLUME;
+	}
+	if (isCube)
+	{
+		header.caps |= DDSCAPS_COMPLEX;
+		header.caps2 = DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALLFACES;
+	}
+	header.pixelFormat = pixelFormat;
+
+	const uint32_t magic = makeFourCC('D','D','S',' ');
+	if (file->write(&magic, sizeof(magic)) != sizeof(magic) || file->write(&header, sizeof(header)) != sizeof(header))
+		return false;
+	if (needsDX10)
+	{
+		SDDSHeaderDX10 dx10Header = {};
+		dx10Header.dxgiFormat = dxgiFormat;
+		dx10Header.resourceDimension = is3D ? DDS_DIMENSION_TEXTURE3D : (type == video::ITexture::ETT_1D ? DDS_DIMENSION_TEXTURE1D : DDS_DIMENSION_TEXTURE2D);
+		dx10Header.miscFlag = isCube ? DDS_RESOURCE_MISC_TEXTURECUBE : 0u;
+		// cube maps count whole cubes
+		dx10Header.arraySize = isCube ? layers / 6u : layers;
+		if (file->write(&dx10Header, sizeof(dx10Header)) != sizeof(dx10Header))
+			return false;
+	}
+
+	// layers (and cube faces) one after the other, each with its whole mip chain
+	core::vector<uint8_t> rowStaging;
+	for (uint32_t layer = 0u; layer < layers; ++layer)
+	for (uint32_t level = 0u; level < mipCount; ++level)
+	{
+		const CImageData* image = levels[level];
+		const auto extent = image->getSize();
+		const size_t rowBytes = getRowBytes(extent.X);
+		const uint32_t rowsPerSlice = getRowCount(extent.Y);
+		const size_t srcPitch = compressed ? rowBytes : image->getPitchIncludingAlignment();
+		const uint32_t slices = is3D ? extent.Z : 1u;
+
+		const uint8_t* src = reinterpret_cast<const uint8_t*>(image->getData()) + size_t(layer) * rowsPerSlice * srcPitch;
+		const uint32_t rows = rowsPerSlice * slices;
+		if (swapRedBlue)
+		{
+			rowStaging.resize(rowBytes);
+			for (uint32_t row = 0u; row < rows; ++row, src += srcPitch)
+			{
+				for (size_t i = 0u; i < rowBytes; i += 3u)
+				{
+					rowStaging[i] = src[i + 2u];
+					rowStaging[i + 1u] = src[i + 1u];
+					rowStaging[i + 2u] = src[i];
+				}
+				if (file->write(rowStaging.data(), static_cast<uint32_t>(rowBytes)) != static_cast<int32_t>(rowBytes))
+					return false;
+			}
+		}
+		else if (srcPitch == rowBytes)
+		{
+			const int32_t bytes = static_cast<int32_t>(rowBytes * rows);
+			if (file->write(src, bytes) != bytes)
+				return false;
+		}
+		else
+		for (uint32_t row = 0u; row < rows; ++row, src += srcPitch)
+		{
+			if (file->write(src, static_cast<uint32_t>(rowBytes)) != static_cast<int32_t>(rowBytes))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+} // namespace asset
+} // namespace irr
+
+#endif
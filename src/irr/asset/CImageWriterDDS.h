@@ -0,0 +1,50 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#ifndef _C_IMAGE_WRITER_DDS_H_INCLUDED__
+#define _C_IMAGE_WRITER_DDS_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+
+#ifdef _IRR_COMPILE_WITH_DDS_WRITER_
+
+#include "irr/asset/IAssetWriter.h"
+
+namespace irr
+{
+namespace asset
+{
+
+//! Writes textures with their whole mip chain, also 3D textures, arrays and cube maps
+/** Formats which the original DDS pixel format describes and CImageLoaderDDS reads back as the very same format
+are written without the DX10 header so older tools read them, everything else and arrays get the DX10 header.
+With `EWF_COMPRESSED` a texture which isn't block compressed yet is compressed on the CPU first,
+to BC4, BC5, BC1 or BC3 depending on how many channels it has, SNORM sources with one or two channels
+go to the SNORM variants of BC4 and BC5. Float, integer and other signed sources can't be compressed and fail. */
+class CImageWriterDDS : public asset::IAssetWriter
+{
+public:
+	//! constructor
+	CImageWriterDDS();
+
+    virtual const char** getAssociatedFileExtensions() const
+    {
+        static const char* ext[]{ "dds", nullptr };
+        return ext;
+    }
+
+    virtual uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE|asset::IAsset::ET_SUB_IMAGE; }
+
+    virtual uint32_t getSupportedFlags() override { return asset::EWF_COMPRESSED; }
+
+    virtual uint32_t getForcedFlags() { return asset::EWF_BINARY; }
+
+    virtual bool writeAsset(io::IWriteFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override = nullptr) override;
+};
+
+} // namespace asset
+} // namespace irr
+
+#endif // _IRR_COMPILE_WITH_DDS_WRITER_
+#endif
@@ -33,6 +33,77 @@ inline unsigned int charsToUInt(const char *str)
 }
 
 
+namespace
+{
+	// LWO is big endian, these parse chunks already in memory and advance `data`
+	inline uint16_t parseU16(const uint8_t*& data)
+	{
+		const uint16_t retval = (uint16_t(data[0])<<8u)|data[1];
+		data += 2;
+		return retval;
+	}
+
+	inline uint32_t parseU32(const uint8_t*& data)
+	{
+		const uint32_t retval = (uint32_t(data[0])<<24u)|(uint32_t(data[1])<<16u)|(uint32_t(data[2])<<8u)|data[3];
+		data += 4;
+		return retval;
+	}
+
+	inline float parseF32(const uint8_t*& data)
+	{
+		const uint32_t tmp = parseU32(data);
+		float retval;
+		memcpy(&retval,&tmp,4);
+		return retval;
+	}
+
+	//! variable length index, 2 bytes or 4 bytes starting with 0xFF
+	inline uint32_t parseVX(const uint8_t*& data, const uint8_t* end)
+	{
+		uint32_t retval = parseU16(data);
+		if (retval>=0xFF00u && end-data>=2)
+			retval = ((retval<<16u)|parseU16(data))&~0xFF000000u;
+		return retval;
+	}
+
+	//! zero terminated and padded to an even length, returns the bytes used
+	inline uint32_t parseString(core::stringc& name, const uint8_t* data, const uint8_t* end)
+	{
+		const char* str = reinterpret_cast<const char*>(data);
+		const uint32_t length = static_cast<uint32_t>(strnlen(str,end-data));
+		name = core::stringc(str,length);
+		return core::min<uint32_t>((length+2u)&~1u,static_cast<uint32_t>(end-data));
+	}
+
+	//! converts `count` big endian 32bit values, 4 at a time with a byte shuffle
+	void byteswap32(uint32_t* out, const uint8_t* in, size_t count)
+	{
+		size_t i=0u;
+#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+		const __m128i mask = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+		for (; i+4u<=count; i+=4u)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out+i),_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+i*4u)),mask));
+#endif
+		for (const uint8_t* it=in+i*4u; i<count; i++)
+			out[i] = parseU32(it);
+	}
+
+	//! converts `count` big endian 16bit values, 8 at a time with a byte shuffle
+	void byteswap16(uint16_t* out, const uint8_t* in, size_t count)
+	{
+		size_t i=0u;
+#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+		const __m128i mask = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+		for (; i+8u<=count; i+=8u)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out+i),_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+i*2u)),mask));
+#endif
+		for (const uint8_t* it=in+i*2u; i<count; i++)
+			out[i] = parseU16(it);
+	}
+}
+
+
 struct tLWOTextureInfo
 {
 	tLWOTextureInfo() : UVTag(0), DUVTag(0), Flags(0), WidthWrap(2),
@@ -468,32 +539,39 @@ bool CLWOMeshFileLoader::readChunks()
 #ifdef LWO_READER_DEBUG
 					os::Printer::log("LWO loader: loading points.");
 #endif
-					core::vector3df vec;
-					Points.clear();
-					const uint32_t tmpsize = size/12;
-					Points.reallocate(tmpsize);
-					for (uint32_t i=0; i<tmpsize; ++i)
-					{
-						readVec(vec);
-						Points.push_back(vec);
-					}
+					const uint8_t* data = readChunk(size);
+					if (!data)
+						return false;
+					static_assert(sizeof(core::vector3df)==12u, "Points get byteswapped straight into the array.");
+					Points.set_used(size/12);
+					byteswap32(reinterpret_cast<uint32_t*>(Points.pointer()),data,Points.size()*3u);
 				}
 				break;
 			case charsToUIntD('V','M','A','P'):
 #ifdef LWO_READER_DEBUG
 				os::Printer::log("LWO loader: loading Vertex mapping.");
 #endif
-				readVertexMapping(size);
+				{
+					const uint8_t* data = readChunk(size);
+					if (!data)
+						return false;
+					readVertexMapping(data,size);
+				}
 				break;
 			case charsToUIntD('P','O','L','S'):
 			case charsToUIntD('P','T','C','H'): // TODO: should be a subdivison mesh
 #ifdef LWO_READER_DEBUG
 				os::Printer::log("LWO loader: loading polygons.");
 #endif
-				if (FormatVersion!=2)
-					readObj1(size);
-				else
-					readObj2(size);
+				{
+					const uint8_t* data = readChunk(size);
+					if (!data)
+						return false;
+					if (FormatVersion!=2)
+						readObj1(data,size);
+					else
+						readObj2(data,size);
+				}
 #ifdef LWO_READER_DEBUG
 				os::Printer::log("LWO loader: Done loading polygons.");
 #endif
@@ -520,13 +598,23 @@ bool CLWOMeshFileLoader::readChunks()
 #ifdef LWO_READER_DEBUG
 				os::Printer::log("LWO loader: loading tag mapping.");
 #endif
-				readTagMapping(size);
+				{
+					const uint8_t* data = readChunk(size);
+					if (!data)
+						return false;
+					readTagMapping(data,size);
+				}
 				break;
 			case charsToUIntD('V','M','A','D'): // discontinuous vertex mapping, i.e. additional texcoords
 #ifdef LWO_READER_DEBUG
 				os::Printer::log("LWO loader: loading Vertex mapping VMAD.");
 #endif
-				readDiscVertexMapping(size);
+				{
+					const uint8_t* data = readChunk(size);
+					if (!data)
+						return false;
+					readDiscVertexMapping(data,size);
+				}
 //			case charsToUIntD('V','M','P','A'):
 //			case charsToUIntD('E','N','V','L'):
 				break;
@@ -609,42 +697,53 @@ bool CLWOMeshFileLoader::readChunks()
 }
 
 
-void CLWOMeshFileLoader::readObj1(uint32_t size)
+const uint8_t* CLWOMeshFileLoader::readChunk(uint32_t size)
 {
-	uint32_t pos;
-	uint16_t numVerts, vertIndex;
-	int16_t material;
+	const size_t pos = File->getPos();
+	if (pos>File->getSize() || size>File->getSize()-pos)
+		return nullptr;
+
+	if (const uint8_t* mapped = reinterpret_cast<const uint8_t*>(File->getMappedPointer()))
+	{
+		File->seek(size, true);
+		return mapped+pos;
+	}
+
+	ChunkBuffer.resize(size);
+	if (File->read(ChunkBuffer.data(), size)!=static_cast<int32_t>(size))
+		return nullptr;
+	return ChunkBuffer.data();
+}
+
+
+void CLWOMeshFileLoader::readObj1(const uint8_t* data, uint32_t size)
+{
+	const uint8_t* const end = data+size;
+	core::vector<uint16_t> vertIndices;
 	video::S3DVertex vertex;
 	vertex.Color=0xffffffff;
 
-	while (size!=0)
+	while (end-data>=2)
 	{
-		File->read(&numVerts, 2);
-		numVerts=os::Byteswap::byteswap(numVerts);
-
-		pos=File->getPos();
-		// skip forward to material number
-		File->seek(2*numVerts, true);
-		File->read(&material, 2);
-		material=os::Byteswap::byteswap(material);
+		const uint16_t numVerts = parseU16(data);
+		if (end-data<2*numVerts+2)
+			break;
+		vertIndices.resize(numVerts);
+		byteswap16(vertIndices.data(),data,numVerts);
+		data += 2*numVerts;
+		const int16_t material = static_cast<int16_t>(parseU16(data));
 
-		size -=2*numVerts+4;
 		// detail meshes ?
 		scene::SMeshBuffer *mb;
 		if (material<0)
 			mb=Materials[-material-1]->Meshbuffer;
 		else
 			mb=Materials[material-1]->Meshbuffer;
-		// back to vertex list start
-		File->seek(pos, false);
 
 		const uint16_t vertCount=mb->Vertices.size();
 		for (uint16_t i=0; i<numVerts; ++i)
 		{
-			File->read(&vertIndex, 2);
-			vertIndex=os::Byteswap::byteswap(vertIndex);
-
-			vertex.Pos=Points[vertIndex];
+			vertex.Pos=Points[vertIndices[i]];
 			mb->Vertices.push_back(vertex);
 		}
 		for (uint16_t i=1; i<numVerts-1; ++i)
@@ -653,37 +752,32 @@ void CLWOMeshFileLoader::readObj1(uint32_t size)
 			mb->Indices.push_back(vertCount+i);
 			mb->Indices.push_back(vertCount+i+1);
 		}
-		// skip material number and detail surface count
+		// skip detail surface count
 		// detail surface can be read just as a normal one now
 		if (material<0)
-			File->read(&material, 2);
-		File->read(&material, 2);
+			data += 2;
 	}
 }
 
 
-void CLWOMeshFileLoader::readVertexMapping(uint32_t size)
+void CLWOMeshFileLoader::readVertexMapping(const uint8_t* data, uint32_t size)
 {
+	if (size<6)
+		return;
+	const uint8_t* const end = data+size;
 	char type[5]={0};
-	uint16_t dimension;
-	core::stringc name;
-	File->read(&type, 4);
+	memcpy(type, data, 4);
 #ifdef LWO_READER_DEBUG
 	os::Printer::log("LWO loader: Vertex map type", type);
 #endif
-	File->read(&dimension,2);
-	dimension=os::Byteswap::byteswap(dimension);
-
-	size -= 6;
-	size -= readString(name);
+	data += 6; // type and dimension
+	core::stringc name;
+	data += parseString(name, data, end);
 #ifdef LWO_READER_DEBUG
 	os::Printer::log("LWO loader: Vertex map", name.c_str());
 #endif
 	if (strncmp(type, "TXUV", 4)) // also support RGB, RGBA, WGHT, ...
-	{
-		File->seek(size, true);
 		return;
-	}
 	UvName.push_back(name);
 
 	TCoords.push_back(core::array<core::vector2df>());
@@ -693,20 +787,16 @@ void CLWOMeshFileLoader::readVertexMapping(uint32_t size)
 	core::array<uint32_t>& UvPointsArray=UvIndex.back();
 	UvPointsArray.reallocate(Points.size());
 
-	uint32_t index;
 	core::vector2df tcoord;
-	while (size)
+	while (end-data>=10)
 	{
-		size -= readVX(index);
-		File->read(&tcoord.X, 4);
-		File->read(&tcoord.Y, 4);
-		size -= 8;
-		index=os::Byteswap::byteswap(index);
-		tcoord.X=os::Byteswap::byteswap(tcoord.X);
-		tcoord.Y=os::Byteswap::byteswap(tcoord.Y);
-
+		const uint32_t point = parseVX(data, end);
+		if (end-data<8)
+			break;
+		UvPointsArray.push_back(point);
+		tcoord.X=parseF32(data);
+		tcoord.Y=parseF32(data);
 		UvCoords.push_back(tcoord);
-		UvPointsArray.push_back(index);
 	}
 #ifdef LWO_READER_DEBUG
 	os::Printer::log("LWO loader: UvCoords", core::stringc(UvCoords.size()));
@@ -714,28 +804,24 @@ void CLWOMeshFileLoader::readVertexMapping(uint32_t size)
 }
 
 
-void CLWOMeshFileLoader::readDiscVertexMapping(uint32_t size)
+void CLWOMeshFileLoader::readDiscVertexMapping(const uint8_t* data, uint32_t size)
 {
+	if (size<6)
+		return;
+	const uint8_t* const end = data+size;
 	char type[5]={0};
-	uint16_t dimension;
-	core::stringc name;
-	File->read(&type, 4);
+	memcpy(type, data, 4);
 #ifdef LWO_READER_DEBUG
 	os::Printer::log("LWO loader: Discontinuous vertex map type", type);
 #endif
-	File->read(&dimension,2);
-	dimension=os::Byteswap::byteswap(dimension);
-
-	size -= 6;
-	size -= readString(name);
+	data += 6; // type and dimension
+	core::stringc name;
+	data += parseString(name, data, end);
 #ifdef LWO_READER_DEBUG
 	os::Printer::log("LWO loader: Discontinuous vertex map", name.c_str());
 #endif
 	if (strncmp(type, "TXUV", 4))
-	{
-		File->seek(size, true);
 		return;
-	}
 	DUvName.push_back(name);
 	VmPolyPointsIndex.push_back(core::array<uint32_t>());
 	core::array<uint32_t>& VmPolyPoints=VmPolyPointsIndex.back();
@@ -743,20 +829,15 @@ void CLWOMeshFileLoader::readDiscVertexMapping(uint32_t size)
 	VmCoordsIndex.push_back(core::array<core::vector2df>());
 	core::array<core::vector2df>& VmCoords=VmCoordsIndex.back();
 
-	uint32_t vmpolys;
-	uint32_t vmpoints;
 	core::vector2df vmcoords;
-	while (size)
+	while (end-data>=12)
 	{
-		size-=readVX(vmpoints);
-		size-=readVX(vmpolys);
-		File->read(&vmcoords.X, 4);
-		File->read(&vmcoords.Y, 4);
-		size -= 8;
-		vmpoints=os::Byteswap::byteswap(vmpoints);
-		vmpolys=os::Byteswap::byteswap(vmpolys);
-		vmcoords.X=os::Byteswap::byteswap(vmcoords.X);
-		vmcoords.Y=os::Byteswap::byteswap(vmcoords.Y);
+		const uint32_t vmpoints = parseVX(data, end);
+		const uint32_t vmpolys = parseVX(data, end);
+		if (end-data<8)
+			break;
+		vmcoords.X=parseF32(data);
+		vmcoords.Y=parseF32(data);
 
 		VmCoords.push_back(vmcoords);
 		VmPolyPoints.push_back(vmpolys);
@@ -768,64 +849,46 @@ void CLWOMeshFileLoader::readDiscVertexMapping(uint32_t size)
 }
 
 
-void CLWOMeshFileLoader::readTagMapping(uint32_t size)
+void CLWOMeshFileLoader::readTagMapping(const uint8_t* data, uint32_t size)
 {
-	char type[5];
-	type[4]=0;
-	File->read(&type, 4);
-	size -= 4;
-	if ((strncmp(type, "SURF", 4))||(Indices.size()==0))
-	{
-		File->seek(size, true);
+	if (size<4 || strncmp(reinterpret_cast<const char*>(data), "SURF", 4) || Indices.size()==0)
 		return;
-	}
 
-	while (size!=0)
+	const uint8_t* const end = data+size;
+	data += 4;
+	while (end-data>=4)
 	{
-		uint16_t tag;
-		uint32_t polyIndex;
-		size-=readVX(polyIndex);
-		File->read(&tag, 2);
-		tag=os::Byteswap::byteswap(tag);
+		const uint32_t polyIndex = parseVX(data, end);
+		if (end-data<2)
+			break;
+		const uint16_t tag = parseU16(data);
+		if (polyIndex>=MaterialMapping.size() || tag>=Materials.size())
+			continue;
 
-		size -= 2;
 		MaterialMapping[polyIndex]=tag;
 		Materials[tag]->TagType=1;
 	}
 }
 
 
-void CLWOMeshFileLoader::readObj2(uint32_t size)
+void CLWOMeshFileLoader::readObj2(const uint8_t* data, uint32_t size)
 {
-	char type[5];
-	type[4]=0;
-	File->read(&type, 4);
-	size -= 4;
 	Indices.clear();
-	if (strncmp(type, "FACE", 4)) // also possible are splines, subdivision patches, metaballs, and bones
-	{
-		File->seek(size, true);
+	if (size<4 || strncmp(reinterpret_cast<const char*>(data), "FACE", 4)) // also possible are splines, subdivision patches, metaballs, and bones
 		return;
-	}
-	uint16_t numVerts=0;
-	while (size!=0)
-	{
-		File->read(&numVerts, 2);
-		numVerts=os::Byteswap::byteswap(numVerts);
 
+	const uint8_t* const end = data+size;
+	data += 4;
+	while (end-data>=2)
+	{
 		// mask out flags
-		numVerts &= 0x03FF;
+		const uint16_t numVerts = parseU16(data) & 0x03FF;
 
-		size -= 2;
 		Indices.push_back(core::array<uint32_t>());
-		uint32_t vertIndex;
 		core::array<uint32_t>& polyArray = Indices.back();
 		polyArray.reallocate(numVerts);
-		for (uint16_t i=0; i<numVerts; ++i)
-		{
-			size -= readVX(vertIndex);
-			polyArray.push_back(vertIndex);
-		}
+		for (uint16_t i=0; i<numVerts && end-data>=2; ++i)
+			polyArray.push_back(parseVX(data, end));
 	}
 	MaterialMapping.reallocate(Indices.size());
 	for (uint32_t j=0; j<Indices.size(); ++j)
@@ -52,11 +52,14 @@ private:
 
 	bool readFileHeader();
 	bool readChunks();
-	void readObj1(uint32_t size);
-	void readTagMapping(uint32_t size);
-	void readVertexMapping(uint32_t size);
-	void readDiscVertexMapping (uint32_t size);
-	void readObj2(uint32_t size);
+	//! Whole chunk starting at the current position, from the mapped file or read into `ChunkBuffer` in one call, nullptr if the file is too short
+	const uint8_t* readChunk(uint32_t size);
+	// the geometry chunks get parsed from memory
+	void readObj1(const uint8_t* data, uint32_t size);
+	void readTagMapping(const uint8_t* data, uint32_t size);
+	void readVertexMapping(const uint8_t* data, uint32_t size);
+	void readDiscVertexMapping(const uint8_t* data, uint32_t size);
+	void readObj2(const uint8_t* data, uint32_t size);
 	void readMat(uint32_t size);
 	uint32_t readString(core::stringc& name, uint32_t size=0);
 	uint32_t readVec(core::vector3df& vec);
@@ -81,6 +84,7 @@ private:
 	core::array<core::array<core::vector2df> > TCoords;
 	core::array<tLWOMaterial*> Materials;
 	core::array<core::stringc> Images;
+	core::vector<uint8_t> ChunkBuffer;
 	uint8_t FormatVersion;
 };
 
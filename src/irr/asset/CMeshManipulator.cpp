@@ -24,10 +24,10 @@ namespace asset
 {
 
 // declared as extern in SVertexManipulator.h
-core::vector<QuantizationCacheEntry2_10_10_10> normalCacheFor2_10_10_10Quant;
-core::vector<QuantizationCacheEntry8_8_8> normalCacheFor8_8_8Quant;
-core::vector<QuantizationCacheEntry16_16_16> normalCacheFor16_16_16Quant;
-core::vector<QuantizationCacheEntryHalfFloat> normalCacheForHalfFloatQuant;
+CNormalQuantizationCache<QuantizationCacheEntry2_10_10_10> normalCacheFor2_10_10_10Quant;
+CNormalQuantizationCache<QuantizationCacheEntry8_8_8> normalCacheFor8_8_8Quant;
+CNormalQuantizationCache<QuantizationCacheEntry16_16_16> normalCacheFor16_16_16Quant;
+CNormalQuantizationCache<QuantizationCacheEntryHalfFloat> normalCacheForHalfFloatQuant;
 
 
 //! Flips the direction of surfaces. Changes backfacing triangles to frontfacing
@@ -137,6 +137,7 @@ void IMeshManipulator::flipSurfaces(ICPUMeshBuffer* inbuffer)
 
 core::smart_refctd_ptr<ICPUMeshBuffer> CMeshManipulator::createMeshBufferFetchOptimized(const ICPUMeshBuffer* _inbuffer)
 {
+	IRR_PROFILE_SCOPE("CMeshManipulator::createMeshBufferFetchOptimized");
 	if (!_inbuffer || !_inbuffer->getMeshDataAndFormat() || !_inbuffer->getIndices())
 		return NULL;
 
@@ -245,6 +246,7 @@ core::smart_refctd_ptr<ICPUMeshBuffer> CMeshManipulator::createMeshBufferFetchOp
 //! Creates a copy of the mesh, which will only consist of unique primitives
 core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferUniquePrimitives(ICPUMeshBuffer* inbuffer, bool _makeIndexBuf)
 {
+	IRR_PROFILE_SCOPE("IMeshManipulator::createMeshBufferUniquePrimitives");
 	if (!inbuffer)
 		return 0;
     IMeshDataFormatDesc<ICPUBuffer>* oldDesc = inbuffer->getMeshDataAndFormat();
@@ -353,6 +355,7 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferUniqueP
 //
 core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::calculateSmoothNormals(ICPUMeshBuffer* inbuffer, bool makeNewMesh, float epsilon, E_VERTEX_ATTRIBUTE_ID normalAttrID, VxCmpFunction vxcmp)
 {
+	IRR_PROFILE_SCOPE("IMeshManipulator::calculateSmoothNormals");
 	if (inbuffer == nullptr)
 	{
 		_IRR_DEBUG_BREAK_IF(true);
@@ -417,6 +420,7 @@ static bool cmpVertices(ICPUMeshBuffer* _inbuf, const void* _va, const void* _vb
 //! Creates a copy of a mesh, which will have identical vertices welded together
 core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferWelded(ICPUMeshBuffer *inbuffer, const SErrorMetric* _errMetrics, const bool& optimIndexType, const bool& makeNewMesh)
 {
+    IRR_PROFILE_SCOPE("IMeshManipulator::createMeshBufferWelded");
     if (!inbuffer)
         return nullptr;
     IMeshDataFormatDesc<ICPUBuffer>* oldDesc = inbuffer->getMeshDataAndFormat();
@@ -558,6 +562,7 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferWelded(
 
 core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createOptimizedMeshBuffer(const ICPUMeshBuffer* _inbuffer, const SErrorMetric* _errMetric)
 {
+	IRR_PROFILE_SCOPE("IMeshManipulator::createOptimizedMeshBuffer");
 	if (!_inbuffer)
 		return nullptr;
 	auto outbuffer = createMeshBufferDuplicate(_inbuffer);
@@ -730,6 +735,7 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createOptimizedMeshBuff
 
 void IMeshManipulator::requantizeMeshBuffer(ICPUMeshBuffer* _meshbuffer, const SErrorMetric* _errMetric)
 {
+	IRR_PROFILE_SCOPE("IMeshManipulator::requantizeMeshBuffer");
 	CMeshManipulator::SAttrib newAttribs[EVAI_COUNT];
 	for (size_t i = 0u; i < EVAI_COUNT; ++i)
 		newAttribs[i].vaid = (E_VERTEX_ATTRIBUTE_ID)i;
@@ -860,6 +866,7 @@ void CMeshManipulator::copyMeshBufferMemberVars<ICPUSkinnedMeshBuffer>(ICPUSkinn
 
 core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferDuplicate(const ICPUMeshBuffer* _src)
 {
+	IRR_PROFILE_SCOPE("IMeshManipulator::createMeshBufferDuplicate");
 	if (!_src)
 		return nullptr;
 
@@ -923,6 +930,7 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferDuplica
 
 void IMeshManipulator::filterInvalidTriangles(ICPUMeshBuffer* _input)
 {
+    IRR_PROFILE_SCOPE("IMeshManipulator::filterInvalidTriangles");
     if (!_input || !_input->getMeshDataAndFormat() || !_input->getIndices())
         return;
 
@@ -68,6 +68,7 @@ COBJMeshFileLoader::~COBJMeshFileLoader()
 
 asset::SAssetBundle COBJMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
+    IRR_PROFILE_SCOPE("COBJMeshFileLoader::loadAsset");
     SContext ctx(
         asset::IAssetLoader::SAssetLoadContext{
             _params,
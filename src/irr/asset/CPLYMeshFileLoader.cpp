@@ -66,6 +66,7 @@ bool CPLYMeshFileLoader::isALoadableFileFormat(io::IReadFile* _file) const
 //! creates/loads an animated mesh from the file.
 asset::SAssetBundle CPLYMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
+	IRR_PROFILE_SCOPE("CPLYMeshFileLoader::loadAsset");
 	if (!_file)
 		return {};
 
@@ -12,156 +12,341 @@
 #include "IReadFile.h"
 #include "os.h"
 
-#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <string>
 
 namespace irr
 {
 	namespace asset
 	{
 
-		asset::SAssetBundle CSTLMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+		namespace
 		{
-			const long filesize = _file->getSize();
-			if (filesize < 6) // we need a header
-				return {};
+			//! 50 bytes per triangle: normal, 3 vertices and the attribute word
+			constexpr size_t BinaryTriangleSize = 12u*sizeof(float)+sizeof(uint16_t);
+			constexpr size_t BinaryHeaderSize = 84u;
 
-			bool hasColor = false;
+			struct SToken
+			{
+				const char* ptr;
+				size_t length;
 
-			auto mesh = core::make_smart_refctd_ptr<asset::CCPUMesh>();
-			auto meshbuffer = core::make_smart_refctd_ptr<asset::ICPUMeshBuffer>();
-			auto desc = core::make_smart_refctd_ptr<asset::ICPUMeshDataFormatDesc>();
+				inline bool operator==(const char* keyword) const
+				{
+					return strncmp(ptr,keyword,length)==0 && keyword[length]==0;
+				}
+				inline bool operator!=(const char* keyword) const { return !operator==(keyword); }
+			};
 
-			meshbuffer->setNormalnAttributeIx(EVAI_ATTR3);
+			//! Reads the file in big blocks and hands out whitespace separated tokens pointing into the block
+			class CBufferedTokenizer
+			{
+				public:
+					_IRR_STATIC_INLINE_CONSTEXPR size_t BufferSize = 0x1u<<20u;
+					//! longer tokens get split, nothing valid in an ASCII STL comes close
+					_IRR_STATIC_INLINE_CONSTEXPR size_t MaxTokenLength = 0x1u<<10u;
 
-			bool binary = false;
-			core::stringc token;
-			if (getNextToken(_file, token) != "solid")
-				binary = hasColor = true;
+					CBufferedTokenizer(io::IReadFile* _file) : file(_file), buffer(BufferSize), eof(false)
+					{
+						cursor = end = buffer.data();
+					}
 
-			core::vector<core::vectorSIMDf> positions, normals;
-			core::vector<uint32_t> colors;
-			if (binary)
-			{
-				if (_file->getSize() < 80)
-					return {};
-
-				_file->seek(80); // skip header
-				uint32_t vtxCnt = 0u;
-				_file->read(&vtxCnt, 4);
-				positions.reserve(3 * vtxCnt);
-				normals.reserve(vtxCnt);
-				colors.reserve(vtxCnt);
-			}
-			else
-				goNextLine(_file); // skip header
+					//! returns a zero length token at the end of the file
+					SToken next()
+					{
+						for (;;)
+						{
+							while (cursor<end && core::isspace(*cursor))
+								cursor++;
+							if (cursor<end)
+								break;
+							if (!refill())
+								return {cursor,0u};
+						}
+						// make sure the whole token is in the buffer before pointing into it
+						if (size_t(end-cursor)<MaxTokenLength)
+							refill();
+
+						const char* begin = cursor;
+						const char* limit = core::min(end,begin+MaxTokenLength);
+						while (cursor<limit && !core::isspace(*cursor))
+							cursor++;
+						return {begin,size_t(cursor-begin)};
+					}
+
+					//! skips until the next line break
+					void skipLine()
+					{
+						for (;;)
+						{
+							while (cursor<end && *cursor!='\n' && *cursor!='\r')
+								cursor++;
+							if (cursor<end || !refill())
+								return;
+						}
+					}
 
+				private:
+					//! moves the unread bytes to the front and fills up the rest, returns false if nothing more could be read
+					bool refill()
+					{
+						if (eof)
+							return false;
+
+						const size_t remaining = end-cursor;
+						memmove(buffer.data(),cursor,remaining);
+						cursor = buffer.data();
+						const int32_t readBytes = file->read(buffer.data()+remaining,static_cast<uint32_t>(BufferSize-remaining));
+						end = cursor+remaining+core::max(readBytes,0);
+						eof = readBytes<=0;
+						return !eof;
+					}
 
-			uint16_t attrib = 0u;
-			token.reserve(32);
-			while (_file->getPos() < filesize)
+					io::IReadFile* file;
+					core::vector<char> buffer;
+					const char* cursor;
+					const char* end;
+					bool eof;
+			};
+
+			//! Parses a whole token as a float, returns false if it isn't one
+			/** Plain decimal notation with up to 19 significant digits (what every exporter writes) is assembled in integers
+			and scaled by an exact power of ten, which rounds the same as `strtod` in all but pathological cases.
+			Everything else (hex floats, inf, nan, overlong mantissas) goes through `strtod`. */
+			bool parseFloat(const SToken& token, float& out)
 			{
-				if (!binary)
+				static const double PowersOf10[] = {
+					1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+					1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22
+				};
+				constexpr int32_t MaxExactPower = sizeof(PowersOf10)/sizeof(double)-1;
+
+				auto fallback = [&token,&out]() -> bool
+				{
+					const std::string tmp(token.ptr,token.length);
+					char* parsedEnd = nullptr;
+					out = static_cast<float>(strtod(tmp.c_str(),&parsedEnd));
+					return tmp.size() && parsedEnd==tmp.c_str()+tmp.size();
+				};
+
+				const char* p = token.ptr;
+				const char* const end = token.ptr+token.length;
+				const bool negative = p<end && *p=='-';
+				if (p<end && (*p=='-'||*p=='+'))
+					p++;
+
+				uint64_t mantissa = 0ull;
+				int32_t exponent = 0;
+				uint32_t significantDigits = 0u;
+				bool anyDigits = false;
+				for (; p<end && *p>='0' && *p<='9'; p++)
 				{
-					if (getNextToken(_file, token) != "facet")
+					anyDigits = true;
+					if (significantDigits<19u)
 					{
-						if (token == "endsolid")
-							break;
-						return {};
+						mantissa = mantissa*10ull+uint64_t(*p-'0');
+						significantDigits += mantissa ? 1u:0u;
 					}
-					if (getNextToken(_file, token) != "normal")
+					else
+						return fallback();
+				}
+				if (p<end && *p=='.')
+				{
+					for (p++; p<end && *p>='0' && *p<='9'; p++)
 					{
-						return {};
+						anyDigits = true;
+						if (significantDigits<19u)
+						{
+							mantissa = mantissa*10ull+uint64_t(*p-'0');
+							significantDigits += mantissa ? 1u:0u;
+							exponent--;
+						}
+						// further fractional digits are below the precision of a float anyway
 					}
 				}
-
+				if (!anyDigits)
+					return fallback();
+				if (p<end && (*p=='e'||*p=='E'))
 				{
-					core::vectorSIMDf n;
-					getNextVector(_file, n, binary);
-					if(_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
-						performActionBasedOnOrientationSystem<float>(n.x, [](float& varToFlip) {varToFlip = -varToFlip;});
-					normals.push_back(core::normalize(n));
+					p++;
+					const bool negativeExponent = p<end && *p=='-';
+					if (p<end && (*p=='-'||*p=='+'))
+						p++;
+					if (p==end)
+						return fallback();
+					int32_t explicitExponent = 0;
+					for (; p<end && *p>='0' && *p<='9'; p++)
+						explicitExponent = core::min(explicitExponent*10+(*p-'0'),9999);
+					exponent += negativeExponent ? -explicitExponent:explicitExponent;
 				}
+				if (p!=end)
+					return fallback();
 
-				if (!binary)
+				double value = static_cast<double>(mantissa);
+				if (mantissa)
 				{
-					if (getNextToken(_file, token) != "outer" || getNextToken(_file, token) != "loop")
-						return {};
+					if (exponent<-MaxExactPower || exponent>MaxExactPower)
+						value *= std::pow(10.0,exponent);
+					else if (exponent<0)
+						value /= PowersOf10[-exponent];
+					else
+						value *= PowersOf10[exponent];
 				}
+				out = static_cast<float>(negative ? -value:value);
+				return true;
+			}
+
+			//! hashes the raw bits of an interleaved vertex
+			struct SVertexHash
+			{
+				size_t vertexSize;
 
+				inline size_t operator()(const uint8_t* vertex) const
 				{
-					core::vectorSIMDf p[3];
-					for (uint32_t i = 0u; i < 3u; ++i)
+					uint64_t hash = 0xcbf29ce484222325ull;
+					for (size_t i=0u; i<vertexSize; i+=sizeof(uint32_t))
 					{
-						if (!binary)
-						{
-							if (getNextToken(_file, token) != "vertex")
-								return {};
-						}
-						getNextVector(_file, p[i], binary);
-						if (_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
-							performActionBasedOnOrientationSystem<float>(p[i].x, [](float& varToFlip){varToFlip = -varToFlip; });
+						uint32_t word;
+						memcpy(&word,vertex+i,sizeof(uint32_t));
+						hash = (hash^word)*0x100000001b3ull;
 					}
-					for (uint32_t i = 0u; i < 3u; ++i) // seems like in STL format vertices are ordered in clockwise manner...
-						positions.push_back(p[2u - i]);
+					return static_cast<size_t>(hash^(hash>>32u));
 				}
+			};
+			struct SVertexEqual
+			{
+				size_t vertexSize;
 
-				if (!binary)
+				inline bool operator()(const uint8_t* a, const uint8_t* b) const
 				{
-					if (getNextToken(_file, token) != "endloop" || getNextToken(_file, token) != "endfacet")
-						return {};
-				}
-				else
-				{
-					_file->read(&attrib, 2);
+					return memcmp(a,b,vertexSize)==0;
 				}
+			};
+		}
 
-				if (hasColor && (attrib & 0x8000)) // assuming VisCam/SolidView non-standard trick to store color in 2 bytes of extra attribute
+
+		asset::SAssetBundle CSTLMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+		{
+			IRR_PROFILE_SCOPE("CSTLMeshFileLoader::loadAsset");
+			const size_t filesize = _file->getSize();
+			if (filesize < 6u) // we need a header
+				return {};
+
+			char header[6];
+			_file->seek(0u);
+			_file->read(header, 6u);
+			// some exporters start binary headers with "solid" too, but then the size gives it away
+			bool binary = strncmp(header, "solid", 5u) != 0;
+			if (!binary && filesize >= BinaryHeaderSize)
+			{
+				uint32_t triCnt = 0u;
+				_file->seek(80u);
+				_file->read(&triCnt, 4u);
+				binary = filesize == BinaryHeaderSize + BinaryTriangleSize * triCnt;
+			}
+
+			SParsedTriangles triangles;
+			_file->seek(0u);
+			if (!(binary ? readBinary(_file, triangles) : readASCII(_file, triangles)))
+				return {};
+
+			const size_t triangleCount = triangles.normals.size();
+			if (triangleCount == 0u)
+				return {};
+			const bool hasColor = triangles.colors.size() == triangleCount;
+
+			// the file is right-handed, every vector had its x flipped for the left-handed default
+			const bool flipX = !(_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES);
+			size_t vertexCount = 3u * triangleCount;
+			const size_t vtxSize = hasColor ? (3 * sizeof(float) + 4 + 4) : (3 * sizeof(float) + 4);
+			core::vector<uint8_t> vertices(vtxSize * vertexCount);
+			for (size_t t = 0u; t < triangleCount; ++t)
+			{
+				float* p = triangles.positions.data() + 9u * t;
+				if (flipX)
 				{
-					colors.push_back(video::A1R5G5B5toA8R8G8B8(attrib));
+					p[0] = -p[0];
+					p[3] = -p[3];
+					p[6] = -p[6];
 				}
+
+				core::vectorSIMDf n = triangles.normals[t];
+				if (flipX)
+					n.x = -n.x;
+				if ((n == core::vectorSIMDf()).all())
+					n = core::plane3dSIMDf(core::vectorSIMDf(p[0], p[1], p[2]), core::vectorSIMDf(p[3], p[4], p[5]), core::vectorSIMDf(p[6], p[7], p[8])).getNormal();
 				else
-				{
-					hasColor = false;
-					colors.clear();
-				}
+					n = core::normalize(n);
+				const uint32_t normal = asset::quantizeNormal2_10_10_10(n);
 
-				if ((normals.back() == core::vectorSIMDf()).all())
+				for (uint32_t i = 0u; i < 3u; ++i)
 				{
-					normals.back().set(
-						core::plane3dSIMDf(
-							*(positions.rbegin() + 2),
-							*(positions.rbegin() + 1),
-							*(positions.rbegin() + 0)).getNormal()
-					);
+					uint8_t* ptr = vertices.data() + (3u * t + i) * vtxSize;
+					memcpy(ptr, p + 3u * i, 3 * 4);
+					memcpy(ptr + 12, &normal, 4);
+					if (hasColor)
+						memcpy(ptr + 16, triangles.colors.data() + t, 4);
 				}
-			} // end while (_file->getPos() < filesize)
+			}
+			// free the parsed data before the buffers get allocated
+			triangles = SParsedTriangles();
 
-			const size_t vtxSize = hasColor ? (3 * sizeof(float) + 4 + 4) : (3 * sizeof(float) + 4);
+			core::vector<uint32_t> indices;
+			if (_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_WELD_VERTICES)
 			{
-				auto vertexBuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vtxSize * positions.size());
-
-				uint32_t normal{};
-				for (size_t i = 0u; i < positions.size(); ++i)
+				// vertices only merge if every attribute is bit-exact, so the flat shading of STL survives
+				core::unordered_map<const uint8_t*, uint32_t, SVertexHash, SVertexEqual> uniqueVertices(vertexCount / 2u, SVertexHash{ vtxSize }, SVertexEqual{ vtxSize });
+				indices.resize(vertexCount);
+				uint32_t uniqueCount = 0u;
+				for (size_t i = 0u; i < vertexCount; ++i)
 				{
-					if (i % 3 == 0)
-						normal = asset::quantizeNormal2_10_10_10(normals[i / 3]);
-					uint8_t* ptr = ((uint8_t*)(vertexBuf->getPointer())) + i * vtxSize;
-					memcpy(ptr, positions[i].pointer, 3 * 4);
-					((uint32_t*)(ptr + 12))[0] = normal;
-					if (hasColor)
-						memcpy(ptr + 16, colors.data() + i / 3, 4);
+					// compacts in place, the slot written to is never past the vertex being read
+					uint8_t* dst = vertices.data() + uniqueCount * vtxSize;
+					if (dst != vertices.data() + i * vtxSize)
+						memcpy(dst, vertices.data() + i * vtxSize, vtxSize);
+					auto found = uniqueVertices.emplace(dst, uniqueCount);
+					if (found.second)
+						uniqueCount++;
+					indices[i] = found.first->second;
 				}
+				vertexCount = uniqueCount;
+				vertices.resize(vtxSize * vertexCount);
+			}
+
+			auto mesh = core::make_smart_refctd_ptr<asset::CCPUMesh>();
+			auto meshbuffer = core::make_smart_refctd_ptr<asset::ICPUMeshBuffer>();
+			auto desc = core::make_smart_refctd_ptr<asset::ICPUMeshDataFormatDesc>();
+
+			meshbuffer->setNormalnAttributeIx(EVAI_ATTR3);
+			{
+				auto vertexBuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vertices.size());
+				memcpy(vertexBuf->getPointer(), vertices.data(), vertices.size());
 
 				desc->setVertexAttrBuffer(core::smart_refctd_ptr(vertexBuf), asset::EVAI_ATTR0, asset::EF_R32G32B32_SFLOAT, vtxSize, 0);
 				desc->setVertexAttrBuffer(core::smart_refctd_ptr(vertexBuf), asset::EVAI_ATTR3, asset::EF_A2B10G10R10_SNORM_PACK32, vtxSize, 12);
 				if (hasColor)
 					desc->setVertexAttrBuffer(core::smart_refctd_ptr(vertexBuf), asset::EVAI_ATTR1, asset::EF_B8G8R8A8_UNORM, vtxSize, 16);
 			}
+			if (indices.size())
+			{
+				const bool shortIndices = vertexCount <= 0x10000u;
+				auto idxBuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(indices.size() * (shortIndices ? sizeof(uint16_t) : sizeof(uint32_t)));
+				if (shortIndices)
+				{
+					uint16_t* idx = reinterpret_cast<uint16_t*>(idxBuf->getPointer());
+					for (size_t i = 0u; i < indices.size(); ++i)
+						idx[i] = static_cast<uint16_t>(indices[i]);
+				}
+				else
+					memcpy(idxBuf->getPointer(), indices.data(), idxBuf->getSize());
+				desc->setIndexBuffer(std::move(idxBuf));
+				meshbuffer->setIndexType(shortIndices ? asset::EIT_16BIT : asset::EIT_32BIT);
+			}
+			meshbuffer->setIndexCount(3u * triangleCount);
 			meshbuffer->setMeshDataAndFormat(std::move(desc));
 			mesh->addMeshBuffer(std::move(meshbuffer));
 
-			mesh->getMeshBuffer(0)->setIndexCount(positions.size());
-			//mesh->getMeshBuffer(0)->setPrimitiveType(EPT_POINTS);
 			mesh->recalculateBoundingBox(true);
 
 			return SAssetBundle({ std::move(mesh) });
@@ -196,78 +381,105 @@ namespace irr
 			}
 		}
 
-		//! Read 3d vector of floats
-		void CSTLMeshFileLoader::getNextVector(io::IReadFile* file, core::vectorSIMDf& vec, bool binary) const
+		bool CSTLMeshFileLoader::readBinary(io::IReadFile* _file, SParsedTriangles& _out) const
 		{
-			if (binary)
-			{
-				file->read(&vec.X, 4);
-				file->read(&vec.Y, 4);
-				file->read(&vec.Z, 4);
-			}
-			else
-			{
-				goNextWord(file);
-				core::stringc tmp;
-
-				getNextToken(file, tmp);
-				sscanf(tmp.c_str(), "%f", &vec.X);
-				getNextToken(file, tmp);
-				sscanf(tmp.c_str(), "%f", &vec.Y);
-				getNextToken(file, tmp);
-				sscanf(tmp.c_str(), "%f", &vec.Z);
-			}
-			vec.X = -vec.X;
-		}
+			constexpr uint32_t TrianglesPerChunk = 4096u;
 
+			if (_file->getSize() < BinaryHeaderSize)
+				return false;
+			_file->seek(80u); // skip header
+			uint32_t triCnt = 0u;
+			_file->read(&triCnt, 4u);
 
-		//! Read next word
-		const core::stringc& CSTLMeshFileLoader::getNextToken(io::IReadFile* file, core::stringc& token) const
-		{
-			goNextWord(file);
-			uint8_t c;
-			token = "";
-			while (file->getPos() != file->getSize())
+			const size_t available = (_file->getSize() - BinaryHeaderSize) / BinaryTriangleSize;
+			if (triCnt > available)
 			{
-				file->read(&c, 1);
-				// found it, so leave
-				if (core::isspace(c))
-					break;
-				token.append(c);
+				os::Printer::log("STL file is truncated, loading only the complete triangles", _file->getFileName().c_str(), ELL_WARNING);
+				triCnt = static_cast<uint32_t>(available);
 			}
-			return token;
-		}
 
+			_out.positions.resize(9u * triCnt);
+			_out.normals.resize(triCnt);
+			_out.colors.resize(triCnt);
 
-		//! skip to next word
-		void CSTLMeshFileLoader::goNextWord(io::IReadFile* file) const
-		{
-			uint8_t c;
-			while (file->getPos() != file->getSize())
+			// assuming VisCam/SolidView non-standard trick to store color in 2 bytes of extra attribute, only if every triangle has one
+			bool hasColor = true;
+			core::vector<uint8_t> chunk(TrianglesPerChunk * BinaryTriangleSize);
+			for (uint32_t first = 0u; first < triCnt; first += TrianglesPerChunk)
 			{
-				file->read(&c, 1);
-				// found it, so leave
-				if (!core::isspace(c))
+				const uint32_t count = core::min(TrianglesPerChunk, triCnt - first);
+				const int32_t chunkSize = static_cast<int32_t>(count * BinaryTriangleSize);
+				if (_file->read(chunk.data(), chunkSize) != chunkSize)
+					return false;
+
+				for (uint32_t i = 0u; i < count; ++i)
 				{
-					file->seek(-1, true);
-					break;
+					const uint8_t* tri = chunk.data() + i * BinaryTriangleSize;
+					float data[12];
+					memcpy(data, tri, sizeof(data));
+					uint16_t attrib;
+					memcpy(&attrib, tri + sizeof(data), sizeof(attrib));
+
+					const uint32_t t = first + i;
+					_out.normals[t].set(data[0], data[1], data[2]);
+					float* p = _out.positions.data() + 9u * t;
+					for (uint32_t v = 0u; v < 3u; ++v) // seems like in STL format vertices are ordered in clockwise manner...
+						memcpy(p + 3u * v, data + 3u * (3u - v), 3 * sizeof(float));
+
+					hasColor = hasColor && (attrib & 0x8000);
+					_out.colors[t] = video::A1R5G5B5toA8R8G8B8(attrib);
 				}
 			}
-		}
+			if (!hasColor)
+				_out.colors.clear();
 
+			return true;
+		}
 
-		//! Read until line break is reached and stop at the next non-space character
-		void CSTLMeshFileLoader::goNextLine(io::IReadFile* file) const
+		bool CSTLMeshFileLoader::readASCII(io::IReadFile* _file, SParsedTriangles& _out) const
 		{
-			uint8_t c;
-			// look for newline characters
-			while (file->getPos() != file->getSize())
+			CBufferedTokenizer tokenizer(_file);
+			auto readVector = [&tokenizer](float* out) -> bool
 			{
-				file->read(&c, 1);
-				// found it, so leave
-				if (c == '\n' || c == '\r')
+				return parseFloat(tokenizer.next(), out[0]) && parseFloat(tokenizer.next(), out[1]) && parseFloat(tokenizer.next(), out[2]);
+			};
+
+			tokenizer.skipLine(); // skip header
+			for (;;)
+			{
+				SToken token = tokenizer.next();
+				if (token.length == 0u)
 					break;
+				// files concatenated from several solids are common enough
+				if (token == "endsolid" || token == "solid")
+				{
+					tokenizer.skipLine();
+					continue;
+				}
+
+				if (token != "facet" || tokenizer.next() != "normal")
+					return false;
+				float n[3];
+				if (!readVector(n))
+					return false;
+				_out.normals.emplace_back(n[0], n[1], n[2]);
+
+				if (tokenizer.next() != "outer" || tokenizer.next() != "loop")
+					return false;
+				float p[9];
+				for (uint32_t i = 0u; i < 3u; ++i)
+				{
+					if (tokenizer.next() != "vertex" || !readVector(p + 3u * i))
+						return false;
+				}
+				for (uint32_t i = 0u; i < 3u; ++i) // seems like in STL format vertices are ordered in clockwise manner...
+					_out.positions.insert(_out.positions.end(), p + 3u * (2u - i), p + 3u * (3u - i));
+
+				if (tokenizer.next() != "endloop" || tokenizer.next() != "endfacet")
+					return false;
 			}
+
+			return true;
 		}
 
 	} // end namespace scene
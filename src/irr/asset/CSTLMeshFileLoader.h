@@ -28,16 +28,18 @@ public:
 	virtual uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_MESH; }
 
 private:
-
-	// skips to the first non-space character available
-	void goNextWord(io::IReadFile* file) const;
-	// returns the next word
-	const core::stringc& getNextToken(io::IReadFile* file, core::stringc& token) const;
-	// skip to next printable character after the first line break
-	void goNextLine(io::IReadFile* file) const;
-
-	//! Read 3d vector of floats
-	void getNextVector(io::IReadFile* file, core::vectorSIMDf& vec, bool binary) const;
+	//! per vertex positions, per triangle normals and colors, as gathered from the file
+	struct SParsedTriangles
+	{
+		core::vector<float> positions;
+		core::vector<core::vectorSIMDf> normals;
+		core::vector<uint32_t> colors;
+	};
+
+	//! reads the triangles in chunks with a single `read` each, returns false if the file is truncated
+	bool readBinary(io::IReadFile* _file, SParsedTriangles& _out) const;
+	//! buffered tokenizer over the whole file, returns false on a syntax error
+	bool readASCII(io::IReadFile* _file, SParsedTriangles& _out) const;
 
 	template<typename aType>
 	static inline void performActionBasedOnOrientationSystem(aType& varToHandle, void (*performOnCertainOrientation)(aType& varToHandle))
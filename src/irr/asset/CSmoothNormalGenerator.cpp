@@ -10,16 +10,6 @@ namespace irr
 {
 	namespace asset
 	{
-		static inline bool operator<(uint32_t lhs, const IMeshManipulator::SSNGVertexData& rhs)
-		{
-			return lhs < rhs.hash;
-		}
-
-		static inline bool operator<(const IMeshManipulator::SSNGVertexData& lhs, uint32_t rhs)
-		{
-			return lhs.hash < rhs;
-		}
-
 		static inline bool compareVertexPosition(const core::vectorSIMDf& a, const core::vectorSIMDf& b, float epsilon)
 		{
 			const core::vectorSIMDf difference = core::abs(b - a);
@@ -60,8 +50,8 @@ namespace irr
 		{
 			assert((core::isPoT(hashTableMaxSize)));
 
-			vertices.reserve(_vertexCount);
-			buckets.reserve(_hashTableMaxSize + 1);
+			vertices.resize(_vertexCount);
+			buckets.resize(_hashTableMaxSize + 1);
 		}
 
 		uint32_t CSmoothNormalGenerator::VertexHashMap::hash(const IMeshManipulator::SSNGVertexData & vertex) const
@@ -88,126 +78,116 @@ namespace irr
 				(position.z * primeNumber3))& (hashTableMaxSize - 1);
 		}
 
-		void CSmoothNormalGenerator::VertexHashMap::add(IMeshManipulator::SSNGVertexData && vertex)
+		void CSmoothNormalGenerator::VertexHashMap::set(uint32_t index, IMeshManipulator::SSNGVertexData && vertex)
 		{
 			vertex.hash = hash(vertex);
-			vertices.push_back(vertex);
-		}
-
-		CSmoothNormalGenerator::VertexHashMap::BucketBounds CSmoothNormalGenerator::VertexHashMap::getBucketBoundsByHash(uint32_t hash)
-		{
-			if (hash == invalidHash)
-				return { vertices.end(), vertices.end() };
-
-			core::vector<IMeshManipulator::SSNGVertexData>::iterator begin = std::lower_bound(vertices.begin(), vertices.end(), hash);
-			core::vector<IMeshManipulator::SSNGVertexData>::iterator end = std::upper_bound(vertices.begin(), vertices.end(), hash);
-
-			//bucket missing
-			if (begin == vertices.end())
-				return { vertices.end(), vertices.end() };
-
-			//bucket missing
-			if (begin->hash != hash)
-				return { vertices.end(), vertices.end() };
-
-			return { begin, end };
+			vertices[index] = std::move(vertex);
 		}
 
 		void CSmoothNormalGenerator::VertexHashMap::validate()
 		{
-			std::sort(vertices.begin(), vertices.end(), [](IMeshManipulator::SSNGVertexData & a, IMeshManipulator::SSNGVertexData & b) { return a.hash < b.hash; });
-
-			uint16_t prevHash = vertices[0].hash;
-			core::vector<IMeshManipulator::SSNGVertexData>::iterator prevBegin = vertices.begin();
-			buckets.push_back(prevBegin);
-
-			while (true)
-			{
-				core::vector<IMeshManipulator::SSNGVertexData>::iterator next = std::upper_bound(prevBegin, vertices.end(), prevHash);
-				buckets.push_back(next);
-
-				if (next == vertices.end())
-					break;
-
-				prevBegin = next;
-				prevHash = next->hash;
-			}
+			//count vertices of every bucket one slot ahead, so the prefix sum turns the counts into bucket beginnings
+			std::fill(buckets.begin(), buckets.end(), 0u);
+			for (const auto& vertex : vertices)
+				buckets[vertex.hash + 1]++;
+			for (uint32_t i = 1; i <= hashTableMaxSize; i++)
+				buckets[i] += buckets[i - 1];
+
+			//stable, so vertices in a bucket keep the order of the index buffer
+			//the beginnings double as write cursors, afterwards each one holds the beginning of the next bucket
+			core::vector<IMeshManipulator::SSNGVertexData> sorted(vertices.size());
+			for (const auto& vertex : vertices)
+				sorted[buckets[vertex.hash]++] = vertex;
+			vertices.swap(sorted);
+			//shift them back, the last one is the vertex count either way
+			std::copy_backward(buckets.begin(), buckets.end() - 2, buckets.end() - 1);
+			buckets[0] = 0u;
 		}
 
 		CSmoothNormalGenerator::VertexHashMap CSmoothNormalGenerator::setupData(asset::ICPUMeshBuffer * buffer, float epsilon)
 		{
 			const size_t idxCount = buffer->getIndexCount();
 			_IRR_DEBUG_BREAK_IF((idxCount % 3));
+			const uint32_t triangleCount = idxCount / 3;
 
-			VertexHashMap vertices(idxCount, std::min(16u * 1024u, core::roundUpToPoT<unsigned int>(idxCount * 1.0f / 32.0f)), epsilon == 0.0f ? 0.00001f : epsilon * 1.00001f);
-
-			core::vector3df_SIMD faceNormal;
+			//bucket lookups are O(1), so the table can be big enough to keep buckets short
+			VertexHashMap vertices(triangleCount * 3, core::min(0x1u << 22u, core::roundUpToPoT<uint32_t>(core::max<uint32_t>(idxCount / 8u, 2u))), epsilon == 0.0f ? 0.00001f : epsilon * 1.00001f);
 
-			for (uint32_t i = 0; i < idxCount; i += 3)
+			core::CTaskScheduler::getGlobal().parallelFor(0u, triangleCount, 0u, [&](uint32_t triangleBegin, uint32_t triangleEnd)
 			{
-				const uint32_t ix[3]{
-					buffer->getIndexValue(i),
-					buffer->getIndexValue(i + 1),
-					buffer->getIndexValue(i + 2)
-				};
-				//calculate face normal of parent triangle
-				core::vectorSIMDf v1 = buffer->getPosition(ix[0]);
-				core::vectorSIMDf v2 = buffer->getPosition(ix[1]);
-				core::vectorSIMDf v3 = buffer->getPosition(ix[2]);
-
-				faceNormal = core::cross(v2 - v1, v3 - v1);
-				faceNormal = core::normalize(faceNormal);
-
-				//set data for vertices
-				core::vector3df_SIMD angleWages = getAngleWeight(v1, v2, v3);
-
-				vertices.add({ i,		0,	angleWages.x,	v1,		faceNormal });
-				vertices.add({ i + 1,	0,	angleWages.y,	v2,		faceNormal });
-				vertices.add({ i + 2,	0,	angleWages.z,	v3,		faceNormal });
-			}
+				for (uint32_t i = triangleBegin * 3; i < triangleEnd * 3; i += 3)
+				{
+					const uint32_t ix[3]{
+						buffer->getIndexValue(i),
+						buffer->getIndexValue(i + 1),
+						buffer->getIndexValue(i + 2)
+					};
+					//calculate face normal of parent triangle
+					core::vectorSIMDf v1 = buffer->getPosition(ix[0]);
+					core::vectorSIMDf v2 = buffer->getPosition(ix[1]);
+					core::vectorSIMDf v3 = buffer->getPosition(ix[2]);
+
+					core::vector3df_SIMD faceNormal = core::cross(v2 - v1, v3 - v1);
+					faceNormal = core::normalize(faceNormal);
+
+					//set data for vertices
+					core::vector3df_SIMD angleWages = getAngleWeight(v1, v2, v3);
+
+					vertices.set(i,		{ i,		0,	angleWages.x,	v1,		faceNormal });
+					vertices.set(i + 1,	{ i + 1,	0,	angleWages.y,	v2,		faceNormal });
+					vertices.set(i + 2,	{ i + 2,	0,	angleWages.z,	v3,		faceNormal });
+				}
+			});
 
 			vertices.validate();
 
 			return vertices;
 		}
 
-		void CSmoothNormalGenerator::processConnectedVertices(asset::ICPUMeshBuffer * buffer, VertexHashMap & vertexHashMap, float epsilon, asset::E_VERTEX_ATTRIBUTE_ID normalAttrID, IMeshManipulator::VxCmpFunction vxcmp)
+		void CSmoothNormalGenerator::processConnectedVertices(asset::ICPUMeshBuffer * buffer, const VertexHashMap & vertexHashMap, float epsilon, asset::E_VERTEX_ATTRIBUTE_ID normalAttrID, IMeshManipulator::VxCmpFunction vxcmp)
 		{
-			for (uint32_t cell = 0; cell < vertexHashMap.getBucketCount() - 1; cell++)
-			{
-				VertexHashMap::BucketBounds processedBucket = vertexHashMap.getBucketBoundsById(cell);
+			const IMeshManipulator::SSNGVertexData* const sortedVertices = vertexHashMap.getVertices();
+			core::vector<core::vectorSIMDf> normals(vertexHashMap.getVertexCount());
 
-				for (core::vector<IMeshManipulator::SSNGVertexData>::iterator processedVertex = processedBucket.begin; processedVertex != processedBucket.end; processedVertex++)
+			//cells only read the vertex data, so they can be processed in parallel
+			core::CTaskScheduler::getGlobal().parallelFor(0u, vertexHashMap.getBucketCount(), 0u, [&](uint32_t cellBegin, uint32_t cellEnd)
+			{
+				for (uint32_t cell = cellBegin; cell < cellEnd; cell++)
 				{
-					std::array<uint32_t, 8> neighboringCells = vertexHashMap.getNeighboringCellHashes(*processedVertex);
-					core::vector3df_SIMD normal = processedVertex->parentTriangleFaceNormal * processedVertex->wage;
+					VertexHashMap::BucketBounds processedBucket = vertexHashMap.getBucketBoundsById(cell);
 
-					//iterate among all neighboring cells
-					for (int i = 0; i < 8; i++)
+					for (const IMeshManipulator::SSNGVertexData* processedVertex = processedBucket.begin; processedVertex != processedBucket.end; processedVertex++)
 					{
-						VertexHashMap::BucketBounds bounds = vertexHashMap.getBucketBoundsByHash(neighboringCells[i]);
-						for (; bounds.begin != bounds.end; bounds.begin++)
+						std::array<uint32_t, 8> neighboringCells = vertexHashMap.getNeighboringCellHashes(*processedVertex);
+						core::vector3df_SIMD normal = processedVertex->parentTriangleFaceNormal * processedVertex->wage;
+
+						//iterate among all neighboring cells
+						for (int i = 0; i < 8; i++)
 						{
-							if (processedVertex != bounds.begin)
-								if (compareVertexPosition(processedVertex->position, bounds.begin->position, epsilon) &&
-									vxcmp(*processedVertex, *bounds.begin, buffer))
-								{
-									//TODO: better mean calculation algorithm
-									normal += bounds.begin->parentTriangleFaceNormal * bounds.begin->wage;
-								}
+							VertexHashMap::BucketBounds bounds = vertexHashMap.getBucketBoundsByHash(neighboringCells[i]);
+							for (; bounds.begin != bounds.end; bounds.begin++)
+							{
+								if (processedVertex != bounds.begin)
+									if (compareVertexPosition(processedVertex->position, bounds.begin->position, epsilon) &&
+										vxcmp(*processedVertex, *bounds.begin, buffer))
+									{
+										//TODO: better mean calculation algorithm
+										normal += bounds.begin->parentTriangleFaceNormal * bounds.begin->wage;
+									}
+							}
 						}
-					}
-
 
-					normal = core::normalize(core::vectorSIMDf(normal));
-					buffer->setAttribute(normal, normalAttrID, buffer->getIndexValue(processedVertex->indexOffset));
+						normals[processedVertex - sortedVertices] = core::normalize(core::vectorSIMDf(normal));
+					}
 				}
-			}
-
+			});
 
+			//vertices shared by triangles can get several normals, writing them in order keeps the last one like before
+			for (uint32_t i = 0; i < normals.size(); i++)
+				buffer->setAttribute(normals[i], normalAttrID, buffer->getIndexValue(sortedVertices[i].indexOffset));
 		}
 
-		std::array<uint32_t, 8> CSmoothNormalGenerator::VertexHashMap::getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData & vertex)
+		std::array<uint32_t, 8> CSmoothNormalGenerator::VertexHashMap::getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData & vertex) const
 		{
 			std::array<uint32_t, 8> neighbourhood;
 
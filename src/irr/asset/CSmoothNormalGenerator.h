@@ -26,32 +26,39 @@ private:
 	public:
 		struct BucketBounds
 		{
-			core::vector<IMeshManipulator::SSNGVertexData>::iterator begin;
-			core::vector<IMeshManipulator::SSNGVertexData>::iterator end;
+			const IMeshManipulator::SSNGVertexData* begin;
+			const IMeshManipulator::SSNGVertexData* end;
 		};
 
 	public:
 		VertexHashMap(size_t _vertexCount, uint32_t _hashTableMaxSize, float _cellSize);
 
-		//inserts vertex into hash table
-		void add(IMeshManipulator::SSNGVertexData&& vertex);
+		//sets vertex at given index of the unsorted vertex array, safe to call from many threads for different indices
+		void set(uint32_t index, IMeshManipulator::SSNGVertexData&& vertex);
 
-		//sorts hashtable and sets iterators at beginnings of bucktes
+		//counting sorts vertices by hash and computes beginnings of buckets
 		void validate();
 
 		//
-		std::array<uint32_t, 8> getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData& vertex);
+		std::array<uint32_t, 8> getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData& vertex) const;
 
-		inline uint32_t getBucketCount() const { return buckets.size(); }
-		inline BucketBounds getBucketBoundsById(uint32_t index) { return { buckets[index], buckets[index + 1] }; }
-		BucketBounds getBucketBoundsByHash(uint32_t hash);
+		inline uint32_t getBucketCount() const { return hashTableMaxSize; }
+		inline uint32_t getVertexCount() const { return vertices.size(); }
+		inline const IMeshManipulator::SSNGVertexData* getVertices() const { return vertices.data(); }
+		inline BucketBounds getBucketBoundsById(uint32_t index) const { return { vertices.data() + buckets[index], vertices.data() + buckets[index + 1] }; }
+		inline BucketBounds getBucketBoundsByHash(uint32_t hash) const
+		{
+			if (hash == invalidHash)
+				return { nullptr, nullptr };
+			return getBucketBoundsById(hash);
+		}
 
 	private:
 		static constexpr uint32_t invalidHash = 0xFFFFFFFF;
 
 	private:
-		//holds iterators pointing to beginning of each bucket, last iterator points to vertices.end()
-		core::vector<core::vector<IMeshManipulator::SSNGVertexData>::iterator> buckets;
+		//offsets of beginnings of buckets in sorted vertices, last one is vertex count
+		core::vector<uint32_t> buckets;
 		core::vector<IMeshManipulator::SSNGVertexData> vertices;
 		const uint32_t hashTableMaxSize;
 		const float cellSize;
@@ -64,7 +71,7 @@ private:
 
 private:
 	static VertexHashMap setupData(asset::ICPUMeshBuffer* buffer, float epsilon);
-	static void processConnectedVertices(asset::ICPUMeshBuffer* buffer, VertexHashMap& vertices, float epsilon, asset::E_VERTEX_ATTRIBUTE_ID normalAttrID, IMeshManipulator::VxCmpFunction vxcmp);
+	static void processConnectedVertices(asset::ICPUMeshBuffer* buffer, const VertexHashMap& vertices, float epsilon, asset::E_VERTEX_ATTRIBUTE_ID normalAttrID, IMeshManipulator::VxCmpFunction vxcmp);
 
 };
 
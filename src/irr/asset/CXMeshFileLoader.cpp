@@ -76,6 +76,7 @@ bool CXMeshFileLoader::isALoadableFileFormat(io::IReadFile* _file) const
 
 asset::SAssetBundle CXMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
+	IRR_PROFILE_SCOPE("CXMeshFileLoader::loadAsset");
 //#ifdef _XREADER_DEBUG
 	auto time = std::chrono::high_resolution_clock::now();
 //#endif
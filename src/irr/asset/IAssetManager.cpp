@@ -55,6 +55,10 @@
 #include "irr/asset/CImageWriterTGA.h"
 #endif
 
+#ifdef _IRR_COMPILE_WITH_DDS_WRITER_
+#include "irr/asset/CImageWriterDDS.h"
+#endif
+
 #ifdef _IRR_COMPILE_WITH_JPG_WRITER_
 #include "irr/asset/CImageWriterJPG.h"
 #endif
@@ -133,6 +137,9 @@ void IAssetManager::addLoadersAndWriters()
 #ifdef _IRR_COMPILE_WITH_TGA_WRITER_
 	addAssetWriter(core::make_smart_refctd_ptr<asset::CImageWriterTGA>());
 #endif
+#ifdef _IRR_COMPILE_WITH_DDS_WRITER_
+	addAssetWriter(core::make_smart_refctd_ptr<asset::CImageWriterDDS>());
+#endif
 #ifdef _IRR_COMPILE_WITH_JPG_WRITER_
 	addAssetWriter(core::make_smart_refctd_ptr<asset::CImageWriterJPG>());
 #endif
@@ -132,8 +132,13 @@ FinalBoneHierarchyBlobV3::FinalBoneHierarchyBlobV3(const CFinalBoneHierarchy* _f
 	memcpy(ptr + calcBonesOffset(_fbh), _fbh->getBoneData(), calcBonesByteSize(_fbh));
 	memcpy(ptr + calcLevelsOffset(_fbh), _fbh->getBoneTreeLevelEnd(), calcLevelsByteSize(_fbh));
 	memcpy(ptr + calcKeyFramesOffset(_fbh), _fbh->getKeys(), calcKeyFramesByteSize(_fbh));
-	memcpy(ptr + calcInterpolatedAnimsOffset(_fbh), _fbh->getInterpolatedAnimationData(), calcInterpolatedAnimsByteSize(_fbh));
-	memcpy(ptr + calcNonInterpolatedAnimsOffset(_fbh), _fbh->getNonInterpolatedAnimationData(), calcNonInterpolatedAnimsByteSize(_fbh));
+	if (_fbh->hasCompressedAnimations())
+		memcpy(ptr + calcInterpolatedAnimsOffset(_fbh), _fbh->getCompressedAnimationData(), calcInterpolatedAnimsByteSize(_fbh));
+	else
+	{
+		memcpy(ptr + calcInterpolatedAnimsOffset(_fbh), _fbh->getInterpolatedAnimationData(), calcInterpolatedAnimsByteSize(_fbh));
+		memcpy(ptr + calcNonInterpolatedAnimsOffset(_fbh), _fbh->getNonInterpolatedAnimationData(), calcNonInterpolatedAnimsByteSize(_fbh));
+	}
 	uint8_t* strPtr = ptr + calcBoneNamesOffset(_fbh);
 	for (size_t i = 0; i < boneCount; ++i)
 	{
@@ -144,6 +149,8 @@ FinalBoneHierarchyBlobV3::FinalBoneHierarchyBlobV3(const CFinalBoneHierarchy* _f
 	}
 
 	finalBoneHierarchyFlags = 0; //default initialization for proper usage of bit operators later on
+	if (_fbh->hasCompressedAnimations())
+		finalBoneHierarchyFlags |= EBFBHF_COMPRESSED_ANIMATIONS;
 }
 
 template<>
@@ -198,11 +205,15 @@ size_t FinalBoneHierarchyBlobV3::calcKeyFramesByteSize(const CFinalBoneHierarchy
 }
 size_t FinalBoneHierarchyBlobV3::calcInterpolatedAnimsByteSize(const CFinalBoneHierarchy * _fbh)
 {
-	return _fbh->getAnimationCount()*sizeof(*_fbh->getInterpolatedAnimationData());
+	if (_fbh->hasCompressedAnimations())
+		return _fbh->getCompressedAnimationDataSize();
+	return _fbh->getAnimationCount()*CFinalBoneHierarchy::getSizeOfSingleAnimationData();
 }
 size_t FinalBoneHierarchyBlobV3::calcNonInterpolatedAnimsByteSize(const CFinalBoneHierarchy * _fbh)
 {
-	return _fbh->getAnimationCount()*sizeof(*_fbh->getNonInterpolatedAnimationData());
+	if (_fbh->hasCompressedAnimations())
+		return 0u;
+	return _fbh->getAnimationCount()*CFinalBoneHierarchy::getSizeOfSingleAnimationData();
 }
 size_t FinalBoneHierarchyBlobV3::calcBoneNamesByteSize(const CFinalBoneHierarchy * _fbh)
 {
@@ -248,10 +259,19 @@ size_t FinalBoneHierarchyBlobV3::calcKeyFramesByteSize() const
 }
 size_t FinalBoneHierarchyBlobV3::calcInterpolatedAnimsByteSize() const
 {
+	if (finalBoneHierarchyFlags & EBFBHF_COMPRESSED_ANIMATIONS)
+	{
+		// compressed storage begins with its own size, blob memory is not necessarily aligned
+		decltype(CFinalBoneHierarchy::CompressedAnimationsHeader::byteSize) byteSize;
+		memcpy(&byteSize, reinterpret_cast<const uint8_t*>(this) + calcInterpolatedAnimsOffset(), sizeof(byteSize));
+		return byteSize;
+	}
 	return keyframeCount * boneCount * CFinalBoneHierarchy::getSizeOfSingleAnimationData();
 }
 size_t FinalBoneHierarchyBlobV3::calcNonInterpolatedAnimsByteSize() const
 {
+	if (finalBoneHierarchyFlags & EBFBHF_COMPRESSED_ANIMATIONS)
+		return 0u;
 	return keyframeCount * boneCount * CFinalBoneHierarchy::getSizeOfSingleAnimationData();
 }
 
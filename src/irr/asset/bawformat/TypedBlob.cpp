@@ -399,14 +399,26 @@ void* TypedBlob<FinalBoneHierarchyBlobV3, CFinalBoneHierarchy>::instantiateEmpty
 		strPtr += len;
 	}
 
-	CFinalBoneHierarchy* fbh = new CFinalBoneHierarchy(
-		bonesBegin, bonesEnd,
-		boneNames, boneNames + blob->boneCount,
-		(const size_t*)levelsBegin, (const size_t*)levelsEnd,
-		(const float*)keyframesBegin, (const float*)keyframesEnd,
-		interpolatedAnimsBegin, interpolatedAnimsEnd,
-		nonInterpolatedAnimsBegin, nonInterpolatedAnimsEnd, blob->finalBoneHierarchyFlags&FinalBoneHierarchyBlobV3::EBFBHF_RIGHT_HANDED
-	);
+	CFinalBoneHierarchy* fbh;
+	if (blob->finalBoneHierarchyFlags&FinalBoneHierarchyBlobV3::EBFBHF_COMPRESSED_ANIMATIONS)
+		fbh = new CFinalBoneHierarchy(
+			bonesBegin, bonesEnd,
+			boneNames, boneNames + blob->boneCount,
+			(const size_t*)levelsBegin, (const size_t*)levelsEnd,
+			(const float*)keyframesBegin, (const float*)keyframesEnd,
+			nullptr, nullptr,
+			nullptr, nullptr, blob->finalBoneHierarchyFlags&FinalBoneHierarchyBlobV3::EBFBHF_RIGHT_HANDED,
+			interpolatedAnimsBegin, interpolatedAnimsEnd
+		);
+	else
+		fbh = new CFinalBoneHierarchy(
+			bonesBegin, bonesEnd,
+			boneNames, boneNames + blob->boneCount,
+			(const size_t*)levelsBegin, (const size_t*)levelsEnd,
+			(const float*)keyframesBegin, (const float*)keyframesEnd,
+			interpolatedAnimsBegin, interpolatedAnimsEnd,
+			nonInterpolatedAnimsBegin, nonInterpolatedAnimsEnd, blob->finalBoneHierarchyFlags&FinalBoneHierarchyBlobV3::EBFBHF_RIGHT_HANDED
+		);
 
 	if ((uint8_t*)boneNames == stack)
 		for (size_t i = 0; i < blob->boneCount; ++i)
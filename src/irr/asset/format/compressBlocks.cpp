@@ -0,0 +1,684 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#include "irr/asset/format/compressBlocks.h"
+#include "irr/asset/format/convertColor.h"
+#include "irr/asset/ICPUTexture.h"
+#include "irr/core/parallel/CTaskScheduler.h"
+
+#include <cfloat>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace irr { namespace asset
+{
+
+namespace
+{
+	//! 16 texels of a block stored channel after channel, so 4 texels of a channel fill an SSE register
+	struct SBlockTexels
+	{
+		alignas(16) float c[4][16];
+	};
+
+	//! Picks the closest of `_count` palette entries in channels `[_firstChannel,_firstChannel+Channels)` for every texel
+	/** Texels in `_ignoreMask` keep their index and don't count towards the returned sum of squared errors. */
+	template<uint32_t Channels>
+	float selectIndices(const SBlockTexels& _texels, uint32_t _firstChannel, const float (*_palette)[4], uint32_t _count, uint8_t* _indices, uint32_t _ignoreMask=0u)
+	{
+		float error = 0.f;
+		for (uint32_t g=0u; g<16u; g+=4u)
+		{
+			__m128 best = _mm_set1_ps(FLT_MAX);
+			__m128i bestIx = _mm_setzero_si128();
+			for (uint32_t k=0u; k<_count; k++)
+			{
+				__m128 dist = _mm_setzero_ps();
+				for (uint32_t ch=0u; ch<Channels; ch++)
+				{
+					const __m128 diff = _mm_sub_ps(_mm_load_ps(_texels.c[_firstChannel+ch]+g),_mm_set1_ps(_palette[k][ch]));
+					dist = _mm_add_ps(dist,_mm_mul_ps(diff,diff));
+				}
+				// strictly closer, so ties go to the lowest index
+				const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(dist,best));
+				best = _mm_min_ps(dist,best);
+				bestIx = _mm_or_si128(_mm_and_si128(closer,_mm_set1_epi32(k)),_mm_andnot_si128(closer,bestIx));
+			}
+
+			alignas(16) float bestDist[4];
+			alignas(16) int32_t ix[4];
+			_mm_store_ps(bestDist,best);
+			_mm_store_si128(reinterpret_cast<__m128i*>(ix),bestIx);
+			for (uint32_t i=0u; i<4u; i++)
+			{
+				if (_ignoreMask&(0x1u<<(g+i)))
+					continue;
+				_indices[g+i] = static_cast<uint8_t>(ix[i]);
+				error += bestDist[i];
+			}
+		}
+		return error;
+	}
+
+	//! Mean of the texels outside `_ignoreMask` and the direction they spread the most in
+	/** The direction comes from power iteration on the covariance matrix, started from the bounding box diagonal.
+	A single iteration already fixes the sign of the diagonal's components, more of them converge on the principal axis. */
+	template<uint32_t Channels>
+	void findAxis(const SBlockTexels& _texels, uint32_t _ignoreMask, uint32_t _iterations, float* _mean, float* _axis)
+	{
+		float minC[Channels], maxC[Channels];
+		for (uint32_t ch=0u; ch<Channels; ch++)
+		{
+			_mean[ch] = 0.f;
+			minC[ch] = FLT_MAX;
+			maxC[ch] = -FLT_MAX;
+		}
+		uint32_t count = 0u;
+		for (uint32_t i=0u; i<16u; i++)
+		{
+			if (_ignoreMask&(0x1u<<i))
+				continue;
+			for (uint32_t ch=0u; ch<Channels; ch++)
+			{
+				const float v = _texels.c[ch][i];
+				_mean[ch] += v;
+				minC[ch] = core::min(minC[ch],v);
+				maxC[ch] = core::max(maxC[ch],v);
+			}
+			count++;
+		}
+		for (uint32_t ch=0u; ch<Channels; ch++)
+		{
+			_mean[ch] /= float(count);
+			_axis[ch] = maxC[ch]-minC[ch];
+		}
+
+		float covariance[Channels][Channels] = {};
+		for (uint32_t i=0u; i<16u; i++)
+		{
+			if (_ignoreMask&(0x1u<<i))
+				continue;
+			float d[Channels];
+			for (uint32_t ch=0u; ch<Channels; ch++)
+				d[ch] = _texels.c[ch][i]-_mean[ch];
+			for (uint32_t r=0u; r<Channels; r++)
+			for (uint32_t c=r; c<Channels; c++)
+				covariance[r][c] += d[r]*d[c];
+		}
+		for (uint32_t r=1u; r<Channels; r++)
+		for (uint32_t c=0u; c<r; c++)
+			covariance[r][c] = covariance[c][r];
+
+		for (uint32_t it=0u; it<_iterations; it++)
+		{
+			float next[Channels] = {};
+			float largest = 0.f;
+			for (uint32_t r=0u; r<Channels; r++)
+			{
+				for (uint32_t c=0u; c<Channels; c++)
+					next[r] += covariance[r][c]*_axis[c];
+				largest = core::max(largest,std::abs(next[r]));
+			}
+			// all texels the same, or all along a direction orthogonal to the start
+			if (largest<=FLT_MIN)
+				break;
+			for (uint32_t ch=0u; ch<Channels; ch++)
+				_axis[ch] = next[ch]/largest;
+		}
+
+		float lengthSq = 0.f;
+		for (uint32_t ch=0u; ch<Channels; ch++)
+			lengthSq += _axis[ch]*_axis[ch];
+		const float invLength = lengthSq>FLT_MIN ? 1.f/std::sqrt(lengthSq):0.f;
+		for (uint32_t ch=0u; ch<Channels; ch++)
+			_axis[ch] *= invLength;
+	}
+
+	//! Extremes of the texels projected on the axis, clamped to the value range
+	template<uint32_t Channels>
+	void findEndpoints(const SBlockTexels& _texels, uint32_t _ignoreMask, const float* _mean, const float* _axis, float _minValue, float _maxValue, float* _lo, float* _hi)
+	{
+		float tMin = FLT_MAX, tMax = -FLT_MAX;
+		for (uint32_t i=0u; i<16u; i++)
+		{
+			if (_ignoreMask&(0x1u<<i))
+				continue;
+			float t = 0.f;
+			for (uint32_t ch=0u; ch<Channels; ch++)
+				t += (_texels.c[ch][i]-_mean[ch])*_axis[ch];
+			tMin = core::min(tMin,t);
+			tMax = core::max(tMax,t);
+		}
+		for (uint32_t ch=0u; ch<Channels; ch++)
+		{
+			_lo[ch] = core::clamp(_mean[ch]+_axis[ch]*tMin,_minValue,_maxValue);
+			_hi[ch] = core::clamp(_mean[ch]+_axis[ch]*tMax,_minValue,_maxValue);
+		}
+	}
+
+	//! Least squares endpoints for fixed indices, index `i` takes `_weights[i]` of the first endpoint and the rest of the second
+	template<uint32_t Channels>
+	bool fitEndpoints(const SBlockTexels& _texels, uint32_t _firstChannel, uint32_t _ignoreMask, const uint8_t* _indices, const float* _weights, float* _e0, float* _e1)
+	{
+		float aa = 0.f, ab = 0.f, bb = 0.f;
+		float ax[Channels] = {}, bx[Channels] = {};
+		for (uint32_t i=0u; i<16u; i++)
+		{
+			if (_ignoreMask&(0x1u<<i))
+				continue;
+			const float a = _weights[_indices[i]];
+			const float b = 1.f-a;
+			aa += a*a;
+			ab += a*b;
+			bb += b*b;
+			for (uint32_t ch=0u; ch<Channels; ch++)
+			{
+				ax[ch] += a*_texels.c[_firstChannel+ch][i];
+				bx[ch] += b*_texels.c[_firstChannel+ch][i];
+			}
+		}
+
+		const float det = aa*bb-ab*ab;
+		// every texel got the same index
+		if (std::abs(det)<1e-6f)
+			return false;
+		const float invDet = 1.f/det;
+		for (uint32_t ch=0u; ch<Channels; ch++)
+		{
+			_e0[ch] = (bb*ax[ch]-ab*bx[ch])*invDet;
+			_e1[ch] = (aa*bx[ch]-ab*ax[ch])*invDet;
+		}
+		return true;
+	}
+
+
+	inline uint16_t quantizeR5G6B5(const float* _rgb)
+	{
+		const uint32_t r = static_cast<uint32_t>(core::clamp(_rgb[0]*(31.f/255.f)+0.5f,0.f,31.f));
+		const uint32_t g = static_cast<uint32_t>(core::clamp(_rgb[1]*(63.f/255.f)+0.5f,0.f,63.f));
+		const uint32_t b = static_cast<uint32_t>(core::clamp(_rgb[2]*(31.f/255.f)+0.5f,0.f,31.f));
+		return static_cast<uint16_t>((r<<11u)|(g<<5u)|b);
+	}
+	inline void expandR5G6B5(uint16_t _color, float* _rgb)
+	{
+		const uint32_t r = _color>>11u;
+		const uint32_t g = (_color>>5u)&0x3fu;
+		const uint32_t b = _color&0x1fu;
+		_rgb[0] = float((r<<3u)|(r>>2u));
+		_rgb[1] = float((g<<2u)|(g>>4u));
+		_rgb[2] = float((b<<3u)|(b>>2u));
+	}
+
+	//! Builds the palette the decoder will and picks the indices, transparent texels get index 3
+	float evaluateBC1(const SBlockTexels& _texels, uint16_t _c0, uint16_t _c1, bool _threeColor, uint32_t _transparentMask, uint8_t* _indices)
+	{
+		float palette[4][4] = {};
+		expandR5G6B5(_c0,palette[0]);
+		expandR5G6B5(_c1,palette[1]);
+		for (uint32_t ch=0u; ch<3u; ch++)
+		{
+			if (_threeColor)
+				palette[2][ch] = (palette[0][ch]+palette[1][ch])*0.5f;
+			else
+			{
+				palette[2][ch] = (2.f*palette[0][ch]+palette[1][ch])*(1.f/3.f);
+				palette[3][ch] = (palette[0][ch]+2.f*palette[1][ch])*(1.f/3.f);
+			}
+		}
+
+		const float error = selectIndices<3u>(_texels,0u,palette,_threeColor ? 3u:4u,_indices,_transparentMask);
+		for (uint32_t i=0u; i<16u; i++)
+		if (_transparentMask&(0x1u<<i))
+			_indices[i] = 3u;
+		return error;
+	}
+
+	//! With `_punchThroughAlpha` texels with alpha under half become transparent, which forces the 3 color mode on their block
+	void encodeBC1(const SBlockTexels& _texels, uint8_t* _out, bool _punchThroughAlpha, E_BLOCK_COMPRESSION_QUALITY _quality)
+	{
+		uint32_t transparentMask = 0u;
+		if (_punchThroughAlpha)
+		for (uint32_t i=0u; i<16u; i++)
+		if (_texels.c[3][i]<128.f)
+			transparentMask |= 0x1u<<i;
+
+		uint16_t c0 = 0u, c1 = 0u;
+		uint32_t lut = 0xffffffffu;
+		if (transparentMask!=0xffffu)
+		{
+			const bool threeColor = transparentMask!=0u;
+			// the 4 color mode needs c0>c1 and the 3 color mode c0<=c1, equal endpoints decode fine in both as index 0 is picked
+			auto order = [threeColor](uint16_t& a, uint16_t& b)
+			{
+				if (threeColor ? (a>b):(a<b))
+					std::swap(a,b);
+			};
+
+			float mean[3], axis[3], lo[3], hi[3];
+			findAxis<3u>(_texels,transparentMask,_quality==EBCQ_FAST ? 1u:8u,mean,axis);
+			findEndpoints<3u>(_texels,transparentMask,mean,axis,0.f,255.f,lo,hi);
+			c0 = quantizeR5G6B5(hi);
+			c1 = quantizeR5G6B5(lo);
+			order(c0,c1);
+
+			uint8_t indices[16];
+			float error = evaluateBC1(_texels,c0,c1,threeColor,transparentMask,indices);
+			if (_quality!=EBCQ_FAST)
+			{
+				const float weights4[4] = {1.f,0.f,2.f/3.f,1.f/3.f};
+				const float weights3[4] = {1.f,0.f,0.5f,0.f};
+				for (uint32_t it=0u; it<2u && error>0.f; it++)
+				{
+					float e0[3], e1[3];
+					if (!fitEndpoints<3u>(_texels,0u,transparentMask,indices,threeColor ? weights3:weights4,e0,e1))
+						break;
+					uint16_t n0 = quantizeR5G6B5(e0);
+					uint16_t n1 = quantizeR5G6B5(e1);
+					order(n0,n1);
+
+					uint8_t newIndices[16];
+					const float newError = evaluateBC1(_texels,n0,n1,threeColor,transparentMask,newIndices);
+					if (newError>=error)
+						break;
+					error = newError;
+					c0 = n0;
+					c1 = n1;
+					memcpy(indices,newIndices,sizeof(indices));
+				}
+			}
+
+			lut = 0u;
+			for (uint32_t i=0u; i<16u; i++)
+				lut |= uint32_t(indices[i])<<(2u*i);
+		}
+
+		memcpy(_out,&c0,2u);
+		memcpy(_out+2,&c1,2u);
+		memcpy(_out+4,&lut,4u);
+	}
+
+	void encodeBC2Alpha(const SBlockTexels& _texels, uint8_t* _out)
+	{
+		uint64_t bits = 0ull;
+		for (uint32_t i=0u; i<16u; i++)
+			bits |= uint64_t(_texels.c[3][i]*(15.f/255.f)+0.5f)<<(4u*i);
+		memcpy(_out,&bits,8u);
+	}
+
+	//! Palette of the 8 value mode if `_a0>_a1`, otherwise of the 6 value mode which also has both ends of the range
+	float evaluateBC4(const SBlockTexels& _texels, uint32_t _channel, int32_t _a0, int32_t _a1, int32_t _minValue, int32_t _maxValue, uint8_t* _indices)
+	{
+		float palette[8][4] = {};
+		palette[0][0] = float(_a0);
+		palette[1][0] = float(_a1);
+		if (_a0>_a1)
+		{
+			for (uint32_t i=1u; i<7u; i++)
+				palette[i+1u][0] = (float(7u-i)*_a0+float(i)*_a1)*(1.f/7.f);
+		}
+		else
+		{
+			for (uint32_t i=1u; i<5u; i++)
+				palette[i+1u][0] = (float(5u-i)*_a0+float(i)*_a1)*(1.f/5.f);
+			palette[6][0] = float(_minValue);
+			palette[7][0] = float(_maxValue);
+		}
+		return selectIndices<1u>(_texels,_channel,palette,8u,_indices);
+	}
+
+	//! Also used for the alpha of BC3 and both channels of BC5
+	void encodeBC4(const SBlockTexels& _texels, uint32_t _channel, uint8_t* _out, bool _signed, E_BLOCK_COMPRESSION_QUALITY _quality)
+	{
+		const int32_t minValue = _signed ? -127:0;
+		const int32_t maxValue = _signed ? 127:255;
+
+		int32_t lo = maxValue, hi = minValue;
+		int32_t innerLo = maxValue, innerHi = minValue;
+		for (uint32_t i=0u; i<16u; i++)
+		{
+			const int32_t v = static_cast<int32_t>(_texels.c[_channel][i]);
+			lo = core::min(lo,v);
+			hi = core::max(hi,v);
+			if (v!=minValue && v!=maxValue)
+			{
+				innerLo = core::min(innerLo,v);
+				innerHi = core::max(innerHi,v);
+			}
+		}
+
+		int32_t a0 = hi, a1 = lo;
+		uint8_t indices[16];
+		float error = evaluateBC4(_texels,_channel,a0,a1,minValue,maxValue,indices);
+		if (_quality!=EBCQ_FAST && error>0.f)
+		{
+			// 8 value mode, tightened around the clusters
+			const float weights8[8] = {1.f,0.f,6.f/7.f,5.f/7.f,4.f/7.f,3.f/7.f,2.f/7.f,1.f/7.f};
+			float e0, e1;
+			if (fitEndpoints<1u>(_texels,_channel,0u,indices,weights8,&e0,&e1))
+			{
+				const int32_t n0 = core::clamp(static_cast<int32_t>(std::floor(e0+0.5f)),minValue,maxValue);
+				const int32_t n1 = core::clamp(static_cast<int32_t>(std::floor(e1+0.5f)),minValue,maxValue);
+				uint8_t newIndices[16];
+				if (n0>n1)
+				{
+					const float newError = evaluateBC4(_texels,_channel,n0,n1,minValue,maxValue,newIndices);
+					if (newError<error)
+					{
+						error = newError;
+						a0 = n0;
+						a1 = n1;
+						memcpy(indices,newIndices,sizeof(indices));
+					}
+				}
+			}
+			// 6 value mode spends its interpolated values on what is in between the extremes of the range
+			if (innerLo<=innerHi && (lo==minValue||hi==maxValue))
+			{
+				uint8_t newIndices[16];
+				const float newError = evaluateBC4(_texels,_channel,innerLo,innerHi,minValue,maxValue,newIndices);
+				if (newError<error)
+				{
+					error = newError;
+					a0 = innerLo;
+					a1 = innerHi;
+					memcpy(indices,newIndices,sizeof(indices));
+				}
+			}
+		}
+
+		_out[0] = static_cast<uint8_t>(a0);
+		_out[1] = static_cast<uint8_t>(a1);
+		uint64_t bits = 0ull;
+		for (uint32_t i=0u; i<16u; i++)
+			bits |= uint64_t(indices[i])<<(3u*i);
+		memcpy(_out+2,&bits,6u);
+	}
+
+	const uint32_t BC7Weights4[16] = {0u,4u,9u,13u,17u,21u,26u,30u,34u,38u,43u,47u,51u,55u,60u,64u};
+
+	//! Mode 6 endpoints are 7 bits per channel and a p-bit shared by the channels, pick the p-bit which lands closer
+	void quantizeBC7Endpoint(const float* _e, uint8_t* _q, uint8_t& _p)
+	{
+		float bestError = FLT_MAX;
+		for (uint8_t p=0u; p<2u; p++)
+		{
+			uint8_t q[4];
+			float error = 0.f;
+			for (uint32_t ch=0u; ch<4u; ch++)
+			{
+				q[ch] = static_cast<uint8_t>(core::clamp(std::floor((_e[ch]-float(p))*0.5f+0.5f),0.f,127.f));
+				const float diff = float((q[ch]<<1u)|p)-_e[ch];
+				error += diff*diff;
+			}
+			if (error<bestError)
+			{
+				bestError = error;
+				memcpy(_q,q,4u);
+				_p = p;
+			}
+		}
+	}
+
+	float evaluateBC7(const SBlockTexels& _texels, const uint8_t* _q0, uint8_t _p0, const uint8_t* _q1, uint8_t _p1, uint8_t* _indices)
+	{
+		float palette[16][4];
+		for (uint32_t ch=0u; ch<4u; ch++)
+		{
+			const uint32_t e0 = (uint32_t(_q0[ch])<<1u)|_p0;
+			const uint32_t e1 = (uint32_t(_q1[ch])<<1u)|_p1;
+			for (uint32_t i=0u; i<16u; i++)
+				palette[i][ch] = float(((64u-BC7Weights4[i])*e0+BC7Weights4[i]*e1+32u)>>6u);
+		}
+		return selectIndices<4u>(_texels,0u,palette,16u,_indices);
+	}
+
+	class CBitWriter
+	{
+		public:
+			CBitWriter(uint8_t* _out) : out(_out), bit(0u) {}
+
+			inline void write(uint32_t _value, uint32_t _bitCount)
+			{
+				for (uint32_t i=0u; i<_bitCount; i++, bit++)
+				if ((_value>>i)&0x1u)
+					out[bit>>3u] |= 0x1u<<(bit&7u);
+			}
+
+		private:
+			uint8_t* out;
+			uint32_t bit;
+	};
+
+	//! Only mode 6, a single subset of RGBA endpoints and 4 bit indices
+	void encodeBC7(const SBlockTexels& _texels, uint8_t* _out, E_BLOCK_COMPRESSION_QUALITY _quality)
+	{
+		float mean[4], axis[4], lo[4], hi[4];
+		findAxis<4u>(_texels,0u,_quality==EBCQ_FAST ? 1u:8u,mean,axis);
+		findEndpoints<4u>(_texels,0u,mean,axis,0.f,255.f,lo,hi);
+
+		uint8_t q0[4], q1[4], p0, p1;
+		quantizeBC7Endpoint(lo,q0,p0);
+		quantizeBC7Endpoint(hi,q1,p1);
+		uint8_t indices[16];
+		float error = evaluateBC7(_texels,q0,p0,q1,p1,indices);
+		if (_quality!=EBCQ_FAST)
+		{
+			float weights[16];
+			for (uint32_t i=0u; i<16u; i++)
+				weights[i] = float(64u-BC7Weights4[i])/64.f;
+			for (uint32_t it=0u; it<2u && error>0.f; it++)
+			{
+				float e0[4], e1[4];
+				if (!fitEndpoints<4u>(_texels,0u,0u,indices,weights,e0,e1))
+					break;
+				for (uint32_t ch=0u; ch<4u; ch++)
+				{
+					e0[ch] = core::clamp(e0[ch],0.f,255.f);
+					e1[ch] = core::clamp(e1[ch],0.f,255.f);
+				}
+				uint8_t n0[4], n1[4], np0, np1, newIndices[16];
+				quantizeBC7Endpoint(e0,n0,np0);
+				quantizeBC7Endpoint(e1,n1,np1);
+				const float newError = evaluateBC7(_texels,n0,np0,n1,np1,newIndices);
+				if (newError>=error)
+					break;
+				error = newError;
+				memcpy(q0,n0,4u);
+				memcpy(q1,n1,4u);
+				p0 = np0;
+				p1 = np1;
+				memcpy(indices,newIndices,sizeof(indices));
+			}
+		}
+
+		// the most significant bit of the first index is implied zero
+		if (indices[0]&0x8u)
+		{
+			for (uint32_t ch=0u; ch<4u; ch++)
+				std::swap(q0[ch],q1[ch]);
+			std::swap(p0,p1);
+			for (uint32_t i=0u; i<16u; i++)
+				indices[i] = 15u-indices[i];
+		}
+
+		memset(_out,0,16u);
+		CBitWriter writer(_out);
+		writer.write(0x1u<<6u,7u);
+		for (uint32_t ch=0u; ch<4u; ch++)
+		{
+			writer.write(q0[ch],7u);
+			writer.write(q1[ch],7u);
+		}
+		writer.write(p0,1u);
+		writer.write(p1,1u);
+		writer.write(indices[0],3u);
+		for (uint32_t i=1u; i<16u; i++)
+			writer.write(indices[i],4u);
+	}
+
+	void encodeBlock(E_FORMAT _format, const SBlockTexels& _texels, uint8_t* _out, E_BLOCK_COMPRESSION_QUALITY _quality)
+	{
+		switch (_format)
+		{
+			case EF_BC1_RGB_UNORM_BLOCK:
+			case EF_BC1_RGB_SRGB_BLOCK:
+				encodeBC1(_texels,_out,false,_quality);
+				break;
+			case EF_BC1_RGBA_UNORM_BLOCK:
+			case EF_BC1_RGBA_SRGB_BLOCK:
+				encodeBC1(_texels,_out,true,_quality);
+				break;
+			case EF_BC2_UNORM_BLOCK:
+			case EF_BC2_SRGB_BLOCK:
+				encodeBC2Alpha(_texels,_out);
+				encodeBC1(_texels,_out+8,false,_quality);
+				break;
+			case EF_BC3_UNORM_BLOCK:
+			case EF_BC3_SRGB_BLOCK:
+				encodeBC4(_texels,3u,_out,false,_quality);
+				encodeBC1(_texels,_out+8,false,_quality);
+				break;
+			case EF_BC4_UNORM_BLOCK:
+			case EF_BC4_SNORM_BLOCK:
+				encodeBC4(_texels,0u,_out,_format==EF_BC4_SNORM_BLOCK,_quality);
+				break;
+			case EF_BC5_UNORM_BLOCK:
+			case EF_BC5_SNORM_BLOCK:
+				encodeBC4(_texels,0u,_out,_format==EF_BC5_SNORM_BLOCK,_quality);
+				encodeBC4(_texels,1u,_out+8,_format==EF_BC5_SNORM_BLOCK,_quality);
+				break;
+			case EF_BC7_UNORM_BLOCK:
+			case EF_BC7_SRGB_BLOCK:
+				encodeBC7(_texels,_out,_quality);
+				break;
+			default:
+				assert(false);
+				break;
+		}
+	}
+
+	//! Out of bounds texels repeat the last row and column, SNORM -128 becomes -127 as both mean -1
+	void gatherBlock(const uint8_t* _slice, size_t _rowPitch, uint32_t _width, uint32_t _height, uint32_t _blockX, uint32_t _blockY, bool _signed, SBlockTexels& _out)
+	{
+		for (uint32_t y=0u; y<4u; y++)
+		{
+			const uint8_t* row = _slice+core::min(_blockY*4u+y,_height-1u)*_rowPitch;
+			for (uint32_t x=0u; x<4u; x++)
+			{
+				const uint8_t* texel = row+core::min(_blockX*4u+x,_width-1u)*4u;
+				for (uint32_t ch=0u; ch<4u; ch++)
+					_out.c[ch][y*4u+x] = _signed ? float(core::max<int32_t>(static_cast<int8_t>(texel[ch]),-127)):float(texel[ch]);
+			}
+		}
+	}
+
+}
+
+
+bool isBlockCompressionEncodable(E_FORMAT _fmt)
+{
+	switch (_fmt)
+	{
+		case EF_BC1_RGB_UNORM_BLOCK:
+		case EF_BC1_RGB_SRGB_BLOCK:
+		case EF_BC1_RGBA_UNORM_BLOCK:
+		case EF_BC1_RGBA_SRGB_BLOCK:
+		case EF_BC2_UNORM_BLOCK:
+		case EF_BC2_SRGB_BLOCK:
+		case EF_BC3_UNORM_BLOCK:
+		case EF_BC3_SRGB_BLOCK:
+		case EF_BC4_UNORM_BLOCK:
+		case EF_BC4_SNORM_BLOCK:
+		case EF_BC5_UNORM_BLOCK:
+		case EF_BC5_SNORM_BLOCK:
+		case EF_BC7_UNORM_BLOCK:
+		case EF_BC7_SRGB_BLOCK:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool compressBlocks(E_FORMAT _dstFormat, void* _dst, const void* _src, size_t _srcRowPitch, uint32_t _width, uint32_t _height, uint32_t _depth, const SBlockCompressionParams& _params)
+{
+	if (!isBlockCompressionEncodable(_dstFormat) || !_dst || !_src)
+		return false;
+
+	const bool isSigned = _dstFormat==EF_BC4_SNORM_BLOCK || _dstFormat==EF_BC5_SNORM_BLOCK;
+	const uint32_t blockBytes = getTexelOrBlockBytesize(_dstFormat);
+	const uint32_t blocksX = (_width+3u)/4u;
+	const uint32_t blocksY = (_height+3u)/4u;
+	const size_t slicePitch = _srcRowPitch*_height;
+
+	core::CTaskScheduler::getGlobal().parallelFor(0u,blocksY*_depth,_params.grain,[&](uint32_t _begin, uint32_t _end)
+	{
+		for (uint32_t row=_begin; row<_end; row++)
+		{
+			const uint8_t* slice = reinterpret_cast<const uint8_t*>(_src)+(row/blocksY)*slicePitch;
+			uint8_t* out = reinterpret_cast<uint8_t*>(_dst)+size_t(row)*blocksX*blockBytes;
+			SBlockTexels texels;
+			for (uint32_t x=0u; x<blocksX; x++, out+=blockBytes)
+			{
+				gatherBlock(slice,_srcRowPitch,_width,_height,x,row%blocksY,isSigned,texels);
+				encodeBlock(_dstFormat,texels,out,_params.quality);
+			}
+		}
+	});
+	return true;
+}
+
+ICPUTexture* createBlockCompressedTexture(const ICPUTexture* _texture, E_FORMAT _dstFormat, const SBlockCompressionParams& _params)
+{
+	if (!_texture || !isBlockCompressionEncodable(_dstFormat))
+		return nullptr;
+
+	// convertColor linearizes sRGB on decode and reapplies it on encode, so the texels end up in the color space of the target
+	E_FORMAT texelFormat = isSRGBFormat(_dstFormat) ? EF_R8G8B8A8_SRGB:EF_R8G8B8A8_UNORM;
+	if (_dstFormat==EF_BC4_SNORM_BLOCK || _dstFormat==EF_BC5_SNORM_BLOCK)
+		texelFormat = EF_R8G8B8A8_SNORM;
+
+	core::vector<CImageData*> ranges;
+	auto dropRanges = [&ranges]()
+	{
+		for (auto range : ranges)
+			range->drop();
+	};
+	core::vector<uint8_t> texels;
+	for (const CImageData* range : _texture->getRanges())
+	{
+		const E_FORMAT srcFormat = range->getColorFormat();
+		if (isBlockCompressionFormat(srcFormat) || isPlanarFormat(srcFormat) || !range->getData())
+		{
+			dropRanges();
+			return nullptr;
+		}
+
+		const auto size = range->getSize();
+		const uint8_t* src = reinterpret_cast<const uint8_t*>(range->getData());
+		const size_t srcPitch = range->getPitchIncludingAlignment();
+		size_t texelPitch = srcPitch;
+		if (srcFormat!=texelFormat)
+		{
+			texelPitch = size_t(size.X)*4u;
+			texels.resize(texelPitch*size.Y*size.Z);
+			core::vector3d<uint32_t> rowSize(size.X,1u,1u);
+			for (uint32_t row=0u; row<size.Y*size.Z; row++)
+			{
+				const void* srcRow[4] = {src+row*srcPitch,nullptr,nullptr,nullptr};
+				video::convertColor(srcFormat,texelFormat,srcRow,texels.data()+row*texelPitch,size.X,rowSize);
+			}
+			src = texels.data();
+		}
+
+		auto compressed = new CImageData(nullptr,range->getSliceMin(),range->getSliceMax(),range->getSupposedMipLevel(),_dstFormat);
+		ranges.push_back(compressed);
+		compressBlocks(_dstFormat,compressed->getData(),src,texelPitch,size.X,size.Y,size.Z,_params);
+	}
+
+	ICPUTexture* retval = ICPUTexture::create(ranges,_texture->getSourceFilename(),_texture->getType());
+	dropRanges();
+	return retval;
+}
+
+}} //irr::asset
@@ -0,0 +1,311 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#include "irr/asset/format/generateMipMaps.h"
+#include "irr/asset/format/convertColor.h"
+#include "irr/asset/ICPUTexture.h"
+#include "irr/core/parallel/CTaskScheduler.h"
+
+#include <cmath>
+#include <xmmintrin.h>
+
+namespace irr { namespace asset
+{
+
+namespace
+{
+	//! in texels of the smaller level
+	constexpr double FilterRadius = 3.0;
+	constexpr double KaiserAlpha = 4.0;
+
+	double sinc(double _x)
+	{
+		if (std::abs(_x)<1e-6)
+			return 1.0;
+		_x *= core::PI<double>();
+		return std::sin(_x)/_x;
+	}
+
+	//! Modified Bessel function of the first kind, order 0
+	double besselI0(double _x)
+	{
+		const double quarterSq = _x*_x*0.25;
+		double sum = 1.0, term = 1.0;
+		for (uint32_t k=1u; k<64u && term>sum*1e-12; k++)
+		{
+			term *= quarterSq/double(k*k);
+			sum += term;
+		}
+		return sum;
+	}
+
+	double evaluateKernel(E_MIP_MAP_FILTER _filter, double _x)
+	{
+		const double t = _x/FilterRadius;
+		if (std::abs(t)>=1.0)
+			return 0.0;
+		if (_filter==EMMF_KAISER)
+			return sinc(_x)*besselI0(KaiserAlpha*std::sqrt(1.0-t*t))/besselI0(KaiserAlpha);
+		return sinc(_x)*sinc(t);
+	}
+
+	//! Source texels and normalized weights of every output texel along one dimension
+	struct SFilterTaps
+	{
+		//! output texel `i` uses taps `[offsets[i],offsets[i+1])`
+		core::vector<uint32_t> offsets;
+		core::vector<uint32_t> indices;
+		core::vector<float> weights;
+	};
+
+	void computeTaps(E_MIP_MAP_FILTER _filter, uint32_t _srcExtent, uint32_t _dstExtent, SFilterTaps& _taps)
+	{
+		_taps.offsets.assign(1u,0u);
+		_taps.indices.clear();
+		_taps.weights.clear();
+
+		const double scale = double(_srcExtent)/double(_dstExtent);
+		for (uint32_t i=0u; i<_dstExtent; i++)
+		{
+			const size_t first = _taps.weights.size();
+			const double center = (i+0.5)*scale;
+			double sum = 0.0;
+			auto addTap = [&](int32_t _index, double _weight)
+			{
+				const uint32_t index = static_cast<uint32_t>(core::clamp(_index,0,int32_t(_srcExtent)-1));
+				sum += _weight;
+				// taps clamped onto the same edge texel get merged
+				if (_taps.weights.size()>first && _taps.indices.back()==index)
+				{
+					_taps.weights.back() += static_cast<float>(_weight);
+					return;
+				}
+				_taps.indices.push_back(index);
+				_taps.weights.push_back(static_cast<float>(_weight));
+			};
+
+			if (_filter==EMMF_BOX)
+			{
+				// exact coverage, odd sized levels give the middle texel to both neighbours
+				const double lo = center-0.5*scale, hi = center+0.5*scale;
+				for (int32_t j=int32_t(lo); double(j)<hi; j++)
+				{
+					const double covered = core::min(hi,j+1.0)-core::max(lo,double(j));
+					if (covered>0.0)
+						addTap(j,covered);
+				}
+			}
+			else
+			{
+				// texels past the edge are clamped to it
+				const int32_t lo = int32_t(std::floor(center-FilterRadius*scale));
+				const int32_t hi = int32_t(std::ceil(center+FilterRadius*scale));
+				for (int32_t j=lo; j<=hi; j++)
+				{
+					const double weight = evaluateKernel(_filter,(j+0.5-center)/scale);
+					if (weight!=0.0)
+						addTap(j,weight);
+				}
+			}
+
+			for (size_t k=first; k<_taps.weights.size(); k++)
+				_taps.weights[k] = static_cast<float>(_taps.weights[k]/sum);
+			_taps.offsets.push_back(static_cast<uint32_t>(_taps.weights.size()));
+		}
+	}
+
+	//! RGBA float texels of a whole mip level, rows of `size[0]` texels
+	struct SLevel
+	{
+		uint32_t size[3];
+		core::vector<float> texels;
+	};
+
+	//! Resamples `_src` along dimension `_dim` to `_dstExtent` texels, the other dimensions keep their size
+	void resample(const SLevel& _src, SLevel& _dst, uint32_t _dim, uint32_t _dstExtent, const SFilterTaps& _taps, uint32_t _grain)
+	{
+		std::copy(_src.size,_src.size+3u,_dst.size);
+		_dst.size[_dim] = _dstExtent;
+		_dst.texels.resize(size_t(_dst.size[0])*_dst.size[1]*_dst.size[2]*4u);
+
+		const uint32_t rowFloats = _dst.size[0]*4u;
+		if (_dim==0u)
+		{
+			const size_t srcRowFloats = size_t(_src.size[0])*4u;
+			core::CTaskScheduler::getGlobal().parallelFor(0u,_dst.size[1]*_dst.size[2],_grain,[&](uint32_t _begin, uint32_t _end)
+			{
+				for (uint32_t row=_begin; row<_end; row++)
+				{
+					const float* in = _src.texels.data()+row*srcRowFloats;
+					float* out = _dst.texels.data()+size_t(row)*rowFloats;
+					for (uint32_t x=0u; x<_dstExtent; x++, out+=4u)
+					{
+						__m128 acc = _mm_setzero_ps();
+						for (uint32_t k=_taps.offsets[x]; k<_taps.offsets[x+1u]; k++)
+							acc = _mm_add_ps(acc,_mm_mul_ps(_mm_set1_ps(_taps.weights[k]),_mm_loadu_ps(in+_taps.indices[k]*4u)));
+						_mm_storeu_ps(out,acc);
+					}
+				}
+			});
+			return;
+		}
+
+		// whole rows get weighted and summed, a task is one output row
+		const uint32_t rowsBelow = _dim==1u ? 1u:_src.size[1];
+		const uint32_t outer = _dim==1u ? _src.size[2]:1u;
+		const size_t srcRowFloats = rowFloats;
+		core::CTaskScheduler::getGlobal().parallelFor(0u,outer*_dstExtent*rowsBelow,_grain,[&](uint32_t _begin, uint32_t _end)
+		{
+			for (uint32_t task=_begin; task<_end; task++)
+			{
+				const uint32_t row = task%rowsBelow;
+				const uint32_t i = (task/rowsBelow)%_dstExtent;
+				const uint32_t o = task/(rowsBelow*_dstExtent);
+
+				float* out = _dst.texels.data()+(size_t(o*_dstExtent+i)*rowsBelow+row)*rowFloats;
+				for (uint32_t k=_taps.offsets[i]; k<_taps.offsets[i+1u]; k++)
+				{
+					const float* in = _src.texels.data()+(size_t(o*_src.size[_dim]+_taps.indices[k])*rowsBelow+row)*srcRowFloats;
+					const __m128 weight = _mm_set1_ps(_taps.weights[k]);
+					if (k==_taps.offsets[i])
+					{
+						for (uint32_t f=0u; f<rowFloats; f+=4u)
+							_mm_storeu_ps(out+f,_mm_mul_ps(weight,_mm_loadu_ps(in+f)));
+					}
+					else
+					{
+						for (uint32_t f=0u; f<rowFloats; f+=4u)
+							_mm_storeu_ps(out+f,_mm_add_ps(_mm_loadu_ps(out+f),_mm_mul_ps(weight,_mm_loadu_ps(in+f))));
+					}
+				}
+			}
+		});
+	}
+}
+
+
+ICPUTexture* createMipMappedTexture(const ICPUTexture* _texture, const SMipMapGenerationParams& _params)
+{
+	if (!_texture)
+		return nullptr;
+
+	const E_FORMAT format = _texture->getColorFormat();
+	if (isBlockCompressionFormat(format) || isPlanarFormat(format))
+		return nullptr;
+
+	const auto baseLevel = _texture->getMipMap(0u);
+	if (baseLevel.first==baseLevel.second || (*baseLevel.first)->getSupposedMipLevel()!=0u)
+		return nullptr;
+
+	const auto type = _texture->getType();
+	// how many of the dimensions shrink with every level, the rest are array layers
+	const uint32_t mipDimensions[video::ITexture::ETT_COUNT+1u] = {1u,2u,3u,1u,2u,2u,2u,0u};
+	const uint32_t filteredDims = mipDimensions[core::min<uint32_t>(type,video::ITexture::ETT_COUNT)];
+	if (!filteredDims)
+		return nullptr;
+
+	SLevel level;
+	std::copy(_texture->getSize(),_texture->getSize()+3u,level.size);
+	level.texels.resize(size_t(level.size[0])*level.size[1]*level.size[2]*4u,0.f);
+
+	// decode level 0 into linear floats, channels the format doesn't have get filled like on the GPU
+	const uint32_t channels = getFormatChannelCount(format);
+	for (auto it=baseLevel.first; it!=baseLevel.second; it++)
+	{
+		const CImageData* range = *it;
+		if (!range->getData())
+			return nullptr;
+		const auto size = range->getSize();
+		const uint32_t* offset = range->getSliceMin();
+		const uint8_t* src = reinterpret_cast<const uint8_t*>(range->getData());
+		const size_t srcPitch = range->getPitchIncludingAlignment();
+		core::CTaskScheduler::getGlobal().parallelFor(0u,size.Y*size.Z,_params.grain,[&](uint32_t _begin, uint32_t _end)
+		{
+			for (uint32_t row=_begin; row<_end; row++)
+			{
+				const uint32_t y = offset[1]+row%size.Y, z = offset[2]+row/size.Y;
+				float* out = level.texels.data()+((size_t(z)*level.size[1]+y)*level.size[0]+offset[0])*4u;
+				const void* srcRow[4] = {src+row*srcPitch,nullptr,nullptr,nullptr};
+				core::vector3d<uint32_t> rowSize(size.X,1u,1u);
+				video::convertColor(format,EF_R32G32B32A32_SFLOAT,srcRow,out,size.X,rowSize);
+				for (uint32_t x=0u; x<size.X; x++)
+				for (uint32_t c=channels; c<4u; c++)
+					out[x*4u+c] = c==3u ? 1.f:0.f;
+			}
+		});
+	}
+
+	uint32_t largest = 1u;
+	for (uint32_t d=0u; d<filteredDims; d++)
+		largest = core::max(largest,level.size[d]);
+	uint32_t levelCount = 1u;
+	while (largest>>levelCount)
+		levelCount++;
+
+	core::vector<CImageData*> ranges(baseLevel.first,baseLevel.second);
+	const size_t sharedRanges = ranges.size();
+
+	const bool isInteger = isIntegerFormat(format) || isScaledFormat(format);
+	const bool isNormalized = isNormalizedFormat(format);
+	const bool isSigned = isSignedFormat(format);
+	// negative lobes could push integers out of the range of the format, a box filter can't
+	const E_MIP_MAP_FILTER filter = isInteger ? EMMF_BOX:_params.filter;
+
+	SLevel scratch;
+	SFilterTaps taps;
+	for (uint32_t mip=1u; mip<levelCount; mip++)
+	{
+		uint32_t size[3];
+		std::copy(level.size,level.size+3u,size);
+		for (uint32_t d=0u; d<filteredDims; d++)
+			size[d] = core::max(level.size[d]>>1u,1u);
+		// ICPUTexture refuses levels with any extent, layers included, over 65536>>level
+		if (*std::max_element(size,size+3u)>(0x10000u>>mip))
+			break;
+
+		for (uint32_t d=0u; d<filteredDims; d++)
+		{
+			if (size[d]==level.size[d])
+				continue;
+			computeTaps(filter,level.size[d],size[d],taps);
+			resample(level,scratch,d,size[d],taps,_params.grain);
+			std::swap(level,scratch);
+		}
+
+		const uint32_t minCoord[3] = {0u,0u,0u};
+		auto image = new CImageData(nullptr,minCoord,size,mip,format);
+		ranges.push_back(image);
+
+		uint8_t* dst = reinterpret_cast<uint8_t*>(image->getData());
+		const size_t dstPitch = image->getPitchIncludingAlignment();
+		core::CTaskScheduler::getGlobal().parallelFor(0u,size[1]*size[2],_params.grain,[&](uint32_t _begin, uint32_t _end)
+		{
+			for (uint32_t row=_begin; row<_end; row++)
+			{
+				const float* in = level.texels.data()+size_t(row)*size[0]*4u;
+				core::vector<float> encoded(in,in+size[0]*4u);
+				for (auto& value : encoded)
+				{
+					if (isInteger)
+						value = std::floor(value+0.5f);
+					if (isNormalized)
+						value = core::clamp(value,isSigned ? -1.f:0.f,1.f);
+					else if (!isSigned)
+						value = core::max(value,0.f);
+				}
+
+				const void* srcRow[4] = {encoded.data(),nullptr,nullptr,nullptr};
+				core::vector3d<uint32_t> rowSize(size[0],1u,1u);
+				video::convertColor(EF_R32G32B32A32_SFLOAT,format,srcRow,dst+row*dstPitch,size[0],rowSize);
+			}
+		});
+	}
+
+	ICPUTexture* retval = ICPUTexture::create(ranges,_texture->getSourceFilename(),type);
+	for (size_t i=sharedRanges; i<ranges.size(); i++)
+		ranges[i]->drop();
+	return retval;
+}
+
+}} //irr::asset
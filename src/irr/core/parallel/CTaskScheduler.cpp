@@ -0,0 +1,343 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#include "irr/core/parallel/CTaskScheduler.h"
+
+namespace irr
+{
+namespace core
+{
+
+struct CTaskScheduler::SThreadQueue
+{
+	std::mutex mutex;
+	core::deque<Task*> tasks;
+
+	//! only the owning thread writes these, except for the shared queue
+	std::atomic<uint64_t> submitted;
+	std::atomic<uint64_t> executed;
+	std::atomic<uint64_t> stolen;
+	std::atomic<uint64_t> failedSteals;
+
+	SThreadQueue() : submitted(0ull), executed(0ull), stolen(0ull), failedSteals(0ull) {}
+};
+
+namespace
+{
+	thread_local const CTaskScheduler* LocalScheduler = nullptr;
+	thread_local void* LocalQueue = nullptr;
+	//! task whose functor is running on this thread, parent of the children it spawns
+	thread_local CTaskScheduler::Task* LocalTask = nullptr;
+	thread_local const CTaskScheduler* LocalTaskScheduler = nullptr;
+	thread_local uint32_t LocalRandomState = 0u;
+
+	inline uint32_t nextRandom()
+	{
+		uint32_t x = LocalRandomState ? LocalRandomState:static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()))|1u;
+		x ^= x<<13u;
+		x ^= x>>17u;
+		x ^= x<<5u;
+		LocalRandomState = x;
+		return x;
+	}
+}
+
+
+bool CTaskScheduler::TaskHandle::isDone() const
+{
+	return !task || task->done.load(std::memory_order_acquire);
+}
+
+void CTaskScheduler::TaskHandle::grab()
+{
+	if (task)
+		task->refCount.fetch_add(1u,std::memory_order_relaxed);
+}
+
+void CTaskScheduler::TaskHandle::release()
+{
+	if (task && task->refCount.fetch_sub(1u,std::memory_order_acq_rel)==1u)
+		_IRR_DELETE(task);
+	task = nullptr;
+}
+
+
+CTaskScheduler::CTaskScheduler(uint32_t workerCount) : queuedTasks(0u), liveTasks(0u), sleepingWorkers(0u), stopping(false)
+{
+	if (!workerCount)
+		workerCount = core::max(std::thread::hardware_concurrency(),2u)-1u;
+
+	for (uint32_t i=0u; i<=workerCount; i++)
+		queues.push_back(_IRR_NEW(SThreadQueue));
+	workers.reserve(workerCount);
+	for (uint32_t i=0u; i<workerCount; i++)
+		workers.emplace_back(&CTaskScheduler::workerLoop,this,queues[i]);
+}
+
+CTaskScheduler::~CTaskScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping.store(true);
+	}
+	wakeUp.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+
+	// workers only quit once every task ran, tasks waiting on dependencies included, so nothing is left to leak
+	_IRR_DEBUG_BREAK_IF(liveTasks.load() || queuedTasks.load())
+
+	for (auto queue : queues)
+		_IRR_DELETE(queue);
+}
+
+CTaskScheduler& CTaskScheduler::getGlobal()
+{
+	static CTaskScheduler scheduler;
+	return scheduler;
+}
+
+
+void CTaskScheduler::wait(const TaskHandle& task)
+{
+	SThreadQueue* queue = getLocalQueue();
+	while (!task.isDone())
+	{
+		if (Task* other = findTask(queue))
+			execute(other);
+		else
+			std::this_thread::yield();
+	}
+}
+
+
+CTaskScheduler::SStatistics CTaskScheduler::getStatistics() const
+{
+	SStatistics retval = {0ull,0ull,0ull,0ull};
+	for (auto queue : queues)
+	{
+		retval.submitted += queue->submitted.load(std::memory_order_relaxed);
+		retval.executed += queue->executed.load(std::memory_order_relaxed);
+		retval.stolen += queue->stolen.load(std::memory_order_relaxed);
+		retval.failedSteals += queue->failedSteals.load(std::memory_order_relaxed);
+	}
+	return retval;
+}
+
+void CTaskScheduler::resetStatistics()
+{
+	for (auto queue : queues)
+	{
+		queue->submitted.store(0ull,std::memory_order_relaxed);
+		queue->executed.store(0ull,std::memory_order_relaxed);
+		queue->stolen.store(0ull,std::memory_order_relaxed);
+		queue->failedSteals.store(0ull,std::memory_order_relaxed);
+	}
+}
+
+
+void CTaskScheduler::enqueueAfter(Task* task, const TaskHandle* dependencies, uint32_t dependencyCount)
+{
+	// one reference for the handle given back, one for the scheduler until the functor returned
+	task->refCount.store(2u,std::memory_order_relaxed);
+	task->scheduler = this;
+	liveTasks.fetch_add(1u);
+	getLocalQueue()->submitted.fetch_add(1ull,std::memory_order_relaxed);
+
+	for (uint32_t i=0u; i<dependencyCount; i++)
+	{
+		Task* dependency = dependencies[i].task;
+		if (!dependency)
+			continue;
+
+		std::lock_guard<std::mutex> lock(dependency->continuationMutex);
+		if (dependency->done.load(std::memory_order_relaxed))
+			continue;
+		task->pendingDependencies.fetch_add(1u,std::memory_order_relaxed);
+		dependency->continuations.push_back(task);
+	}
+
+	if (task->pendingDependencies.fetch_sub(1u,std::memory_order_acq_rel)==1u)
+		push(task);
+}
+
+void CTaskScheduler::enqueueChild(Task* task)
+{
+	task->scheduler = this;
+	liveTasks.fetch_add(1u);
+	getLocalQueue()->submitted.fetch_add(1ull,std::memory_order_relaxed);
+	if (LocalTask && LocalTaskScheduler==this)
+	{
+		LocalTask->unfinished.fetch_add(1u,std::memory_order_relaxed);
+		LocalTask->refCount.fetch_add(1u,std::memory_order_relaxed);
+		task->parent = TaskHandle(LocalTask);
+	}
+	task->pendingDependencies.store(0u,std::memory_order_relaxed);
+	push(task);
+}
+
+void CTaskScheduler::push(Task* task)
+{
+	// counted before it can be found, otherwise the thread popping it could wrap the count around
+	queuedTasks.fetch_add(1u);
+	SThreadQueue* queue = getLocalQueue();
+	{
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->tasks.push_back(task);
+	}
+
+	if (sleepingWorkers.load())
+	{
+		// makes sure the worker either saw the new count or is already waiting for the notification
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wakeUp.notify_one();
+	}
+}
+
+CTaskScheduler::Task* CTaskScheduler::findTask(SThreadQueue* queue)
+{
+	Task* task = nullptr;
+	auto pop = [&](SThreadQueue* from, bool back) -> bool
+	{
+		std::lock_guard<std::mutex> lock(from->mutex);
+		if (from->tasks.empty())
+			return false;
+		if (back)
+		{
+			task = from->tasks.back();
+			from->tasks.pop_back();
+		}
+		else
+		{
+			task = from->tasks.front();
+			from->tasks.pop_front();
+		}
+		return true;
+	};
+
+	SThreadQueue* sharedQueue = queues.back();
+	if (!queuedTasks.load(std::memory_order_relaxed))
+		return nullptr;
+
+	// the shared queue is first come first served
+	if (!pop(queue,queue!=sharedQueue) && !pop(sharedQueue,false))
+	{
+		const uint32_t workerCount = getWorkerCount();
+		const uint32_t first = workerCount ? nextRandom()%workerCount:0u;
+		for (uint32_t i=0u; i<workerCount; i++)
+		{
+			SThreadQueue* victim = queues[(first+i)%workerCount];
+			if (victim!=queue && pop(victim,false))
+			{
+				queue->stolen.fetch_add(1ull,std::memory_order_relaxed);
+				break;
+			}
+		}
+		if (!task)
+		{
+			queue->failedSteals.fetch_add(1ull,std::memory_order_relaxed);
+			return nullptr;
+		}
+	}
+
+	queuedTasks.fetch_sub(1u,std::memory_order_relaxed);
+	return task;
+}
+
+void CTaskScheduler::execute(Task* task)
+{
+	Task* const previous = LocalTask;
+	const CTaskScheduler* const previousScheduler = LocalTaskScheduler;
+	LocalTask = task;
+	LocalTaskScheduler = this;
+	task->execute();
+	LocalTask = previous;
+	LocalTaskScheduler = previousScheduler;
+
+	getLocalQueue()->executed.fetch_add(1ull,std::memory_order_relaxed);
+	finishOne(task);
+	// scheduler's reference
+	TaskHandle(task).release();
+	releaseLiveTask();
+}
+
+void CTaskScheduler::releaseLiveTask()
+{
+	if (liveTasks.fetch_sub(1u)==1u && stopping.load())
+	{
+		// last task of a scheduler being destroyed, workers waiting for more have to quit now,
+		// notifying under the lock means the scheduler can't be gone before this thread let go of it
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		wakeUp.notify_all();
+	}
+}
+
+void CTaskScheduler::finishOne(Task* task)
+{
+	if (task->unfinished.fetch_sub(1u,std::memory_order_acq_rel)!=1u)
+		return;
+
+	core::vector<Task*> continuations;
+	{
+		std::lock_guard<std::mutex> lock(task->continuationMutex);
+		task->done.store(true,std::memory_order_release);
+		continuations.swap(task->continuations);
+	}
+	for (auto continuation : continuations)
+	if (continuation->pendingDependencies.fetch_sub(1u,std::memory_order_acq_rel)==1u)
+	{
+		CTaskScheduler* owner = continuation->scheduler;
+		if (owner==this)
+		{
+			push(continuation);
+			continue;
+		}
+		// the continuation could run and its scheduler get destroyed before `push` returned, so hold it alive meanwhile
+		owner->liveTasks.fetch_add(1u);
+		owner->push(continuation);
+		owner->releaseLiveTask();
+	}
+
+	if (task->parent)
+	{
+		Task* parent = task->parent.task;
+		finishOne(parent);
+		task->parent = TaskHandle();
+	}
+}
+
+void CTaskScheduler::workerLoop(SThreadQueue* queue)
+{
+	LocalScheduler = this;
+	LocalQueue = queue;
+	while (true)
+	{
+		if (Task* task = findTask(queue))
+		{
+			execute(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		if (stopping.load() && !liveTasks.load())
+			break;
+		sleepingWorkers.fetch_add(1u);
+		wakeUp.wait(lock,[this]() {return queuedTasks.load()!=0u || stopping.load()&&!liveTasks.load();});
+		sleepingWorkers.fetch_sub(1u);
+	}
+	LocalScheduler = nullptr;
+	LocalQueue = nullptr;
+}
+
+CTaskScheduler::SThreadQueue* CTaskScheduler::getLocalQueue()
+{
+	if (LocalScheduler==this)
+		return reinterpret_cast<SThreadQueue*>(LocalQueue);
+	return queues.back();
+}
+
+} // end namespace core
+} // end namespace irr
@@ -0,0 +1,214 @@
+// Copyright (C) 2019 DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "IrrlichtBaW".
+// For conditions of distribution and use, see LICENSE.md
+
+#include "irr/core/profiling/CProfiler.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <iomanip>
+
+namespace irr
+{
+namespace core
+{
+
+std::atomic<bool> CProfiler::Enabled(false);
+
+namespace
+{
+	struct SThreadRing
+	{
+		uint32_t threadIndex;
+		uint32_t depth = 0u;
+		//! zones ever written, the ring holds the last `min(written,ThreadRingCapacity)` of them
+		std::atomic<uint64_t> written;
+		core::vector<CProfiler::SZone> zones;
+
+		SThreadRing(uint32_t _threadIndex) : threadIndex(_threadIndex), written(0ull), zones(CProfiler::ThreadRingCapacity) {}
+
+		template<class F>
+		void forEach(F&& f) const
+		{
+			const uint64_t end = written.load(std::memory_order_acquire);
+			const uint64_t begin = end>CProfiler::ThreadRingCapacity ? (end-CProfiler::ThreadRingCapacity):0ull;
+			for (uint64_t i=begin; i<end; i++)
+				f(zones[i%CProfiler::ThreadRingCapacity]);
+		}
+	};
+
+	//! rings are never freed, so a thread's zones can be exported after the thread has finished
+	std::mutex RingsMutex;
+	core::vector<std::unique_ptr<SThreadRing> > Rings;
+
+	thread_local SThreadRing* LocalRing = nullptr;
+
+	SThreadRing* getLocalRing()
+	{
+		if (!LocalRing)
+		{
+			std::lock_guard<std::mutex> lock(RingsMutex);
+			Rings.emplace_back(new SThreadRing(static_cast<uint32_t>(Rings.size())));
+			LocalRing = Rings.back().get();
+		}
+		return LocalRing;
+	}
+
+	void writeJSONString(std::ostream& out, const char* str)
+	{
+		out << '"';
+		for (; *str; str++)
+		{
+			switch (*str)
+			{
+				case '"':
+					out << "\\\"";
+					break;
+				case '\\':
+					out << "\\\\";
+					break;
+				default:
+					if (static_cast<unsigned char>(*str)>=0x20u)
+						out << *str;
+					break;
+			}
+		}
+		out << '"';
+	}
+}
+
+
+void CProfiler::setEnabled(bool enabled)
+{
+	Enabled.store(enabled,std::memory_order_relaxed);
+}
+
+void CProfiler::beginZone()
+{
+	getLocalRing()->depth++;
+}
+
+void CProfiler::endZone(const char* name, uint64_t beginNs, uint64_t endNs)
+{
+	SThreadRing* ring = getLocalRing();
+	ring->depth--;
+
+	const uint64_t ix = ring->written.load(std::memory_order_relaxed);
+	ring->zones[ix%ThreadRingCapacity] = {name,beginNs,endNs,ring->depth};
+	ring->written.store(ix+1ull,std::memory_order_release);
+}
+
+void CProfiler::clear()
+{
+	std::lock_guard<std::mutex> lock(RingsMutex);
+	for (auto& ring : Rings)
+		ring->written.store(0ull,std::memory_order_release);
+}
+
+void CProfiler::exportChromeTrace(std::ostream& out)
+{
+	std::lock_guard<std::mutex> lock(RingsMutex);
+
+	uint64_t origin = ~0ull;
+	for (const auto& ring : Rings)
+		ring->forEach([&origin](const SZone& zone) {origin = std::min(origin,zone.beginNs);});
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	for (const auto& ring : Rings)
+	{
+		const uint32_t tid = ring->threadIndex;
+		ring->forEach([&](const SZone& zone)
+		{
+			if (!first)
+				out << ',';
+			first = false;
+
+			// timestamps are in microseconds, keep the nanoseconds as decimals
+			out << "\n{\"ph\":\"X\",\"pid\":0,\"tid\":" << tid << ",\"name\":";
+			writeJSONString(out,zone.name);
+			const uint64_t ts = zone.beginNs-origin;
+			const uint64_t dur = zone.endNs-zone.beginNs;
+			out << ",\"ts\":" << ts/1000ull << '.' << std::setw(3) << std::setfill('0') << ts%1000ull;
+			out << ",\"dur\":" << dur/1000ull << '.' << std::setw(3) << std::setfill('0') << dur%1000ull << '}';
+		});
+	}
+	out << "\n]}\n";
+}
+
+core::vector<CProfiler::SZoneSummary> CProfiler::getSummary()
+{
+	core::unordered_map<std::string,SZoneSummary> summaries;
+	core::vector<SZone> zones;
+	core::vector<std::pair<const SZone*,uint64_t> > stack;
+
+	std::lock_guard<std::mutex> lock(RingsMutex);
+	for (const auto& ring : Rings)
+	{
+		zones.clear();
+		ring->forEach([&zones](const SZone& zone) {zones.push_back(zone);});
+		// zones are written when they end, so parents come after their children, put them in begin order
+		std::sort(zones.begin(),zones.end(),[](const SZone& a, const SZone& b) {return a.beginNs<b.beginNs || (a.beginNs==b.beginNs&&a.depth<b.depth);});
+
+		auto popUntilParentOf = [&](const SZone* zone)
+		{
+			while (!stack.empty() && (zone==nullptr||stack.back().first->endNs<=zone->beginNs||stack.back().first->depth>=zone->depth))
+			{
+				const SZone* done = stack.back().first;
+				const uint64_t duration = done->endNs-done->beginNs;
+				auto& summary = summaries[done->name];
+				if (summary.calls==0u)
+				{
+					summary.name = done->name;
+					summary.minNs = duration;
+				}
+				summary.calls++;
+				summary.totalNs += duration;
+				summary.selfNs += duration-std::min(stack.back().second,duration);
+				summary.minNs = std::min(summary.minNs,duration);
+				summary.maxNs = std::max(summary.maxNs,duration);
+				stack.pop_back();
+			}
+		};
+		for (const auto& zone : zones)
+		{
+			popUntilParentOf(&zone);
+			if (!stack.empty())
+				stack.back().second += zone.endNs-zone.beginNs;
+			stack.emplace_back(&zone,0ull);
+		}
+		popUntilParentOf(nullptr);
+	}
+
+	core::vector<SZoneSummary> retval;
+	retval.reserve(summaries.size());
+	for (auto& summary : summaries)
+		retval.push_back(std::move(summary.second));
+	std::sort(retval.begin(),retval.end(),[](const SZoneSummary& a, const SZoneSummary& b) {return a.totalNs>b.totalNs;});
+	return retval;
+}
+
+void CProfiler::printSummary(std::ostream& out)
+{
+	const auto summary = getSummary();
+
+	size_t nameWidth = 4u;
+	for (const auto& zone : summary)
+		nameWidth = std::max(nameWidth,zone.name.size());
+
+	auto ms = [](uint64_t ns) {return double(ns)/1000000.0;};
+	out << std::left << std::setw(nameWidth) << "Zone" << std::right
+		<< std::setw(10) << "Calls" << std::setw(14) << "Total ms" << std::setw(14) << "Self ms"
+		<< std::setw(12) << "Avg ms" << std::setw(12) << "Min ms" << std::setw(12) << "Max ms" << '\n';
+	out << std::fixed << std::setprecision(3);
+	for (const auto& zone : summary)
+	{
+		out << std::left << std::setw(nameWidth) << zone.name << std::right
+			<< std::setw(10) << zone.calls << std::setw(14) << ms(zone.totalNs) << std::setw(14) << ms(zone.selfNs)
+			<< std::setw(12) << ms(zone.totalNs)/double(zone.calls) << std::setw(12) << ms(zone.minNs) << std::setw(12) << ms(zone.maxNs) << '\n';
+	}
+}
+
+} // end namespace core
+} // end namespace irr